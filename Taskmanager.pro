@@ -1,19 +1,97 @@
 QT       += core gui network printsupport
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets charts sql serialport
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets charts sql serialport concurrent
 
 CONFIG += c++17
 
+# QCryptographicHash::addData(QByteArrayView)
+!versionAtLeast(QT_VERSION, 6.3.0): error("Qt 6.3 or later is required")
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    analyticscube.cpp \
+    archivestore.cpp \
+    attachmentsdialog.cpp \
+    attachmentstore.cpp \
+    backupmanager.cpp \
+    backupsdialog.cpp \
+    budgettree.cpp \
+    chartrenderer.cpp \
+    descriptionstore.cpp \
+    diagnostics.cpp \
+    filterquery.cpp \
+    fuzzysearch.cpp \
+    ganttview.cpp \
+    historystore.cpp \
+    invoiceengine.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    mapview.cpp \
+    materialsdialog.cpp \
+    materialsstore.cpp \
+    notificationcenter.cpp \
+    projectsdialog.cpp \
+    projectstore.cpp \
+    recurrencerule.cpp \
+    recurrencestore.cpp \
+    recurringdialog.cpp \
+    reportscheduler.cpp \
+    reportsdialog.cpp \
+    spatialindex.cpp \
+    taskgraph.cpp \
+    taskpack.cpp \
+    thumbnailcache.cpp \
+    tilecache.cpp \
+    timetracker.cpp \
+    toastoverlay.cpp \
+    trendindex.cpp \
+    undojournal.cpp \
+    workloadengine.cpp \
+    workloadheatmap.cpp
 
 HEADERS += \
-    mainwindow.h
+    analyticscube.h \
+    archivestore.h \
+    attachmentsdialog.h \
+    attachmentstore.h \
+    backupmanager.h \
+    backupsdialog.h \
+    budgettree.h \
+    chartrenderer.h \
+    descriptionstore.h \
+    diagnostics.h \
+    filterquery.h \
+    fuzzysearch.h \
+    ganttview.h \
+    historystore.h \
+    invoiceengine.h \
+    mainwindow.h \
+    mapview.h \
+    materialsdialog.h \
+    materialsstore.h \
+    notificationcenter.h \
+    projectsdialog.h \
+    projectstore.h \
+    recurrencerule.h \
+    recurrencestore.h \
+    recurringdialog.h \
+    reportscheduler.h \
+    reportsdialog.h \
+    spatialindex.h \
+    taskgraph.h \
+    taskpack.h \
+    taskrecord.h \
+    thumbnailcache.h \
+    tilecache.h \
+    timetracker.h \
+    toastoverlay.h \
+    trendindex.h \
+    undojournal.h \
+    workloadengine.h \
+    workloadheatmap.h
 
 FORMS += \
     mainwindow.ui
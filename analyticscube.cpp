@@ -0,0 +1,287 @@
+#include "analyticscube.h"
+#include <QPair>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+const QChar key_separator(0x1f);
+
+// Résultat partiel d'un lot de tâches, fusionné après le calcul parallèle
+struct PartialCube
+{
+    QHash<QString, AnalyticsCube::Cell> cells;
+    QHash<QString, AnalyticsCube::Contribution> contributions;
+};
+
+void sortLabels(AnalyticsCube::Dimension dimension, QStringList &labels)
+{
+    QStringList order;
+    if (dimension == AnalyticsCube::Status) order = TaskRecord::statuses();
+    if (dimension == AnalyticsCube::Priority) order = TaskRecord::priorities();
+
+    std::sort(labels.begin(), labels.end(), [&order](const QString &a, const QString &b) {
+        // Ordre métier pour statut et priorité, valeurs inconnues en dernier
+        int rankA = order.indexOf(a);
+        int rankB = order.indexOf(b);
+        if (rankA != rankB) {
+            if (rankA < 0) return false;
+            if (rankB < 0) return true;
+            return rankA < rankB;
+        }
+        return a.compare(b, Qt::CaseInsensitive) < 0;
+    });
+}
+
+QString csvField(const QString &text)
+{
+    if (!text.contains(',') && !text.contains('"') && !text.contains('\n')) return text;
+    return QString("\"%1\"").arg(QString(text).replace("\"", "\"\""));
+}
+
+QString formatMeasure(const AnalyticsCube::Measures &measures, AnalyticsCube::Measure measure)
+{
+    if (measure == AnalyticsCube::AverageDays) {
+        return QString::number(measures.value(measure), 'f', 1);
+    }
+    return QString::number(int(measures.value(measure)));
+}
+
+}
+
+void AnalyticsCube::Measures::add(const Measures &other, int sign)
+{
+    count += sign * other.count;
+    overdue += sign * other.overdue;
+    days += sign * other.days;
+}
+
+double AnalyticsCube::Measures::value(Measure measure) const
+{
+    switch (measure) {
+    case Count: return count;
+    case Overdue: return overdue;
+    case AverageDays: return count ? double(days) / count : 0.0;
+    }
+    return 0.0;
+}
+
+QString AnalyticsCube::dimensionName(Dimension dimension)
+{
+    switch (dimension) {
+    case Status: return "Status";
+    case Priority: return "Priority";
+    case Assignee: return "Assignee";
+    case Month: return "Month";
+    default: return QString();
+    }
+}
+
+QString AnalyticsCube::measureName(Measure measure)
+{
+    switch (measure) {
+    case Count: return "Tasks";
+    case Overdue: return "Overdue";
+    case AverageDays: return "Average Days";
+    }
+    return QString();
+}
+
+QStringList AnalyticsCube::labelsFor(const TaskRecord &task)
+{
+    QString assignee = task.assignedTo.trimmed();
+    return {task.status,
+            task.priority,
+            assignee.isEmpty() ? QString("Unassigned") : assignee,
+            task.endDate.isValid() ? task.endDate.toString("yyyy-MM") : QString("No date")};
+}
+
+AnalyticsCube::Contribution AnalyticsCube::contributionFor(const TaskRecord &task, const QDate &today,
+                                                           QStringList *labels)
+{
+    *labels = labelsFor(task);
+
+    Contribution contribution;
+    contribution.cellKey = labels->join(key_separator);
+    contribution.measures.count = 1;
+    contribution.measures.overdue = (task.endDate.isValid() && task.endDate < today
+                                     && task.status != "Completed") ? 1 : 0;
+    if (task.startDate.isValid() && task.endDate.isValid()) {
+        contribution.measures.days = qMax<qint64>(1, task.startDate.daysTo(task.endDate) + 1);
+    }
+    return contribution;
+}
+
+void AnalyticsCube::addContribution(const QString &taskId, const Contribution &contribution,
+                                    const QStringList &labels)
+{
+    Cell &cell = cells[contribution.cellKey];
+    if (cell.labels.isEmpty()) {
+        cell.labels = labels;
+    }
+    cell.measures.add(contribution.measures);
+    contributions.insert(taskId, contribution);
+}
+
+void AnalyticsCube::rebuild(const QVector<TaskRecord> &tasks)
+{
+    cells.clear();
+    contributions.clear();
+    asOf = QDate::currentDate();
+    if (tasks.isEmpty()) return;
+
+    // Un lot par cœur; chaque lot agrège localement puis les cubes partiels sont fusionnés
+    int chunkCount = qMax(1, QThread::idealThreadCount());
+    int chunkSize = (int(tasks.size()) + chunkCount - 1) / chunkCount;
+    QVector<QPair<int, int>> ranges;
+    for (int begin = 0; begin < tasks.size(); begin += chunkSize) {
+        ranges << qMakePair(begin, qMin(begin + chunkSize, int(tasks.size())));
+    }
+
+    QDate today = asOf;
+    PartialCube merged = QtConcurrent::blockingMappedReduced<PartialCube>(
+        ranges,
+        [&tasks, today](const QPair<int, int> &range) {
+            PartialCube part;
+            for (int i = range.first; i < range.second; ++i) {
+                QStringList labels;
+                Contribution contribution = contributionFor(tasks[i], today, &labels);
+                Cell &cell = part.cells[contribution.cellKey];
+                if (cell.labels.isEmpty()) {
+                    cell.labels = labels;
+                }
+                cell.measures.add(contribution.measures);
+                part.contributions.insert(tasks[i].id, contribution);
+            }
+            return part;
+        },
+        [](PartialCube &result, const PartialCube &part) {
+            for (auto it = part.cells.constBegin(); it != part.cells.constEnd(); ++it) {
+                Cell &cell = result.cells[it.key()];
+                if (cell.labels.isEmpty()) {
+                    cell.labels = it->labels;
+                }
+                cell.measures.add(it->measures);
+            }
+            result.contributions.insert(part.contributions);
+        });
+
+    cells = merged.cells;
+    contributions = merged.contributions;
+}
+
+void AnalyticsCube::updateTask(const TaskRecord &task)
+{
+    removeTask(task.id);
+    if (!asOf.isValid()) {
+        asOf = QDate::currentDate();
+    }
+
+    QStringList labels;
+    addContribution(task.id, contributionFor(task, asOf, &labels), labels);
+}
+
+void AnalyticsCube::renameTask(const QString &oldId, const QString &newId)
+{
+    if (!contributions.contains(oldId)) return;
+    contributions.insert(newId, contributions.take(oldId));
+}
+
+void AnalyticsCube::removeTask(const QString &taskId)
+{
+    auto it = contributions.find(taskId);
+    if (it == contributions.end()) return;
+
+    auto cell = cells.find(it->cellKey);
+    if (cell != cells.end()) {
+        cell->measures.add(it->measures, -1);
+        if (cell->measures.count == 0) {
+            cells.erase(cell);
+        }
+    }
+    contributions.erase(it);
+}
+
+AnalyticsCube::Pivot AnalyticsCube::pivot(Dimension rows, Dimension columns,
+                                          const QHash<int, QString> &filters) const
+{
+    QHash<QString, QHash<QString, Measures>> grid;
+    QHash<QString, Measures> columnSums;
+
+    for (const Cell &cell : cells) {
+        bool match = true;
+        for (auto filter = filters.constBegin(); filter != filters.constEnd(); ++filter) {
+            if (cell.labels.value(filter.key()) != filter.value()) {
+                match = false;
+                break;
+            }
+        }
+        if (!match) continue;
+
+        const QString &rowLabel = cell.labels[rows];
+        const QString &columnLabel = cell.labels[columns];
+        grid[rowLabel][columnLabel].add(cell.measures);
+        columnSums[columnLabel].add(cell.measures);
+    }
+
+    Pivot result;
+    result.rows = rows;
+    result.columns = columns;
+    result.rowLabels = grid.keys();
+    result.columnLabels = columnSums.keys();
+    sortLabels(rows, result.rowLabels);
+    sortLabels(columns, result.columnLabels);
+
+    for (const QString &rowLabel : std::as_const(result.rowLabels)) {
+        const QHash<QString, Measures> &row = grid[rowLabel];
+        QVector<Measures> line;
+        Measures rowTotal;
+        for (const QString &columnLabel : std::as_const(result.columnLabels)) {
+            Measures measures = row.value(columnLabel);
+            line << measures;
+            rowTotal.add(measures);
+        }
+        result.cells << line;
+        result.rowTotals << rowTotal;
+        result.total.add(rowTotal);
+    }
+    for (const QString &columnLabel : std::as_const(result.columnLabels)) {
+        result.columnTotals << columnSums.value(columnLabel);
+    }
+    return result;
+}
+
+QString AnalyticsCube::toCsv(const Pivot &pivot, Measure measure)
+{
+    QStringList lines;
+
+    QStringList header;
+    header << csvField(QString("%1 / %2 (%3)").arg(dimensionName(pivot.rows), dimensionName(pivot.columns),
+                                                   measureName(measure)));
+    for (const QString &label : pivot.columnLabels) {
+        header << csvField(label);
+    }
+    header << "Total";
+    lines << header.join(',');
+
+    for (int r = 0; r < pivot.rowLabels.size(); ++r) {
+        QStringList line;
+        line << csvField(pivot.rowLabels[r]);
+        for (const Measures &measures : pivot.cells[r]) {
+            line << formatMeasure(measures, measure);
+        }
+        line << formatMeasure(pivot.rowTotals[r], measure);
+        lines << line.join(',');
+    }
+
+    QStringList footer;
+    footer << "Total";
+    for (const Measures &measures : pivot.columnTotals) {
+        footer << formatMeasure(measures, measure);
+    }
+    footer << formatMeasure(pivot.total, measure);
+    lines << footer.join(',');
+
+    return lines.join("\n") + "\n";
+}
@@ -0,0 +1,80 @@
+#ifndef ANALYTICSCUBE_H
+#define ANALYTICSCUBE_H
+
+#include <QDate>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "taskrecord.h"
+
+// Cube pré-agrégé statut x priorité x personne x mois (d'échéance).
+// Chaque cellule de base cumule les mesures des tâches qui y tombent;
+// un pivot agrège les cellules de base (roll-up) en filtrant sur les
+// dimensions déjà explorées (drill-down).
+class AnalyticsCube
+{
+public:
+    enum Dimension { Status, Priority, Assignee, Month, DimensionCount };
+    enum Measure { Count, Overdue, AverageDays };
+
+    struct Measures
+    {
+        int count = 0;
+        int overdue = 0;
+        qint64 days = 0;
+
+        void add(const Measures &other, int sign = 1);
+        double value(Measure measure) const;
+    };
+
+    struct Pivot
+    {
+        Dimension rows;
+        Dimension columns;
+        QStringList rowLabels;
+        QStringList columnLabels;
+        QVector<QVector<Measures>> cells;
+        QVector<Measures> rowTotals;
+        QVector<Measures> columnTotals;
+        Measures total;
+    };
+
+    static QString dimensionName(Dimension dimension);
+    static QString measureName(Measure measure);
+
+    // Reconstruction complète répartie sur tous les cœurs
+    void rebuild(const QVector<TaskRecord> &tasks);
+    void updateTask(const TaskRecord &task);
+    void renameTask(const QString &oldId, const QString &newId);
+    void removeTask(const QString &taskId);
+
+    // Les tâches en retard dépendent de la date du jour
+    bool isStale() const { return asOf != QDate::currentDate(); }
+
+    Pivot pivot(Dimension rows, Dimension columns, const QHash<int, QString> &filters) const;
+    static QString toCsv(const Pivot &pivot, Measure measure);
+
+    struct Cell
+    {
+        QStringList labels;
+        Measures measures;
+    };
+
+    struct Contribution
+    {
+        QString cellKey;
+        Measures measures;
+    };
+
+private:
+    QHash<QString, Cell> cells;
+    QHash<QString, Contribution> contributions;
+    QDate asOf;
+
+    static QStringList labelsFor(const TaskRecord &task);
+    static Contribution contributionFor(const TaskRecord &task, const QDate &today, QStringList *labels);
+    void addContribution(const QString &taskId, const Contribution &contribution, const QStringList &labels);
+};
+
+#endif // ANALYTICSCUBE_H
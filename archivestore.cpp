@@ -0,0 +1,410 @@
+#include "archivestore.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QUuid>
+#include <QVariant>
+#include <QtConcurrent>
+
+static const QLatin1String shard_alias("archive_shard");
+
+// Connexion en lecture seule propre au thread appelant, fermée après read()
+template <typename Read>
+static void readShardFile(const QString &path, Read read)
+{
+    QString name = "Archive-" + QUuid::createUuid().toString(QUuid::WithoutBraces);
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", name);
+        database.setDatabaseName(path);
+        database.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if (database.open()) {
+            read(database);
+        } else {
+            qWarning() << "Failed to open archive" << path << database.lastError().text();
+        }
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+}
+
+void ArchiveStore::setDatabase(const QSqlDatabase &database)
+{
+    db = database;
+}
+
+void ArchiveStore::setDirectory(const QString &directory)
+{
+    archiveDir = directory;
+}
+
+bool ArchiveStore::initialize(QString *error)
+{
+    QSqlQuery query(db);
+    if (!query.exec("SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name = 'archived_ids'") ||
+        !query.next()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    bool created = query.value(0).toInt() == 0;
+
+    QStringList schemaSQL = {
+        // restoring = 1 le temps que restoreYear() réinsère l'année
+        "CREATE TABLE IF NOT EXISTS archived_ids ("
+        "   id TEXT NOT NULL,"
+        "   year INTEGER NOT NULL,"
+        "   restoring INTEGER NOT NULL DEFAULT 0,"
+        "   PRIMARY KEY (id, year)"
+        ")",
+        "CREATE TRIGGER IF NOT EXISTS trg_tasks_archived_id_insert BEFORE INSERT ON tasks "
+        "WHEN EXISTS (SELECT 1 FROM archived_ids WHERE id = NEW.id AND restoring = 0) "
+        "BEGIN SELECT RAISE(ABORT, 'task ID belongs to an archived task'); END",
+        "CREATE TRIGGER IF NOT EXISTS trg_tasks_archived_id_update BEFORE UPDATE OF id ON tasks "
+        "WHEN NEW.id <> OLD.id AND EXISTS (SELECT 1 FROM archived_ids WHERE id = NEW.id) "
+        "BEGIN SELECT RAISE(ABORT, 'task ID belongs to an archived task'); END"
+    };
+    for (const QString &sql : schemaSQL) {
+        if (!query.exec(sql)) {
+            if (error) *error = query.lastError().text();
+            return false;
+        }
+    }
+    if (!created) return true;
+
+    // Archives écrites avant la table : leurs ID sont réservés d'un coup
+    const QVector<Shard> existing = shards();
+    if (existing.isEmpty()) return true;
+    bool ok = db.transaction();
+    if (ok) ok = query.prepare("INSERT OR IGNORE INTO archived_ids (id, year) VALUES (?, ?)");
+    for (int i = 0; ok && i < existing.size(); ++i) {
+        QVariantList ids, years;
+        readShardFile(existing[i].path, [&ids](const QSqlDatabase &database) {
+            QSqlQuery shardQuery("SELECT id FROM tasks", database);
+            while (shardQuery.next()) {
+                ids << shardQuery.value(0);
+            }
+        });
+        for (int j = 0; j < ids.size(); ++j) {
+            years << existing[i].year;
+        }
+        if (ids.isEmpty()) continue;
+        query.addBindValue(ids);
+        query.addBindValue(years);
+        ok = query.execBatch();
+    }
+    if (ok && db.commit()) return true;
+    if (error) *error = query.lastError().isValid() ? query.lastError().text() : db.lastError().text();
+    db.rollback();
+    return false;
+}
+
+QString ArchiveStore::shardPath(int year) const
+{
+    return QDir(archiveDir).filePath(QString("tasks-%1.db").arg(year));
+}
+
+QVector<ArchiveStore::Shard> ArchiveStore::shards() const
+{
+    QVector<Shard> result;
+    static const QRegularExpression pattern("^tasks-(\\d{4})\\.db$");
+    const QFileInfoList files = QDir(archiveDir).entryInfoList({"tasks-*.db"}, QDir::Files, QDir::Name);
+    for (const QFileInfo &file : files) {
+        QRegularExpressionMatch match = pattern.match(file.fileName());
+        if (!match.hasMatch()) continue;
+
+        Shard shard;
+        shard.year = match.captured(1).toInt();
+        shard.path = file.absoluteFilePath();
+        shard.size = file.size();
+        result << shard;
+    }
+
+    // Comptes lus en parallèle : un fichier par connexion
+    QVector<int> counts = QtConcurrent::blockingMapped<QVector<int>>(result, [](const Shard &shard) {
+        int count = 0;
+        readShardFile(shard.path, [&count](const QSqlDatabase &database) {
+            QSqlQuery query("SELECT COUNT(*) FROM tasks", database);
+            if (query.next()) count = query.value(0).toInt();
+        });
+        return count;
+    });
+    for (int i = 0; i < result.size(); ++i) {
+        result[i].taskCount = counts[i];
+    }
+    return result;
+}
+
+bool ArchiveStore::attach(const QString &path, QString *error)
+{
+    if (!QDir().mkpath(archiveDir)) {
+        if (error) *error = QString("Could not create %1").arg(archiveDir);
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.prepare(QString("ATTACH DATABASE :path AS %1").arg(shard_alias));
+    query.bindValue(":path", path);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+void ArchiveStore::detach()
+{
+    QSqlQuery query(db);
+    if (!query.exec(QString("DETACH DATABASE %1").arg(shard_alias))) {
+        qWarning() << "Failed to detach archive:" << query.lastError().text();
+    }
+}
+
+bool ArchiveStore::prepareShard(QStringList *columns, QString *error)
+{
+    QSqlQuery query(db);
+    QStringList statements = {
+        QString("CREATE TABLE IF NOT EXISTS %1.tasks (id TEXT PRIMARY KEY)").arg(shard_alias),
+        QString("CREATE TABLE IF NOT EXISTS %1.task_dependencies ("
+                "   predecessor_id TEXT NOT NULL,"
+                "   successor_id TEXT NOT NULL,"
+                "   PRIMARY KEY (predecessor_id, successor_id)"
+                ")").arg(shard_alias)
+    };
+    for (const QString &sql : statements) {
+        if (!query.exec(sql)) {
+            if (error) *error = query.lastError().text();
+            return false;
+        }
+    }
+
+    // Colonnes ajoutées à la base active depuis la création de l'archive
+    QStringList existing;
+    if (!query.exec(QString("PRAGMA %1.table_info(tasks)").arg(shard_alias))) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        existing << query.value(1).toString();
+    }
+
+    struct Column { QString name, type, defaultValue; bool notNull; };
+    QVector<Column> mainColumns;
+    if (!query.exec("PRAGMA main.table_info(tasks)")) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        mainColumns.append({query.value(1).toString(), query.value(2).toString(),
+                            query.value(4).isNull() ? QString() : query.value(4).toString(),
+                            query.value(3).toBool()});
+    }
+
+    columns->clear();
+    for (const Column &column : mainColumns) {
+        *columns << column.name;
+        if (existing.contains(column.name)) continue;
+
+        // NOT NULL n'est possible qu'avec une valeur par défaut
+        QString definition = column.type;
+        if (!column.defaultValue.isEmpty()) {
+            definition += (column.notNull ? " NOT NULL DEFAULT " : " DEFAULT ") + column.defaultValue;
+        }
+        if (!query.exec(QString("ALTER TABLE %1.tasks ADD COLUMN %2 %3").arg(shard_alias, column.name, definition))) {
+            if (error) *error = query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ArchiveStore::archiveCompleted(const QDate &before, QStringList *movedIds, QString *error)
+{
+    movedIds->clear();
+    QString cutoff = before.toString("yyyy-MM-dd");
+
+    QSqlQuery query(db);
+    query.prepare("SELECT DISTINCT strftime('%Y', completed_at) FROM tasks "
+                  "WHERE status = 'Completed' AND completed_at IS NOT NULL AND completed_at < :before");
+    query.bindValue(":before", cutoff);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    QStringList years;
+    while (query.next()) {
+        years << query.value(0).toString();
+    }
+
+    if (!query.exec("CREATE TEMP TABLE IF NOT EXISTS archive_batch (id TEXT PRIMARY KEY)")) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+
+    // Une année à la fois, un seul fichier attaché. En WAL une transaction sur deux
+    // fichiers n'est pas atomique : l'archive est validée d'abord, la base active
+    // ensuite. Un arrêt entre les deux laisse une copie identique dans l'archive,
+    // reprise (remplacée) au prochain archivage.
+    for (const QString &year : years) {
+        if (!attach(shardPath(year.toInt()), error)) return false;
+
+        QStringList columns;
+        bool ok = prepareShard(&columns, error);
+        if (ok) {
+            QString columnList = columns.join(", ");
+            const QString inBatch = "IN (SELECT id FROM temp.archive_batch)";
+            ok = db.transaction();
+            if (ok) ok = query.exec("DELETE FROM temp.archive_batch");
+            if (ok) {
+                // Un ID archivé autrement (réutilisé avant archived_ids) reste actif
+                query.prepare("INSERT INTO temp.archive_batch SELECT id FROM main.tasks "
+                              "WHERE status = 'Completed' AND completed_at IS NOT NULL AND completed_at < :before "
+                              "AND strftime('%Y', completed_at) = :year "
+                              "AND id NOT IN (SELECT s.id FROM archive_shard.tasks s JOIN main.tasks m ON m.id = s.id "
+                              "               WHERE s.updated_at IS NOT m.updated_at)");
+                query.bindValue(":before", cutoff);
+                query.bindValue(":year", year);
+                ok = query.exec();
+            }
+            QStringList statements = {
+                QString("INSERT OR REPLACE INTO %1.tasks (%2) SELECT %2 FROM main.tasks WHERE id %3")
+                    .arg(shard_alias, columnList, inBatch),
+                QString("INSERT OR IGNORE INTO %1.task_dependencies (predecessor_id, successor_id) "
+                        "SELECT predecessor_id, successor_id FROM main.task_dependencies "
+                        "WHERE predecessor_id %2 OR successor_id %2").arg(shard_alias, inBatch),
+                QString(),      // validation de l'archive
+                QString("INSERT OR IGNORE INTO main.archived_ids (id, year) SELECT id, %1 FROM temp.archive_batch")
+                    .arg(year.toInt()),
+                QString("DELETE FROM main.task_dependencies WHERE predecessor_id %1 OR successor_id %1").arg(inBatch),
+                QString("DELETE FROM main.tasks WHERE id %1").arg(inBatch)
+            };
+            for (int i = 0; ok && i < statements.size(); ++i) {
+                ok = statements[i].isEmpty() ? db.commit() && db.transaction() : query.exec(statements[i]);
+            }
+
+            QStringList ids;
+            if (ok && (ok = query.exec("SELECT id FROM temp.archive_batch"))) {
+                while (query.next()) {
+                    ids << query.value(0).toString();
+                }
+            }
+            if (ok && db.commit()) {
+                *movedIds += ids;
+            } else {
+                if (error) *error = query.lastError().isValid() ? query.lastError().text() : db.lastError().text();
+                db.rollback();
+                ok = false;
+            }
+        }
+        query.finish();     // DETACH échoue tant qu'une requête reste ouverte sur le fichier
+        detach();
+        if (!ok) return false;
+    }
+    return true;
+}
+
+bool ArchiveStore::restoreYear(int year, QStringList *restoredIds, QString *error)
+{
+    restoredIds->clear();
+    QString path = shardPath(year);
+    if (!QFileInfo::exists(path)) {
+        if (error) *error = QString("No archive for %1").arg(year);
+        return false;
+    }
+    if (!attach(path, error)) return false;
+
+    QStringList columns;
+    bool ok = prepareShard(&columns, error);
+    QSqlQuery query(db);
+
+    // Un identifiant réutilisé depuis l'archivage bloquerait la restauration d'une partie de l'année
+    if (ok && (ok = query.exec(QString("SELECT COUNT(*) FROM %1.tasks WHERE id IN (SELECT id FROM main.tasks)")
+                                   .arg(shard_alias)))) {
+        int conflicts = query.next() ? query.value(0).toInt() : 0;
+        query.finish();
+        if (conflicts > 0) {
+            if (error) *error = QString("%1 archived task ID(s) are in use again").arg(conflicts);
+            detach();
+            return false;
+        }
+    }
+
+    if (ok) {
+        QString columnList = columns.join(", ");
+        ok = db.transaction();
+        QStringList statements = {
+            QString("UPDATE main.archived_ids SET restoring = 1 WHERE year = %1").arg(year),
+            QString("INSERT INTO main.tasks (%2) SELECT %2 FROM %1.tasks").arg(shard_alias, columnList),
+            QString("DELETE FROM main.archived_ids WHERE year = %1").arg(year),
+            QString("INSERT OR IGNORE INTO main.task_dependencies (predecessor_id, successor_id) "
+                    "SELECT predecessor_id, successor_id FROM %1.task_dependencies").arg(shard_alias),
+            QString("SELECT id FROM %1.tasks").arg(shard_alias)
+        };
+        for (int i = 0; ok && i < statements.size(); ++i) {
+            ok = query.exec(statements[i]);
+        }
+        QStringList ids;
+        while (ok && query.next()) {
+            ids << query.value(0).toString();
+        }
+        if (ok && db.commit()) {
+            *restoredIds = ids;
+        } else {
+            if (error) *error = query.lastError().isValid() ? query.lastError().text() : db.lastError().text();
+            db.rollback();
+            ok = false;
+        }
+    }
+    query.finish();
+    detach();
+
+    if (ok && !QFile::remove(path)) {
+        qWarning() << "Restored archive could not be removed:" << path;
+    }
+    return ok;
+}
+
+QVector<TaskRecord> ArchiveStore::readShard(const QString &path)
+{
+    QVector<TaskRecord> tasks;
+    readShardFile(path, [&tasks](const QSqlDatabase &database) {
+        QSqlQuery query("SELECT id, name, status, priority, start_date, end_date, assigned_to FROM tasks", database);
+        while (query.next()) {
+            TaskRecord task;
+            task.id = query.value(0).toString();
+            task.name = query.value(1).toString();
+            task.status = query.value(2).toString();
+            task.priority = query.value(3).toString();
+            task.startDate = QDate::fromString(query.value(4).toString(), "yyyy-MM-dd");
+            task.endDate = QDate::fromString(query.value(5).toString(), "yyyy-MM-dd");
+            task.assignedTo = query.value(6).toString();
+            tasks << task;
+        }
+    });
+    return tasks;
+}
+
+QVector<TaskRecord> ArchiveStore::archivedRecords() const
+{
+    QStringList paths;
+    const QFileInfoList files = QDir(archiveDir).entryInfoList({"tasks-*.db"}, QDir::Files, QDir::Name);
+    for (const QFileInfo &file : files) {
+        paths << file.absoluteFilePath();
+    }
+
+    QVector<QVector<TaskRecord>> perShard = QtConcurrent::blockingMapped<QVector<QVector<TaskRecord>>>(
+        paths, &ArchiveStore::readShard);
+
+    // ID préfixé par l'année : un identifiant réutilisé depuis ne masque pas la tâche archivée
+    QVector<TaskRecord> tasks;
+    for (int i = 0; i < perShard.size(); ++i) {
+        QString prefix = QFileInfo(paths[i]).completeBaseName().mid(6) + "/";
+        for (TaskRecord task : perShard[i]) {
+            task.id.prepend(prefix);
+            tasks << task;
+        }
+    }
+    return tasks;
+}
@@ -0,0 +1,59 @@
+#ifndef ARCHIVESTORE_H
+#define ARCHIVESTORE_H
+
+#include <QDate>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "taskrecord.h"
+
+// Tâches terminées sorties de la base active, un fichier par année
+// d'achèvement (archive/tasks-2023.db). Le déplacement passe par ATTACH,
+// l'archive validée avant la base active (en WAL, une transaction n'est pas
+// atomique entre fichiers). Les requêtes courantes ne lisent plus que la
+// base active; les rapports de portefeuille parcourent
+// les archives en parallèle, une connexion en lecture seule par fichier.
+// Un ID archivé reste réservé (archived_ids) : pièces jointes, temps et
+// mouvements de stock restent dans la base active sous cet ID, une nouvelle
+// tâche ne doit pas en hériter. Les synthèses des rapports s'en servent
+// aussi pour distinguer un archivage d'une suppression.
+class ArchiveStore
+{
+public:
+    struct Shard
+    {
+        int year = 0;
+        QString path;
+        int taskCount = 0;
+        qint64 size = 0;
+    };
+
+    void setDatabase(const QSqlDatabase &database);
+    void setDirectory(const QString &directory);
+    QString directory() const { return archiveDir; }
+    // Table des ID réservés et triggers; remplie depuis les archives à sa création
+    bool initialize(QString *error);
+
+    QVector<Shard> shards() const;
+
+    // Tâches terminées avant la date, rangées dans le fichier de leur année
+    bool archiveCompleted(const QDate &before, QStringList *movedIds, QString *error);
+    // Toute une année revient dans la base active, puis son fichier est supprimé
+    bool restoreYear(int year, QStringList *restoredIds, QString *error);
+
+    // Lecture parallèle de toutes les archives, ID préfixés par l'année ("2023/T001")
+    QVector<TaskRecord> archivedRecords() const;
+    static QVector<TaskRecord> readShard(const QString &path);
+
+private:
+    QSqlDatabase db;
+    QString archiveDir;
+
+    QString shardPath(int year) const;
+    bool attach(const QString &path, QString *error);
+    void detach();
+    bool prepareShard(QStringList *columns, QString *error);
+};
+
+#endif // ARCHIVESTORE_H
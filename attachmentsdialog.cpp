@@ -0,0 +1,294 @@
+#include "attachmentsdialog.h"
+#include <QEventLoop>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QHBoxLayout>
+#include <QMessageBox>
+#include <QMutex>
+#include <QPainter>
+#include <QProgressDialog>
+#include <QPushButton>
+#include <QStyle>
+#include <QStyledItemDelegate>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+
+static const int thumbnail_size = 160;
+
+namespace {
+
+// Dessine la vignette si elle est en cache, sinon un cadre et la demande
+class ThumbnailDelegate : public QStyledItemDelegate
+{
+public:
+    static const int HashRole = Qt::UserRole + 1;
+    static const int PathRole = Qt::UserRole + 2;
+
+    ThumbnailDelegate(ThumbnailCache *thumbnails, QObject *parent)
+        : QStyledItemDelegate(parent), thumbnails(thumbnails) {}
+
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &) const override
+    {
+        return QSize(thumbnail_size + 16, thumbnail_size + option.fontMetrics.height() + 16);
+    }
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override
+    {
+        painter->save();
+        if (option.state & QStyle::State_Selected) {
+            painter->fillRect(option.rect, option.palette.highlight());
+        }
+
+        QRect imageRect(option.rect.x() + 8, option.rect.y() + 8, thumbnail_size, thumbnail_size);
+        QImage image = thumbnails->thumbnail(index.data(HashRole).toString(),
+                                             index.data(PathRole).toString(), thumbnail_size);
+        if (image.isNull()) {
+            painter->setPen(QColor(206, 212, 218));
+            painter->drawRect(imageRect.adjusted(0, 0, -1, -1));
+            painter->drawText(imageRect, Qt::AlignCenter,
+                              QFileInfo(index.data(Qt::DisplayRole).toString()).suffix().toUpper());
+        } else {
+            QSize size = image.size().scaled(imageRect.size(), Qt::KeepAspectRatio);
+            QRect target(QPoint(0, 0), size);
+            target.moveCenter(imageRect.center());
+            painter->drawImage(target, image);
+        }
+
+        QRect textRect(option.rect.x() + 4, imageRect.bottom() + 4,
+                       option.rect.width() - 8, option.fontMetrics.height());
+        painter->setPen(option.state & QStyle::State_Selected ? option.palette.highlightedText().color()
+                                                              : option.palette.text().color());
+        painter->drawText(textRect, Qt::AlignCenter,
+                          option.fontMetrics.elidedText(index.data(Qt::DisplayRole).toString(),
+                                                        Qt::ElideMiddle, textRect.width()));
+        painter->restore();
+    }
+
+private:
+    ThumbnailCache *thumbnails;
+};
+
+}
+
+AttachmentsDialog::AttachmentsDialog(AttachmentStore *store, ThumbnailCache *thumbnails, const QStringList &taskIds,
+                                     const QString &taskId, QWidget *parent)
+    : QDialog(parent),
+    store(store),
+    thumbnails(thumbnails)
+{
+    setWindowTitle("Attachments");
+    resize(1000, 700);
+
+    taskCombo = new QComboBox(this);
+    taskCombo->addItem("All tasks", QString());
+    for (const QString &id : taskIds) {
+        taskCombo->addItem(id, id);
+    }
+    taskCombo->setCurrentIndex(qMax(0, taskCombo->findData(taskId)));
+
+    // Taille d'élément uniforme et mise en page par lots : des milliers de photos sans blocage
+    gallery = new QListWidget(this);
+    gallery->setViewMode(QListView::IconMode);
+    gallery->setResizeMode(QListView::Adjust);
+    gallery->setMovement(QListView::Static);
+    gallery->setUniformItemSizes(true);
+    gallery->setLayoutMode(QListView::Batched);
+    gallery->setBatchSize(200);
+    gallery->setSpacing(4);
+    gallery->setSelectionMode(QAbstractItemView::SingleSelection);
+    gallery->setItemDelegate(new ThumbnailDelegate(thumbnails, gallery));
+
+    summaryLabel = new QLabel(this);
+
+    QPushButton *addBtn = new QPushButton("Add Files", this);
+    QPushButton *saveBtn = new QPushButton("Save As...", this);
+    QPushButton *removeBtn = new QPushButton("Remove", this);
+    QPushButton *closeBtn = new QPushButton("Close", this);
+
+    connect(taskCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &AttachmentsDialog::refreshGallery);
+    connect(addBtn, &QPushButton::clicked, this, &AttachmentsDialog::addFiles);
+    connect(saveBtn, &QPushButton::clicked, this, &AttachmentsDialog::saveFile);
+    connect(removeBtn, &QPushButton::clicked, this, &AttachmentsDialog::removeAttachment);
+    connect(closeBtn, &QPushButton::clicked, this, &QDialog::accept);
+    connect(gallery, &QListWidget::itemDoubleClicked, this, &AttachmentsDialog::saveFile);
+    connect(thumbnails, &ThumbnailCache::thumbnailReady, gallery->viewport(), [this]() {
+        gallery->viewport()->update();
+    });
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    buttonLayout->addWidget(new QLabel("Task:", this));
+    buttonLayout->addWidget(taskCombo);
+    buttonLayout->addWidget(addBtn);
+    buttonLayout->addWidget(saveBtn);
+    buttonLayout->addWidget(removeBtn);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(summaryLabel);
+
+    QHBoxLayout *closeLayout = new QHBoxLayout;
+    closeLayout->addStretch();
+    closeLayout->addWidget(closeBtn);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(buttonLayout);
+    mainLayout->addWidget(gallery, 1);
+    mainLayout->addLayout(closeLayout);
+
+    refreshGallery();
+}
+
+AttachmentsDialog::~AttachmentsDialog()
+{
+    // Les vignettes de cette galerie ne seront plus affichées
+    thumbnails->cancelPending();
+}
+
+int AttachmentsDialog::selectedIndex() const
+{
+    QListWidgetItem *item = gallery->currentItem();
+    return item ? item->data(Qt::UserRole).toInt() : -1;
+}
+
+void AttachmentsDialog::refreshGallery()
+{
+    thumbnails->cancelPending();
+    shown = store->attachments(taskCombo->currentData().toString());
+
+    gallery->clear();
+    qint64 totalSize = 0;
+    for (int i = 0; i < shown.size(); ++i) {
+        const AttachmentStore::Attachment &attachment = shown[i];
+        QListWidgetItem *item = new QListWidgetItem(attachment.fileName);
+        item->setData(Qt::UserRole, i);
+        item->setData(ThumbnailDelegate::HashRole, attachment.hash);
+        item->setData(ThumbnailDelegate::PathRole, store->blobPath(attachment.hash));
+        item->setToolTip(QString("%1\nTask: %2\nAdded: %3\n%4 KB")
+                             .arg(attachment.fileName, attachment.taskId, attachment.createdAt)
+                             .arg(attachment.size / 1024));
+        gallery->addItem(item);
+        totalSize += attachment.size;
+    }
+
+    summaryLabel->setText(QString("%1 file(s), %2 MB")
+                              .arg(shown.size())
+                              .arg(QString::number(totalSize / (1024.0 * 1024.0), 'f', 1)));
+}
+
+void AttachmentsDialog::addFiles()
+{
+    QString taskId = taskCombo->currentData().toString();
+    if (taskId.isEmpty()) {
+        QMessageBox::warning(this, "Selection Required", "Please choose the task to attach files to");
+        return;
+    }
+
+    QStringList files = QFileDialog::getOpenFileNames(this, "Attach Files");
+    if (files.isEmpty()) return;
+
+    QProgressDialog progress("Importing files...", "Cancel", 0, files.size(), this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(0);
+
+    // Empreinte et copie en parallèle, une seule transaction ensuite
+    QString blobDirectory = store->blobDirectory();
+    QFutureWatcher<AttachmentStore::Blob> watcher;
+    connect(&watcher, &QFutureWatcher<AttachmentStore::Blob>::progressValueChanged, &progress, &QProgressDialog::setValue);
+    connect(&progress, &QProgressDialog::canceled, &watcher, &QFutureWatcher<AttachmentStore::Blob>::cancel);
+
+    // Blobs écrits par cet import, y compris ceux dont le résultat est perdu à l'annulation
+    QMutex createdMutex;
+    QVector<AttachmentStore::Blob> created;
+
+    QEventLoop loop;
+    connect(&watcher, &QFutureWatcher<AttachmentStore::Blob>::finished, &loop, &QEventLoop::quit);
+    watcher.setFuture(QtConcurrent::mapped(files, [blobDirectory, &createdMutex, &created](const QString &file) {
+        AttachmentStore::Blob blob = AttachmentStore::importFile(file, blobDirectory);
+        if (blob.created) {
+            QMutexLocker locker(&createdMutex);
+            created << blob;
+        }
+        return blob;
+    }));
+    loop.exec();
+    watcher.waitForFinished();
+    progress.reset();
+
+    // Annulé : rien n'est joint, les fichiers déjà copiés repartent
+    if (watcher.isCanceled()) {
+        store->discardBlobs(created);
+        return;
+    }
+
+    QVector<AttachmentStore::Blob> blobs;
+    QStringList failures;
+    int duplicates = 0;
+    for (int i = 0; i < files.size(); ++i) {
+        if (!watcher.future().isResultReadyAt(i)) continue;
+        AttachmentStore::Blob blob = watcher.resultAt(i);
+        if (!blob.error.isEmpty()) {
+            failures << QString("%1: %2").arg(blob.fileName, blob.error);
+            continue;
+        }
+        if (!blob.created) duplicates++;
+        blobs << blob;
+    }
+
+    QString error;
+    int added = store->addAttachments(taskId, blobs, &error);
+    if (added < 0) {
+        QMessageBox::critical(this, "Database Error", QString("Failed to save attachments: %1").arg(error));
+        return;
+    }
+    refreshGallery();
+
+    if (!failures.isEmpty() || duplicates > 0) {
+        QString summary = QString("%1 file(s) attached, %2 already stored (not copied again).")
+                              .arg(added)
+                              .arg(duplicates);
+        if (!failures.isEmpty()) {
+            summary += "\n\nNot imported:\n" + failures.join("\n");
+        }
+        QMessageBox::information(this, "Attachments", summary);
+    }
+}
+
+void AttachmentsDialog::saveFile()
+{
+    int index = selectedIndex();
+    if (index < 0) {
+        QMessageBox::warning(this, "Selection Required", "Please select a file first");
+        return;
+    }
+
+    const AttachmentStore::Attachment &attachment = shown[index];
+    QString target = QFileDialog::getSaveFileName(this, "Save Attachment", attachment.fileName);
+    if (target.isEmpty()) return;
+
+    if (QFile::exists(target)) QFile::remove(target);
+    if (!QFile::copy(store->blobPath(attachment.hash), target)) {
+        QMessageBox::critical(this, "Save Error", QString("Could not write %1").arg(target));
+    }
+}
+
+void AttachmentsDialog::removeAttachment()
+{
+    int index = selectedIndex();
+    if (index < 0) {
+        QMessageBox::warning(this, "Selection Required", "Please select a file first");
+        return;
+    }
+
+    const AttachmentStore::Attachment &attachment = shown[index];
+    if (QMessageBox::question(this, "Confirm Delete",
+                              QString("Remove \"%1\" from task %2?").arg(attachment.fileName, attachment.taskId))
+        != QMessageBox::Yes) {
+        return;
+    }
+
+    QString error;
+    if (!store->removeAttachment(attachment.id, &error)) {
+        QMessageBox::critical(this, "Database Error", QString("Failed to remove attachment: %1").arg(error));
+        return;
+    }
+    refreshGallery();
+}
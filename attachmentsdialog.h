@@ -0,0 +1,39 @@
+#ifndef ATTACHMENTSDIALOG_H
+#define ATTACHMENTSDIALOG_H
+
+#include <QComboBox>
+#include <QDialog>
+#include <QLabel>
+#include <QListWidget>
+#include "attachmentstore.h"
+#include "thumbnailcache.h"
+
+// Galerie des pièces jointes, par tâche ou pour tout le portefeuille.
+// Seuls les éléments peints (donc visibles) demandent leur vignette.
+class AttachmentsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    AttachmentsDialog(AttachmentStore *store, ThumbnailCache *thumbnails, const QStringList &taskIds,
+                      const QString &taskId, QWidget *parent = nullptr);
+    ~AttachmentsDialog();
+
+private slots:
+    void refreshGallery();
+    void addFiles();
+    void saveFile();
+    void removeAttachment();
+
+private:
+    AttachmentStore *store;
+    ThumbnailCache *thumbnails;
+    QComboBox *taskCombo;
+    QListWidget *gallery;
+    QLabel *summaryLabel;
+    QVector<AttachmentStore::Attachment> shown;
+
+    int selectedIndex() const;
+};
+
+#endif // ATTACHMENTSDIALOG_H
@@ -0,0 +1,294 @@
+#include "attachmentstore.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariant>
+
+// Fenêtre de projection : un fichier de plusieurs Go ne mobilise jamais plus que ça
+static const qint64 map_window = 64 * 1024 * 1024;
+
+void AttachmentStore::setDatabase(const QSqlDatabase &database)
+{
+    db = database;
+}
+
+void AttachmentStore::setDirectory(const QString &dir)
+{
+    directory = dir;
+}
+
+QString AttachmentStore::blobDirectory() const
+{
+    return QDir(directory).filePath("blobs");
+}
+
+QString AttachmentStore::thumbnailDirectory() const
+{
+    return QDir(directory).filePath("thumbnails");
+}
+
+QString AttachmentStore::blobPath(const QString &blobDirectory, const QString &hash)
+{
+    // Deux caractères de préfixe : pas de répertoire à des dizaines de milliers d'entrées
+    return QDir(blobDirectory).filePath(hash.left(2) + "/" + hash);
+}
+
+bool AttachmentStore::initialize(QString *error)
+{
+    QDir dir;
+    if (!dir.mkpath(blobDirectory()) || !dir.mkpath(thumbnailDirectory())) {
+        if (error) *error = QString("Could not create %1").arg(directory);
+        return false;
+    }
+
+    QStringList schemaSQL = {
+        "CREATE TABLE IF NOT EXISTS blobs ("
+        "   hash TEXT PRIMARY KEY,"
+        "   size INTEGER NOT NULL,"
+        "   created_at DATETIME DEFAULT CURRENT_TIMESTAMP"
+        ")",
+        "CREATE TABLE IF NOT EXISTS attachments ("
+        "   id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "   task_id TEXT NOT NULL,"
+        "   hash TEXT NOT NULL REFERENCES blobs(hash),"
+        "   file_name TEXT NOT NULL,"
+        "   created_at DATETIME DEFAULT CURRENT_TIMESTAMP"
+        ")",
+        "CREATE INDEX IF NOT EXISTS idx_attachments_task ON attachments(task_id)",
+        "CREATE INDEX IF NOT EXISTS idx_attachments_hash ON attachments(hash)"
+    };
+
+    QSqlQuery query(db);
+    for (const QString &sql : schemaSQL) {
+        if (!query.exec(sql)) {
+            if (error) *error = query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+AttachmentStore::Blob AttachmentStore::importFile(const QString &filePath, const QString &blobDirectory)
+{
+    Blob blob;
+    blob.sourcePath = filePath;
+    blob.fileName = QFileInfo(filePath).fileName();
+
+    QFile source(filePath);
+    if (!source.open(QIODevice::ReadOnly)) {
+        blob.error = source.errorString();
+        return blob;
+    }
+    blob.size = source.size();
+
+    // Premier passage : empreinte lue directement dans les pages projetées
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    for (qint64 offset = 0; offset < blob.size; offset += map_window) {
+        qint64 length = qMin(map_window, blob.size - offset);
+        uchar *data = source.map(offset, length);
+        if (!data) {
+            blob.error = source.errorString();
+            return blob;
+        }
+        hash.addData(QByteArrayView(reinterpret_cast<const char *>(data), length));
+        source.unmap(data);
+    }
+    blob.hash = QString::fromLatin1(hash.result().toHex());
+
+    QString target = blobPath(blobDirectory, blob.hash);
+    if (QFile::exists(target)) return blob;   // déjà stocké : dédupliqué
+
+    // Second passage uniquement pour un contenu nouveau, écrit puis renommé d'un bloc
+    QDir().mkpath(QFileInfo(target).absolutePath());
+    QSaveFile out(target);
+    if (!out.open(QIODevice::WriteOnly)) {
+        blob.error = out.errorString();
+        return blob;
+    }
+    for (qint64 offset = 0; offset < blob.size; offset += map_window) {
+        qint64 length = qMin(map_window, blob.size - offset);
+        uchar *data = source.map(offset, length);
+        if (!data || out.write(reinterpret_cast<const char *>(data), length) != length) {
+            blob.error = data ? out.errorString() : source.errorString();
+            out.cancelWriting();
+            return blob;
+        }
+        source.unmap(data);
+    }
+    if (!out.commit()) {
+        blob.error = out.errorString();
+        return blob;
+    }
+    blob.created = true;
+    return blob;
+}
+
+int AttachmentStore::addAttachments(const QString &taskId, const QVector<Blob> &blobs, QString *error)
+{
+    if (!db.transaction()) {
+        if (error) *error = db.lastError().text();
+        return -1;
+    }
+
+    QSqlQuery blobQuery(db);
+    blobQuery.prepare("INSERT OR IGNORE INTO blobs (hash, size) VALUES (:hash, :size)");
+    QSqlQuery attachmentQuery(db);
+    attachmentQuery.prepare("INSERT INTO attachments (task_id, hash, file_name) VALUES (:task_id, :hash, :file_name)");
+
+    int added = 0;
+    for (const Blob &blob : blobs) {
+        if (!blob.error.isEmpty() || blob.hash.isEmpty()) continue;
+
+        blobQuery.bindValue(":hash", blob.hash);
+        blobQuery.bindValue(":size", blob.size);
+        attachmentQuery.bindValue(":task_id", taskId);
+        attachmentQuery.bindValue(":hash", blob.hash);
+        attachmentQuery.bindValue(":file_name", blob.fileName);
+        if (!blobQuery.exec() || !attachmentQuery.exec()) {
+            if (error) *error = blobQuery.lastError().isValid() ? blobQuery.lastError().text()
+                                                                : attachmentQuery.lastError().text();
+            db.rollback();
+            discardBlobs(blobs);
+            return -1;
+        }
+        ++added;
+    }
+
+    if (!db.commit()) {
+        if (error) *error = db.lastError().text();
+        return -1;
+    }
+    return added;
+}
+
+void AttachmentStore::discardBlobs(const QVector<Blob> &blobs)
+{
+    for (const Blob &blob : blobs) {
+        if (blob.created) collect(blob.hash);
+    }
+}
+
+QVector<AttachmentStore::Attachment> AttachmentStore::attachments(const QString &taskId) const
+{
+    QVector<Attachment> result;
+    QSqlQuery query(db);
+    QString sql = "SELECT a.id, a.task_id, a.hash, a.file_name, b.size, a.created_at "
+                  "FROM attachments a JOIN blobs b ON b.hash = a.hash ";
+    if (taskId.isEmpty()) {
+        query.prepare(sql + "ORDER BY a.id");
+    } else {
+        query.prepare(sql + "WHERE a.task_id = :task_id ORDER BY a.id");
+        query.bindValue(":task_id", taskId);
+    }
+    if (!query.exec()) return result;
+
+    while (query.next()) {
+        Attachment attachment;
+        attachment.id = query.value(0).toLongLong();
+        attachment.taskId = query.value(1).toString();
+        attachment.hash = query.value(2).toString();
+        attachment.fileName = query.value(3).toString();
+        attachment.size = query.value(4).toLongLong();
+        attachment.createdAt = query.value(5).toString();
+        result << attachment;
+    }
+    return result;
+}
+
+bool AttachmentStore::removeAttachment(qint64 id, QString *error)
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT hash FROM attachments WHERE id = :id");
+    query.bindValue(":id", id);
+    if (!query.exec() || !query.next()) {
+        if (error) *error = query.lastError().isValid() ? query.lastError().text() : QString("Unknown attachment");
+        return false;
+    }
+    QString hash = query.value(0).toString();
+
+    query.prepare("DELETE FROM attachments WHERE id = :id");
+    query.bindValue(":id", id);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    collect(hash);
+    return true;
+}
+
+bool AttachmentStore::renameTask(const QString &oldId, const QString &newId)
+{
+    QSqlQuery query(db);
+    query.prepare("UPDATE attachments SET task_id = :new_id WHERE task_id = :old_id");
+    query.bindValue(":new_id", newId);
+    query.bindValue(":old_id", oldId);
+    return query.exec();
+}
+
+bool AttachmentStore::removeTask(const QString &taskId)
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT DISTINCT hash FROM attachments WHERE task_id = :task_id");
+    query.bindValue(":task_id", taskId);
+    if (!query.exec()) return false;
+
+    QStringList hashes;
+    while (query.next()) {
+        hashes << query.value(0).toString();
+    }
+    if (hashes.isEmpty()) return true;
+
+    query.prepare("DELETE FROM attachments WHERE task_id = :task_id");
+    query.bindValue(":task_id", taskId);
+    if (!query.exec()) return false;
+
+    for (const QString &hash : hashes) {
+        collect(hash);
+    }
+    return true;
+}
+
+bool AttachmentStore::removeOrphans(QString *error)
+{
+    QSqlQuery query(db);
+    if (!query.exec("SELECT DISTINCT task_id FROM attachments "
+                    "WHERE task_id NOT IN (SELECT id FROM tasks) AND task_id NOT IN (SELECT id FROM archived_ids)")) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    QStringList taskIds;
+    while (query.next()) {
+        taskIds << query.value(0).toString();
+    }
+    for (const QString &taskId : taskIds) {
+        if (!removeTask(taskId)) {
+            if (error) *error = QString("Could not remove the attachments of %1").arg(taskId);
+            return false;
+        }
+    }
+    return true;
+}
+
+void AttachmentStore::collect(const QString &hash)
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT COUNT(*) FROM attachments WHERE hash = :hash");
+    query.bindValue(":hash", hash);
+    if (!query.exec() || !query.next() || query.value(0).toInt() > 0) return;
+
+    query.prepare("DELETE FROM blobs WHERE hash = :hash");
+    query.bindValue(":hash", hash);
+    query.exec();
+
+    QFile::remove(blobPath(hash));
+    QDir thumbnails(thumbnailDirectory());
+    for (const QString &name : thumbnails.entryList({hash + "_*"}, QDir::Files)) {
+        thumbnails.remove(name);
+    }
+}
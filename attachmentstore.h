@@ -0,0 +1,65 @@
+#ifndef ATTACHMENTSTORE_H
+#define ATTACHMENTSTORE_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+
+// Pièces jointes des tâches, hors de SQLite : chaque fichier est rangé une
+// seule fois sous le nom de son SHA-256 (blobs/ab/abcdef...), la base ne
+// garde que les références. Deux photos identiques partagent le même blob,
+// qui n'est supprimé qu'avec sa dernière référence.
+class AttachmentStore
+{
+public:
+    struct Attachment
+    {
+        qint64 id = 0;
+        QString taskId;
+        QString hash;
+        QString fileName;
+        qint64 size = 0;
+        QString createdAt;
+    };
+
+    // Résultat de l'import d'un fichier dans le répertoire des blobs
+    struct Blob
+    {
+        QString sourcePath;
+        QString fileName;
+        QString hash;
+        qint64 size = 0;
+        bool created = false;   // faux : contenu déjà présent, rien n'a été copié
+        QString error;
+    };
+
+    void setDatabase(const QSqlDatabase &database);
+    void setDirectory(const QString &directory);
+    bool initialize(QString *error);
+
+    // Sans accès à la base : appelable depuis n'importe quel thread du pool
+    static Blob importFile(const QString &filePath, const QString &blobDirectory);
+    static QString blobPath(const QString &blobDirectory, const QString &hash);
+
+    int addAttachments(const QString &taskId, const QVector<Blob> &blobs, QString *error);
+    // Import abandonné : les blobs copiés pour lui sont retirés s'ils restent sans référence
+    void discardBlobs(const QVector<Blob> &blobs);
+    QVector<Attachment> attachments(const QString &taskId = QString()) const;
+    bool removeAttachment(qint64 id, QString *error);
+    bool renameTask(const QString &oldId, const QString &newId);
+    bool removeTask(const QString &taskId);
+    // Références restées sans tâche (ni active, ni archivée) après un arrêt de l'application
+    bool removeOrphans(QString *error);
+
+    QString blobDirectory() const;
+    QString thumbnailDirectory() const;
+    QString blobPath(const QString &hash) const { return blobPath(blobDirectory(), hash); }
+
+private:
+    QSqlDatabase db;
+    QString directory;
+
+    void collect(const QString &hash);
+};
+
+#endif // ATTACHMENTSTORE_H
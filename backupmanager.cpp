@@ -0,0 +1,486 @@
+#include "backupmanager.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QUrl>
+#include <QUuid>
+#include <QVariant>
+#include <QtConcurrent>
+
+static const int chunk_size = 1 << 20;
+static const int copy_rows = 5000;     // lignes par étape de copie, entre deux contrôles d'annulation
+static const quint32 backup_magic = 0x544d424b;    // "TMBK"
+static const quint32 backup_version = 1;
+
+BackupManager::BackupManager(QObject *parent)
+    : QObject(parent),
+    keep(7),
+    interval(0),
+    checkIsRestore(false),
+    cancelRequested(false)
+{
+    scheduleTimer.setInterval(10 * 60 * 1000);
+    connect(&scheduleTimer, &QTimer::timeout, this, &BackupManager::checkSchedule);
+    connect(&watcher, &QFutureWatcher<Result>::finished, this, &BackupManager::onFinished);
+    connect(&checkWatcher, &QFutureWatcher<Result>::finished, this, &BackupManager::onChecked);
+}
+
+BackupManager::~BackupManager()
+{
+    // Le fichier .part d'une sauvegarde interrompue est supprimé à la prochaine rotation
+    cancelRequested = true;
+    watcher.waitForFinished();
+    checkWatcher.waitForFinished();
+}
+
+void BackupManager::setSource(const QString &databasePath)
+{
+    sourcePath = databasePath;
+}
+
+void BackupManager::setDirectory(const QString &directory)
+{
+    backupDir = directory;
+}
+
+void BackupManager::setRetention(int count)
+{
+    keep = qMax(1, count);
+}
+
+void BackupManager::setIntervalHours(int hours)
+{
+    interval = qMax(0, hours);
+    if (interval > 0) {
+        scheduleTimer.start();
+        // Rattrapage au démarrage, une fois l'application chargée
+        QTimer::singleShot(60 * 1000, this, &BackupManager::checkSchedule);
+    } else {
+        scheduleTimer.stop();
+    }
+}
+
+QVector<BackupManager::Backup> BackupManager::backups() const
+{
+    QVector<Backup> result;
+    if (backupDir.isEmpty()) return result;
+
+    // Noms horodatés : l'ordre alphabétique inverse est l'ordre chronologique inverse
+    const QFileInfoList files = QDir(backupDir).entryInfoList({"tasks-*.tmbk"}, QDir::Files, QDir::Name | QDir::Reversed);
+    for (const QFileInfo &info : files) {
+        Backup backup;
+        backup.path = info.absoluteFilePath();
+        backup.createdAt = QDateTime::fromString(info.completeBaseName().mid(6), "yyyyMMdd-HHmmss");
+        backup.size = info.size();
+        result << backup;
+    }
+    return result;
+}
+
+void BackupManager::checkSchedule()
+{
+    if (interval <= 0 || isRunning()) return;
+
+    QVector<Backup> existing = backups();
+    if (existing.isEmpty() || !existing.first().createdAt.isValid() ||
+        existing.first().createdAt.secsTo(QDateTime::currentDateTime()) >= qint64(interval) * 3600) {
+        startBackup();
+    }
+}
+
+void BackupManager::cancel()
+{
+    cancelRequested = true;
+}
+
+bool BackupManager::startBackup()
+{
+    if (isRunning() || sourcePath.isEmpty() || backupDir.isEmpty()) return false;
+
+    cancelRequested = false;
+    auto report = [this](int done, int total) {
+        QMetaObject::invokeMethod(this, [this, done, total]() { emit progress(done, total); }, Qt::QueuedConnection);
+    };
+    watcher.setFuture(QtConcurrent::run(&BackupManager::run, sourcePath, backupDir,
+                                        &cancelRequested, std::function<void(int, int)>(report)));
+    return true;
+}
+
+void BackupManager::onFinished()
+{
+    Result result = watcher.result();
+    if (result.ok) {
+        rotate();
+    }
+    emit finished(result.ok, result.path, result.error);
+}
+
+void BackupManager::rotate()
+{
+    QVector<Backup> existing = backups();
+    for (int i = keep; i < existing.size(); ++i) {
+        QFile::remove(existing[i].path);
+    }
+
+    // Restes d'une sauvegarde interrompue (arrêt de l'application pendant la copie)
+    const QFileInfoList parts = QDir(backupDir).entryInfoList({"tasks-*.db.part"}, QDir::Files);
+    for (const QFileInfo &info : parts) {
+        QFile::remove(info.absoluteFilePath());
+    }
+}
+
+static QString uniqueConnectionName()
+{
+    return "Backup-" + QUuid::createUuid().toString(QUuid::WithoutBraces);
+}
+
+BackupManager::Result BackupManager::run(const QString &source, const QString &directory,
+                                         const std::atomic<bool> *cancel, const std::function<void(int, int)> &report)
+{
+    Result result;
+    if (!QDir().mkpath(directory)) {
+        result.error = QString("Could not create %1").arg(directory);
+        return result;
+    }
+
+    QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss");
+    QString rawPath = QDir(directory).filePath(QString("tasks-%1.db.part").arg(stamp));
+    result.path = QDir(directory).filePath(QString("tasks-%1.tmbk").arg(stamp));
+    QFile::remove(rawPath);
+
+    // Connexion propre au thread de travail : la copie est sa base principale,
+    // la base de l'application y est attachée en lecture seule
+    QString name = uniqueConnectionName();
+    bool copied = false;
+    if (report) report(0, 0);
+    {
+        QSqlDatabase to = QSqlDatabase::addDatabase("QSQLITE", name);
+        to.setDatabaseName(rawPath);
+        to.setConnectOptions("QSQLITE_OPEN_URI");
+        if (!to.open()) {
+            result.error = to.lastError().text();
+        } else {
+            copied = copyDatabase(to, source, cancel, report, &result.error);
+        }
+        to.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+
+    if (copied && quickCheck(rawPath, &result.error) && compressFile(rawPath, result.path, &result.error)) {
+        result.rawSize = QFileInfo(rawPath).size();
+        result.ok = true;
+    }
+    QFile::remove(rawPath);
+    return result;
+}
+
+static QString quoted(const QString &identifier)
+{
+    return "\"" + QString(identifier).replace("\"", "\"\"") + "\"";
+}
+
+bool BackupManager::copyDatabase(QSqlDatabase &to, const QString &source, const std::atomic<bool> *cancel,
+                                 const std::function<void(int, int)> &report, QString *error)
+{
+    QSqlQuery query(to);
+    auto fail = [&query, error]() {
+        if (error) *error = query.lastError().text();
+        return false;
+    };
+
+    // Copie jetable, contrôlée ensuite : ni journal ni fsync
+    if (!query.exec("PRAGMA main.journal_mode = OFF") || !query.exec("PRAGMA main.synchronous = OFF")) return fail();
+    QUrl uri = QUrl::fromLocalFile(source);
+    uri.setScheme("file");
+    uri.setQuery("mode=ro");
+    query.prepare("ATTACH DATABASE :uri AS source");
+    query.bindValue(":uri", uri.toString(QUrl::FullyEncoded));
+    if (!query.exec()) return fail();
+
+    // Une transaction de lecture pour toute la copie : un instantané cohérent. La base
+    // étant en WAL, les écritures de l'application continuent pendant ce temps.
+    bool ok = to.transaction();
+    struct Table { QString name; QString sql; bool rowid; qint64 rows; };
+    QVector<Table> tables;
+    QStringList later;          // index, vues et triggers, posés une fois les données copiées
+    bool sequence = false;
+    static const QRegularExpression withoutRowid("\\bWITHOUT\\s+ROWID\\b", QRegularExpression::CaseInsensitiveOption);
+    if (ok && (ok = query.exec("SELECT type, name, sql FROM source.sqlite_master WHERE sql IS NOT NULL "
+                               "ORDER BY CASE type WHEN 'table' THEN 0 WHEN 'index' THEN 1 ELSE 2 END, rowid"))) {
+        while (query.next()) {
+            QString type = query.value(0).toString();
+            QString tableName = query.value(1).toString();
+            QString sql = query.value(2).toString();
+            if (tableName == "sqlite_sequence") {
+                sequence = true;
+            } else if (tableName.startsWith("sqlite_")) {
+                continue;
+            } else if (type == "table") {
+                tables.append({tableName, sql, !withoutRowid.match(sql).hasMatch(), 0});
+            } else {
+                later << sql;
+            }
+        }
+    }
+
+    qint64 total = 0;
+    for (int i = 0; ok && i < tables.size(); ++i) {
+        ok = query.exec(tables[i].sql) &&
+             query.exec(QString("SELECT COUNT(*) FROM source.%1").arg(quoted(tables[i].name))) && query.next();
+        if (ok) total += tables[i].rows = query.value(0).toLongLong();
+    }
+
+    // Étapes de copy_rows lignes par rowid; une table WITHOUT ROWID (synthèses, petites) d'un coup
+    qint64 done = 0;
+    auto progress = [&]() {
+        if (report) report(total > 0 ? int(done * 1000 / total) : 0, 1000);
+    };
+    QSqlQuery step(to);
+    for (int i = 0; ok && i < tables.size(); ++i) {
+        const QString table = quoted(tables[i].name);
+        if (!tables[i].rowid) {
+            ok = query.exec(QString("INSERT INTO main.%1 SELECT * FROM source.%1").arg(table));
+            done += tables[i].rows;
+            progress();
+            continue;
+        }
+        QVariant from;
+        if ((ok = query.exec(QString("SELECT MIN(rowid) FROM source.%1").arg(table)) && query.next())) {
+            from = query.value(0);
+        }
+        while (ok && !from.isNull()) {
+            if (cancel && cancel->load()) {
+                if (error) *error = "Backup cancelled";
+                to.rollback();
+                return false;
+            }
+            // Début de l'étape suivante, nul pour la dernière
+            QVariant next;
+            step.prepare(QString("SELECT rowid FROM source.%1 WHERE rowid >= ? ORDER BY rowid LIMIT 1 OFFSET ?").arg(table));
+            step.addBindValue(from);
+            step.addBindValue(copy_rows);
+            if (!(ok = step.exec())) {
+                if (error) *error = step.lastError().text();
+                break;
+            }
+            if (step.next()) next = step.value(0);
+            step.finish();
+
+            step.prepare(QString("INSERT INTO main.%1 SELECT * FROM source.%1 WHERE rowid >= ?%2")
+                             .arg(table, next.isNull() ? QString() : QString(" AND rowid < ?")));
+            step.addBindValue(from);
+            if (!next.isNull()) step.addBindValue(next);
+            if (!(ok = step.exec())) {
+                if (error) *error = step.lastError().text();
+                break;
+            }
+            done += step.numRowsAffected();
+            progress();
+            from = next;
+        }
+        step.finish();
+    }
+
+    // Compteurs AUTOINCREMENT de la source, pas ceux déduits des lignes copiées
+    if (ok && sequence) {
+        ok = query.exec("DELETE FROM main.sqlite_sequence") &&
+             query.exec("INSERT INTO main.sqlite_sequence SELECT * FROM source.sqlite_sequence");
+    }
+    for (int i = 0; ok && i < later.size(); ++i) {
+        ok = query.exec(later[i]);
+    }
+    if (ok) ok = to.commit();
+    if (!ok) {
+        if (error && error->isEmpty()) {
+            *error = query.lastError().isValid() ? query.lastError().text() : to.lastError().text();
+        }
+        to.rollback();
+    }
+    query.finish();
+    query.exec("DETACH DATABASE source");
+    if (report) report(1000, 1000);
+    return ok;
+}
+
+bool BackupManager::quickCheck(const QString &databasePath, QString *error)
+{
+    QString name = uniqueConnectionName();
+    bool ok = false;
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", name);
+        database.setDatabaseName(databasePath);
+        database.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if (!database.open()) {
+            if (error) *error = database.lastError().text();
+        } else {
+            QSqlQuery query(database);
+            if (!query.exec("PRAGMA quick_check") || !query.next()) {
+                if (error) *error = query.lastError().text();
+            } else if (query.value(0).toString() != "ok") {
+                if (error) *error = QString("Integrity check failed: %1").arg(query.value(0).toString());
+            } else {
+                ok = true;
+            }
+        }
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+    return ok;
+}
+
+bool BackupManager::compressFile(const QString &rawPath, const QString &backupPath, QString *error)
+{
+    QFile in(rawPath);
+    if (!in.open(QIODevice::ReadOnly)) {
+        if (error) *error = in.errorString();
+        return false;
+    }
+    QSaveFile out(backupPath);
+    if (!out.open(QIODevice::WriteOnly)) {
+        if (error) *error = out.errorString();
+        return false;
+    }
+
+    // Blocs indépendants d'1 Mo : la mémoire reste bornée quelle que soit la taille de la base
+    QDataStream stream(&out);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << backup_magic << backup_version;
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    while (!in.atEnd()) {
+        QByteArray chunk = in.read(chunk_size);
+        if (chunk.isEmpty()) break;
+        hash.addData(chunk);
+        stream << quint32(chunk.size()) << qCompress(chunk, 6);
+    }
+    stream << quint32(0) << hash.result();
+
+    if (stream.status() != QDataStream::Ok || in.error() != QFile::NoError || !out.commit()) {
+        if (error) *error = QString("Failed to write %1: %2").arg(backupPath, out.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool BackupManager::decompressFile(const QString &backupPath, const QString &rawPath, QString *error)
+{
+    QFile in(backupPath);
+    if (!in.open(QIODevice::ReadOnly)) {
+        if (error) *error = in.errorString();
+        return false;
+    }
+    QFile out(rawPath);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = out.errorString();
+        return false;
+    }
+
+    QDataStream stream(&in);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if (magic != backup_magic || version != backup_version) {
+        if (error) *error = "Not a TaskManager backup file";
+        return false;
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    while (true) {
+        quint32 size = 0;
+        QByteArray compressed;
+        stream >> size;
+        if (stream.status() != QDataStream::Ok) break;
+        if (size == 0) break;
+        stream >> compressed;
+        QByteArray chunk = qUncompress(compressed);
+        if (stream.status() != QDataStream::Ok || quint32(chunk.size()) != size) {
+            if (error) *error = "Backup file is truncated or corrupt";
+            return false;
+        }
+        hash.addData(chunk);
+        if (out.write(chunk) != chunk.size()) {
+            if (error) *error = out.errorString();
+            return false;
+        }
+    }
+
+    QByteArray expected;
+    stream >> expected;
+    if (stream.status() != QDataStream::Ok || expected != hash.result()) {
+        if (error) *error = "Backup checksum mismatch";
+        return false;
+    }
+    return true;
+}
+
+bool BackupManager::startVerify(const QString &backupPath)
+{
+    return startCheck(backupPath, false);
+}
+
+bool BackupManager::startRestore(const QString &backupPath)
+{
+    return startCheck(backupPath, true);
+}
+
+bool BackupManager::startCheck(const QString &backupPath, bool restore)
+{
+    if (isRunning() || (restore && sourcePath.isEmpty())) return false;
+
+    // Copie à restaurer sur le volume de la base : le remplacement est un simple renommage
+    checkIsRestore = restore;
+    QString rawPath = restore ? sourcePath + ".restore" : backupPath + ".verify";
+    checkWatcher.setFuture(QtConcurrent::run(&BackupManager::check, backupPath, rawPath, restore));
+    return true;
+}
+
+void BackupManager::onChecked()
+{
+    Result result = checkWatcher.result();
+    if (checkIsRestore) {
+        emit restoreReady(result.ok, result.path, result.error);
+    } else {
+        emit verified(result.ok, result.path, result.error);
+    }
+}
+
+BackupManager::Result BackupManager::check(const QString &backupPath, const QString &rawPath, bool keepCopy)
+{
+    Result result;
+    result.ok = decompressFile(backupPath, rawPath, &result.error) && quickCheck(rawPath, &result.error);
+    result.rawSize = QFileInfo(rawPath).size();
+    result.path = keepCopy ? rawPath : backupPath;
+    if (!result.ok || !keepCopy) {
+        QFile::remove(rawPath);
+    }
+    return result;
+}
+
+bool BackupManager::replaceDatabase(const QString &preparedPath, const QString &databasePath, QString *error)
+{
+    // Un journal resté à côté de l'ancien fichier serait rejoué sur le nouveau
+    QString previousPath = databasePath + ".previous";
+    QFile::remove(previousPath);
+    if (!QFile::rename(databasePath, previousPath)) {
+        if (error) *error = QString("Could not move %1 aside").arg(databasePath);
+        return false;
+    }
+    // WAL et index partagé de l'ancien fichier : ne doivent pas être appliqués au nouveau
+    for (const char *suffix : {"-journal", "-wal", "-shm"}) {
+        QFile::remove(databasePath + suffix);
+    }
+    if (!QFile::rename(preparedPath, databasePath)) {
+        QFile::rename(previousPath, databasePath);
+        if (error) *error = QString("Could not move the restored copy to %1").arg(databasePath);
+        return false;
+    }
+    QFile::remove(previousPath);
+    return true;
+}
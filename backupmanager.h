@@ -0,0 +1,100 @@
+#ifndef BACKUPMANAGER_H
+#define BACKUPMANAGER_H
+
+#include <QDateTime>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QSqlDatabase>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+#include <functional>
+
+// Sauvegardes à chaud de la base : un thread de travail copie, par étapes de
+// quelques milliers de lignes et par le SQLite du pilote Qt, un instantané
+// cohérent de la base. Celle-ci est en WAL : la lecture ne bloque pas les
+// écritures de l'application; l'annulation est prise en compte entre étapes.
+// La copie est vérifiée (quick_check), compressée par blocs dans un fichier
+// .tmbk avec son SHA-256, puis les plus anciennes sont supprimées.
+// Vérification et restauration décompressent aussi hors du thread GUI; la
+// restauration remplace ensuite le fichier de la base, connexion fermée.
+class BackupManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Backup
+    {
+        QString path;
+        QDateTime createdAt;
+        qint64 size = 0;
+    };
+
+    struct Result
+    {
+        bool ok = false;
+        QString path;
+        QString error;
+        qint64 rawSize = 0;
+    };
+
+    explicit BackupManager(QObject *parent = nullptr);
+    ~BackupManager();
+
+    void setSource(const QString &databasePath);
+    void setDirectory(const QString &directory);
+    QString directory() const { return backupDir; }
+    void setRetention(int count);
+    int retention() const { return keep; }
+    // 0 désactive les sauvegardes planifiées
+    void setIntervalHours(int hours);
+    int intervalHours() const { return interval; }
+
+    QVector<Backup> backups() const;
+    bool isRunning() const { return watcher.isRunning() || checkWatcher.isRunning(); }
+    bool startBackup();
+    // Sauvegarde en cours abandonnée à la prochaine étape, finished(false) suit
+    void cancel();
+
+    // Décompresse dans un fichier temporaire, contrôle l'empreinte et l'intégrité (verified)
+    bool startVerify(const QString &backupPath);
+    // Même contrôle, la copie décompressée reste à côté de la base (restoreReady)
+    bool startRestore(const QString &backupPath);
+    // Base fermée par l'appelant : son fichier est remplacé par la copie préparée
+    static bool replaceDatabase(const QString &preparedPath, const QString &databasePath, QString *error);
+
+signals:
+    void progress(int done, int total);
+    void finished(bool ok, const QString &path, const QString &error);
+    void verified(bool ok, const QString &backupPath, const QString &error);
+    void restoreReady(bool ok, const QString &preparedPath, const QString &error);
+
+private:
+    QString sourcePath;
+    QString backupDir;
+    int keep;
+    int interval;
+    QTimer scheduleTimer;
+    QFutureWatcher<Result> watcher;
+    QFutureWatcher<Result> checkWatcher;
+    bool checkIsRestore;
+    std::atomic<bool> cancelRequested;
+
+    void checkSchedule();
+    void onFinished();
+    void onChecked();
+    void rotate();
+    bool startCheck(const QString &backupPath, bool restore);
+
+    static Result run(const QString &source, const QString &directory,
+                      const std::atomic<bool> *cancel, const std::function<void(int, int)> &report);
+    static bool copyDatabase(QSqlDatabase &to, const QString &source, const std::atomic<bool> *cancel,
+                             const std::function<void(int, int)> &report, QString *error);
+    static Result check(const QString &backupPath, const QString &rawPath, bool keepCopy);
+    static bool compressFile(const QString &rawPath, const QString &backupPath, QString *error);
+    static bool decompressFile(const QString &backupPath, const QString &rawPath, QString *error);
+    static bool quickCheck(const QString &databasePath, QString *error);
+};
+
+#endif // BACKUPMANAGER_H
@@ -0,0 +1,181 @@
+#include "backupsdialog.h"
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLocale>
+#include <QMessageBox>
+#include <QSettings>
+#include <QVBoxLayout>
+
+BackupsDialog::BackupsDialog(BackupManager *manager, QWidget *parent)
+    : QDialog(parent),
+    manager(manager)
+{
+    setWindowTitle("Backups");
+    resize(760, 480);
+
+    backupTable = new QTableWidget(this);
+    backupTable->setColumnCount(3);
+    backupTable->setHorizontalHeaderLabels({"Created", "Size", "File"});
+    backupTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    backupTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    backupTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    backupTable->horizontalHeader()->setStretchLastSection(true);
+
+    keepSpin = new QSpinBox(this);
+    keepSpin->setRange(1, 365);
+    keepSpin->setValue(manager->retention());
+    intervalSpin = new QSpinBox(this);
+    intervalSpin->setRange(0, 24 * 30);
+    intervalSpin->setSuffix(" h");
+    intervalSpin->setSpecialValueText("Off");
+    intervalSpin->setValue(manager->intervalHours());
+
+    progressBar = new QProgressBar(this);
+    progressBar->setRange(0, 1);
+    progressBar->setValue(0);
+    statusLabel = new QLabel(QString("Folder: %1").arg(manager->directory()), this);
+    statusLabel->setWordWrap(true);
+
+    backupBtn = new QPushButton("Back Up Now", this);
+    QPushButton *verifyBtn = new QPushButton("Verify", this);
+    QPushButton *restoreBtn = new QPushButton("Restore...", this);
+    cancelBtn = new QPushButton("Cancel Backup", this);
+    QPushButton *closeBtn = new QPushButton("Close", this);
+    backupBtn->setEnabled(!manager->isRunning());
+    cancelBtn->setEnabled(manager->isRunning());
+
+    connect(backupBtn, &QPushButton::clicked, this, &BackupsDialog::backupNow);
+    connect(cancelBtn, &QPushButton::clicked, manager, &BackupManager::cancel);
+    connect(verifyBtn, &QPushButton::clicked, this, &BackupsDialog::verifySelected);
+    connect(restoreBtn, &QPushButton::clicked, this, &BackupsDialog::restoreSelected);
+    connect(closeBtn, &QPushButton::clicked, this, &QDialog::accept);
+    connect(keepSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &BackupsDialog::saveSettings);
+    connect(intervalSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &BackupsDialog::saveSettings);
+
+    // Total nul : lecture du schéma ou contrôle en cours, durée inconnue
+    connect(manager, &BackupManager::progress, this, [this](int done, int total) {
+        progressBar->setRange(0, total);
+        progressBar->setValue(done);
+        cancelBtn->setEnabled(done < total || total == 0);
+    });
+    connect(manager, &BackupManager::finished, this, [this](bool ok, const QString &path, const QString &error) {
+        backupBtn->setEnabled(true);
+        cancelBtn->setEnabled(false);
+        statusLabel->setText(ok ? QString("Backup written to %1").arg(path)
+                                : QString("Backup failed: %1").arg(error));
+        refreshBackups();
+    });
+    connect(manager, &BackupManager::verified, this, [this](bool ok, const QString &path, const QString &error) {
+        progressBar->setRange(0, 1);
+        statusLabel->setText(ok ? QString("%1 is intact.").arg(QFileInfo(path).fileName())
+                                : QString("%1 is not usable: %2").arg(QFileInfo(path).fileName(), error));
+        if (!ok) {
+            QMessageBox::critical(this, "Verify Backup", statusLabel->text());
+        }
+    });
+    // La fenêtre principale remplace la base et en notifie le résultat
+    connect(manager, &BackupManager::restoreReady, this, [this](bool ok, const QString &, const QString &error) {
+        progressBar->setRange(0, 1);
+        statusLabel->setText(ok ? QString("Backup checked and applied.") : QString("Restore failed: %1").arg(error));
+    });
+
+    QHBoxLayout *settingsLayout = new QHBoxLayout;
+    settingsLayout->addWidget(new QLabel("Keep last:", this));
+    settingsLayout->addWidget(keepSpin);
+    settingsLayout->addWidget(new QLabel("Back up every:", this));
+    settingsLayout->addWidget(intervalSpin);
+    settingsLayout->addStretch();
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    buttonLayout->addWidget(backupBtn);
+    buttonLayout->addWidget(cancelBtn);
+    buttonLayout->addWidget(verifyBtn);
+    buttonLayout->addWidget(restoreBtn);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(closeBtn);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(settingsLayout);
+    mainLayout->addWidget(backupTable, 1);
+    mainLayout->addWidget(progressBar);
+    mainLayout->addWidget(statusLabel);
+    mainLayout->addLayout(buttonLayout);
+
+    refreshBackups();
+}
+
+void BackupsDialog::refreshBackups()
+{
+    QVector<BackupManager::Backup> backups = manager->backups();
+    backupTable->setRowCount(backups.size());
+    for (int row = 0; row < backups.size(); ++row) {
+        const BackupManager::Backup &backup = backups[row];
+        QTableWidgetItem *createdItem = new QTableWidgetItem(backup.createdAt.toString("yyyy-MM-dd HH:mm:ss"));
+        createdItem->setData(Qt::UserRole, backup.path);
+        backupTable->setItem(row, 0, createdItem);
+        backupTable->setItem(row, 1, new QTableWidgetItem(QLocale().formattedDataSize(backup.size)));
+        backupTable->setItem(row, 2, new QTableWidgetItem(QFileInfo(backup.path).fileName()));
+    }
+    backupTable->resizeColumnsToContents();
+}
+
+QString BackupsDialog::selectedPath() const
+{
+    int row = backupTable->currentRow();
+    if (row < 0 || !backupTable->item(row, 0)) return QString();
+    return backupTable->item(row, 0)->data(Qt::UserRole).toString();
+}
+
+void BackupsDialog::backupNow()
+{
+    if (manager->startBackup()) {
+        backupBtn->setEnabled(false);
+        cancelBtn->setEnabled(true);
+        statusLabel->setText("Backing up...");
+    }
+}
+
+void BackupsDialog::verifySelected()
+{
+    QString path = selectedPath();
+    if (path.isEmpty()) return;
+
+    if (!manager->startVerify(path)) {
+        statusLabel->setText("A backup, verification or restore is already running.");
+        return;
+    }
+    progressBar->setRange(0, 0);
+    statusLabel->setText(QString("Verifying %1...").arg(QFileInfo(path).fileName()));
+}
+
+void BackupsDialog::restoreSelected()
+{
+    QString path = selectedPath();
+    if (path.isEmpty() || manager->isRunning()) return;
+
+    if (QMessageBox::question(this, "Restore Backup",
+                              QString("Replace all current data with the backup of %1?\n"
+                                      "Take a backup first if the current data may still be needed.")
+                                  .arg(backupTable->item(backupTable->currentRow(), 0)->text()),
+                              QMessageBox::Yes | QMessageBox::No, QMessageBox::No) != QMessageBox::Yes) {
+        return;
+    }
+
+    if (!manager->startRestore(path)) {
+        statusLabel->setText("A backup, verification or restore is already running.");
+        return;
+    }
+    progressBar->setRange(0, 0);
+    statusLabel->setText("Checking the backup before restoring...");
+}
+
+void BackupsDialog::saveSettings()
+{
+    manager->setRetention(keepSpin->value());
+    manager->setIntervalHours(intervalSpin->value());
+
+    QSettings settings("TaskManager", "TaskManager");
+    settings.setValue("backup/keep", keepSpin->value());
+    settings.setValue("backup/intervalHours", intervalSpin->value());
+}
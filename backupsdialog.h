@@ -0,0 +1,40 @@
+#ifndef BACKUPSDIALOG_H
+#define BACKUPSDIALOG_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include "backupmanager.h"
+
+// Liste des sauvegardes, sauvegarde immédiate, vérification et restauration
+class BackupsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit BackupsDialog(BackupManager *manager, QWidget *parent = nullptr);
+
+private slots:
+    void refreshBackups();
+    void backupNow();
+    void verifySelected();
+    void restoreSelected();
+    void saveSettings();
+
+private:
+    BackupManager *manager;
+    QTableWidget *backupTable;
+    QSpinBox *keepSpin;
+    QSpinBox *intervalSpin;
+    QProgressBar *progressBar;
+    QLabel *statusLabel;
+    QPushButton *backupBtn;
+    QPushButton *cancelBtn;
+
+    QString selectedPath() const;
+};
+
+#endif // BACKUPSDIALOG_H
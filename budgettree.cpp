@@ -0,0 +1,211 @@
+#include "budgettree.h"
+#include <algorithm>
+
+void BudgetTree::clear()
+{
+    nodes.clear();
+    tasks.clear();
+    overrunIds.clear();
+    grandTotal = Costs();
+}
+
+bool BudgetTree::canMove(int id, int parentId, QString *error) const
+{
+    if (parentId == id) {
+        if (error) *error = "A project cannot be its own parent";
+        return false;
+    }
+
+    // Remonte depuis le nouveau parent : rencontrer le nœud déplacé créerait un cycle
+    int steps = 0;
+    for (int p = parentId; p != 0 && steps <= nodes.size(); p = nodes.value(p).parentId, ++steps) {
+        if (p == id) {
+            if (error) *error = "A project cannot be moved under one of its own phases";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BudgetTree::setProject(int id, int parentId, const QString &name, double budget, QString *error)
+{
+    if (id <= 0) {
+        if (error) *error = "Invalid project";
+        return false;
+    }
+    if (!canMove(id, parentId, error)) return false;
+
+    if (!nodes.contains(id)) {
+        Node node;
+        node.id = id;
+        nodes.insert(id, node);
+    }
+    if (parentId != 0 && !nodes.contains(parentId)) {
+        Node parent;
+        parent.id = parentId;
+        nodes.insert(parentId, parent);
+    }
+
+    Node &node = nodes[id];
+    node.name = name;
+    node.budget = budget;
+
+    // Déplacement : le sous-arbre quitte une chaîne d'ancêtres pour une autre
+    int oldParentId = node.parentId;
+    if (oldParentId != parentId) {
+        Costs moved = node.total;
+        int count = node.taskCount;
+        node.parentId = parentId;
+        if (oldParentId != 0) {
+            nodes[oldParentId].children.removeOne(id);
+            applyDelta(oldParentId, Costs{-moved.planned, -moved.actual}, -count);
+        }
+        if (parentId != 0) {
+            nodes[parentId].children << id;
+            applyDelta(parentId, moved, count);
+        }
+    }
+
+    refreshOverrun(nodes.value(id));
+    return true;
+}
+
+QStringList BudgetTree::removeProject(int id)
+{
+    QStringList movedTasks;
+    auto it = nodes.find(id);
+    if (it == nodes.end()) return movedTasks;
+
+    Node node = *it;
+    nodes.erase(it);
+    overrunIds.remove(id);
+
+    // Le sous-arbre se fond dans le parent : ses totaux ne changent pas
+    if (node.parentId != 0) {
+        Node &parent = nodes[node.parentId];
+        parent.children.removeOne(id);
+        parent.children += node.children;
+        parent.own.planned += node.own.planned;
+        parent.own.actual += node.own.actual;
+    }
+    for (int child : node.children) {
+        nodes[child].parentId = node.parentId;
+    }
+
+    for (auto task = tasks.begin(); task != tasks.end(); ++task) {
+        if (task->projectId == id) {
+            task->projectId = node.parentId;
+            movedTasks << task.key();
+        }
+    }
+    return movedTasks;
+}
+
+QVector<int> BudgetTree::roots() const
+{
+    QVector<int> result;
+    for (auto it = nodes.constBegin(); it != nodes.constEnd(); ++it) {
+        if (it->parentId == 0) result << it.key();
+    }
+    std::sort(result.begin(), result.end(), [this](int a, int b) {
+        return nodes.value(a).name.compare(nodes.value(b).name, Qt::CaseInsensitive) < 0;
+    });
+    return result;
+}
+
+QString BudgetTree::path(int id) const
+{
+    QStringList names;
+    int steps = 0;
+    for (int p = id; p != 0 && steps <= nodes.size(); p = nodes.value(p).parentId, ++steps) {
+        names.prepend(nodes.value(p).name);
+    }
+    return names.join(" / ");
+}
+
+int BudgetTree::depth(int id) const
+{
+    int depth = 0;
+    for (int p = nodes.value(id).parentId; p != 0 && depth <= nodes.size(); p = nodes.value(p).parentId) {
+        ++depth;
+    }
+    return depth;
+}
+
+void BudgetTree::setTask(const QString &taskId, int projectId, double planned, double actual)
+{
+    if (!nodes.contains(projectId)) projectId = 0;
+
+    removeTask(taskId);
+
+    TaskCosts costs;
+    costs.projectId = projectId;
+    costs.planned = planned;
+    costs.actual = actual;
+    tasks.insert(taskId, costs);
+
+    grandTotal.planned += planned;
+    grandTotal.actual += actual;
+    if (projectId != 0) {
+        Node &node = nodes[projectId];
+        node.own.planned += planned;
+        node.own.actual += actual;
+        applyDelta(projectId, Costs{planned, actual}, 1);
+    }
+}
+
+void BudgetTree::renameTask(const QString &oldId, const QString &newId)
+{
+    if (oldId == newId || !tasks.contains(oldId)) return;
+    tasks.insert(newId, tasks.take(oldId));
+}
+
+void BudgetTree::removeTask(const QString &taskId)
+{
+    auto it = tasks.find(taskId);
+    if (it == tasks.end()) return;
+
+    TaskCosts old = *it;
+    tasks.erase(it);
+
+    grandTotal.planned -= old.planned;
+    grandTotal.actual -= old.actual;
+    auto node = nodes.find(old.projectId);
+    if (node != nodes.end()) {
+        node->own.planned -= old.planned;
+        node->own.actual -= old.actual;
+        applyDelta(old.projectId, Costs{-old.planned, -old.actual}, -1);
+    }
+}
+
+QVector<int> BudgetTree::overruns() const
+{
+    QVector<int> result(overrunIds.constBegin(), overrunIds.constEnd());
+    std::sort(result.begin(), result.end(), [this](int a, int b) {
+        return nodes.value(a).overrun() > nodes.value(b).overrun();
+    });
+    return result;
+}
+
+void BudgetTree::applyDelta(int projectId, const Costs &delta, int count)
+{
+    int steps = 0;
+    for (int id = projectId; id != 0 && steps <= nodes.size(); ++steps) {
+        auto it = nodes.find(id);
+        if (it == nodes.end()) break;
+        it->total.planned += delta.planned;
+        it->total.actual += delta.actual;
+        it->taskCount += count;
+        refreshOverrun(*it);
+        id = it->parentId;
+    }
+}
+
+void BudgetTree::refreshOverrun(const Node &node)
+{
+    if (node.isOverrun()) {
+        overrunIds.insert(node.id);
+    } else {
+        overrunIds.remove(node.id);
+    }
+}
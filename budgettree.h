@@ -0,0 +1,87 @@
+#ifndef BUDGETTREE_H
+#define BUDGETTREE_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Arbre projets > phases > tâches avec coûts prévus et réels.
+// Chaque nœud garde les totaux de son sous-arbre : modifier une tâche
+// n'applique qu'un delta le long de la chaîne de ses ancêtres.
+// L'ensemble des nœuds en dépassement est tenu à jour au fil des deltas,
+// la requête de dépassement ne parcourt donc jamais le portefeuille.
+class BudgetTree
+{
+public:
+    struct Costs
+    {
+        double planned = 0.0;
+        double actual = 0.0;
+
+        double variance() const { return planned - actual; }
+    };
+
+    struct Node
+    {
+        int id = 0;
+        int parentId = 0;
+        QString name;
+        double budget = 0.0;    // enveloppe du projet ou de la phase
+        Costs own;              // tâches rattachées directement
+        Costs total;            // sous-arbre complet
+        int taskCount = 0;      // sous-arbre complet
+        QVector<int> children;
+
+        // Sans enveloppe, le prévu des tâches sert de référence
+        double limit() const { return budget > 0 ? budget : total.planned; }
+        double overrun() const { return total.actual - limit(); }
+        bool isOverrun() const { return overrun() > 0.005; }
+    };
+
+    struct TaskCosts
+    {
+        int projectId = 0;
+        double planned = 0.0;
+        double actual = 0.0;
+
+        bool isEmpty() const { return projectId == 0 && planned == 0 && actual == 0; }
+    };
+
+    void clear();
+
+    // Un parent inconnu est créé vide : les projets peuvent arriver dans n'importe quel ordre
+    bool setProject(int id, int parentId, const QString &name, double budget, QString *error = nullptr);
+    bool canMove(int id, int parentId, QString *error = nullptr) const;
+    // Les phases et les tâches du nœud supprimé remontent à son parent
+    QStringList removeProject(int id);
+
+    bool contains(int id) const { return nodes.contains(id); }
+    Node node(int id) const { return nodes.value(id); }
+    QVector<int> roots() const;
+    QString path(int id) const;
+    int depth(int id) const;
+    int projectCount() const { return nodes.size(); }
+
+    void setTask(const QString &taskId, int projectId, double planned, double actual);
+    void renameTask(const QString &oldId, const QString &newId);
+    void removeTask(const QString &taskId);
+    TaskCosts task(const QString &taskId) const { return tasks.value(taskId); }
+
+    // Du plus gros dépassement au plus petit
+    QVector<int> overruns() const;
+    int overrunCount() const { return overrunIds.size(); }
+    Costs portfolio() const { return grandTotal; }
+
+private:
+    QHash<int, Node> nodes;
+    QHash<QString, TaskCosts> tasks;
+    QSet<int> overrunIds;
+    Costs grandTotal;
+
+    void applyDelta(int projectId, const Costs &delta, int count);
+    void refreshOverrun(const Node &node);
+};
+
+#endif // BUDGETTREE_H
@@ -0,0 +1,285 @@
+#include "chartrenderer.h"
+#include "diagnostics.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFuture>
+#include <QGraphicsLayout>
+#include <QGraphicsScene>
+#include <QMap>
+#include <QPageSize>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QRegularExpression>
+#include <QtCharts/QBarCategoryAxis>
+#include <QtCharts/QBarSeries>
+#include <QtCharts/QBarSet>
+#include <QtCharts/QPieSeries>
+#include <QtCharts/QValueAxis>
+#include <QtConcurrent>
+#include <algorithm>
+
+// Images en cache, en Ko
+const int chart_cache_cost = 64 * 1024;
+
+int ChartSpec::total() const
+{
+    int sum = 0;
+    for (int value : values) {
+        sum += value;
+    }
+    return sum;
+}
+
+QString ChartSpec::cacheKey(int dpi) const
+{
+    QStringList parts;
+    parts << QString::number(kind) << scope << caption << QString::number(dpi);
+    for (int i = 0; i < labels.size(); ++i) {
+        parts << labels[i] << QString::number(values.value(i));
+    }
+    return parts.join(QChar(0x1f));
+}
+
+QString ChartSpec::fileStem() const
+{
+    QString name = scope.isEmpty() ? QString("all") : scope.toLower();
+    name.replace(QRegularExpression("[^a-z0-9]+"), "_");
+    // Nom réduit (casse, accents, autres écritures) ou "all" : l'empreinte de la
+    // personne distingue le fichier des autres et de celui de l'équipe
+    if (!scope.isEmpty() && (name != scope || name == "all")) {
+        name += "_" + QString::fromLatin1(QCryptographicHash::hash(scope.toUtf8(), QCryptographicHash::Sha1)
+                                              .toHex().left(8));
+    }
+    return QString("%1_%2").arg(name, kind == StatusPie ? "status" : "duration");
+}
+
+ChartRenderer::ChartRenderer()
+    : cache(chart_cache_cost)
+{
+}
+
+ChartSpec ChartRenderer::statusSpec(const QVector<TaskRecord> &tasks, const QString &scope)
+{
+    QMap<QString, int> statusCounts;
+    for (const TaskRecord &task : tasks) {
+        statusCounts[task.status]++;
+    }
+
+    ChartSpec spec;
+    spec.kind = ChartSpec::StatusPie;
+    spec.scope = scope;
+    for (auto it = statusCounts.constBegin(); it != statusCounts.constEnd(); ++it) {
+        spec.labels << it.key();
+        spec.values << it.value();
+    }
+    return spec;
+}
+
+ChartSpec ChartRenderer::durationSpec(const QVector<TaskRecord> &tasks, const QString &scope)
+{
+    ChartSpec spec;
+    spec.kind = ChartSpec::DurationBar;
+    spec.scope = scope;
+    spec.labels = QStringList{"1 day", "2-7 days", "1-4 weeks", "1+ months"};
+    spec.values = QVector<int>(spec.labels.size(), 0);
+
+    for (const TaskRecord &task : tasks) {
+        if (!task.startDate.isValid() || !task.endDate.isValid()) continue;
+
+        qint64 days = task.startDate.daysTo(task.endDate) + 1;
+        if (days <= 1) spec.values[0]++;
+        else if (days <= 7) spec.values[1]++;
+        else if (days <= 30) spec.values[2]++;
+        else spec.values[3]++;
+    }
+    return spec;
+}
+
+QChart *ChartRenderer::createChart(const ChartSpec &spec)
+{
+    int totalTasks = spec.total();
+    if (totalTasks == 0) {
+        return nullptr;
+    }
+
+    QString suffix = spec.scope.isEmpty() ? QString() : QString(" - %1").arg(spec.scope);
+    if (!spec.caption.isEmpty()) suffix += QString(" (%1)").arg(spec.caption);
+    QChart *chart = new QChart();
+
+    // Graphiques vivants, y compris ceux rendus en tâche de fond pour les rapports
+    static Diagnostics::Objects &charts = Diagnostics::objects("charts");
+    charts.add(1, sizeof(QChart));
+    QObject::connect(chart, &QObject::destroyed, []() { charts.add(-1, -qint64(sizeof(QChart))); });
+
+    if (spec.kind == ChartSpec::StatusPie) {
+        QPieSeries *series = new QPieSeries();
+        for (int i = 0; i < spec.labels.size(); ++i) {
+            double percentage = (spec.values[i] * 100.0) / totalTasks;
+            QPieSlice *slice = series->append(
+                QString("%1\n%2/%3 (%4%)")
+                    .arg(spec.labels[i])
+                    .arg(spec.values[i])
+                    .arg(totalTasks)
+                    .arg(QString::number(percentage, 'f', 1)),
+                spec.values[i]
+                );
+
+            slice->setLabelVisible();
+            slice->setLabelArmLengthFactor(0.3);
+            slice->setLabelPosition(QPieSlice::LabelOutside);
+        }
+
+        chart->addSeries(series);
+        chart->setTitle(QString("Task Distribution by Status%1\nTotal Tasks: %2").arg(suffix).arg(totalTasks));
+        chart->legend()->setAlignment(Qt::AlignRight);
+        chart->legend()->setMarkerShape(QLegend::MarkerShapeRectangle);
+
+        chart->setTitleFont(QFont("Arial", 12, QFont::Bold));
+        chart->legend()->setFont(QFont("Arial", 9));
+        return chart;
+    }
+
+    QBarSeries *series = new QBarSeries();
+    QBarSet *barSet = new QBarSet("Tasks");
+    int maxCount = *std::max_element(spec.values.constBegin(), spec.values.constEnd());
+    for (int count : spec.values) {
+        *barSet << count;
+    }
+
+    chart->addSeries(series);
+    chart->setTitle(QString("Task Duration Distribution%1\nTotal Tasks: %2").arg(suffix).arg(totalTasks));
+
+    series->append(barSet);
+    barSet->setColor(QColor(32, 159, 223));
+
+    QBarCategoryAxis *axisX = new QBarCategoryAxis();
+    axisX->append(spec.labels);
+    chart->addAxis(axisX, Qt::AlignBottom);
+    series->attachAxis(axisX);
+
+    QValueAxis *axisY = new QValueAxis();
+    axisY->setRange(0, maxCount + 2);
+    axisY->setTitleText("Number of Tasks");
+    axisY->setLabelFormat("%d");
+    chart->addAxis(axisY, Qt::AlignLeft);
+    series->attachAxis(axisY);
+
+    return chart;
+}
+
+QImage ChartRenderer::render(const ChartSpec &spec, int dpi)
+{
+    QString key = spec.cacheKey(dpi);
+    if (QImage *cached = cache.object(key)) {
+        return *cached;
+    }
+
+    // Mise en page à taille logique fixe, le DPI ne change que la résolution
+    qreal scale = dpi / 96.0;
+    QImage image(qRound(LogicalWidth * scale), qRound(LogicalHeight * scale), QImage::Format_ARGB32_Premultiplied);
+    image.setDotsPerMeterX(qRound(dpi / 0.0254));
+    image.setDotsPerMeterY(qRound(dpi / 0.0254));
+    image.fill(Qt::white);
+
+    QChart *chart = createChart(spec);
+    if (chart) {
+        QGraphicsScene scene;
+        scene.addItem(chart);    // la scène devient propriétaire du graphique
+        chart->setGeometry(0, 0, LogicalWidth, LogicalHeight);
+        if (chart->layout()) {
+            chart->layout()->activate();
+        }
+
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setRenderHint(QPainter::TextAntialiasing);
+        scene.render(&painter, QRectF(image.rect()), QRectF(0, 0, LogicalWidth, LogicalHeight));
+    }
+
+    cache.insert(key, new QImage(image), qMax<qsizetype>(1, image.sizeInBytes() / 1024));
+    return image;
+}
+
+bool ChartRenderer::save(const QImage &image, const QString &fileName, int dpi)
+{
+    if (fileName.endsWith(".pdf", Qt::CaseInsensitive)) {
+        return writePdf({image}, fileName, dpi);
+    }
+    return image.save(fileName);
+}
+
+bool ChartRenderer::writePdf(const QVector<QImage> &pages, const QString &fileName, int dpi)
+{
+    if (pages.isEmpty()) return false;
+
+    // QPdfWriter ne dépend pas du thread GUI : utilisable depuis le pool
+    QPdfWriter writer(fileName);
+    writer.setResolution(dpi);
+    writer.setPageSize(QPageSize(QSizeF(LogicalWidth / 96.0, LogicalHeight / 96.0), QPageSize::Inch));
+    writer.setPageMargins(QMarginsF(0, 0, 0, 0));
+
+    QPainter painter;
+    if (!painter.begin(&writer)) return false;
+
+    for (int i = 0; i < pages.size(); ++i) {
+        if (i > 0) writer.newPage();
+        QRect target = painter.viewport();
+        QSize size = pages[i].size().scaled(target.size(), Qt::KeepAspectRatio);
+        painter.drawImage(QRect(target.topLeft(), size), pages[i]);
+    }
+    return painter.end();
+}
+
+QStringList ChartRenderer::renderPack(const QVector<TaskRecord> &tasks, const QString &directory, int dpi)
+{
+    // Regroupement par personne, puis agrégats de chaque groupe en parallèle
+    QMap<QString, QVector<TaskRecord>> byAssignee;
+    for (const TaskRecord &task : tasks) {
+        QString assignee = task.assignedTo.trimmed();
+        byAssignee[assignee.isEmpty() ? QString("Unassigned") : assignee] << task;
+    }
+
+    QVector<QPair<QString, QVector<TaskRecord>>> groups;
+    groups << qMakePair(QString(), tasks);
+    for (auto it = byAssignee.constBegin(); it != byAssignee.constEnd(); ++it) {
+        groups << qMakePair(it.key(), it.value());
+    }
+
+    QVector<QVector<ChartSpec>> groupSpecs = QtConcurrent::blockingMapped<QVector<QVector<ChartSpec>>>(
+        groups, [](const QPair<QString, QVector<TaskRecord>> &group) {
+            return QVector<ChartSpec>{statusSpec(group.second, group.first),
+                                      durationSpec(group.second, group.first)};
+        });
+
+    // Les scènes QtCharts ne sont pas thread-safe : rendu sur ce thread, via le cache
+    QVector<QPair<QImage, QString>> files;
+    QVector<QImage> pages;
+    QDir dir(directory);
+    for (const QVector<ChartSpec> &specs : groupSpecs) {
+        for (const ChartSpec &spec : specs) {
+            if (spec.total() == 0) continue;
+            QImage image = render(spec, dpi);
+            files << qMakePair(image, dir.filePath(spec.fileStem() + ".png"));
+            pages << image;
+        }
+    }
+
+    // Encodage PNG et PDF en parallèle
+    QString pdfName = dir.filePath("report.pdf");
+    QFuture<bool> pdf = QtConcurrent::run([pages, pdfName, dpi]() {
+        return writePdf(pages, pdfName, dpi);
+    });
+    QVector<bool> saved = QtConcurrent::blockingMapped<QVector<bool>>(
+        files, [](const QPair<QImage, QString> &file) {
+            return file.first.save(file.second);
+        });
+
+    QStringList written;
+    for (int i = 0; i < files.size(); ++i) {
+        if (saved[i]) written << files[i].second;
+    }
+    if (pdf.result()) {
+        written << pdfName;
+    }
+    return written;
+}
@@ -0,0 +1,56 @@
+#ifndef CHARTRENDERER_H
+#define CHARTRENDERER_H
+
+#include <QCache>
+#include <QImage>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtCharts/QChart>
+#include "taskrecord.h"
+
+// Données d'un graphique : calculées hors du thread GUI, elles servent
+// aussi de clé de cache (même données + même DPI = même image)
+struct ChartSpec
+{
+    enum Kind { StatusPie, DurationBar };
+
+    Kind kind = StatusPie;
+    QString scope;       // vide pour l'ensemble des tâches, sinon le nom de la personne
+    QString caption;     // précision ajoutée au titre, ex. "as of 2024-03-18"
+    QStringList labels;
+    QVector<int> values;
+
+    int total() const;
+    QString cacheKey(int dpi) const;
+    QString fileStem() const;
+};
+
+// Rendu hors écran des graphiques dans une QImage ou un PDF à un DPI donné
+class ChartRenderer
+{
+public:
+    ChartRenderer();
+
+    static ChartSpec statusSpec(const QVector<TaskRecord> &tasks, const QString &scope = QString());
+    static ChartSpec durationSpec(const QVector<TaskRecord> &tasks, const QString &scope = QString());
+
+    // Graphique prêt à afficher, nullptr si aucune donnée
+    static QChart *createChart(const ChartSpec &spec);
+
+    QImage render(const ChartSpec &spec, int dpi);
+    static bool save(const QImage &image, const QString &fileName, int dpi);
+    static bool writePdf(const QVector<QImage> &pages, const QString &fileName, int dpi);
+
+    // Jeu complet (ensemble + une page par personne) : agrégats et écriture
+    // des fichiers en parallèle, rendu des graphiques via le cache
+    QStringList renderPack(const QVector<TaskRecord> &tasks, const QString &directory, int dpi);
+
+private:
+    static const int LogicalWidth = 800;
+    static const int LogicalHeight = 600;
+
+    QCache<QString, QImage> cache;
+};
+
+#endif // CHARTRENDERER_H
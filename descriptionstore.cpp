@@ -0,0 +1,104 @@
+#include "descriptionstore.h"
+#include "diagnostics.h"
+#include <QSqlError>
+#include <QVariant>
+#include <QDebug>
+
+DescriptionStore::DescriptionStore(int cacheChars)
+    : cache(cacheChars),
+    cacheHits(0),
+    cacheMisses(0)
+{
+}
+
+void DescriptionStore::setDatabase(const QSqlDatabase &database)
+{
+    db = database;
+    clear();
+}
+
+QString DescriptionStore::previewColumns()
+{
+    return QString("substr(description, 1, %1), "
+                   "(description_z IS NOT NULL OR length(description) > %1)")
+        .arg(PreviewLength);
+}
+
+QString DescriptionStore::previewText(const QString &preview, bool truncated)
+{
+    if (!truncated) return preview;
+    return preview.left(PreviewLength) + QChar(0x2026);
+}
+
+void DescriptionStore::bindDescription(QSqlQuery &query, const QString &text) const
+{
+    QVariant description;
+    QVariant compressed;
+    encode(text, &description, &compressed);
+    query.bindValue(":description", description);
+    query.bindValue(":description_z", compressed);
+}
+
+void DescriptionStore::encode(const QString &text, QVariant *description, QVariant *compressed)
+{
+    QByteArray utf8 = text.toUtf8();
+
+    if (utf8.size() > CompressThreshold) {
+        // Le préfixe reste lisible en SQL, le texte complet est compressé
+        *description = text.left(PreviewLength);
+        *compressed = qCompress(utf8);
+    } else {
+        *description = text;
+        *compressed = QVariant();
+    }
+}
+
+QString DescriptionStore::fullText(const QString &taskId)
+{
+    static Diagnostics::Cache &diagnostics = Diagnostics::cache("descriptions");
+    if (QString *cached = cache.object(taskId)) {
+        cacheHits++;
+        diagnostics.hit();
+        return *cached;
+    }
+    cacheMisses++;
+    diagnostics.miss();
+
+    if (!db.isOpen()) return QString();
+
+    QSqlQuery query(db);
+    query.prepare("SELECT description, description_z FROM tasks WHERE id = :id");
+    query.bindValue(":id", taskId);
+
+    static Diagnostics::Latency &latency = Diagnostics::latency("SELECT description (cache miss)");
+    Diagnostics::Timer timer(latency);
+    if (!query.exec() || !query.next()) {
+        qWarning() << "Failed to load description for" << taskId << query.lastError().text();
+        return QString();
+    }
+
+    QString text;
+    if (!query.value(1).isNull()) {
+        text = QString::fromUtf8(qUncompress(query.value(1).toByteArray()));
+    } else {
+        text = query.value(0).toString();
+    }
+
+    store(taskId, text);
+    return text;
+}
+
+void DescriptionStore::store(const QString &taskId, const QString &text)
+{
+    cache.insert(taskId, new QString(text), qMax(1, int(text.size())));
+}
+
+void DescriptionStore::invalidate(const QString &taskId)
+{
+    cache.remove(taskId);
+}
+
+void DescriptionStore::clear()
+{
+    cache.clear();
+}
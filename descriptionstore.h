@@ -0,0 +1,46 @@
+#ifndef DESCRIPTIONSTORE_H
+#define DESCRIPTIONSTORE_H
+
+#include <QCache>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+
+// Accès paresseux aux descriptions des tâches.
+// La table n'affiche qu'un aperçu; le texte complet est lu à la demande
+// et gardé dans un cache LRU borné en nombre de caractères.
+class DescriptionStore
+{
+public:
+    static const int PreviewLength = 80;
+    static const int CompressThreshold = 4096;   // octets UTF-8
+
+    explicit DescriptionStore(int cacheChars = 2 * 1024 * 1024);
+
+    void setDatabase(const QSqlDatabase &database);
+
+    // Colonnes SELECT pour l'aperçu et le drapeau "texte tronqué"
+    static QString previewColumns();
+    static QString previewText(const QString &preview, bool truncated);
+
+    // Lie :description et :description_z pour un INSERT/UPDATE
+    void bindDescription(QSqlQuery &query, const QString &text) const;
+    // Mêmes valeurs, pour les requêtes en lot à paramètres positionnels
+    static void encode(const QString &text, QVariant *description, QVariant *compressed);
+
+    QString fullText(const QString &taskId);
+    void store(const QString &taskId, const QString &text);
+    void invalidate(const QString &taskId);
+    void clear();
+
+    int hits() const { return cacheHits; }
+    int misses() const { return cacheMisses; }
+
+private:
+    QSqlDatabase db;
+    QCache<QString, QString> cache;
+    int cacheHits;
+    int cacheMisses;
+};
+
+#endif // DESCRIPTIONSTORE_H
@@ -0,0 +1,269 @@
+#include "diagnostics.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+#include <map>
+#include <memory>
+
+namespace {
+
+// Puissance de deux; une fois pleine, les requêtes nouvelles passent par le verrou
+const int statement_slots = 1024;
+const int statement_name_length = 72;
+
+// Case libre : empreinte nulle. La latence est publiée après l'empreinte
+struct StatementSlot
+{
+    std::atomic<quint64> fingerprint{0};
+    std::atomic<Diagnostics::Latency *> latency{nullptr};
+};
+
+// Les entrées ne sont jamais supprimées : les références rendues restent valides
+struct Registry
+{
+    StatementSlot statements[statement_slots];
+    QMutex mutex;
+    std::map<QString, std::unique_ptr<Diagnostics::Objects>> objects;
+    std::map<QString, std::unique_ptr<Diagnostics::Cache>> caches;
+    std::map<QString, std::unique_ptr<Diagnostics::Latency>> latencies;
+    std::map<QString, std::function<qint64()>> gauges;
+    QElapsedTimer uptime;
+
+    Registry() { uptime.start(); }
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+template <typename T>
+T &lookup(std::map<QString, std::unique_ptr<T>> &map, const QString &name)
+{
+    QMutexLocker locker(&registry().mutex);
+    std::unique_ptr<T> &entry = map[name];
+    if (!entry) entry.reset(new T);
+    return *entry;
+}
+
+// FNV-1a 64 bits sur les unités UTF-16, jamais nulle
+quint64 fingerprint(const QString &text)
+{
+    quint64 hash = 14695981039346656037ull;
+    for (QChar c : text) {
+        hash = (hash ^ c.unicode()) * 1099511628211ull;
+    }
+    return hash | 1;
+}
+
+// Espaces réduits; un texte tronqué garde son empreinte pour ne pas se confondre avec un autre
+QString statementName(const QString &sql)
+{
+    QString name = sql.simplified();
+    if (name.size() <= statement_name_length) return name;
+    return QString("%1... #%2").arg(name.left(statement_name_length - 21))
+        .arg(fingerprint(name) & 0xffffffffffffull, 12, 16, QLatin1Char('0'));
+}
+
+QString formatBytes(qint64 bytes)
+{
+    if (qAbs(bytes) < 10 * 1024) return QString("%1 B").arg(bytes);
+    if (qAbs(bytes) < 10 * 1024 * 1024) return QString("%1 KB").arg(bytes / 1024);
+    return QString("%1 MB").arg(bytes / (1024 * 1024));
+}
+
+QString formatMicros(qint64 us)
+{
+    if (us < 1000) return QString("%1 us").arg(us);
+    if (us < 1000 * 1000) return QString("%1 ms").arg(us / 1000.0, 0, 'f', 1);
+    return QString("%1 s").arg(us / 1000000.0, 0, 'f', 2);
+}
+
+}
+
+void Diagnostics::Latency::record(qint64 us)
+{
+    us = qMax<qint64>(0, us);
+    int bucket = 0;
+    for (qint64 bound = 2; us >= bound && bucket < LatencyBuckets - 1; bound <<= 1) {
+        ++bucket;
+    }
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    totalUs.fetch_add(us, std::memory_order_relaxed);
+
+    qint64 previous = maxUs.load(std::memory_order_relaxed);
+    while (us > previous && !maxUs.compare_exchange_weak(previous, us, std::memory_order_relaxed)) {
+    }
+}
+
+qint64 Diagnostics::Latency::percentile(double fraction) const
+{
+    qint64 total = count.load(std::memory_order_relaxed);
+    if (total == 0) return 0;
+
+    qint64 wanted = qMax<qint64>(1, qint64(total * fraction + 0.5));
+    qint64 seen = 0;
+    for (int bucket = 0; bucket < LatencyBuckets; ++bucket) {
+        seen += buckets[bucket].load(std::memory_order_relaxed);
+        if (seen >= wanted) {
+            return bucket == LatencyBuckets - 1 ? maxUs.load(std::memory_order_relaxed) : (qint64(2) << bucket);
+        }
+    }
+    return maxUs.load(std::memory_order_relaxed);
+}
+
+Diagnostics::Objects &Diagnostics::objects(const QString &name)
+{
+    return lookup(registry().objects, name);
+}
+
+Diagnostics::Cache &Diagnostics::cache(const QString &name)
+{
+    return lookup(registry().caches, name);
+}
+
+Diagnostics::Latency &Diagnostics::latency(const QString &name)
+{
+    return lookup(registry().latencies, name);
+}
+
+Diagnostics::Latency &Diagnostics::statement(const QString &sql)
+{
+    const quint64 key = fingerprint(sql);
+    StatementSlot *table = registry().statements;
+    for (int probe = 0; probe < statement_slots; ++probe) {
+        StatementSlot &slot = table[(key + probe) & (statement_slots - 1)];
+        quint64 current = slot.fingerprint.load(std::memory_order_acquire);
+        if (current == 0 && slot.fingerprint.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+            Latency &latency = Diagnostics::latency(statementName(sql));
+            slot.latency.store(&latency, std::memory_order_release);
+            return latency;
+        }
+        if (current == key) {
+            // Encore nulle : un autre thread est en train d'enregistrer la même requête
+            if (Latency *latency = slot.latency.load(std::memory_order_acquire)) return *latency;
+            break;
+        }
+    }
+    return latency(statementName(sql));
+}
+
+void Diagnostics::setGauge(const QString &name, const std::function<qint64()> &read)
+{
+    QMutexLocker locker(&registry().mutex);
+    registry().gauges[name] = read;
+}
+
+void Diagnostics::clearGauges()
+{
+    QMutexLocker locker(&registry().mutex);
+    registry().gauges.clear();
+}
+
+void Diagnostics::reset()
+{
+    Registry &r = registry();
+    QMutexLocker locker(&r.mutex);
+    for (auto &entry : r.caches) {
+        entry.second->hits = 0;
+        entry.second->misses = 0;
+    }
+    for (auto &entry : r.latencies) {
+        Latency &latency = *entry.second;
+        latency.count = 0;
+        latency.totalUs = 0;
+        latency.maxUs = 0;
+        for (std::atomic<qint64> &bucket : latency.buckets) {
+            bucket = 0;
+        }
+    }
+}
+
+QString Diagnostics::report()
+{
+    Registry &r = registry();
+    QStringList lines;
+    qint64 seconds = r.uptime.elapsed() / 1000;
+    lines << QString("Task Manager diagnostics - %1, uptime %2:%3:%4")
+                 .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"))
+                 .arg(seconds / 3600)
+                 .arg((seconds / 60) % 60, 2, 10, QChar('0'))
+                 .arg(seconds % 60, 2, 10, QChar('0'));
+
+    // Jauges évaluées hors verrou : elles peuvent elles-mêmes incrémenter des compteurs
+    std::map<QString, std::function<qint64()>> gauges;
+    {
+        QMutexLocker locker(&r.mutex);
+        gauges = r.gauges;
+    }
+    QStringList gaugeLines;
+    for (const auto &gauge : gauges) {
+        gaugeLines << QString("  %1 %2").arg(gauge.first, -36).arg(gauge.second(), 12);
+    }
+
+    QMutexLocker locker(&r.mutex);
+    lines << "" << QString("%1 %2 %3").arg("Objects", -38).arg("count", 12).arg("bytes", 12);
+    for (const auto &entry : r.objects) {
+        lines << QString("  %1 %2 %3").arg(entry.first, -36)
+                     .arg(entry.second->count.load(std::memory_order_relaxed), 12)
+                     .arg(formatBytes(entry.second->bytes.load(std::memory_order_relaxed)), 12);
+    }
+
+    lines << "" << QString("%1 %2").arg("Gauges", -38).arg("value", 12);
+    lines << gaugeLines;
+
+    lines << "" << QString("%1 %2 %3 %4").arg("Caches", -38).arg("hits", 12).arg("misses", 12).arg("hit rate", 10);
+    for (const auto &entry : r.caches) {
+        qint64 hits = entry.second->hits.load(std::memory_order_relaxed);
+        qint64 misses = entry.second->misses.load(std::memory_order_relaxed);
+        QString rate = hits + misses ? QString("%1 %").arg(100.0 * hits / (hits + misses), 0, 'f', 1) : QString("-");
+        lines << QString("  %1 %2 %3 %4").arg(entry.first, -36).arg(hits, 12).arg(misses, 12).arg(rate, 10);
+    }
+
+    lines << "" << QString("%1 %2 %3 %4 %5 %6").arg("Latency", -38).arg("count", 8)
+                       .arg("mean", 10).arg("p50", 10).arg("p95", 10).arg("max", 10);
+    for (const auto &entry : r.latencies) {
+        const Latency &latency = *entry.second;
+        qint64 count = latency.count.load(std::memory_order_relaxed);
+        if (count == 0) continue;
+        lines << QString("  %1 %2 %3 %4 %5 %6").arg(entry.first, -36).arg(count, 8)
+                     .arg(formatMicros(latency.totalUs.load(std::memory_order_relaxed) / count), 10)
+                     .arg(formatMicros(latency.percentile(0.5)), 10)
+                     .arg(formatMicros(latency.percentile(0.95)), 10)
+                     .arg(formatMicros(latency.maxUs.load(std::memory_order_relaxed)), 10);
+
+        // Histogramme condensé : compartiments non vides seulement
+        QStringList histogram;
+        for (int bucket = 0; bucket < LatencyBuckets; ++bucket) {
+            qint64 n = latency.buckets[bucket].load(std::memory_order_relaxed);
+            if (n == 0) continue;
+            histogram << QString("%1%2:%3").arg(bucket == LatencyBuckets - 1 ? ">=" : "<")
+                             .arg(formatMicros(bucket == LatencyBuckets - 1 ? (qint64(1) << bucket) : (qint64(2) << bucket)))
+                             .arg(n);
+        }
+        lines << "      " + histogram.join("  ");
+    }
+    return lines.join('\n') + '\n';
+}
+
+StallMonitor::StallMonitor(QObject *parent)
+    : QObject(parent)
+{
+    ticker.setInterval(TickMs);
+    connect(&ticker, &QTimer::timeout, this, &StallMonitor::tick);
+    sinceLastTick.start();
+    ticker.start();
+}
+
+void StallMonitor::tick()
+{
+    static Diagnostics::Latency &stalls = Diagnostics::latency("event loop stalls");
+    qint64 late = sinceLastTick.restart() - TickMs;
+    if (late >= StallThresholdMs) {
+        stalls.record(late * 1000);
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <atomic>
+#include <functional>
+
+// Compteurs de diagnostic toujours actifs : objets et octets par sous-système,
+// succès des caches, histogrammes de latence par requête. Chaque compteur est
+// un atomique relâché, enregistré une seule fois par nom : le point d'appel
+// garde la référence dans une variable statique et n'a plus de verrou à prendre.
+// Les requêtes SQL, trop nombreuses pour une statique chacune, sont retrouvées
+// par l'empreinte de leur texte dans une table sans verrou.
+// Les jauges (lignes de modèle, formats du calendrier) ne sont lues qu'au rapport.
+class Diagnostics
+{
+public:
+    // Compartiments en puissances de deux de microsecondes : < 2 µs ... >= 2^18 µs (0,26 s)
+    static constexpr int LatencyBuckets = 19;
+
+    struct Objects
+    {
+        std::atomic<qint64> count{0};
+        std::atomic<qint64> bytes{0};
+
+        void add(qint64 objects, qint64 size)
+        {
+            count.fetch_add(objects, std::memory_order_relaxed);
+            bytes.fetch_add(size, std::memory_order_relaxed);
+        }
+    };
+
+    struct Cache
+    {
+        std::atomic<qint64> hits{0};
+        std::atomic<qint64> misses{0};
+
+        void hit() { hits.fetch_add(1, std::memory_order_relaxed); }
+        void miss() { misses.fetch_add(1, std::memory_order_relaxed); }
+    };
+
+    struct Latency
+    {
+        std::atomic<qint64> count{0};
+        std::atomic<qint64> totalUs{0};
+        std::atomic<qint64> maxUs{0};
+        std::atomic<qint64> buckets[LatencyBuckets] = {};
+
+        void record(qint64 us);
+        // Borne supérieure du compartiment contenant le centile demandé
+        qint64 percentile(double fraction) const;
+    };
+
+    // Mesure la durée de la portée courante
+    class Timer
+    {
+    public:
+        explicit Timer(Latency &latency) : target(latency) { clock.start(); }
+        ~Timer() { target.record(clock.nsecsElapsed() / 1000); }
+
+    private:
+        Latency &target;
+        QElapsedTimer clock;
+    };
+
+    // Références stables pendant toute la vie du programme
+    static Objects &objects(const QString &name);
+    static Cache &cache(const QString &name);
+    static Latency &latency(const QString &name);
+    // Histogramme d'une requête SQL : ni allocation ni verrou une fois la requête vue
+    static Latency &statement(const QString &sql);
+
+    // Lue sur le thread principal, au moment du rapport seulement
+    static void setGauge(const QString &name, const std::function<qint64()> &read);
+    static void clearGauges();
+
+    // Remet à zéro latences et caches; les objets vivants restent comptés
+    static void reset();
+    static QString report();
+};
+
+// Retard des minuteries : une boucle d'événements occupée déclenche le tick en retard
+class StallMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int TickMs = 50;
+    static constexpr int StallThresholdMs = 30;
+
+    explicit StallMonitor(QObject *parent = nullptr);
+
+private:
+    QTimer ticker;
+    QElapsedTimer sinceLastTick;
+
+    void tick();
+};
+
+#endif // DIAGNOSTICS_H
@@ -0,0 +1,329 @@
+#include "filterquery.h"
+#include <QRegularExpression>
+#include <QHash>
+
+static const char *fieldPattern =
+    "(?:^|\\s)(id|name|status|priority|prio|start|due|end|assignee|assigned|assigned_to)(!=|<=|>=|:|=|<|>)";
+
+static QString likePattern(const QString &value)
+{
+    QString escaped = value;
+    escaped.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+    return "%" + escaped + "%";
+}
+
+static QString sqlOperator(FilterQuery::Op op)
+{
+    switch (op) {
+    case FilterQuery::NotEqual: return "<>";
+    case FilterQuery::Less: return "<";
+    case FilterQuery::LessEqual: return "<=";
+    case FilterQuery::Greater: return ">";
+    case FilterQuery::GreaterEqual: return ">=";
+    default: return "=";
+    }
+}
+
+static QString canonicalValue(const QString &value, const QStringList &allowed)
+{
+    for (const QString &candidate : allowed) {
+        if (candidate.compare(value, Qt::CaseInsensitive) == 0) return candidate;
+    }
+    return QString();
+}
+
+bool FilterQuery::looksStructured(const QString &text)
+{
+    static const QRegularExpression re(fieldPattern, QRegularExpression::CaseInsensitiveOption);
+    return re.match(text).hasMatch();
+}
+
+QStringList FilterQuery::tokenize(const QString &text)
+{
+    QStringList tokens;
+    QString current;
+    bool inQuotes = false;
+
+    for (QChar c : text) {
+        if (c == '"') {
+            inQuotes = !inQuotes;
+        } else if (c.isSpace() && !inQuotes) {
+            if (!current.isEmpty()) tokens << current;
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    if (!current.isEmpty()) tokens << current;
+
+    return tokens;
+}
+
+bool FilterQuery::parseTerm(const QString &token, Term *term, QString *error)
+{
+    static const QRegularExpression re("^([A-Za-z_]+)(!=|<=|>=|:|=|<|>)(.+)$");
+    static const QHash<QString, Field> fields = {
+        {"id", Id}, {"name", Name}, {"status", Status}, {"priority", Priority}, {"prio", Priority},
+        {"start", Start}, {"due", Due}, {"end", Due},
+        {"assignee", Assignee}, {"assigned", Assignee}, {"assigned_to", Assignee}
+    };
+    static const QHash<QString, Op> ops = {
+        {":", Equal}, {"=", Equal}, {"!=", NotEqual}, {"<", Less},
+        {"<=", LessEqual}, {">", Greater}, {">=", GreaterEqual}
+    };
+
+    QRegularExpressionMatch match = re.match(token);
+    if (!match.hasMatch() || !fields.contains(match.captured(1).toLower())) {
+        term->field = Text;
+        term->op = Contains;
+        term->value = token;
+        return true;
+    }
+
+    QString opText = match.captured(2);
+    term->field = fields.value(match.captured(1).toLower());
+    term->op = ops.value(opText);
+    term->value = match.captured(3).trimmed();
+
+    bool ordered = term->op != Equal && term->op != NotEqual;
+
+    switch (term->field) {
+    case Name:
+        if (opText == ":") term->op = Contains;
+        else if (ordered) {
+            *error = "Names only support ':', '=' and '!='";
+            return false;
+        }
+        break;
+
+    case Status:
+        term->value = canonicalValue(term->value, TaskRecord::statuses());
+        if (term->value.isEmpty()) {
+            *error = QString("Unknown status in '%1' (expected %2)")
+                         .arg(token, TaskRecord::statuses().join(", "));
+            return false;
+        }
+        if (ordered) {
+            *error = "Status only supports ':', '=' and '!='";
+            return false;
+        }
+        break;
+
+    case Priority:
+        term->value = canonicalValue(term->value, TaskRecord::priorities());
+        if (term->value.isEmpty()) {
+            *error = QString("Unknown priority in '%1' (expected %2)")
+                         .arg(token, TaskRecord::priorities().join(", "));
+            return false;
+        }
+        break;
+
+    case Start:
+    case Due:
+        if (term->value.compare("today", Qt::CaseInsensitive) == 0) {
+            term->date = QDate::currentDate();
+        } else {
+            term->date = QDate::fromString(term->value, "yyyy-MM-dd");
+        }
+        if (!term->date.isValid()) {
+            *error = QString("Invalid date in '%1' (expected YYYY-MM-DD or today)").arg(token);
+            return false;
+        }
+        term->value = term->date.toString("yyyy-MM-dd");
+        break;
+
+    case Assignee:
+        if (ordered) {
+            *error = "Assignee only supports ':', '=' and '!='";
+            return false;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return true;
+}
+
+FilterQuery FilterQuery::parse(const QString &text, QString *error)
+{
+    FilterQuery query;
+    QString message;
+
+    for (const QString &token : tokenize(text)) {
+        Term term;
+        if (!parseTerm(token, &term, &message)) {
+            if (error) *error = message;
+            return FilterQuery();
+        }
+        query.terms << term;
+    }
+
+    if (error) error->clear();
+    return query;
+}
+
+bool FilterQuery::usesIndex() const
+{
+    for (const Term &term : terms) {
+        switch (term.field) {
+        case Status:
+        case Priority:
+        case Start:
+        case Due:
+            return true;
+        case Id:
+        case Assignee:
+            if (term.op == Equal) return true;
+            break;
+        default:
+            break;
+        }
+    }
+    return false;
+}
+
+void FilterQuery::compile(QStringList *clauses, QVariantList *values) const
+{
+    for (const Term &term : terms) {
+        switch (term.field) {
+        case Id:
+            *clauses << QString("id %1 ?").arg(sqlOperator(term.op));
+            *values << term.value.toUpper();
+            break;
+
+        case Name:
+            if (term.op == Contains) {
+                *clauses << "name LIKE ? ESCAPE '\\'";
+                *values << likePattern(term.value);
+            } else {
+                *clauses << QString("name %1 ? COLLATE NOCASE").arg(sqlOperator(term.op));
+                *values << term.value;
+            }
+            break;
+
+        case Status:
+            *clauses << QString("status %1 ?").arg(sqlOperator(term.op));
+            *values << term.value;
+            break;
+
+        case Priority: {
+            // Les niveaux de priorité sont développés en IN (...) pour rester indexables
+            int rank = TaskRecord::priorityRank(term.value);
+            QStringList placeholders;
+            for (const QString &priority : TaskRecord::priorities()) {
+                if (compare(TaskRecord::priorityRank(priority) - rank, term.op)) {
+                    placeholders << "?";
+                    *values << priority;
+                }
+            }
+            *clauses << (placeholders.isEmpty() ? QString("0")
+                                                : QString("priority IN (%1)").arg(placeholders.join(", ")));
+            break;
+        }
+
+        case Start:
+            *clauses << QString("start_date %1 ?").arg(sqlOperator(term.op));
+            *values << term.value;
+            break;
+
+        case Due:
+            *clauses << QString("end_date %1 ?").arg(sqlOperator(term.op));
+            *values << term.value;
+            break;
+
+        case Assignee:
+            *clauses << QString("assigned_to %1 ? COLLATE NOCASE").arg(sqlOperator(term.op));
+            *values << term.value;
+            break;
+
+        case Text:
+            *clauses << "(id LIKE ? ESCAPE '\\' OR name LIKE ? ESCAPE '\\')";
+            *values << likePattern(term.value) << likePattern(term.value);
+            break;
+        }
+    }
+}
+
+QString FilterQuery::whereClause() const
+{
+    QStringList clauses;
+    QVariantList values;
+    compile(&clauses, &values);
+    return clauses.isEmpty() ? QString("1") : clauses.join(" AND ");
+}
+
+QVariantList FilterQuery::bindings() const
+{
+    QStringList clauses;
+    QVariantList values;
+    compile(&clauses, &values);
+    return values;
+}
+
+QString FilterQuery::selectIdsSql() const
+{
+    return "SELECT id FROM tasks WHERE " + whereClause();
+}
+
+QString FilterQuery::countSql() const
+{
+    return "SELECT COUNT(*) FROM tasks WHERE " + whereClause();
+}
+
+bool FilterQuery::compare(int cmp, Op op)
+{
+    switch (op) {
+    case NotEqual: return cmp != 0;
+    case Less: return cmp < 0;
+    case LessEqual: return cmp <= 0;
+    case Greater: return cmp > 0;
+    case GreaterEqual: return cmp >= 0;
+    default: return cmp == 0;
+    }
+}
+
+bool FilterQuery::matches(const TaskRecord &task) const
+{
+    for (const Term &term : terms) {
+        bool ok = false;
+
+        switch (term.field) {
+        case Id:
+            ok = compare(QString::compare(task.id, term.value, Qt::CaseInsensitive), term.op);
+            break;
+        case Name:
+            ok = (term.op == Contains)
+                     ? task.name.contains(term.value, Qt::CaseInsensitive)
+                     : compare(QString::compare(task.name, term.value, Qt::CaseInsensitive), term.op);
+            break;
+        case Status:
+            ok = compare(QString::compare(task.status, term.value), term.op);
+            break;
+        case Priority: {
+            int rank = TaskRecord::priorityRank(task.priority);
+            ok = rank >= 0 && compare(rank - TaskRecord::priorityRank(term.value), term.op);
+            break;
+        }
+        case Start:
+            ok = task.startDate.isValid()
+                 && compare(int(term.date.daysTo(task.startDate)), term.op);
+            break;
+        case Due:
+            ok = task.endDate.isValid()
+                 && compare(int(term.date.daysTo(task.endDate)), term.op);
+            break;
+        case Assignee:
+            ok = compare(QString::compare(task.assignedTo, term.value, Qt::CaseInsensitive), term.op);
+            break;
+        case Text:
+            ok = task.id.contains(term.value, Qt::CaseInsensitive)
+                 || task.name.contains(term.value, Qt::CaseInsensitive);
+            break;
+        }
+
+        if (!ok) return false;
+    }
+    return true;
+}
@@ -0,0 +1,49 @@
+#ifndef FILTERQUERY_H
+#define FILTERQUERY_H
+
+#include <QList>
+#include <QString>
+#include <QVariantList>
+#include "taskrecord.h"
+
+// Petit langage de filtre pour la barre de recherche, par exemple :
+//   status:"In Progress" priority>=High due<2026-11-01 assignee:karim
+// Une requête se compile soit en clause WHERE paramétrée (colonnes indexées),
+// soit en prédicat évalué sur les lignes déjà chargées.
+class FilterQuery
+{
+public:
+    enum Field { Id, Name, Status, Priority, Start, Due, Assignee, Text };
+    enum Op { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual, Contains };
+
+    struct Term
+    {
+        Field field;
+        Op op;
+        QString value;
+        QDate date;
+    };
+
+    static FilterQuery parse(const QString &text, QString *error = nullptr);
+    static bool looksStructured(const QString &text);
+
+    bool isEmpty() const { return terms.isEmpty(); }
+    bool usesIndex() const;
+
+    QString whereClause() const;
+    QVariantList bindings() const;
+    QString selectIdsSql() const;
+    QString countSql() const;
+
+    bool matches(const TaskRecord &task) const;
+
+private:
+    QList<Term> terms;
+
+    void compile(QStringList *clauses, QVariantList *values) const;
+    static bool parseTerm(const QString &token, Term *term, QString *error);
+    static QStringList tokenize(const QString &text);
+    static bool compare(int cmp, Op op);
+};
+
+#endif // FILTERQUERY_H
@@ -0,0 +1,293 @@
+#include "fuzzysearch.h"
+#include <QApplication>
+#include <QPainter>
+#include <QStyle>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+const int MaxCandidates = 20000;
+const int FieldWeight[FuzzyIndex::FieldCount] = {10, 30, 20};
+
+// Masques de bits par caractère du motif (un bit par position)
+struct PatternMasks
+{
+    quint64 ascii[128];
+    QHash<ushort, quint64> other;
+
+    explicit PatternMasks(const QString &pattern)
+    {
+        std::fill(ascii, ascii + 128, quint64(0));
+        for (int i = 0; i < pattern.size(); ++i) {
+            ushort u = pattern.at(i).unicode();
+            if (u < 128) ascii[u] |= quint64(1) << i;
+            else other[u] |= quint64(1) << i;
+        }
+    }
+
+    quint64 mask(QChar c) const
+    {
+        ushort u = c.unicode();
+        return u < 128 ? ascii[u] : other.value(u, 0);
+    }
+};
+
+// Distance d'édition minimale entre le motif et une sous-chaîne du texte
+// (Myers 1999) : une itération par caractère du texte, motif <= 64 caractères.
+int bestDistance(const PatternMasks &peq, int m, const QString &text, int *endPos)
+{
+    quint64 pv = ~quint64(0);
+    quint64 mv = 0;
+    const quint64 high = quint64(1) << (m - 1);
+    int score = m;
+    int best = m;
+    int bestEnd = -1;
+
+    for (int j = 0; j < text.size(); ++j) {
+        quint64 eq = peq.mask(text.at(j));
+        quint64 xv = eq | mv;
+        quint64 xh = (((eq & pv) + pv) ^ pv) | eq;
+        quint64 ph = mv | ~(xh | pv);
+        quint64 mh = pv & xh;
+
+        if (ph & high) ++score;
+        else if (mh & high) --score;
+
+        ph <<= 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        if (score < best) {
+            best = score;
+            bestEnd = j;
+        }
+    }
+
+    *endPos = bestEnd;
+    return best;
+}
+
+} // namespace
+
+void FuzzyIndex::clear()
+{
+    entries.clear();
+    postings.clear();
+}
+
+QVector<quint64> FuzzyIndex::trigrams(const QString &lowerText)
+{
+    QVector<quint64> grams;
+    for (int i = 0; i + 2 < lowerText.size(); ++i) {
+        grams << ((quint64(lowerText.at(i).unicode()) << 32)
+                  | (quint64(lowerText.at(i + 1).unicode()) << 16)
+                  | quint64(lowerText.at(i + 2).unicode()));
+    }
+    return grams;
+}
+
+void FuzzyIndex::addTask(const QString &id, const QString &name, const QString &assignee)
+{
+    int doc = entries.size();
+
+    Entry entry;
+    entry.id = id;
+    entry.fields[IdField] = id.toLower();
+    entry.fields[NameField] = name.toLower();
+    entry.fields[AssigneeField] = assignee.toLower();
+
+    for (const QString &field : entry.fields) {
+        for (quint64 gram : trigrams(field)) {
+            QVector<int> &list = postings[gram];
+            if (list.isEmpty() || list.last() != doc) {
+                list.append(doc);
+            }
+        }
+    }
+
+    entries.append(entry);
+}
+
+// k + 1 morceaux d'au moins 3 caractères (voir search) : k <= longueur / 3 - 1
+int FuzzyIndex::maxDistance(int patternLength)
+{
+    if (patternLength < 6) return 0;
+    if (patternLength < 9) return 1;
+    if (patternLength < 12) return 2;
+    return 3;
+}
+
+QVector<FuzzyIndex::Match> FuzzyIndex::search(const QString &text, int limit) const
+{
+    QVector<Match> results;
+    QString pattern = text.trimmed().toLower().left(64);
+    const int m = pattern.size();
+    if (m == 0 || entries.isEmpty()) return results;
+
+    const int k = maxDistance(m);
+
+    // Préfiltre par tiroirs : le motif est coupé en k + 1 morceaux disjoints, et
+    // k éditions en laissent au moins un intact. Une chaîne à distance <= k
+    // contient donc l'un des morceaux tel quel, et tous ses trigrammes. Les
+    // candidats sont l'union, sur les morceaux, de l'intersection des listes de
+    // leurs trigrammes. Moins de 3 caractères : pas de trigramme, tout est examiné.
+    QVector<int> candidates;
+    if (m < 3) {
+        candidates.resize(entries.size());
+        std::iota(candidates.begin(), candidates.end(), 0);
+    } else {
+        QVector<quint16> counts(entries.size(), 0);      // morceaux trouvés par entrée
+        QVector<int> touched;
+
+        for (int piece = 0; piece <= k; ++piece) {
+            int from = piece * m / (k + 1);
+            int to = (piece + 1) * m / (k + 1);
+            QVector<quint64> grams = trigrams(pattern.mid(from, to - from));
+            std::sort(grams.begin(), grams.end());
+            grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+            QVector<const QVector<int> *> lists;
+            for (quint64 gram : grams) {
+                auto it = postings.constFind(gram);
+                if (it == postings.constEnd()) {
+                    lists.clear();
+                    break;
+                }
+                lists.append(&it.value());
+            }
+            if (lists.isEmpty()) continue;
+
+            // Listes triées par document : intersection en partant de la plus courte
+            std::sort(lists.begin(), lists.end(),
+                      [](const QVector<int> *a, const QVector<int> *b) { return a->size() < b->size(); });
+            QVector<int> docs = *lists.first();
+            QVector<int> kept;
+            for (int i = 1; i < lists.size() && !docs.isEmpty(); ++i) {
+                kept.clear();
+                std::set_intersection(docs.cbegin(), docs.cend(), lists[i]->cbegin(), lists[i]->cend(),
+                                      std::back_inserter(kept));
+                docs.swap(kept);
+            }
+            for (int doc : docs) {
+                if (counts[doc]++ == 0) touched.append(doc);
+            }
+        }
+        candidates = touched;
+
+        if (candidates.size() > MaxCandidates) {
+            std::nth_element(candidates.begin(), candidates.begin() + MaxCandidates, candidates.end(),
+                             [&counts](int a, int b) { return counts[a] > counts[b]; });
+            candidates.resize(MaxCandidates);
+        }
+    }
+
+    PatternMasks peq(pattern);
+
+    for (int doc : candidates) {
+        const Entry &entry = entries[doc];
+        Match best;
+        best.score = -1;
+        best.distance = k + 1;
+        best.field = NameField;
+        best.start = 0;
+        best.length = 0;
+
+        for (int f = 0; f < FieldCount; ++f) {
+            const QString &field = entry.fields[f];
+            int end = -1;
+            int distance = bestDistance(peq, m, field, &end);
+            if (distance > k || end < 0) continue;
+
+            int start = qMax(0, end - m + 1);
+            int score = 1000 - distance * 250 + FieldWeight[f] - qMin(int(field.size()), 200) / 4;
+            if (start == 0 || field.at(start - 1).isSpace()) score += 40;
+
+            if (score > best.score) {
+                best.taskId = entry.id;
+                best.score = score;
+                best.distance = distance;
+                best.field = Field(f);
+                best.start = start;
+                best.length = end - start + 1;
+            }
+        }
+
+        if (best.score >= 0) results.append(best);
+    }
+
+    auto byScore = [](const Match &a, const Match &b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.taskId < b.taskId;
+    };
+
+    if (results.size() > limit) {
+        std::partial_sort(results.begin(), results.begin() + limit, results.end(), byScore);
+        results.resize(limit);
+    } else {
+        std::sort(results.begin(), results.end(), byScore);
+    }
+
+    return results;
+}
+
+FuzzyHighlightDelegate::FuzzyHighlightDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+void FuzzyHighlightDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
+                                   const QModelIndex &index) const
+{
+    QVariantList span = index.data(HighlightRole).toList();
+    if (activeQuery.isEmpty() || span.size() != 3 || span[0].toString() != activeQuery) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    QString text = opt.text;
+    opt.text.clear();
+
+    QStyle *style = opt.widget ? opt.widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, opt.widget);
+
+    int start = qBound(0, span[1].toInt(), int(text.size()));
+    int length = qBound(0, span[2].toInt(), int(text.size()) - start);
+
+    QRect textRect = style->subElementRect(QStyle::SE_ItemViewItemText, &opt, opt.widget).adjusted(3, 0, -3, 0);
+    bool selected = opt.state & QStyle::State_Selected;
+    QColor textColor = opt.palette.color(selected ? QPalette::HighlightedText : QPalette::Text);
+
+    QFont boldFont = opt.font;
+    boldFont.setBold(true);
+    QFontMetrics fm(opt.font);
+    QFontMetrics boldFm(boldFont);
+    int baseline = textRect.top() + (textRect.height() + fm.ascent() - fm.descent()) / 2;
+    int x = textRect.left();
+
+    painter->save();
+    painter->setClipRect(textRect);
+
+    QString prefix = text.left(start);
+    painter->setFont(opt.font);
+    painter->setPen(textColor);
+    painter->drawText(x, baseline, prefix);
+    x += fm.horizontalAdvance(prefix);
+
+    QString matched = text.mid(start, length);
+    int matchWidth = boldFm.horizontalAdvance(matched);
+    if (!selected) {
+        painter->fillRect(QRect(x, textRect.top() + 2, matchWidth, textRect.height() - 4), QColor(255, 230, 120));
+    }
+    painter->setFont(boldFont);
+    painter->drawText(x, baseline, matched);
+    x += matchWidth;
+
+    painter->setFont(opt.font);
+    painter->drawText(x, baseline, text.mid(start + length));
+
+    painter->restore();
+}
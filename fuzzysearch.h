@@ -0,0 +1,66 @@
+#ifndef FUZZYSEARCH_H
+#define FUZZYSEARCH_H
+
+#include <QHash>
+#include <QString>
+#include <QStyledItemDelegate>
+#include <QVector>
+
+// Recherche approximative sur l'ID, le nom et la personne assignée.
+// Un index de trigrammes réduit l'ensemble des candidats, puis une distance
+// d'édition bornée (algorithme bit-parallèle de Myers, 64 cellules par mot
+// machine) classe les correspondances.
+class FuzzyIndex
+{
+public:
+    enum Field { IdField, NameField, AssigneeField, FieldCount };
+
+    struct Match
+    {
+        QString taskId;
+        int score;
+        int distance;
+        Field field;
+        int start;
+        int length;
+    };
+
+    void clear();
+    void addTask(const QString &id, const QString &name, const QString &assignee);
+    int size() const { return entries.size(); }
+
+    QVector<Match> search(const QString &text, int limit = 50) const;
+
+    static int maxDistance(int patternLength);
+
+private:
+    struct Entry
+    {
+        QString id;
+        QString fields[FieldCount];
+    };
+
+    QVector<Entry> entries;
+    QHash<quint64, QVector<int>> postings;
+
+    static QVector<quint64> trigrams(const QString &lowerText);
+};
+
+// Surligne la portion correspondante dans les cellules issues d'une recherche
+class FuzzyHighlightDelegate : public QStyledItemDelegate
+{
+public:
+    static const int HighlightRole = Qt::UserRole + 1;
+
+    explicit FuzzyHighlightDelegate(QObject *parent = nullptr);
+
+    void setActiveQuery(const QString &query) { activeQuery = query; }
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option,
+               const QModelIndex &index) const override;
+
+private:
+    QString activeQuery;
+};
+
+#endif // FUZZYSEARCH_H
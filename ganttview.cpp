@@ -0,0 +1,341 @@
+#include "ganttview.h"
+#include <QDate>
+#include <QHelpEvent>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QToolTip>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+
+// En dessous de ce zoom, les barres individuelles laissent place aux bandes de densité
+static const qreal density_threshold = 1.5;    // pixels par jour
+
+GanttItem::GanttItem()
+    : origin(0),
+    span(1),
+    detailMode(true)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+void GanttItem::setTasks(const QVector<GanttTask> &newTasks, const QStringList &statuses,
+                         const QVector<QColor> &colors)
+{
+    prepareGeometryChange();
+
+    tasks = newTasks;
+    statusNames = statuses;
+    statusColors = colors;
+
+    qint64 first = QDate::currentDate().toJulianDay();
+    qint64 last = first;
+    for (const GanttTask &task : tasks) {
+        first = qMin(first, task.startDay);
+        last = qMax(last, task.endDay);
+    }
+    origin = first - 7;
+    span = last - origin + 14;
+
+    buildLanes();
+
+    // Index de comptage : débuts et fins triés, par statut
+    startsByStatus = QVector<QVector<qint64>>(statusNames.size());
+    endsByStatus = QVector<QVector<qint64>>(statusNames.size());
+    for (const GanttTask &task : tasks) {
+        if (task.statusIndex < 0 || task.statusIndex >= statusNames.size()) continue;
+        startsByStatus[task.statusIndex].append(task.startDay);
+        endsByStatus[task.statusIndex].append(task.endDay);
+    }
+    for (int s = 0; s < statusNames.size(); ++s) {
+        std::sort(startsByStatus[s].begin(), startsByStatus[s].end());
+        std::sort(endsByStatus[s].begin(), endsByStatus[s].end());
+    }
+
+    update();
+}
+
+void GanttItem::buildLanes()
+{
+    lanes.clear();
+
+    QVector<int> order(tasks.size());
+    for (int i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        if (tasks[a].startDay != tasks[b].startDay) return tasks[a].startDay < tasks[b].startDay;
+        return tasks[a].endDay < tasks[b].endDay;
+    });
+
+    // Affectation gloutonne au couloir qui se libère le plus tôt
+    typedef std::pair<qint64, int> LaneEnd;
+    std::priority_queue<LaneEnd, std::vector<LaneEnd>, std::greater<LaneEnd>> freeAt;
+
+    for (int index : order) {
+        const GanttTask &task = tasks[index];
+        int lane;
+        if (!freeAt.empty() && freeAt.top().first < task.startDay) {
+            lane = freeAt.top().second;
+            freeAt.pop();
+        } else {
+            lane = lanes.size();
+            lanes.append(QVector<int>());
+        }
+        lanes[lane].append(index);
+        freeAt.push(LaneEnd(task.endDay, lane));
+    }
+}
+
+int GanttItem::activeCount(int status, qint64 fromDay, qint64 toDay) const
+{
+    const QVector<qint64> &starts = startsByStatus[status];
+    const QVector<qint64> &ends = endsByStatus[status];
+
+    // Intervalles avec début <= toDay, moins ceux déjà terminés avant fromDay
+    auto startedBefore = std::upper_bound(starts.begin(), starts.end(), toDay) - starts.begin();
+    auto endedBefore = std::lower_bound(ends.begin(), ends.end(), fromDay) - ends.begin();
+    return int(startedBefore - endedBefore);
+}
+
+QRectF GanttItem::boundingRect() const
+{
+    int height = qMax(int(lanes.size()) * LaneHeight, int(statusNames.size()) * BandHeight);
+    return QRectF(0, 0, span, qMax(height, LaneHeight));
+}
+
+const GanttTask *GanttItem::taskAt(const QPointF &pos) const
+{
+    if (!detailMode || pos.y() < 0) return nullptr;
+
+    int lane = int(pos.y() / LaneHeight);
+    if (lane >= lanes.size()) return nullptr;
+
+    qint64 day = origin + qint64(std::floor(pos.x()));
+    const QVector<int> &indices = lanes[lane];
+    auto it = std::lower_bound(indices.begin(), indices.end(), day,
+                               [this](int index, qint64 d) { return tasks[index].endDay < d; });
+
+    if (it != indices.end() && tasks[*it].startDay <= day) {
+        return &tasks[*it];
+    }
+    return nullptr;
+}
+
+void GanttItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+
+    QRectF exposed = option->exposedRect;
+    qreal pixelsPerDay = painter->worldTransform().m11();
+    detailMode = pixelsPerDay >= density_threshold;
+
+    painter->fillRect(exposed, Qt::white);
+    paintMonthGrid(painter, exposed, pixelsPerDay);
+
+    if (detailMode) {
+        paintBars(painter, exposed, pixelsPerDay);
+    } else {
+        paintDensity(painter, exposed, pixelsPerDay);
+    }
+
+    // Repère du jour courant
+    qreal today = QDate::currentDate().toJulianDay() - origin;
+    if (today >= exposed.left() && today <= exposed.right()) {
+        QPen pen(QColor(220, 53, 69));
+        pen.setCosmetic(true);
+        pen.setWidth(2);
+        painter->setPen(pen);
+        painter->drawLine(QLineF(today, exposed.top(), today, exposed.bottom()));
+    }
+}
+
+void GanttItem::paintMonthGrid(QPainter *painter, const QRectF &exposed, qreal pixelsPerDay)
+{
+    bool yearsOnly = pixelsPerDay * 30 < 8;
+
+    QPen pen(QColor(222, 226, 230));
+    pen.setCosmetic(true);
+    painter->setPen(pen);
+
+    QDate date = QDate::fromJulianDay(origin + qint64(std::floor(exposed.left())));
+    date = QDate(date.year(), yearsOnly ? 1 : date.month(), 1);
+    qint64 lastDay = origin + qint64(std::ceil(exposed.right()));
+
+    while (date.isValid() && date.toJulianDay() <= lastDay) {
+        qreal x = date.toJulianDay() - origin;
+        painter->drawLine(QLineF(x, exposed.top(), x, exposed.bottom()));
+        date = yearsOnly ? date.addYears(1) : date.addMonths(1);
+    }
+}
+
+void GanttItem::paintBars(QPainter *painter, const QRectF &exposed, qreal pixelsPerDay)
+{
+    Q_UNUSED(pixelsPerDay);
+
+    int firstLane = qMax(0, int(exposed.top() / LaneHeight));
+    int lastLane = qMin(int(lanes.size()) - 1, int(exposed.bottom() / LaneHeight));
+    qint64 fromDay = origin + qint64(std::floor(exposed.left()));
+    qint64 toDay = origin + qint64(std::ceil(exposed.right()));
+
+    QPen outline(QColor(0, 0, 0, 60));
+    outline.setCosmetic(true);
+    QFontMetrics metrics(painter->font());
+
+    for (int l = firstLane; l <= lastLane; ++l) {
+        const QVector<int> &indices = lanes[l];
+
+        // Dans un couloir les intervalles sont disjoints : débuts et fins sont triés
+        auto it = std::lower_bound(indices.begin(), indices.end(), fromDay,
+                                   [this](int index, qint64 day) { return tasks[index].endDay < day; });
+
+        for (; it != indices.end() && tasks[*it].startDay <= toDay; ++it) {
+            const GanttTask &task = tasks[*it];
+            QRectF bar(task.startDay - origin, l * LaneHeight + 3,
+                       task.endDay - task.startDay + 1, LaneHeight - 6);
+
+            painter->setPen(outline);
+            painter->setBrush(statusColors.value(task.statusIndex, QColor(Qt::gray)));
+            painter->drawRect(bar);
+
+            QRectF deviceRect = painter->worldTransform().mapRect(bar);
+            if (deviceRect.width() > 40) {
+                painter->save();
+                painter->resetTransform();
+                painter->setPen(Qt::white);
+                QRectF textRect = deviceRect.adjusted(4, 0, -2, 0);
+                painter->drawText(textRect, Qt::AlignVCenter | Qt::AlignLeft,
+                                  metrics.elidedText(task.name, Qt::ElideRight, int(textRect.width())));
+                painter->restore();
+            }
+        }
+    }
+}
+
+void GanttItem::paintDensity(QPainter *painter, const QRectF &exposed, qreal pixelsPerDay)
+{
+    // Une case d'environ 4 pixels, comptée en O(log n) dans l'index par statut
+    qint64 step = qMax<qint64>(1, qint64(std::ceil(4.0 / pixelsPerDay)));
+    qint64 fromDay = origin + qint64(std::floor(exposed.left()));
+    fromDay -= (fromDay - origin) % step;
+    qint64 toDay = origin + qint64(std::ceil(exposed.right()));
+
+    for (int s = 0; s < statusNames.size(); ++s) {
+        qreal top = s * BandHeight;
+        if (top > exposed.bottom() || top + BandHeight < exposed.top()) continue;
+
+        QVector<int> counts;
+        int peak = 0;
+        for (qint64 day = fromDay; day <= toDay; day += step) {
+            counts.append(activeCount(s, day, day + step - 1));
+            peak = qMax(peak, counts.last());
+        }
+
+        for (int i = 0; i < counts.size() && peak > 0; ++i) {
+            if (counts[i] == 0) continue;
+            QColor color = statusColors.value(s, QColor(Qt::gray));
+            color.setAlpha(40 + 215 * counts[i] / peak);
+            painter->fillRect(QRectF(fromDay + i * step - origin, top + 2, step, BandHeight - 4), color);
+        }
+
+        QPointF labelPos = painter->worldTransform().map(QPointF(exposed.left(), top));
+        painter->save();
+        painter->resetTransform();
+        painter->setPen(QColor(52, 58, 64));
+        painter->drawText(QPointF(labelPos.x() + 6, labelPos.y() + 14),
+                          QString("%1 (peak %2)").arg(statusNames[s]).arg(peak));
+        painter->restore();
+    }
+}
+
+GanttView::GanttView(QWidget *parent)
+    : QGraphicsView(parent),
+    scene(new QGraphicsScene(this)),
+    item(new GanttItem())
+{
+    scene->setItemIndexMethod(QGraphicsScene::NoIndex);
+    scene->addItem(item);
+    setScene(scene);
+
+    setDragMode(QGraphicsView::ScrollHandDrag);
+    setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
+    setViewportUpdateMode(QGraphicsView::FullViewportUpdate);
+    setOptimizationFlags(QGraphicsView::DontAdjustForAntialiasing | QGraphicsView::DontSavePainterState);
+    setAlignment(Qt::AlignLeft | Qt::AlignTop);
+    setBackgroundBrush(QColor(248, 249, 250));
+}
+
+void GanttView::setTasks(const QVector<GanttTask> &tasks, const QStringList &statuses,
+                         const QVector<QColor> &colors)
+{
+    item->setTasks(tasks, statuses, colors);
+    scene->setSceneRect(item->boundingRect().adjusted(0, -HeaderHeight, 0, 0));
+
+    resetTransform();
+    scale(6.0, 1.0);
+    centerOn(QDate::currentDate().toJulianDay() - item->originDay(), 0);
+}
+
+void GanttView::wheelEvent(QWheelEvent *event)
+{
+    if (!(event->modifiers() & Qt::ControlModifier)) {
+        QGraphicsView::wheelEvent(event);
+        return;
+    }
+
+    // Ctrl + molette : zoom horizontal uniquement
+    qreal current = transform().m11();
+    qreal target = qBound(0.02, current * (event->angleDelta().y() > 0 ? 1.25 : 0.8), 60.0);
+    scale(target / current, 1.0);
+    event->accept();
+}
+
+bool GanttView::viewportEvent(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent *helpEvent = static_cast<QHelpEvent*>(event);
+        const GanttTask *task = item->taskAt(mapToScene(helpEvent->pos()));
+
+        if (task) {
+            QToolTip::showText(helpEvent->globalPos(),
+                               QString("%1 - %2\n%3 to %4")
+                                   .arg(task->id, task->name,
+                                        QDate::fromJulianDay(task->startDay).toString("yyyy-MM-dd"),
+                                        QDate::fromJulianDay(task->endDay).toString("yyyy-MM-dd")),
+                               viewport());
+        } else {
+            QToolTip::hideText();
+        }
+        return true;
+    }
+    return QGraphicsView::viewportEvent(event);
+}
+
+void GanttView::drawForeground(QPainter *painter, const QRectF &rect)
+{
+    Q_UNUSED(rect);
+
+    painter->save();
+    painter->resetTransform();
+    painter->fillRect(QRect(0, 0, viewport()->width(), HeaderHeight), QColor(52, 58, 64, 230));
+    painter->setPen(Qt::white);
+
+    qreal pixelsPerDay = transform().m11();
+    int yearStep = pixelsPerDay * 365 < 60 ? 5 : 1;
+    bool yearsOnly = pixelsPerDay * 30 < 60;
+
+    qint64 fromDay = item->originDay() + qint64(std::floor(mapToScene(0, 0).x()));
+    qint64 toDay = item->originDay() + qint64(std::ceil(mapToScene(viewport()->width(), 0).x()));
+
+    QDate date = QDate::fromJulianDay(fromDay);
+    date = yearsOnly ? QDate(date.year() - date.year() % yearStep, 1, 1) : QDate(date.year(), date.month(), 1);
+
+    while (date.isValid() && date.toJulianDay() <= toDay) {
+        int x = mapFromScene(QPointF(date.toJulianDay() - item->originDay(), 0)).x();
+        painter->drawText(QRect(x + 4, 0, 200, HeaderHeight), Qt::AlignVCenter | Qt::AlignLeft,
+                          date.toString(yearsOnly ? "yyyy" : "MMM yyyy"));
+        date = yearsOnly ? date.addYears(yearStep) : date.addMonths(1);
+    }
+
+    painter->restore();
+}
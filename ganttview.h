@@ -0,0 +1,76 @@
+#ifndef GANTTVIEW_H
+#define GANTTVIEW_H
+
+#include <QColor>
+#include <QGraphicsItem>
+#include <QGraphicsView>
+#include <QStringList>
+#include <QVector>
+
+struct GanttTask
+{
+    QString id;
+    QString name;
+    int statusIndex;
+    qint64 startDay;    // jour julien
+    qint64 endDay;
+};
+
+// Élément unique couvrant toute la chronologie. Les tâches sont rangées en
+// couloirs sans chevauchement; paint() n'interroge que les couloirs et
+// l'intervalle de dates visibles. Vue d'ensemble : bandes de densité par statut.
+class GanttItem : public QGraphicsItem
+{
+public:
+    static const int LaneHeight = 22;
+    static const int BandHeight = 36;
+
+    GanttItem();
+
+    void setTasks(const QVector<GanttTask> &tasks, const QStringList &statuses, const QVector<QColor> &colors);
+    const GanttTask *taskAt(const QPointF &pos) const;
+    qint64 originDay() const { return origin; }
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+private:
+    QVector<GanttTask> tasks;
+    QVector<QVector<int>> lanes;            // indices triés par début (et donc par fin)
+    QVector<QVector<qint64>> startsByStatus;  // index de comptage des intervalles
+    QVector<QVector<qint64>> endsByStatus;
+    QStringList statusNames;
+    QVector<QColor> statusColors;
+    qint64 origin;
+    qint64 span;
+    bool detailMode;
+
+    void buildLanes();
+    int activeCount(int status, qint64 fromDay, qint64 toDay) const;
+    void paintBars(QPainter *painter, const QRectF &exposed, qreal pixelsPerDay);
+    void paintDensity(QPainter *painter, const QRectF &exposed, qreal pixelsPerDay);
+    void paintMonthGrid(QPainter *painter, const QRectF &exposed, qreal pixelsPerDay);
+};
+
+class GanttView : public QGraphicsView
+{
+    Q_OBJECT
+
+public:
+    static const int HeaderHeight = 24;
+
+    explicit GanttView(QWidget *parent = nullptr);
+
+    void setTasks(const QVector<GanttTask> &tasks, const QStringList &statuses, const QVector<QColor> &colors);
+
+protected:
+    void wheelEvent(QWheelEvent *event) override;
+    bool viewportEvent(QEvent *event) override;
+    void drawForeground(QPainter *painter, const QRectF &rect) override;
+
+private:
+    QGraphicsScene *scene;
+    GanttItem *item;
+};
+
+#endif // GANTTVIEW_H
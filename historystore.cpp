@@ -0,0 +1,367 @@
+#include "historystore.h"
+#include "diagnostics.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+
+QStringList HistoryStore::trackedColumns()
+{
+    // Champs du planning; les descriptions compressées restent hors de l'historique
+    return {"name", "status", "priority", "start_date", "end_date", "assigned_to",
+            "project_id", "planned_cost", "actual_cost", "latitude", "longitude"};
+}
+
+void HistoryStore::setDatabase(const QSqlDatabase &database)
+{
+    db = database;
+    lastSnapshotSeq = -1;
+}
+
+QString HistoryStore::fieldsJson(const QString &prefix)
+{
+    QStringList pairs;
+    for (const QString &column : trackedColumns()) {
+        pairs << QString("'%1', %2%1").arg(column, prefix);
+    }
+    return QString("json_object(%1)").arg(pairs.join(", "));
+}
+
+QString HistoryStore::utcText(const QDateTime &when)
+{
+    // Même format que CURRENT_TIMESTAMP, donc comparable comme texte
+    return when.toUTC().toString("yyyy-MM-dd HH:mm:ss");
+}
+
+bool HistoryStore::initialize(QString *error)
+{
+    // Une modification qui ne touche aucun champ suivi (updated_at, description...) n'écrit rien
+    QStringList changed = {"OLD.id IS NOT NEW.id"};
+    for (const QString &column : trackedColumns()) {
+        changed << QString("OLD.%1 IS NOT NEW.%1").arg(column);
+    }
+
+    QStringList schemaSQL = {
+        "CREATE TABLE IF NOT EXISTS task_history ("
+        "   seq INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "   task_id TEXT NOT NULL,"
+        "   previous_id TEXT,"
+        "   op TEXT NOT NULL,"
+        "   data TEXT,"
+        "   changed_at DATETIME DEFAULT CURRENT_TIMESTAMP,"
+        "   origin_at DATETIME"
+        ")",
+        "CREATE INDEX IF NOT EXISTS idx_task_history_task ON task_history(task_id)",
+        "CREATE INDEX IF NOT EXISTS idx_task_history_previous ON task_history(previous_id)",
+        "CREATE INDEX IF NOT EXISTS idx_task_history_changed ON task_history(changed_at)",
+        "CREATE TABLE IF NOT EXISTS task_snapshots ("
+        "   id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "   last_seq INTEGER NOT NULL,"
+        "   taken_at DATETIME NOT NULL,"
+        "   task_count INTEGER NOT NULL,"
+        "   data BLOB NOT NULL"
+        ")",
+        "CREATE INDEX IF NOT EXISTS idx_task_snapshots_taken ON task_snapshots(taken_at)",
+        "CREATE TRIGGER IF NOT EXISTS trg_task_history_no_update BEFORE UPDATE ON task_history "
+        "BEGIN SELECT RAISE(ABORT, 'task_history is append-only'); END",
+        // Recréés à chaque démarrage : la liste des champs suit les migrations de tasks
+        "DROP TRIGGER IF EXISTS trg_tasks_history_insert",
+        "DROP TRIGGER IF EXISTS trg_tasks_history_update",
+        "DROP TRIGGER IF EXISTS trg_tasks_history_delete",
+        QString("CREATE TRIGGER trg_tasks_history_insert AFTER INSERT ON tasks "
+                "BEGIN "
+                "   INSERT INTO task_history (task_id, op, data) VALUES (NEW.id, 'I', %1);"
+                "END").arg(fieldsJson("NEW.")),
+        QString("CREATE TRIGGER trg_tasks_history_update AFTER UPDATE ON tasks WHEN %1 "
+                "BEGIN "
+                "   INSERT INTO task_history (task_id, previous_id, op, data) "
+                "   VALUES (NEW.id, CASE WHEN OLD.id IS NOT NEW.id THEN OLD.id END, 'U', %2);"
+                "END").arg(changed.join(" OR "), fieldsJson("NEW.")),
+        "CREATE TRIGGER trg_tasks_history_delete AFTER DELETE ON tasks "
+        "BEGIN "
+        "   INSERT INTO task_history (task_id, op) VALUES (OLD.id, 'D');"
+        "END"
+    };
+
+    QSqlQuery query(db);
+    for (const QString &sql : schemaSQL) {
+        if (!query.exec(sql)) {
+            if (error) *error = query.lastError().text();
+            return false;
+        }
+    }
+
+    // Date d'origine des versions reprises d'une autre base (voir TaskPack)
+    bool hasOrigin = false;
+    if (!query.exec("PRAGMA table_info(task_history)")) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        if (query.value(1).toString() == "origin_at") hasOrigin = true;
+    }
+    if (!hasOrigin && !query.exec("ALTER TABLE task_history ADD COLUMN origin_at DATETIME")) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+
+    // Instantané de référence : les tâches existant avant l'historique restent visibles
+    if (!query.exec("SELECT COALESCE(MAX(last_seq), -1) FROM task_snapshots") || !query.next()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    lastSnapshotSeq = query.value(0).toLongLong();
+    return lastSnapshotSeq >= 0 || takeSnapshot(error);
+}
+
+qint64 HistoryStore::maxSeq() const
+{
+    QSqlQuery query("SELECT COALESCE(MAX(seq), 0) FROM task_history", db);
+    return query.next() ? query.value(0).toLongLong() : 0;
+}
+
+bool HistoryStore::maybeSnapshot(QString *error)
+{
+    // MAX sur la clé primaire : une seule lecture d'index
+    if (maxSeq() - lastSnapshotSeq < snapshotInterval) return true;
+    return takeSnapshot(error);
+}
+
+bool HistoryStore::takeSnapshot(QString *error)
+{
+    if (!db.transaction()) {
+        if (error) *error = db.lastError().text();
+        return false;
+    }
+
+    qint64 last = maxSeq();
+    if (last == lastSnapshotSeq) {
+        db.commit();
+        return true;
+    }
+
+    State state;
+    QSqlQuery query(db);
+    if (!query.exec(QString("SELECT id, %1 FROM tasks").arg(fieldsJson(QString())))) {
+        if (error) *error = query.lastError().text();
+        db.rollback();
+        return false;
+    }
+    while (query.next()) {
+        apply(state, "I", query.value(0).toString(), QString(), query.value(1).toByteArray());
+    }
+
+    if (!insertSnapshot(state, last, utcText(QDateTime::currentDateTimeUtc()), error)) {
+        db.rollback();
+        return false;
+    }
+    if (!db.commit()) {
+        if (error) *error = db.lastError().text();
+        return false;
+    }
+    lastSnapshotSeq = last;
+    return true;
+}
+
+bool HistoryStore::insertSnapshot(const State &state, qint64 lastSeq, const QString &takenAt, QString *error)
+{
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO task_snapshots (last_seq, taken_at, task_count, data) "
+                  "VALUES (:last_seq, :taken_at, :task_count, :data)");
+    query.bindValue(":last_seq", lastSeq);
+    query.bindValue(":taken_at", takenAt);
+    query.bindValue(":task_count", state.size());
+    query.bindValue(":data", encode(state));
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QByteArray HistoryStore::encode(const State &state)
+{
+    QJsonObject root;
+    for (auto it = state.constBegin(); it != state.constEnd(); ++it) {
+        root.insert(it.key(), QJsonObject::fromVariantMap(it.value()));
+    }
+    return qCompress(QJsonDocument(root).toJson(QJsonDocument::Compact));
+}
+
+HistoryStore::State HistoryStore::decode(const QByteArray &data)
+{
+    State state;
+    QJsonObject root = QJsonDocument::fromJson(qUncompress(data)).object();
+    for (auto it = root.constBegin(); it != root.constEnd(); ++it) {
+        state.insert(it.key(), it.value().toObject().toVariantMap());
+    }
+    return state;
+}
+
+void HistoryStore::apply(State &state, const QString &op, const QString &taskId,
+                         const QString &previousId, const QByteArray &json)
+{
+    if (op == "D") {
+        state.remove(taskId);
+        return;
+    }
+    if (!previousId.isEmpty()) {
+        state.remove(previousId);
+    }
+    state.insert(taskId, QJsonDocument::fromJson(json).object().toVariantMap());
+}
+
+HistoryStore::State HistoryStore::stateAt(const QDateTime &when, int *replayed, QString *error) const
+{
+    return stateAtUtc(utcText(when), replayed, error);
+}
+
+HistoryStore::State HistoryStore::stateAtUtc(const QString &utc, int *replayed, QString *error) const
+{
+    static Diagnostics::Latency &latency = Diagnostics::latency("history state at (snapshot + replay)");
+    Diagnostics::Timer timer(latency);
+    State state;
+    if (replayed) *replayed = 0;
+
+    // Dernier instantané antérieur, puis les versions écrites entre lui et l'instant demandé
+    QSqlQuery query(db);
+    query.prepare("SELECT last_seq, data FROM task_snapshots WHERE taken_at <= :at "
+                  "ORDER BY last_seq DESC LIMIT 1");
+    query.bindValue(":at", utc);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return state;
+    }
+    qint64 fromSeq = 0;
+    if (query.next()) {
+        fromSeq = query.value(0).toLongLong();
+        state = decode(query.value(1).toByteArray());
+    }
+
+    // Borne haute par l'index sur changed_at : le rejeu ne parcourt que l'intervalle utile
+    query.prepare("SELECT COALESCE(MAX(seq), 0) FROM task_history WHERE changed_at <= :at");
+    query.bindValue(":at", utc);
+    if (!query.exec() || !query.next()) {
+        if (error) *error = query.lastError().text();
+        return state;
+    }
+    qint64 toSeq = query.value(0).toLongLong();
+    if (toSeq <= fromSeq) return state;
+
+    query.prepare("SELECT op, task_id, previous_id, data FROM task_history "
+                  "WHERE seq > :from AND seq <= :to ORDER BY seq");
+    query.bindValue(":from", fromSeq);
+    query.bindValue(":to", toSeq);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return state;
+    }
+    while (query.next()) {
+        apply(state, query.value(0).toString(), query.value(1).toString(),
+              query.value(2).toString(), query.value(3).toByteArray());
+        if (replayed) ++*replayed;
+    }
+    return state;
+}
+
+QVector<HistoryStore::Version> HistoryStore::taskHistory(const QString &taskId, int limit) const
+{
+    QVector<Version> result;
+    QSqlQuery query(db);
+    query.prepare("SELECT seq, task_id, previous_id, op, datetime(COALESCE(origin_at, changed_at), 'localtime'), data "
+                  "FROM task_history WHERE task_id = :id OR previous_id = :previous "
+                  "ORDER BY seq DESC LIMIT :limit");
+    query.bindValue(":id", taskId);
+    query.bindValue(":previous", taskId);
+    query.bindValue(":limit", limit);
+    if (!query.exec()) return result;
+
+    while (query.next()) {
+        Version version;
+        version.seq = query.value(0).toLongLong();
+        version.taskId = query.value(1).toString();
+        version.previousId = query.value(2).toString();
+        QString op = query.value(3).toString();
+        version.op = op == "I" ? "insert" : op == "D" ? "delete" : "update";
+        version.changedAt = query.value(4).toString();
+        version.fields = QJsonDocument::fromJson(query.value(5).toByteArray()).object().toVariantMap();
+        result << version;
+    }
+    return result;
+}
+
+QDateTime HistoryStore::firstRecorded() const
+{
+    QSqlQuery query("SELECT datetime(MIN(taken_at), 'localtime') FROM task_snapshots", db);
+    if (!query.next() || query.value(0).isNull()) return QDateTime();
+    return QDateTime::fromString(query.value(0).toString(), "yyyy-MM-dd HH:mm:ss");
+}
+
+bool HistoryStore::compact(int retentionDays, QString *error)
+{
+    QString cutoff = utcText(QDateTime::currentDateTimeUtc().addDays(-retentionDays));
+
+    if (!db.transaction()) {
+        if (error) *error = db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(db);
+    auto fail = [this, &query, error]() {
+        if (error) *error = query.lastError().text();
+        db.rollback();
+        return false;
+    };
+
+    query.prepare("SELECT MAX(seq) FROM task_history WHERE changed_at <= :cutoff");
+    query.bindValue(":cutoff", cutoff);
+    if (!query.exec() || !query.next()) return fail();
+
+    if (!query.value(0).isNull()) {
+        qint64 lastSeq = query.value(0).toLongLong();
+
+        // Les versions supprimées sont résumées par un instantané daté de la limite
+        QString stateError;
+        State state = stateAtUtc(cutoff, nullptr, &stateError);
+        if (!stateError.isEmpty()) {
+            if (error) *error = stateError;
+            db.rollback();
+            return false;
+        }
+        if (!insertSnapshot(state, lastSeq, cutoff, error)) {
+            db.rollback();
+            return false;
+        }
+
+        query.prepare("DELETE FROM task_history WHERE seq <= :seq");
+        query.bindValue(":seq", lastSeq);
+        if (!query.exec()) return fail();
+        lastSnapshotSeq = qMax(lastSnapshotSeq, lastSeq);
+    }
+
+    // Avant la limite, une résolution mensuelle suffit : dernier instantané de chaque mois
+    query.prepare("DELETE FROM task_snapshots WHERE taken_at < :cutoff AND last_seq < ("
+                  "   SELECT MAX(s.last_seq) FROM task_snapshots s "
+                  "   WHERE strftime('%Y-%m', s.taken_at) = strftime('%Y-%m', task_snapshots.taken_at))");
+    query.bindValue(":cutoff", cutoff);
+    if (!query.exec()) return fail();
+
+    if (!db.commit()) {
+        if (error) *error = db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+qint64 HistoryStore::versionCount() const
+{
+    QSqlQuery query("SELECT COUNT(*) FROM task_history", db);
+    return query.next() ? query.value(0).toLongLong() : 0;
+}
+
+int HistoryStore::snapshotCount() const
+{
+    QSqlQuery query("SELECT COUNT(*) FROM task_snapshots", db);
+    return query.next() ? query.value(0).toInt() : 0;
+}
@@ -0,0 +1,73 @@
+#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+#include <QDateTime>
+#include <QMap>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+
+// Historique des tâches en ajout seul : des triggers sur tasks écrivent une
+// version (champs du planning en JSON) à chaque insertion, modification ou
+// suppression. Des instantanés compressés de toute la table sont pris toutes
+// les snapshotInterval versions; l'état à une date est rebâti à partir du
+// dernier instantané antérieur et des seules versions qui le suivent.
+class HistoryStore
+{
+public:
+    // Au-delà de la rétention, seul le dernier instantané de chaque mois est gardé
+    static const int snapshotInterval = 500;
+    static const int defaultRetentionDays = 365;
+
+    struct Version
+    {
+        qint64 seq = 0;
+        QString taskId;
+        QString previousId;     // renseigné quand l'identifiant a changé
+        QString op;             // "insert", "update" ou "delete"
+        QString changedAt;      // heure locale
+        QVariantMap fields;
+    };
+
+    // Identifiant de tâche -> champs suivis
+    typedef QMap<QString, QVariantMap> State;
+
+    static QStringList trackedColumns();
+
+    void setDatabase(const QSqlDatabase &database);
+    bool initialize(QString *error);
+
+    // Instantané si snapshotInterval versions ont été écrites depuis le dernier
+    bool maybeSnapshot(QString *error = nullptr);
+    bool takeSnapshot(QString *error);
+
+    // État de la table tasks à l'instant donné; replayed reçoit le nombre de versions rejouées
+    State stateAt(const QDateTime &when, int *replayed = nullptr, QString *error = nullptr) const;
+    QVector<Version> taskHistory(const QString &taskId, int limit = 200) const;
+    QDateTime firstRecorded() const;
+
+    // Supprime les versions plus anciennes que la rétention après les avoir
+    // résumées dans un instantané, puis éclaircit les anciens instantanés
+    bool compact(int retentionDays, QString *error);
+
+    qint64 versionCount() const;
+    int snapshotCount() const;
+
+private:
+    QSqlDatabase db;
+    qint64 lastSnapshotSeq = -1;
+
+    static QString fieldsJson(const QString &prefix);
+    static QString utcText(const QDateTime &when);
+    static QByteArray encode(const State &state);
+    static State decode(const QByteArray &data);
+    static void apply(State &state, const QString &op, const QString &taskId,
+                      const QString &previousId, const QByteArray &json);
+    qint64 maxSeq() const;
+    State stateAtUtc(const QString &utc, int *replayed, QString *error) const;
+    bool insertSnapshot(const State &state, qint64 lastSeq, const QString &takenAt, QString *error);
+};
+
+#endif // HISTORYSTORE_H
@@ -0,0 +1,303 @@
+#include "invoiceengine.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QPageSize>
+#include <QPrinter>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QTextDocument>
+#include <QVariant>
+
+// Conversion du temps pointé en jours facturables
+static const double tracked_hours_per_day = 8.0;
+
+void InvoiceEngine::setDatabase(const QSqlDatabase &database)
+{
+    db = database;
+}
+
+bool InvoiceEngine::initialize(QString *error)
+{
+    QStringList schemaSQL = {
+        "CREATE TABLE IF NOT EXISTS billing_rates ("
+        "   assignee TEXT PRIMARY KEY COLLATE NOCASE,"
+        "   daily_rate REAL NOT NULL"
+        ")",
+        "CREATE TABLE IF NOT EXISTS invoices ("
+        "   number TEXT PRIMARY KEY,"
+        "   period TEXT NOT NULL,"
+        "   sequence INTEGER NOT NULL,"
+        "   task_id TEXT NOT NULL,"
+        "   task_name TEXT,"
+        "   assignee TEXT,"
+        "   labor_days REAL NOT NULL DEFAULT 0,"
+        "   daily_rate REAL NOT NULL DEFAULT 0,"
+        "   materials_amount REAL NOT NULL DEFAULT 0,"
+        "   status TEXT NOT NULL DEFAULT 'pending',"
+        "   file_path TEXT,"
+        "   created_at DATETIME DEFAULT CURRENT_TIMESTAMP,"
+        "   UNIQUE (period, sequence)"
+        ")",
+        "CREATE INDEX IF NOT EXISTS idx_invoices_task ON invoices(task_id)",
+        "CREATE INDEX IF NOT EXISTS idx_invoices_period_status ON invoices(period, status)"
+    };
+
+    QSqlQuery query(db);
+    for (const QString &sql : schemaSQL) {
+        if (!query.exec(sql)) {
+            if (error) *error = query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+QMap<QString, double> InvoiceEngine::rates() const
+{
+    QMap<QString, double> result;
+    QSqlQuery query("SELECT assignee, daily_rate FROM billing_rates", db);
+    while (query.next()) {
+        result.insert(query.value(0).toString(), query.value(1).toDouble());
+    }
+    return result;
+}
+
+bool InvoiceEngine::setRates(const QMap<QString, double> &rates, QString *error)
+{
+    QSqlQuery query(db);
+    if (!db.transaction() || !query.exec("DELETE FROM billing_rates")) {
+        if (error) *error = db.lastError().text();
+        return false;
+    }
+
+    query.prepare("INSERT INTO billing_rates (assignee, daily_rate) VALUES (:assignee, :daily_rate)");
+    for (auto it = rates.constBegin(); it != rates.constEnd(); ++it) {
+        query.bindValue(":assignee", it.key());
+        query.bindValue(":daily_rate", it.value());
+        if (!query.exec()) {
+            if (error) *error = query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    return db.commit();
+}
+
+int InvoiceEngine::planRun(const QString &period, QString *error)
+{
+    QHash<QString, double> rateByAssignee;
+    QMap<QString, double> rateTable = rates();
+    for (auto it = rateTable.constBegin(); it != rateTable.constEnd(); ++it) {
+        rateByAssignee.insert(it.key().trimmed().toLower(), it.value());
+    }
+    double defaultRate = rateByAssignee.value(DefaultRateKey);
+
+    // Coût des matériaux sortis, toutes tâches confondues, en une requête groupée
+    QHash<QString, double> materialCosts;
+    QSqlQuery query(db);
+    if (query.exec("SELECT t.task_id, SUM(-m.quantity * m.unit_cost) "
+                   "FROM movement_tasks t JOIN stock_movements m ON m.id = t.movement_id "
+                   "WHERE m.quantity < 0 GROUP BY t.task_id")) {
+        while (query.next()) {
+            materialCosts.insert(query.value(0).toString(), query.value(1).toDouble());
+        }
+    }
+
+    // Temps pointé, lu dans les totaux hebdomadaires : remplace la durée planifiée
+    QHash<QString, double> trackedDays;
+    if (query.exec("SELECT task_id, SUM(seconds) FROM time_rollups GROUP BY task_id")) {
+        while (query.next()) {
+            trackedDays.insert(query.value(0).toString(), query.value(1).toDouble() / (tracked_hours_per_day * 3600));
+        }
+    }
+
+    query.prepare("SELECT COALESCE(MAX(sequence), 0) FROM invoices WHERE period = :period");
+    query.bindValue(":period", period);
+    if (!query.exec() || !query.next()) {
+        if (error) *error = query.lastError().text();
+        return -1;
+    }
+    int sequence = query.value(0).toInt();
+
+    // Tâches terminées dans le mois et jamais facturées, dans un ordre stable
+    query.prepare("SELECT t.id, t.name, t.assigned_to, t.start_date, t.end_date FROM tasks t "
+                  "WHERE t.status = 'Completed' AND strftime('%Y%m', t.completed_at) = :period "
+                  "AND NOT EXISTS (SELECT 1 FROM invoices i WHERE i.task_id = t.id) "
+                  "ORDER BY t.completed_at, t.id");
+    query.bindValue(":period", period);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return -1;
+    }
+
+    QVector<Invoice> planned;
+    while (query.next()) {
+        Invoice invoice;
+        invoice.taskId = query.value(0).toString();
+        invoice.taskName = query.value(1).toString();
+        invoice.assignee = query.value(2).toString();
+        QDate start = QDate::fromString(query.value(3).toString(), "yyyy-MM-dd");
+        QDate end = QDate::fromString(query.value(4).toString(), "yyyy-MM-dd");
+        invoice.laborDays = (start.isValid() && end.isValid()) ? qMax<qint64>(1, start.daysTo(end) + 1) : 0;
+        if (trackedDays.value(invoice.taskId) > 0) invoice.laborDays = trackedDays.value(invoice.taskId);
+        invoice.dailyRate = rateByAssignee.value(invoice.assignee.trimmed().toLower(), defaultRate);
+        invoice.materialsAmount = materialCosts.value(invoice.taskId);
+        invoice.sequence = ++sequence;
+        invoice.number = QString("INV-%1-%2").arg(period).arg(sequence, 4, 10, QChar('0'));
+        planned << invoice;
+    }
+    if (planned.isEmpty()) return 0;
+
+    if (!db.transaction()) {
+        if (error) *error = db.lastError().text();
+        return -1;
+    }
+
+    QSqlQuery insert(db);
+    insert.prepare("INSERT INTO invoices (number, period, sequence, task_id, task_name, assignee, "
+                   "labor_days, daily_rate, materials_amount) "
+                   "VALUES (:number, :period, :sequence, :task_id, :task_name, :assignee, "
+                   ":labor_days, :daily_rate, :materials_amount)");
+    for (const Invoice &invoice : planned) {
+        insert.bindValue(":number", invoice.number);
+        insert.bindValue(":period", period);
+        insert.bindValue(":sequence", invoice.sequence);
+        insert.bindValue(":task_id", invoice.taskId);
+        insert.bindValue(":task_name", invoice.taskName);
+        insert.bindValue(":assignee", invoice.assignee);
+        insert.bindValue(":labor_days", invoice.laborDays);
+        insert.bindValue(":daily_rate", invoice.dailyRate);
+        insert.bindValue(":materials_amount", invoice.materialsAmount);
+        if (!insert.exec()) {
+            if (error) *error = insert.lastError().text();
+            db.rollback();
+            return -1;
+        }
+    }
+
+    if (!db.commit()) {
+        if (error) *error = db.lastError().text();
+        return -1;
+    }
+    return planned.size();
+}
+
+QVector<InvoiceEngine::Invoice> InvoiceEngine::pendingInvoices(const QString &period, const QString &directory) const
+{
+    QVector<Invoice> result;
+    QDir dir(directory);
+
+    QSqlQuery query(db);
+    query.prepare("SELECT number, task_id, task_name, assignee, labor_days, daily_rate, materials_amount, created_at "
+                  "FROM invoices WHERE period = :period AND status = 'pending' ORDER BY sequence");
+    query.bindValue(":period", period);
+    if (!query.exec()) return result;
+
+    while (query.next()) {
+        Invoice invoice;
+        invoice.number = query.value(0).toString();
+        invoice.period = period;
+        invoice.taskId = query.value(1).toString();
+        invoice.taskName = query.value(2).toString();
+        invoice.assignee = query.value(3).toString();
+        invoice.laborDays = query.value(4).toDouble();
+        invoice.dailyRate = query.value(5).toDouble();
+        invoice.materialsAmount = query.value(6).toDouble();
+        invoice.issueDate = QDate::fromString(query.value(7).toString().left(10), "yyyy-MM-dd");
+        invoice.filePath = dir.filePath(invoice.number + ".pdf");
+        result << invoice;
+    }
+    return result;
+}
+
+int InvoiceEngine::invoiceCount(const QString &period, const QString &status) const
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT COUNT(*) FROM invoices WHERE period = :period AND status = :status");
+    query.bindValue(":period", period);
+    query.bindValue(":status", status);
+    if (query.exec() && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+
+bool InvoiceEngine::markRendered(const QVector<Invoice> &invoices, QString *error)
+{
+    if (invoices.isEmpty()) return true;
+
+    if (!db.transaction()) {
+        if (error) *error = db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("UPDATE invoices SET status = 'rendered', file_path = :file_path WHERE number = :number");
+    for (const Invoice &invoice : invoices) {
+        if (!invoice.rendered) continue;
+        query.bindValue(":file_path", invoice.filePath);
+        query.bindValue(":number", invoice.number);
+        if (!query.exec()) {
+            if (error) *error = query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    return db.commit();
+}
+
+QString InvoiceEngine::html(const Invoice &invoice)
+{
+    auto money = [](double amount) { return QString::number(amount, 'f', 2); };
+
+    QString html = QString("<h1>Invoice %1</h1>"
+                           "<p>Date: %2<br>Task: %3 - %4<br>Assigned to: %5</p>")
+                       .arg(invoice.number,
+                            invoice.issueDate.toString("yyyy-MM-dd"),
+                            invoice.taskId.toHtmlEscaped(),
+                            invoice.taskName.toHtmlEscaped(),
+                            invoice.assignee.toHtmlEscaped());
+
+    html += "<table border='1' cellpadding='4' width='100%'>"
+            "<tr><th>Description</th><th>Quantity</th><th>Unit Price</th><th>Amount</th></tr>";
+    html += QString("<tr><td>Labor</td><td>%1 day(s)</td><td>%2</td><td align='right'>%3</td></tr>")
+                .arg(invoice.laborDays)
+                .arg(money(invoice.dailyRate), money(invoice.laborAmount()));
+    if (invoice.materialsAmount > 0) {
+        html += QString("<tr><td>Materials</td><td>1</td><td>%1</td><td align='right'>%1</td></tr>")
+                    .arg(money(invoice.materialsAmount));
+    }
+    html += QString("<tr><td colspan='3'><b>Total</b></td><td align='right'><b>%1</b></td></tr></table>")
+                .arg(money(invoice.total()));
+    return html;
+}
+
+bool InvoiceEngine::render(const Invoice &invoice)
+{
+    // Une imprimante par thread du pool, réutilisée d'une facture à l'autre
+    thread_local QPrinter printer(QPrinter::HighResolution);
+    printer.setOutputFormat(QPrinter::PdfFormat);
+    printer.setPageSize(QPageSize(QPageSize::A4));
+    printer.setOutputFileName(invoice.filePath);
+
+    QTextDocument doc;
+    doc.setHtml(html(invoice));
+    doc.print(&printer);
+
+    return QFileInfo(invoice.filePath).size() > 0;
+}
+
+bool InvoiceEngine::renameTask(const QString &oldId, const QString &newId, QString *error)
+{
+    QSqlQuery query(db);
+    query.prepare("UPDATE invoices SET task_id = :new_id WHERE task_id = :old_id");
+    query.bindValue(":new_id", newId);
+    query.bindValue(":old_id", oldId);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef INVOICEENGINE_H
+#define INVOICEENGINE_H
+
+#include <QDate>
+#include <QMap>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+
+// Facturation mensuelle : une facture par tâche terminée dans le mois.
+// Une tournée se fait en deux temps :
+//  1. planRun() numérote les nouvelles factures (INV-AAAAMM-NNNN, dans l'ordre
+//     de fin des tâches) et fige les montants; les numéros déjà attribués ne
+//     changent jamais;
+//  2. les factures encore « pending » sont rendues en PDF en parallèle, puis
+//     marquées « rendered ». Une tournée interrompue reprend là où elle s'est arrêtée.
+class InvoiceEngine
+{
+public:
+    static constexpr const char *DefaultRateKey = "*";
+
+    struct Invoice
+    {
+        QString number;
+        QString period;           // AAAAMM
+        int sequence = 0;
+        QString taskId;
+        QString taskName;
+        QString assignee;
+        QDate issueDate;
+        double laborDays = 0.0;
+        double dailyRate = 0.0;
+        double materialsAmount = 0.0;
+        QString filePath;
+        bool rendered = false;
+
+        double laborAmount() const { return laborDays * dailyRate; }
+        double total() const { return laborAmount() + materialsAmount; }
+    };
+
+    void setDatabase(const QSqlDatabase &database);
+    bool initialize(QString *error);
+
+    QMap<QString, double> rates() const;
+    bool setRates(const QMap<QString, double> &rates, QString *error);
+
+    static QString periodFor(const QDate &month) { return month.toString("yyyyMM"); }
+
+    // Nombre de nouvelles factures, -1 en cas d'erreur
+    int planRun(const QString &period, QString *error);
+    QVector<Invoice> pendingInvoices(const QString &period, const QString &directory) const;
+    int invoiceCount(const QString &period, const QString &status) const;
+    bool markRendered(const QVector<Invoice> &invoices, QString *error);
+    // Appelé dans la transaction qui change l'ID de la tâche : une tâche facturée le reste
+    bool renameTask(const QString &oldId, const QString &newId, QString *error);
+
+    // Sans accès à la base : appelable depuis n'importe quel thread du pool
+    static bool render(const Invoice &invoice);
+    static QString html(const Invoice &invoice);
+
+private:
+    QSqlDatabase db;
+};
+
+#endif // INVOICEENGINE_H
@@ -1,9 +1,19 @@
 #include <QApplication>
+#include <QTextStream>
+#include "diagnostics.h"
 #include "mainwindow.h"
 
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
+
+    // --stats : rapport des compteurs de diagnostic sur la sortie standard à la fermeture
+    if (app.arguments().contains("--stats")) {
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, []() {
+            QTextStream(stdout) << Diagnostics::report();
+        });
+    }
+
     MainWindow mainWindow;
     mainWindow.show();
     return app.exec();
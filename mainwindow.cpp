@@ -28,26 +28,124 @@
 #include <QSystemTrayIcon>
 #include <QAction>
 #include <QMenu>
+#include <QToolTip>
+#include <QHelpEvent>
+#include <QSet>
+#include <QDateEdit>
+#include <QDateTimeEdit>
+#include <QSpinBox>
+#include <QDoubleSpinBox>
+#include <QScrollArea>
+#include <QSlider>
+#include <QFile>
+#include <QFileInfo>
+#include <QListWidget>
+#include <QSettings>
+#include <QApplication>
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QProgressDialog>
+#include <QHeaderView>
+#include <QtConcurrent>
+#include <QtCharts/QDateTimeAxis>
+#include <QShortcut>
+#include <QPlainTextEdit>
+#include <QScrollBar>
+#include <QFontDatabase>
+#include <QClipboard>
+#include <QCheckBox>
+#include <algorithm>
+#include "workloadheatmap.h"
+#include "materialsdialog.h"
+#include "projectsdialog.h"
+#include "attachmentsdialog.h"
+#include "mapview.h"
+#include "backupsdialog.h"
+#include "reportsdialog.h"
+#include "recurringdialog.h"
+#include "taskpack.h"
 
 // Identifiants USB pour Arduino
 const quint16 arduino_uno_vendor_id = 9025;
 const quint16 arduino_uno_product_id = 67;
 
+// Au-delà de ce nombre de lignes, un filtre indexable est délégué à SQLite
+const int sql_filter_row_threshold = 5000;
+
+// Occurrences récurrentes affichées sans être enregistrées : marqueur sur la cellule ID.
+// Qt::UserRole marque les descriptions tronquées, Qt::UserRole + 1 porte le surlignage
+// de la recherche (FuzzyHighlightDelegate::HighlightRole), y compris sur la cellule ID.
+const int occurrence_role = Qt::UserRole + 16;
+const int occurrence_days_before = 7;
+const int occurrence_days_after = 30;
+
+// Latence mesurée par texte de requête préparée
+static bool timedExec(QSqlQuery &query)
+{
+    Diagnostics::Timer timer(Diagnostics::statement(query.lastQuery()));
+    return query.exec();
+}
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
     ui(new Ui::MainWindow),
     networkManager(new QNetworkAccessManager(this)),
     trayIcon(nullptr),
     calendarWidget(nullptr),
+    ganttView(nullptr),
     arduino(nullptr),
-    arduinoIsAvailable(false)
+    arduinoIsAvailable(false),
+    fuzzyIndexDirty(true),
+    highlightDelegate(nullptr),
+    workloadLimit(3),
+    thumbnails(new ThumbnailCache(this)),
+    tiles(new TileCache(networkManager, this)),
+    backups(new BackupManager(this)),
+    reports(new ReportScheduler(&chartRenderer, this)),
+    timeTracker(new TimeTracker(this)),
+    notifications(new NotificationCenter(this)),
+    toastOverlay(nullptr)
 {
     ui->setupUi(this);
+
+    // Messages non bloquants : toasts en surimpression, historique consultable
+    toastOverlay = new ToastOverlay(this);
+    connect(notifications, &NotificationCenter::toastRequested, toastOverlay, &ToastOverlay::showToast);
+    connect(notifications, &NotificationCenter::toastUpdated, toastOverlay, &ToastOverlay::updateToast);
+    connect(toastOverlay, &ToastOverlay::closed, notifications, &NotificationCenter::toastClosed);
+    connect(toastOverlay, &ToastOverlay::clicked, this, &MainWindow::showNotificationHistory);
+    connect(notifications, &NotificationCenter::historyChanged, this, &MainWindow::updateNotificationsButton);
+    connect(reports, &ReportScheduler::finished, this, [this](bool ok, const QString &path, const QString &error) {
+        if (ok) {
+            notifications->info("Weekly Report", QString("Written to %1").arg(QDir::toNativeSeparators(path)));
+        } else {
+            notifications->error("Weekly Report", error);
+        }
+    });
+    // Fenêtre des occurrences glissée au changement de jour
+    occurrenceTimer.setSingleShot(true);
+    connect(&occurrenceTimer, &QTimer::timeout, this, [this]() {
+        // Pas sous une boîte de dialogue modale : elle peut tenir un numéro de ligne
+        if (QApplication::activeModalWidget()) {
+            occurrenceTimer.start(60 * 1000);
+            return;
+        }
+        refreshOccurrenceRows();
+    });
+    // Sauvegarde décompressée et contrôlée hors du thread GUI, puis substituée à la base
+    connect(backups, &BackupManager::restoreReady, this, [this](bool ok, const QString &preparedPath, const QString &error) {
+        if (ok) {
+            restoreDatabase(preparedPath);
+        } else {
+            notifications->error("Restore Backup", error);
+        }
+    });
+
     setWindowTitle("Task Management System");
     resize(1400, 900);
 
     if (!initializeDatabase()) {
-        QMessageBox::critical(this, "Database Error", "Failed to initialize database.");
+        notifications->error("Database Error", "Failed to initialize database.");
     }
 
     // Style setup
@@ -99,6 +197,33 @@ MainWindow::MainWindow(QWidget *parent)
         "#exportBtn:hover {"
         "   background: #5a32a3;"
         "}"
+        "#filesBtn {"
+        "   background: #e83e8c;"
+        "}"
+        "#filesBtn:hover {"
+        "   background: #d91a72;"
+        "}"
+        "#bulkBtn {"
+        "   background: #6610f2;"
+        "}"
+        "#bulkBtn:hover {"
+        "   background: #520dc2;"
+        "}"
+        "#clockBtn {"
+        "   background: #795548;"
+        "}"
+        "#clockBtn:hover {"
+        "   background: #5d4037;"
+        "}"
+        "#undoBtn, #redoBtn {"
+        "   background: #495057;"
+        "}"
+        "#undoBtn:hover, #redoBtn:hover {"
+        "   background: #343a40;"
+        "}"
+        "#undoBtn:disabled, #redoBtn:disabled {"
+        "   background: #adb5bd;"
+        "}"
         "#sortBtn {"
         "   background: #fd7e14;"
         "}"
@@ -111,6 +236,12 @@ MainWindow::MainWindow(QWidget *parent)
         "#searchBtn:hover {"
         "   background: #17a589;"
         "}"
+        "#filterBtn {"
+        "   background: #6c757d;"
+        "}"
+        "#filterBtn:hover {"
+        "   background: #5a6268;"
+        "}"
         "#notificationBtn {"
         "   background: #17a2b8;"
         "   font-weight: bold;"
@@ -162,6 +293,17 @@ MainWindow::MainWindow(QWidget *parent)
     QButtonGroup *navGroup = new QButtonGroup(this);
     navGroup->addButton(ui->navTasksBtn);
     navGroup->addButton(ui->navCalendarBtn);
+    navGroup->addButton(ui->navTimelineBtn);
+    navGroup->addButton(ui->navWorkloadBtn);
+    navGroup->addButton(ui->navMaterialsBtn);
+    navGroup->addButton(ui->navProjectsBtn);
+    navGroup->addButton(ui->navMapBtn);
+    navGroup->addButton(ui->navHistoryBtn);
+    navGroup->addButton(ui->navBackupsBtn);
+    navGroup->addButton(ui->navArchiveBtn);
+    navGroup->addButton(ui->navRecurringBtn);
+    navGroup->addButton(ui->navTimesheetBtn);
+    navGroup->addButton(ui->navNotificationsBtn);
     navGroup->addButton(ui->navStatsBtn);
 
     QString navButtonStyle =
@@ -180,11 +322,23 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->notificationBtn, &QPushButton::clicked,
             this, &MainWindow::on_notificationBtn_clicked);
 
+    // Diagnostics : retards de la boucle d'événements, panneau caché (Ctrl+Maj+D)
+    new StallMonitor(this);
+    QShortcut *diagnosticsShortcut = new QShortcut(QKeySequence("Ctrl+Shift+D"), this);
+    connect(diagnosticsShortcut, &QShortcut::activated, this, &MainWindow::showDiagnostics);
+
     setupTaskTable();
     loadTasksFromDatabase();
+    connect(ui->taskTable, &QTableWidget::currentCellChanged, this, &MainWindow::updateClockButton);
+    connect(timeTracker, &TimeTracker::clockChanged, this, &MainWindow::updateClockButton);
+    ui->undoBtn->setShortcut(QKeySequence::Undo);
+    ui->redoBtn->setShortcut(QKeySequence::Redo);
+    updateUndoButtons();
     setupCalendar();
+    setupTimeline();
     setupSystemTray();
     setupArduino();
+    registerDiagnostics();
 }
 
 void MainWindow::setupArduino()
@@ -216,11 +370,9 @@ void MainWindow::setupArduino()
 
         connect(arduino, &QSerialPort::readyRead, this, &MainWindow::readSerialData);
 
-        QMessageBox::information(this, "Arduino Connected",
-                                 QString("Connected to Arduino on %1").arg(arduinoPortName));
+        notifications->info("Arduino Connected", QString("Connected to Arduino on %1").arg(arduinoPortName));
     } else {
-        QMessageBox::warning(this, "Arduino Error",
-                             "Could not find Arduino. Check connection and try again.");
+        notifications->warning("Arduino Error", "Could not find Arduino. Check connection and try again.");
     }
 }
 
@@ -231,21 +383,24 @@ void MainWindow::readSerialData()
 
         if (data == "TASK_COMPLETED") {
             int row = ui->taskTable->currentRow();
-            if (row >= 0) {
+            if (row >= 0 && materializeOccurrence(row)) {
+                QString taskId = ui->taskTable->item(row, 0)->text();
+                QString previous = ui->taskTable->item(row, 3)->text();
                 ui->taskTable->item(row, 3)->setText("Completed");
-                updateTaskInDatabase({
-                                         ui->taskTable->item(row, 0)->text(),
-                                         ui->taskTable->item(row, 1)->text(),
-                                         ui->taskTable->item(row, 2)->text(),
-                                         "Completed",
-                                         ui->taskTable->item(row, 4)->text(),
-                                         ui->taskTable->item(row, 5)->text(),
-                                         ui->taskTable->item(row, 6)->text(),
-                                         ui->taskTable->item(row, 7)->text()
-                                     }, row);
-
-                QMessageBox::information(this, "Task Completed",
-                                         "Current task marked as completed via Arduino");
+                updateTaskInDatabase(taskDataForRow(row), row);
+                if (previous != "Completed") {
+                    recordChange(QString("Complete %1").arg(taskId),
+                                 {{taskId, UndoJournal::Status, previous, QString("Completed")}});
+                }
+
+                notifications->info("Task Completed",
+                                    QString("%1 marked as completed via Arduino").arg(ui->taskTable->item(row, 0)->text()));
+            }
+        } else if (data == "CLOCK_TOGGLE") {
+            // Bouton de pointage : pas de boîte de dialogue, l'Arduino allume sa LED
+            int row = ui->taskTable->currentRow();
+            if (row >= 0) {
+                sendToArduino(toggleClock(row, "arduino") ? "CLOCK_ON" : "CLOCK_OFF");
             }
         }
     }
@@ -271,19 +426,27 @@ bool MainWindow::initializeDatabase()
         dbPath += "/tasks.db";
         qDebug() << "Database path:" << dbPath;
 
+        // Après une restauration, la même connexion est rouverte : les stores en gardent une copie
         QString connectionName = "TaskConnection";
-        if (QSqlDatabase::contains(connectionName)) {
-            QSqlDatabase::removeDatabase(connectionName);
+        if (!db.isValid()) {
+            if (QSqlDatabase::contains(connectionName)) {
+                QSqlDatabase::removeDatabase(connectionName);
+            }
+            db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+            db.setDatabaseName(dbPath);
         }
 
-        db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
-        db.setDatabaseName(dbPath);
-
-        if (!db.open()) {
+        if (!db.isOpen() && !db.open()) {
             throw std::runtime_error(QString("Failed to open database: %1").arg(db.lastError().text()).toStdString());
         }
 
+        // WAL : sauvegardes et lectures en arrière-plan ne bloquent pas les écritures
         QSqlQuery query(db);
+        if (!query.exec("PRAGMA journal_mode = WAL") || !query.next() ||
+            query.value(0).toString().compare("wal", Qt::CaseInsensitive) != 0) {
+            qWarning() << "Write-ahead logging unavailable, background reads will delay writes";
+        }
+        query.finish();
         QString createTableSQL = R"(
             CREATE TABLE IF NOT EXISTS tasks (
                 id TEXT PRIMARY KEY,
@@ -303,6 +466,156 @@ bool MainWindow::initializeDatabase()
             throw std::runtime_error(QString("Failed to create table: %1").arg(query.lastError().text()).toStdString());
         }
 
+        // Descriptions longues stockées compressées (voir DescriptionStore)
+        if (!ensureColumn("tasks", "description_z", "BLOB")) {
+            throw std::runtime_error("Failed to migrate tasks table");
+        }
+        descriptions.setDatabase(db);
+
+        // Date de fin des tâches, utilisée par les courbes de tendance
+        if (!ensureColumn("tasks", "completed_at", "DATETIME")) {
+            throw std::runtime_error("Failed to migrate tasks table");
+        }
+        if (!query.exec("UPDATE tasks SET completed_at = updated_at "
+                        "WHERE status = 'Completed' AND completed_at IS NULL")) {
+            throw std::runtime_error(QString("Failed to migrate tasks table: %1").arg(query.lastError().text()).toStdString());
+        }
+
+        // Rattachement à un projet ou une phase, coûts prévus et réels
+        if (!ensureColumn("tasks", "project_id", "INTEGER") ||
+            !ensureColumn("tasks", "planned_cost", "REAL NOT NULL DEFAULT 0") ||
+            !ensureColumn("tasks", "actual_cost", "REAL NOT NULL DEFAULT 0")) {
+            throw std::runtime_error("Failed to migrate tasks table");
+        }
+
+        // Emplacement du chantier (WGS84)
+        if (!ensureColumn("tasks", "latitude", "REAL") || !ensureColumn("tasks", "longitude", "REAL")) {
+            throw std::runtime_error("Failed to migrate tasks table");
+        }
+
+        // Index utilisés par les filtres structurés
+        QStringList indexSQL = {
+            "CREATE INDEX IF NOT EXISTS idx_tasks_status ON tasks(status)",
+            "CREATE INDEX IF NOT EXISTS idx_tasks_priority ON tasks(priority)",
+            "CREATE INDEX IF NOT EXISTS idx_tasks_start_date ON tasks(start_date)",
+            "CREATE INDEX IF NOT EXISTS idx_tasks_end_date ON tasks(end_date)",
+            "CREATE INDEX IF NOT EXISTS idx_tasks_assigned_to ON tasks(assigned_to COLLATE NOCASE)",
+            "CREATE INDEX IF NOT EXISTS idx_tasks_project ON tasks(project_id)",
+            "CREATE TABLE IF NOT EXISTS saved_filters ("
+            "   name TEXT PRIMARY KEY,"
+            "   query TEXT NOT NULL"
+            ")",
+            "CREATE TABLE IF NOT EXISTS task_dependencies ("
+            "   predecessor_id TEXT NOT NULL,"
+            "   successor_id TEXT NOT NULL,"
+            "   PRIMARY KEY (predecessor_id, successor_id)"
+            ")",
+            "CREATE INDEX IF NOT EXISTS idx_dependencies_successor ON task_dependencies(successor_id)"
+        };
+        for (const QString &sql : indexSQL) {
+            if (!query.exec(sql)) {
+                throw std::runtime_error(QString("Failed to create index: %1").arg(query.lastError().text()).toStdString());
+            }
+        }
+
+        // Stock : fournisseurs, matériaux et registre des mouvements
+        materials.setDatabase(db);
+        QString materialsError;
+        if (!materials.initialize(&materialsError)) {
+            throw std::runtime_error(QString("Failed to create materials tables: %1").arg(materialsError).toStdString());
+        }
+
+        invoices.setDatabase(db);
+        QString invoicesError;
+        if (!invoices.initialize(&invoicesError)) {
+            throw std::runtime_error(QString("Failed to create invoice tables: %1").arg(invoicesError).toStdString());
+        }
+
+        projects.setDatabase(db);
+        QString projectsError;
+        if (!projects.initialize(&projectsError)) {
+            throw std::runtime_error(QString("Failed to create project tables: %1").arg(projectsError).toStdString());
+        }
+        if (!ensureColumn("projects", "latitude", "REAL") || !ensureColumn("projects", "longitude", "REAL")) {
+            throw std::runtime_error("Failed to migrate projects table");
+        }
+
+        recurrence.setDatabase(db);
+        QString recurrenceError;
+        if (!recurrence.initialize(&recurrenceError)) {
+            throw std::runtime_error(QString("Failed to create recurring task tables: %1").arg(recurrenceError).toStdString());
+        }
+
+        timeTracker->setDatabase(db);
+        QString timeError;
+        if (!timeTracker->initialize(&timeError)) {
+            throw std::runtime_error(QString("Failed to create time tracking tables: %1").arg(timeError).toStdString());
+        }
+
+        // Historique des versions : triggers posés après toutes les migrations de tasks
+        history.setDatabase(db);
+        QString historyError;
+        if (!history.initialize(&historyError)) {
+            throw std::runtime_error(QString("Failed to create history tables: %1").arg(historyError).toStdString());
+        }
+        if (!history.compact(HistoryStore::defaultRetentionDays, &historyError)) {
+            qWarning() << "Failed to compact task history:" << historyError;
+        }
+
+        // Pièces jointes rangées à côté de la base, par empreinte de contenu
+        attachments.setDatabase(db);
+        attachments.setDirectory(QDir(QFileInfo(dbPath).absolutePath()).filePath("attachments"));
+        QString attachmentsError;
+        if (!attachments.initialize(&attachmentsError)) {
+            throw std::runtime_error(QString("Failed to create attachment store: %1").arg(attachmentsError).toStdString());
+        }
+        thumbnails->setDirectory(attachments.thumbnailDirectory());
+
+        // Tuiles de carte : cache local, serveur facultatif (la variable d'environnement sert aux tests)
+        tiles->setDirectory(QDir(QFileInfo(dbPath).absolutePath()).filePath("tiles"));
+        QString tileUrl = qEnvironmentVariable("TASKMANAGER_TILE_URL");
+        if (tileUrl.isEmpty()) {
+            tileUrl = QSettings("TaskManager", "TaskManager").value("map/tileUrl").toString();
+        }
+        tiles->setUrlTemplate(tileUrl);
+
+        // Sauvegardes planifiées, instantané écrit par VACUUM INTO sur un thread de travail
+        QSettings settings("TaskManager", "TaskManager");
+        backups->setSource(dbPath);
+        backups->setDirectory(QDir(QFileInfo(dbPath).absolutePath()).filePath("backups"));
+        backups->setRetention(settings.value("backup/keep", 7).toInt());
+        backups->setIntervalHours(settings.value("backup/intervalHours", 24).toInt());
+
+        // Tâches terminées des années passées, un fichier par année hors de la base active
+        archive.setDatabase(db);
+        archive.setDirectory(QDir(QFileInfo(dbPath).absolutePath()).filePath("archive"));
+        QString archiveError;
+        if (!archive.initialize(&archiveError)) {
+            throw std::runtime_error(QString("Failed to create archive tables: %1").arg(archiveError).toStdString());
+        }
+        // Pièces jointes gardées pour une annulation que l'arrêt a rendue impossible
+        if (!attachments.removeOrphans(&attachmentsError)) {
+            qWarning() << "Failed to remove orphaned attachments:" << attachmentsError;
+        }
+
+        // Rapports hebdomadaires : synthèses tenues à jour par triggers, génération planifiée
+        reports->setDatabase(db);
+        QString reportsError;
+        if (!reports->initialize(&reportsError)) {
+            throw std::runtime_error(QString("Failed to create report summary tables: %1").arg(reportsError).toStdString());
+        }
+        reports->setSource(dbPath);
+        reports->setDirectory(QDir(QFileInfo(dbPath).absolutePath()).filePath("reports"));
+        ReportScheduler::Settings reportSettings;
+        reportSettings.enabled = settings.value("reports/enabled", false).toBool();
+        reportSettings.dpi = settings.value("reports/dpi", reportSettings.dpi).toInt();
+        reportSettings.trendWeeks = settings.value("reports/trendWeeks", reportSettings.trendWeeks).toInt();
+        reportSettings.assignees = settings.value("reports/assignees").toStringList();
+        reports->setSettings(reportSettings);
+
+        journal.setLimits(settings.value("undo/depth", UndoJournal::DefaultDepth).toInt(),
+                          settings.value("undo/maxChanges", UndoJournal::DefaultMaxChanges).toInt());
+
         qDebug() << "Database initialized successfully";
         return true;
 
@@ -319,46 +632,503 @@ bool MainWindow::initializeDatabase()
     }
 }
 
+bool MainWindow::ensureColumn(const QString &table, const QString &column, const QString &definition)
+{
+    QSqlQuery query(db);
+    if (!query.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+        qCritical() << "Failed to inspect table" << table << query.lastError().text();
+        return false;
+    }
+
+    while (query.next()) {
+        if (query.value(1).toString() == column) return true;
+    }
+
+    if (!query.exec(QString("ALTER TABLE %1 ADD COLUMN %2 %3").arg(table, column, definition))) {
+        qCritical() << "Failed to add column" << column << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
 void MainWindow::loadTasksFromDatabase()
 {
     if (!db.isOpen()) return;
+    static Diagnostics::Latency &latency = Diagnostics::latency("load tasks (SELECT + table fill)");
+    Diagnostics::Timer timer(latency);
 
-    QSqlQuery query("SELECT id, name, description, status, priority, start_date, end_date, assigned_to FROM tasks ORDER BY end_date", db);
+    // Seul un aperçu de la description est chargé, le texte complet est lu à la demande
+    QSqlQuery query(QString("SELECT id, name, %1, status, priority, start_date, end_date, assigned_to, "
+                            "created_at, completed_at, project_id, planned_cost, actual_cost, latitude, longitude "
+                            "FROM tasks ORDER BY end_date").arg(DescriptionStore::previewColumns()), db);
 
     ui->taskTable->setRowCount(0); // Clear existing data
+    rankedFrom.clear();
+    descriptions.clear();
+    workload.clear();
+    trends.clear();
+    sites.clear();
+    fuzzyIndexDirty = true;
+
+    QString projectsError;
+    if (!projects.load(&projectsError)) {
+        qWarning() << "Failed to load projects:" << projectsError;
+    }
+    loadProjectSites();
 
     while (query.next()) {
         int row = ui->taskTable->rowCount();
         ui->taskTable->insertRow(row);
 
+        QStringList rowData;    // aperçu en colonne 2, inutile pour la charge
         for (int col = 0; col < 8; ++col) {
-            QTableWidgetItem *item = new QTableWidgetItem(query.value(col).toString());
+            int field = col > 2 ? col + 1 : col;
+            QTableWidgetItem *item = new QTableWidgetItem(query.value(field).toString());
+            if (col == 2) {
+                bool truncated = query.value(3).toBool();
+                item->setText(DescriptionStore::previewText(item->text(), truncated));
+                item->setData(Qt::UserRole, truncated);
+            }
             ui->taskTable->setItem(row, col, item);
+            rowData << item->text();
+        }
+        updateWorkload(rowData);
+        trends.setTask(rowData[0],
+                       QDate::fromString(query.value(9).toString().left(10), "yyyy-MM-dd"),
+                       QDate::fromString(query.value(10).toString().left(10), "yyyy-MM-dd"),
+                       QDate::fromString(rowData[6], "yyyy-MM-dd"));
+        projects.trackTask(rowData[0], query.value(11).toInt(),
+                           query.value(12).toDouble(), query.value(13).toDouble());
+        setVarianceCell(row);
+        if (!query.value(14).isNull() && !query.value(15).isNull()) {
+            sites.insert(rowData[0], QString("%1 - %2").arg(rowData[0], rowData[1]),
+                         QPointF(query.value(15).toDouble(), query.value(14).toDouble()));
         }
     }
+
+    rebuildAnalytics();
+    loadDependencies();
+    refreshOccurrenceRows();
 }
 
-void MainWindow::saveTaskToDatabase(const QStringList &taskData)
+void MainWindow::loadDependencies()
 {
-    if (!db.isOpen()) return;
+    taskGraph.clear();
+    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+        taskGraph.insertTask(ui->taskTable->item(row, 0)->text(),
+                             QDate::fromString(ui->taskTable->item(row, 5)->text(), "yyyy-MM-dd"),
+                             QDate::fromString(ui->taskTable->item(row, 6)->text(), "yyyy-MM-dd"));
+    }
+
+    QSqlQuery query("SELECT predecessor_id, successor_id FROM task_dependencies", db);
+    while (query.next()) {
+        QString error;
+        if (!taskGraph.insertDependency(query.value(0).toString(), query.value(1).toString(), &error)) {
+            qWarning() << "Ignoring dependency:" << error;
+        }
+    }
+
+    taskGraph.recomputeAll();
+    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+        setScheduleCell(row);
+    }
+}
+
+bool MainWindow::saveDependencies(const QString &taskId, const QString &text)
+{
+    QStringList predecessors = text.toUpper().split(QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts);
+    predecessors.removeDuplicates();
+
+    QString error;
+    QStringList changed = taskGraph.setPredecessors(taskId, predecessors, &error);
+    if (!error.isEmpty()) {
+        QMessageBox::warning(this, "Invalid Dependencies", error);
+        return false;
+    }
+
+    db.transaction();
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM task_dependencies WHERE successor_id = :id");
+    query.bindValue(":id", taskId);
+    bool ok = timedExec(query);
+
+    query.prepare("INSERT INTO task_dependencies (predecessor_id, successor_id) VALUES (:predecessor, :successor)");
+    for (int i = 0; ok && i < predecessors.size(); ++i) {
+        query.bindValue(":predecessor", predecessors[i]);
+        query.bindValue(":successor", taskId);
+        ok = timedExec(query);
+    }
+
+    if (!ok || !db.commit()) {
+        QString message = query.lastError().text();
+        db.rollback();
+        notifications->error("Database Error", QString("Failed to save dependencies: %1").arg(message));
+        loadDependencies();
+        return false;
+    }
+
+    updateScheduleCells(changed);
+    return true;
+}
+
+void MainWindow::setScheduleCell(int row)
+{
+    QTableWidgetItem *item = ui->taskTable->item(row, 8);
+    if (!item) {
+        item = new QTableWidgetItem();
+        ui->taskTable->setItem(row, 8, item);
+    }
+
+    TaskGraph::Schedule schedule = taskGraph.schedule(ui->taskTable->item(row, 0)->text());
+    QFont font = item->font();
+    font.setBold(schedule.critical);
+    item->setFont(font);
+
+    if (!schedule.linked) {
+        item->setText(QString());
+        item->setToolTip(QString());
+        item->setData(Qt::ForegroundRole, QVariant());
+        return;
+    }
+
+    item->setText(schedule.critical ? QString("0 d (critical)") : QString("%1 d").arg(schedule.slack));
+    item->setToolTip(QString("Earliest start: %1\nEarliest finish: %2\nLatest start: %3\nLatest finish: %4")
+                         .arg(schedule.earlyStart.toString("yyyy-MM-dd"),
+                              schedule.earlyFinish.toString("yyyy-MM-dd"),
+                              schedule.lateStart.toString("yyyy-MM-dd"),
+                              schedule.lateFinish.toString("yyyy-MM-dd")));
+    if (schedule.critical) {
+        item->setForeground(QColor(220, 53, 69));
+    } else {
+        item->setData(Qt::ForegroundRole, QVariant());
+    }
+}
+
+void MainWindow::setVarianceCell(int row)
+{
+    QTableWidgetItem *item = ui->taskTable->item(row, 9);
+    if (!item) {
+        item = new QTableWidgetItem();
+        ui->taskTable->setItem(row, 9, item);
+    }
+
+    BudgetTree::TaskCosts costs = projects.tree().task(ui->taskTable->item(row, 0)->text());
+    if (costs.isEmpty()) {
+        item->setText(QString());
+        item->setToolTip(QString());
+        item->setData(Qt::ForegroundRole, QVariant());
+        return;
+    }
+
+    double variance = costs.planned - costs.actual;
+    item->setText(QString::number(variance, 'f', 2));
+    item->setToolTip(QString("Project: %1\nPlanned: %2\nActual: %3")
+                         .arg(costs.projectId ? projects.tree().path(costs.projectId) : QString("(none)"),
+                              QString::number(costs.planned, 'f', 2),
+                              QString::number(costs.actual, 'f', 2)));
+    if (variance < 0) {
+        item->setForeground(QColor(220, 53, 69));
+    } else {
+        item->setData(Qt::ForegroundRole, QVariant());
+    }
+}
+
+void MainWindow::refreshVarianceCells()
+{
+    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+        setVarianceCell(row);
+    }
+}
+
+QComboBox *MainWindow::createProjectCombo(QWidget *parent, int projectId)
+{
+    const BudgetTree &tree = projects.tree();
+    QComboBox *combo = new QComboBox(parent);
+    combo->addItem("(none)", 0);
+
+    QVector<QPair<QString, int>> entries;
+    QVector<int> pending = tree.roots();
+    while (!pending.isEmpty()) {
+        int id = pending.takeLast();
+        entries << qMakePair(tree.path(id), id);
+        pending += tree.node(id).children;
+    }
+    std::sort(entries.begin(), entries.end(), [](const QPair<QString, int> &a, const QPair<QString, int> &b) {
+        return a.first.compare(b.first, Qt::CaseInsensitive) < 0;
+    });
+    for (const auto &entry : entries) {
+        combo->addItem(entry.first, entry.second);
+    }
+
+    combo->setCurrentIndex(qMax(0, combo->findData(projectId)));
+    return combo;
+}
+
+void MainWindow::saveTaskCosts(const QString &taskId, int projectId, double planned, double actual, int row)
+{
+    // Rien à écrire si rien n'a changé (une nouvelle tâche a déjà des coûts nuls)
+    BudgetTree::TaskCosts current = projects.tree().task(taskId);
+    if (current.projectId == projectId && current.planned == planned && current.actual == actual) {
+        setVarianceCell(row);
+        return;
+    }
+
+    // Seule la chaîne des ancêtres du projet est remise à jour
+    QString error;
+    if (!projects.setTaskCosts(taskId, projectId, planned, actual, &error)) {
+        notifications->error("Database Error", QString("Failed to save task costs: %1").arg(error));
+    }
+    setVarianceCell(row);
+}
+
+void MainWindow::saveTaskSite(const QString &taskId, const QString &name, const QString &coordinates)
+{
+    QPointF site;
+    bool located = !coordinates.trimmed().isEmpty();
+    if (located && !SpatialIndex::parseCoordinates(coordinates, &site)) {
+        QMessageBox::warning(this, "Invalid Site",
+                             QString("Site of %1 was not saved: use \"latitude, longitude\", e.g. 48.8566, 2.3522").arg(taskId));
+        return;
+    }
+
+    if (located || sites.contains(taskId)) {
+        QSqlQuery query(db);
+        query.prepare("UPDATE tasks SET latitude = :latitude, longitude = :longitude WHERE id = :id");
+        query.bindValue(":latitude", located ? QVariant(site.y()) : QVariant());
+        query.bindValue(":longitude", located ? QVariant(site.x()) : QVariant());
+        query.bindValue(":id", taskId);
+        if (!timedExec(query)) {
+            notifications->error("Database Error", QString("Failed to save task site: %1").arg(query.lastError().text()));
+            return;
+        }
+    }
+
+    if (located) {
+        sites.insert(taskId, QString("%1 - %2").arg(taskId, name), site);
+    } else {
+        sites.remove(taskId);
+    }
+}
+
+void MainWindow::loadProjectSites()
+{
+    sites.removeByPrefix("project:");
+    QHash<int, QPointF> projectSites = projects.sites();
+    for (auto it = projectSites.constBegin(); it != projectSites.constEnd(); ++it) {
+        sites.insert(QString("project:%1").arg(it.key()),
+                     QString("Project: %1").arg(projects.tree().path(it.key())),
+                     it.value());
+    }
+}
+
+bool MainWindow::isOccurrenceRow(int row) const
+{
+    QTableWidgetItem *item = ui->taskTable->item(row, 0);
+    return item && item->data(occurrence_role).toBool();
+}
+
+void MainWindow::refreshOccurrenceRows()
+{
+    // Les occurrences ne sont jamais en base : elles sont recalculées pour la fenêtre visible
+    ui->taskTable->setUpdatesEnabled(false);
+    restoreRankedOrder();
+    QSet<QString> taskIds;
+    for (int row = ui->taskTable->rowCount() - 1; row >= 0; --row) {
+        QString taskId = ui->taskTable->item(row, 0)->text();
+        if (isOccurrenceRow(row)) {
+            workload.removeTask(taskId);
+            ui->taskTable->removeRow(row);
+        } else {
+            taskIds.insert(taskId);
+        }
+    }
+
+    QDate today = QDate::currentDate();
+    QFont font = ui->taskTable->font();
+    font.setItalic(true);
+    for (const RecurrenceStore::Occurrence &occurrence :
+         recurrence.occurrences(today.addDays(-occurrence_days_before), today.addDays(occurrence_days_after))) {
+        if (taskIds.contains(occurrence.taskId)) continue;    // déjà enregistrée sous le même ID
+
+        QStringList rowData = {occurrence.taskId, occurrence.name, QString(), "Not Started", occurrence.priority,
+                               occurrence.start.toString("yyyy-MM-dd"), occurrence.end.toString("yyyy-MM-dd"),
+                               occurrence.assignedTo};
+        QString tip = QString("Recurring: %1\nNot saved until edited")
+                          .arg(recurrence.seriesById(occurrence.seriesId).parsed.describe());
+
+        int row = ui->taskTable->rowCount();
+        ui->taskTable->insertRow(row);
+        for (int col = 0; col < 10; ++col) {
+            QTableWidgetItem *item = new QTableWidgetItem(col < rowData.size() ? rowData[col] : QString());
+            item->setFont(font);
+            item->setForeground(QColor(108, 117, 125));
+            item->setToolTip(tip);
+            ui->taskTable->setItem(row, col, item);
+        }
+        ui->taskTable->item(row, 0)->setData(occurrence_role, true);
+        setDescriptionCell(row, occurrence.description);
+        updateWorkload(rowData);
+    }
+    ui->taskTable->setUpdatesEnabled(true);
+    fuzzyIndexDirty = true;
+
+    // Filtre ou recherche en cours appliqués aussi aux nouvelles occurrences
+    if (!ui->searchInput->text().trimmed().isEmpty()) {
+        on_searchBtn_clicked();
+    }
+
+    // Prochain recalcul juste après minuit
+    occurrenceTimer.start(QDateTime::currentDateTime().msecsTo(QDateTime(today.addDays(1), QTime(0, 0))) + 1000);
+}
+
+bool MainWindow::materializeOccurrence(int row)
+{
+    if (!isOccurrenceRow(row)) return true;
+
+    int seriesId = 0;
+    QDate date;
+    QString taskId = ui->taskTable->item(row, 0)->text();
+    if (!RecurrenceStore::parseOccurrenceId(taskId, &seriesId, &date)) return false;
+    if (!saveTaskToDatabase(taskDataForRow(row))) return false;
+
+    // L'exception empêche de générer à nouveau cette date
+    QString error;
+    if (!recurrence.addException(seriesId, date, &error)) {
+        qWarning() << "Failed to record materialized occurrence" << taskId << error;
+    }
+
+    for (int col = 0; col < 10; ++col) {
+        QTableWidgetItem *item = ui->taskTable->item(row, col);
+        item->setFont(ui->taskTable->font());
+        item->setData(Qt::ForegroundRole, QVariant());
+        item->setToolTip(QString());
+    }
+    ui->taskTable->item(row, 0)->setData(occurrence_role, QVariant());
+    setScheduleCell(row);
+    return true;
+}
+
+bool MainWindow::materializeOccurrences(const QVector<int> &rows)
+{
+    for (int row : rows) {
+        if (!materializeOccurrence(row)) return false;
+    }
+    return true;
+}
+
+void MainWindow::skipOccurrence(int row)
+{
+    int seriesId = 0;
+    QDate date;
+    QString taskId = ui->taskTable->item(row, 0)->text();
+    if (!RecurrenceStore::parseOccurrenceId(taskId, &seriesId, &date)) return;
+
+    QString error;
+    if (!recurrence.addException(seriesId, date, &error)) {
+        notifications->error("Database Error", QString("Failed to skip occurrence: %1").arg(error));
+        return;
+    }
+    workload.removeTask(taskId);
+    ui->taskTable->removeRow(row);
+    fuzzyIndexDirty = true;
+    updateCharts();
+}
+
+void MainWindow::paintCalendarOccurrences(int year, int month)
+{
+    // Mois affiché seulement : les séries sans fin ne sont jamais déroulées en entier
+    QDate first(year, month, 1);
+    QTextCharFormat format;
+    format.setBackground(statusColor("Not Started").lighter(160));
+    format.setFontItalic(true);
+
+    for (const RecurrenceStore::Occurrence &occurrence : recurrence.occurrences(first, first.addMonths(1).addDays(-1))) {
+        for (QDate date = occurrence.start; date <= occurrence.end; date = date.addDays(1)) {
+            // Les tâches enregistrées gardent leur couleur de statut
+            if (calendarWidget->dateTextFormat(date).background().style() == Qt::NoBrush) {
+                calendarWidget->setDateTextFormat(date, format);
+            }
+        }
+    }
+}
+
+bool MainWindow::toggleClock(int row, const QString &source)
+{
+    // Le temps est toujours pointé sur une vraie tâche
+    if (!materializeOccurrence(row)) return false;
+
+    return timeTracker->toggle(ui->taskTable->item(row, 0)->text(), clockPerson(row), source);
+}
+
+QString MainWindow::clockPerson(int row) const
+{
+    // Le temps est pointé au nom de la personne assignée
+    QString person = ui->taskTable->item(row, 7)->text().trimmed();
+    return person.isEmpty() ? QString("Unassigned") : person;
+}
+
+void MainWindow::updateClockButton()
+{
+    int row = ui->taskTable->currentRow();
+    bool running = row >= 0 && ui->taskTable->item(row, 0) && ui->taskTable->item(row, 7) &&
+                   timeTracker->isRunning(ui->taskTable->item(row, 0)->text(), clockPerson(row));
+    ui->clockBtn->setText(running ? "Clock Out" : "Clock In");
+}
+
+void MainWindow::on_clockBtn_clicked()
+{
+    if (!validateRowSelection()) return;
+    toggleClock(ui->taskTable->currentRow(), "gui");
+}
+
+void MainWindow::updateScheduleCells(const QStringList &taskIds)
+{
+    if (taskIds.isEmpty()) return;
+
+    QSet<QString> ids(taskIds.begin(), taskIds.end());
+    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+        if (ids.contains(ui->taskTable->item(row, 0)->text())) {
+            setScheduleCell(row);
+        }
+    }
+}
+
+bool MainWindow::saveTaskToDatabase(const QStringList &taskData)
+{
+    if (!db.isOpen()) return false;
+
+    dropDetachedAttachments(taskData[0]);      // nouvelle tâche : rien à hériter d'une supprimée
 
     QSqlQuery query(db);
-    query.prepare("INSERT INTO tasks (id, name, description, status, priority, start_date, end_date, assigned_to) "
-                  "VALUES (:id, :name, :description, :status, :priority, :start_date, :end_date, :assigned_to)");
+    query.prepare("INSERT INTO tasks (id, name, description, description_z, status, priority, start_date, end_date, assigned_to, completed_at) "
+                  "VALUES (:id, :name, :description, :description_z, :status, :priority, :start_date, :end_date, :assigned_to, "
+                  "CASE WHEN :completed THEN CURRENT_TIMESTAMP END)");
 
     query.bindValue(":id", taskData[0]);
     query.bindValue(":name", taskData[1]);
-    query.bindValue(":description", taskData[2]);
+    descriptions.bindDescription(query, taskData[2]);
     query.bindValue(":status", taskData[3]);
     query.bindValue(":priority", taskData[4]);
     query.bindValue(":start_date", taskData[5]);
     query.bindValue(":end_date", taskData[6]);
     query.bindValue(":assigned_to", taskData[7]);
+    query.bindValue(":completed", taskData[3] == "Completed");
 
-    if (!query.exec()) {
-        QMessageBox::critical(this, "Database Error",
-                              QString("Failed to save task: %1").arg(query.lastError().text()));
+    if (!timedExec(query)) {
+        notifications->error("Database Error", QString("Failed to save task: %1").arg(query.lastError().text()));
+        return false;
     }
+    descriptions.store(taskData[0], taskData[2]);
+    fuzzyIndexDirty = true;
+    updateWorkload(taskData);
+    trends.updateTask(taskData[0], taskData[3] == "Completed", QDate::fromString(taskData[6], "yyyy-MM-dd"));
+    analytics.updateTask(TaskRecord::fromTaskData(taskData));
+
+    updateScheduleCells(taskGraph.updateTask(taskData[0],
+                                             QDate::fromString(taskData[5], "yyyy-MM-dd"),
+                                             QDate::fromString(taskData[6], "yyyy-MM-dd")));
+    history.maybeSnapshot();
+    return true;
 }
 
 void MainWindow::updateTaskInDatabase(const QStringList &taskData, int row)
@@ -366,34 +1136,85 @@ void MainWindow::updateTaskInDatabase(const QStringList &taskData, int row)
     if (!db.isOpen()) return;
 
     QString taskId = ui->taskTable->item(row, 0)->text();
+    bool renamed = taskId != taskData[0];
+
+    // Un changement d'ID et les liens qui le citent sont validés ensemble
+    if (renamed && !db.transaction()) {
+        notifications->error("Database Error", QString("Failed to update task: %1").arg(db.lastError().text()));
+        return;
+    }
 
     QSqlQuery query(db);
     query.prepare("UPDATE tasks SET "
                   "id = :id, "
                   "name = :name, "
                   "description = :description, "
+                  "description_z = :description_z, "
                   "status = :status, "
                   "priority = :priority, "
                   "start_date = :start_date, "
                   "end_date = :end_date, "
                   "assigned_to = :assigned_to, "
+                  "completed_at = CASE WHEN :completed THEN COALESCE(completed_at, CURRENT_TIMESTAMP) END, "
                   "updated_at = CURRENT_TIMESTAMP "
                   "WHERE id = :old_id");
 
     query.bindValue(":id", taskData[0]);
     query.bindValue(":name", taskData[1]);
-    query.bindValue(":description", taskData[2]);
+    descriptions.bindDescription(query, taskData[2]);
     query.bindValue(":status", taskData[3]);
     query.bindValue(":priority", taskData[4]);
     query.bindValue(":start_date", taskData[5]);
     query.bindValue(":end_date", taskData[6]);
     query.bindValue(":assigned_to", taskData[7]);
+    query.bindValue(":completed", taskData[3] == "Completed");
     query.bindValue(":old_id", taskId);
 
-    if (!query.exec()) {
-        QMessageBox::critical(this, "Database Error",
-                              QString("Failed to update task: %1").arg(query.lastError().text()));
+    bool ok = timedExec(query);
+    QString renameError;
+    if (ok && renamed) {
+        for (const QString &column : {QString("predecessor_id"), QString("successor_id")}) {
+            query.prepare(QString("UPDATE task_dependencies SET %1 = :new_id WHERE %1 = :old_id").arg(column));
+            query.bindValue(":new_id", taskData[0]);
+            query.bindValue(":old_id", taskId);
+            if (!(ok = timedExec(query))) break;
+        }
+        ok = ok && materials.renameTask(taskId, taskData[0], &renameError) &&
+             invoices.renameTask(taskId, taskData[0], &renameError);
+    }
+    if (!ok || (renamed && !db.commit())) {
+        QString message = !renameError.isEmpty() ? renameError
+                          : query.lastError().isValid() ? query.lastError().text() : db.lastError().text();
+        if (renamed) db.rollback();
+        notifications->error("Database Error", QString("Failed to update task: %1").arg(message));
+        return;
+    }
+    descriptions.invalidate(taskId);
+    descriptions.store(taskData[0], taskData[2]);
+    fuzzyIndexDirty = true;
+
+    if (renamed) {
+        taskGraph.renameTask(taskId, taskData[0]);
+        workload.removeTask(taskId);
+        trends.renameTask(taskId, taskData[0]);
+        analytics.renameTask(taskId, taskData[0]);
+        projects.renameTask(taskId, taskData[0]);
+        dropDetachedAttachments(taskData[0]);
+        attachments.renameTask(taskId, taskData[0]);
+        sites.rename(taskId, taskData[0]);
+        QString timeError;
+        if (!timeTracker->renameTask(taskId, taskData[0], &timeError)) {
+            qWarning() << "Failed to rename tracked time of" << taskId << timeError;
+        }
     }
+    updateWorkload(taskData);
+    trends.updateTask(taskData[0], taskData[3] == "Completed", QDate::fromString(taskData[6], "yyyy-MM-dd"));
+    analytics.updateTask(TaskRecord::fromTaskData(taskData));
+
+    updateScheduleCells(taskGraph.updateTask(taskData[0],
+                                             QDate::fromString(taskData[5], "yyyy-MM-dd"),
+                                             QDate::fromString(taskData[6], "yyyy-MM-dd")));
+    history.maybeSnapshot();
 }
 
 void MainWindow::deleteTaskFromDatabase(const QString &taskId)
@@ -404,20 +1225,563 @@ void MainWindow::deleteTaskFromDatabase(const QString &taskId)
     query.prepare("DELETE FROM tasks WHERE id = :id");
     query.bindValue(":id", taskId);
 
-    if (!query.exec()) {
-        QMessageBox::critical(this, "Database Error",
-                              QString("Failed to delete task: %1").arg(query.lastError().text()));
+    if (!timedExec(query)) {
+        notifications->error("Database Error", QString("Failed to delete task: %1").arg(query.lastError().text()));
+    }
+    descriptions.invalidate(taskId);
+    fuzzyIndexDirty = true;
+
+    query.prepare("DELETE FROM task_dependencies WHERE predecessor_id = :predecessor OR successor_id = :successor");
+    query.bindValue(":predecessor", taskId);
+    query.bindValue(":successor", taskId);
+    if (!timedExec(query)) {
+        qWarning() << "Failed to delete dependencies of" << taskId << query.lastError().text();
     }
+    updateScheduleCells(taskGraph.removeTask(taskId));
+    workload.removeTask(taskId);
+    trends.removeTask(taskId);
+    analytics.removeTask(taskId);
+    projects.removeTask(taskId);
+    detachedAttachments.insert(taskId);
+    sites.remove(taskId);
+    timeTracker->stopTask(taskId, "delete");
+    history.maybeSnapshot();
 }
 
-void MainWindow::setupTaskTable()
+QStringList MainWindow::journalState(int row, bool fullText)
 {
-    ui->taskTable->setColumnCount(8);
-    QStringList headers = {"ID", "Name", "Description", "Status", "Priority", "Start Date", "End Date", "Assigned To"};
-    ui->taskTable->setHorizontalHeaderLabels(headers);
+    // Champs dans l'ordre d'UndoJournal::Field; sans fullText, aperçu de la description seulement
+    QString taskId = ui->taskTable->item(row, 0)->text();
+    BudgetTree::TaskCosts costs = projects.tree().task(taskId);
+    QStringList state = fullText ? taskDataForRow(row) : taskCellsForRow(row);
+    state << taskGraph.predecessors(taskId).join(", ")
+          << (costs.projectId > 0 ? QString::number(costs.projectId) : QString())
+          << (costs.planned != 0.0 ? QString::number(costs.planned, 'f', 2) : QString())
+          << (costs.actual != 0.0 ? QString::number(costs.actual, 'f', 2) : QString())
+          << (sites.contains(taskId) ? SpatialIndex::formatCoordinates(sites.point(taskId)) : QString());
+    QPair<QString, QString> stamps = taskTimestamps(taskId);
+    state << stamps.first << stamps.second;
+    return state;
+}
+
+QPair<QString, QString> MainWindow::taskTimestamps(const QString &taskId) const
+{
+    // created_at et completed_at tels qu'enregistrés; vides pour une occurrence non enregistrée
+    QSqlQuery query(db);
+    query.prepare("SELECT created_at, completed_at FROM tasks WHERE id = :id");
+    query.bindValue(":id", taskId);
+    if (!timedExec(query) || !query.next()) return {};
+    return {query.value(0).toString(), query.value(1).toString()};
+}
+
+QVector<UndoJournal::Change> MainWindow::dependencyChangesForRemoval(const QSet<QString> &removedIds) const
+{
+    // Les liens vers une tâche supprimée disparaissent aussi chez ses successeurs
+    QVector<UndoJournal::Change> changes;
+    QSet<QString> seen;
+    for (const QString &taskId : removedIds) {
+        for (const QString &successor : taskGraph.successors(taskId)) {
+            if (removedIds.contains(successor) || seen.contains(successor)) continue;
+            seen.insert(successor);
+
+            QStringList before = taskGraph.predecessors(successor);
+            QStringList after;
+            for (const QString &predecessor : before) {
+                if (!removedIds.contains(predecessor)) after << predecessor;
+            }
+            changes.append({successor, UndoJournal::Predecessors, before.join(", "), after.join(", ")});
+        }
+    }
+    return changes;
+}
+
+void MainWindow::recordChange(const QString &label, const QVector<UndoJournal::Change> &changes, bool mergeable)
+{
+    if (!journal.record(label, changes, mergeable)) {
+        forgetUndoHistory(QString("%1 is too large to undo (%2 field changes)").arg(label).arg(changes.size()));
+        return;
+    }
+    updateUndoButtons();
+}
+
+void MainWindow::forgetUndoHistory(const QString &reason)
+{
+    journal.clear();
+    updateUndoButtons();
+    notifications->warning("Undo", reason + "; undo history cleared.");
+}
+
+void MainWindow::updateUndoButtons()
+{
+    QString undoKey = ui->undoBtn->shortcut().toString(QKeySequence::NativeText);
+    QString redoKey = ui->redoBtn->shortcut().toString(QKeySequence::NativeText);
+    ui->undoBtn->setEnabled(journal.canUndo());
+    ui->undoBtn->setToolTip(journal.canUndo() ? QString("Undo %1 (%2)").arg(journal.nextUndo().label, undoKey)
+                                              : QString("Nothing to undo"));
+    ui->redoBtn->setEnabled(journal.canRedo());
+    ui->redoBtn->setToolTip(journal.canRedo() ? QString("Redo %1 (%2)").arg(journal.nextRedo().label, redoKey)
+                                              : QString("Nothing to redo"));
+    // Appelé après chaque changement du journal
+    collectDetachedAttachments();
+}
+
+void MainWindow::collectDetachedAttachments()
+{
+    // Pièces jointes rendues à leur tâche, ou qu'aucune entrée du journal ne peut plus rendre
+    if (detachedAttachments.isEmpty()) return;
+    const QSet<QString> restorable = journal.taskIds();
+    QSqlQuery query(db);
+    query.prepare("SELECT 1 FROM tasks WHERE id = :id");
+    for (auto it = detachedAttachments.begin(); it != detachedAttachments.end();) {
+        query.bindValue(":id", *it);
+        bool exists = timedExec(query) && query.next();
+        query.finish();
+        if (exists) {
+            it = detachedAttachments.erase(it);
+        } else if (!restorable.contains(*it)) {
+            attachments.removeTask(*it);
+            it = detachedAttachments.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void MainWindow::dropDetachedAttachments(const QString &taskId)
+{
+    if (detachedAttachments.remove(taskId)) {
+        attachments.removeTask(taskId);
+    }
+}
+
+void MainWindow::on_undoBtn_clicked()
+{
+    if (!journal.canUndo()) return;
+
+    // Copie : une incohérence détectée pendant l'application vide le journal
+    UndoJournal::Entry entry = journal.nextUndo();
+    if (applyJournalEntry(entry, true)) {
+        journal.undone();
+        notifications->info("Undo", entry.label);
+    }
+    updateUndoButtons();
+}
+
+void MainWindow::on_redoBtn_clicked()
+{
+    if (!journal.canRedo()) return;
+
+    UndoJournal::Entry entry = journal.nextRedo();
+    if (applyJournalEntry(entry, false)) {
+        journal.redone();
+        notifications->info("Redo", entry.label);
+    }
+    updateUndoButtons();
+}
+
+// Valeurs enregistrées d'un état du journal, dans l'ordre des colonnes de l'INSERT
+static QVariantList journalRowValues(const QStringList &state)
+{
+    QVariant description;
+    QVariant compressed;
+    DescriptionStore::encode(state[UndoJournal::Description], &description, &compressed);
+
+    QPointF site;
+    bool located = SpatialIndex::parseCoordinates(state[UndoJournal::Site], &site);
+    int projectId = state[UndoJournal::Project].toInt();
+    auto stamp = [&state](int field) {
+        return state[field].isEmpty() ? QVariant() : QVariant(state[field]);
+    };
+
+    return {state[UndoJournal::Id], state[UndoJournal::Name], description, compressed,
+            state[UndoJournal::Status], state[UndoJournal::Priority],
+            state[UndoJournal::StartDate], state[UndoJournal::EndDate], state[UndoJournal::AssignedTo],
+            projectId > 0 ? QVariant(projectId) : QVariant(),
+            state[UndoJournal::PlannedCost].toDouble(), state[UndoJournal::ActualCost].toDouble(),
+            located ? QVariant(site.y()) : QVariant(), located ? QVariant(site.x()) : QVariant(),
+            state[UndoJournal::Status] == "Completed", stamp(UndoJournal::CompletedAt),
+            stamp(UndoJournal::CreatedAt)};
+}
+
+bool MainWindow::applyJournalEntry(const UndoJournal::Entry &entry, bool undo)
+{
+    if (!db.isOpen()) return false;
+    QString action = undo ? "Undo" : "Redo";
+
+    // État visé par tâche : valeurs "avant" pour annuler, "après" pour rétablir
+    struct Target
+    {
+        QString currentId;
+        QHash<int, QString> fields;
+    };
+    QVector<Target> targets;
+    QHash<QString, int> targetIndex;
+    for (const UndoJournal::Change &change : entry.changes) {
+        auto it = targetIndex.find(change.taskId);
+        if (it == targetIndex.end()) {
+            it = targetIndex.insert(change.taskId, targets.size());
+            targets.append({change.taskId, {}});
+        }
+        Target &target = targets[it.value()];
+        target.fields.insert(change.field, undo ? change.before : change.after);
+        if (undo && change.field == UndoJournal::Id) target.currentId = change.after;
+    }
+
+    QHash<QString, int> rowOf;
+    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+        if (!isOccurrenceRow(row)) rowOf.insert(ui->taskTable->item(row, 0)->text(), row);
+    }
+
+    // Tout est vérifié avant d'écrire : la table a pu changer hors journal depuis
+    QVariantList removed;
+    QVector<int> updatedRows;
+    QVector<QStringList> updated;
+    QVector<QStringList> inserted;
+    QStringList previousIds;
+    QVector<bool> described;
+    QVariantList linkedIds, predecessors, successors;
+    for (const Target &target : targets) {
+        int row = rowOf.value(target.currentId, -1);
+        bool existence = target.fields.contains(UndoJournal::Exists);
+        bool exists = existence ? !target.fields.value(UndoJournal::Exists).isEmpty() : row >= 0;
+
+        QString conflict;
+        if (!existence && row < 0) {
+            conflict = QString("task %1 no longer exists").arg(target.currentId);
+        } else if (existence && exists && row >= 0) {
+            conflict = QString("task %1 already exists").arg(target.currentId);
+        }
+        if (!conflict.isEmpty()) {
+            forgetUndoHistory(QString("Cannot %1 \"%2\": %3").arg(action.toLower(), entry.label, conflict));
+            return false;
+        }
+
+        if (!exists) {
+            if (row >= 0) removed << target.currentId;
+            continue;
+        }
+
+        QStringList state = row >= 0 ? journalState(row, false) : UndoJournal::emptyState();
+        for (auto it = target.fields.constBegin(); it != target.fields.constEnd(); ++it) {
+            if (it.key() != UndoJournal::Exists) state[it.key()] = it.value();
+        }
+        if (!projects.tree().contains(state[UndoJournal::Project].toInt())) {
+            state[UndoJournal::Project].clear();      // projet supprimé entre-temps
+        }
+
+        if (row >= 0) {
+            updatedRows << row;
+            updated << state;
+            previousIds << target.currentId;
+            described << target.fields.contains(UndoJournal::Description);
+        } else {
+            inserted << state;
+        }
+
+        if (target.fields.contains(UndoJournal::Predecessors) || row < 0) {
+            QString taskId = state[UndoJournal::Id];
+            linkedIds << taskId;
+            const QStringList links = state[UndoJournal::Predecessors].split(QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts);
+            for (const QString &predecessor : links) {
+                predecessors << predecessor;
+                successors << taskId;
+            }
+        }
+    }
+
+    // Une transaction, requêtes préparées exécutées en lot comme les traitements de masse
+    QList<QVariantList> updateColumns(15), insertColumns(17), descriptionColumns(3);
+    QVariantList renamedFrom, renamedTo;
+    for (int i = 0; i < updated.size(); ++i) {
+        QVariantList values = journalRowValues(updated[i]);
+        int column = 0;
+        for (int field : {0, 1, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}) {
+            updateColumns[column++] << values[field];
+        }
+        updateColumns[column] << previousIds[i];
+
+        if (previousIds[i] != updated[i][UndoJournal::Id]) {
+            renamedFrom << previousIds[i];
+            renamedTo << updated[i][UndoJournal::Id];
+        }
+        if (described[i]) {
+            descriptionColumns[0] << values[2];
+            descriptionColumns[1] << values[3];
+            descriptionColumns[2] << updated[i][UndoJournal::Id];
+        }
+    }
+    for (const QStringList &state : inserted) {
+        QVariantList values = journalRowValues(state);
+        for (int field = 0; field < values.size(); ++field) {
+            insertColumns[field] << values[field];
+        }
+    }
+
+    QSqlQuery query(db);
+    bool ok = db.transaction();
+    if (ok && !removed.isEmpty()) {
+        ok = execBatch(query, "DELETE FROM tasks WHERE id = ?", {removed}) &&
+             execBatch(query, "DELETE FROM task_dependencies WHERE predecessor_id = ? OR successor_id = ?", {removed, removed});
+    }
+    if (ok && !updated.isEmpty()) {
+        ok = execBatch(query, "UPDATE tasks SET id = ?, name = ?, status = ?, priority = ?, start_date = ?, end_date = ?, "
+                              "assigned_to = ?, project_id = ?, planned_cost = ?, actual_cost = ?, latitude = ?, longitude = ?, "
+                              "completed_at = CASE WHEN ? THEN COALESCE(?, completed_at, CURRENT_TIMESTAMP) END, "
+                              "updated_at = CURRENT_TIMESTAMP WHERE id = ?",
+                       updateColumns);
+    }
+    if (ok && !renamedFrom.isEmpty()) {
+        ok = execBatch(query, "UPDATE task_dependencies SET predecessor_id = ? WHERE predecessor_id = ?", {renamedTo, renamedFrom}) &&
+             execBatch(query, "UPDATE task_dependencies SET successor_id = ? WHERE successor_id = ?", {renamedTo, renamedFrom}) &&
+             execBatch(query, "UPDATE movement_tasks SET task_id = ? WHERE task_id = ?", {renamedTo, renamedFrom}) &&
+             execBatch(query, "UPDATE invoices SET task_id = ? WHERE task_id = ?", {renamedTo, renamedFrom});
+    }
+    if (ok && !descriptionColumns[0].isEmpty()) {
+        ok = execBatch(query, "UPDATE tasks SET description = ?, description_z = ? WHERE id = ?", descriptionColumns);
+    }
+    // Tâche supprimée puis rétablie : mêmes dates de création et d'achèvement qu'avant
+    if (ok && !inserted.isEmpty()) {
+        ok = execBatch(query, "INSERT INTO tasks (id, name, description, description_z, status, priority, start_date, end_date, "
+                              "assigned_to, project_id, planned_cost, actual_cost, latitude, longitude, completed_at, created_at) "
+                              "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, "
+                              "CASE WHEN ? THEN COALESCE(?, CURRENT_TIMESTAMP) END, COALESCE(?, CURRENT_TIMESTAMP))",
+                       insertColumns);
+    }
+    if (ok && !linkedIds.isEmpty()) {
+        ok = execBatch(query, "DELETE FROM task_dependencies WHERE successor_id = ?", {linkedIds}) &&
+             (predecessors.isEmpty() ||
+              execBatch(query, "INSERT INTO task_dependencies (predecessor_id, successor_id) VALUES (?, ?)",
+                        {predecessors, successors}));
+    }
+    if (!ok || !db.commit()) {
+        QString message = query.lastError().isValid() ? query.lastError().text() : db.lastError().text();
+        db.rollback();
+        notifications->error("Database Error", QString("%1 failed: %2").arg(action, message));
+        return false;
+    }
+
+    // Mémoire mise à jour après la validation seulement
+    auto refreshTask = [this](int row, const QStringList &state) {
+        QString taskId = state[UndoJournal::Id];
+        updateWorkload(state.mid(0, 8));
+        QDate completedOn = QDate::fromString(state[UndoJournal::CompletedAt].left(10), "yyyy-MM-dd");
+        if (!completedOn.isValid()) completedOn = QDate::currentDate();
+        trends.setTask(taskId, QDate::fromString(state[UndoJournal::CreatedAt].left(10), "yyyy-MM-dd"),
+                       state[UndoJournal::Status] == "Completed" ? completedOn : QDate(),
+                       QDate::fromString(state[UndoJournal::EndDate], "yyyy-MM-dd"));
+        projects.trackTask(taskId, state[UndoJournal::Project].toInt(),
+                           state[UndoJournal::PlannedCost].toDouble(), state[UndoJournal::ActualCost].toDouble());
+        QPointF site;
+        if (SpatialIndex::parseCoordinates(state[UndoJournal::Site], &site)) {
+            sites.insert(taskId, QString("%1 - %2").arg(taskId, state[UndoJournal::Name]), site);
+        } else {
+            sites.remove(taskId);
+        }
+        setVarianceCell(row);
+    };
+
+    ui->taskTable->setUpdatesEnabled(false);
+    for (int i = 0; i < updated.size(); ++i) {
+        int row = updatedRows[i];
+        const QStringList &state = updated[i];
+        QString oldId = previousIds[i];
+        QString taskId = state[UndoJournal::Id];
+        if (oldId != taskId) {
+            workload.removeTask(oldId);
+            trends.renameTask(oldId, taskId);
+            projects.renameTask(oldId, taskId);
+            attachments.renameTask(oldId, taskId);
+            sites.rename(oldId, taskId);
+            descriptions.invalidate(oldId);
+            QString timeError;
+            if (!timeTracker->renameTask(oldId, taskId, &timeError)) {
+                qWarning() << "Failed to rename tracked time of" << oldId << timeError;
+            }
+        }
+        for (int col = 0; col < 8; ++col) {
+            if (col != 2) ui->taskTable->item(row, col)->setText(state[col]);
+        }
+        if (described[i]) {
+            setDescriptionCell(row, state[UndoJournal::Description]);
+            descriptions.invalidate(taskId);
+            descriptions.store(taskId, state[UndoJournal::Description]);
+        }
+        refreshTask(row, state);
+    }
+
+    for (const QStringList &state : inserted) {
+        int row = ui->taskTable->rowCount();
+        ui->taskTable->insertRow(row);
+        for (int col = 0; col < 8; ++col) {
+            if (col == 2) {
+                setDescriptionCell(row, state[col]);
+            } else {
+                ui->taskTable->setItem(row, col, new QTableWidgetItem(state[col]));
+            }
+        }
+        ui->taskTable->setItem(row, 8, new QTableWidgetItem());
+        descriptions.store(state[UndoJournal::Id], state[UndoJournal::Description]);
+        refreshTask(row, state);
+    }
+
+    // Suppressions en dernier : les lignes ajoutées ci-dessus sont en fin de table
+    QVector<int> removedRows;
+    for (const QVariant &id : removed) {
+        QString taskId = id.toString();
+        removedRows << rowOf.value(taskId);
+        descriptions.invalidate(taskId);
+        workload.removeTask(taskId);
+        trends.removeTask(taskId);
+        projects.removeTask(taskId);
+        detachedAttachments.insert(taskId);
+        sites.remove(taskId);
+        timeTracker->stopTask(taskId, action.toLower());
+    }
+    std::sort(removedRows.begin(), removedRows.end(), std::greater<int>());
+    for (int row : removedRows) {
+        ui->taskTable->removeRow(row);
+    }
+
+    // Liens relus de la base et un seul calcul du chemin critique
+    loadDependencies();
+    ui->taskTable->setUpdatesEnabled(true);
+
+    fuzzyIndexDirty = true;
+    rebuildAnalytics();
+    history.maybeSnapshot();
+    updateCharts();
+    return true;
+}
+
+void MainWindow::updateWorkload(const QStringList &taskData)
+{
+    // Une tâche terminée ne compte plus dans la charge de la personne
+    if (taskData[3] == "Completed") {
+        workload.removeTask(taskData[0]);
+        return;
+    }
+    workload.updateTask(taskData[0], taskData[7],
+                        QDate::fromString(taskData[5], "yyyy-MM-dd"),
+                        QDate::fromString(taskData[6], "yyyy-MM-dd"));
+}
+
+void MainWindow::rebuildAnalytics()
+{
+    analytics.rebuild(allTaskRecords());
+}
+
+QStringList MainWindow::workloadAlerts(const QDate &from, const QDate &to)
+{
+    QStringList alerts;
+    for (const WorkloadEngine::Overload &overload : workload.overloaded(workloadLimit, from, to)) {
+        alerts << QString("• Overbooked: %1 (%2 concurrent tasks, %3 to %4)")
+                      .arg(overload.assignee)
+                      .arg(overload.peak)
+                      .arg(overload.from.toString("yyyy-MM-dd"), overload.to.toString("yyyy-MM-dd"));
+    }
+    return alerts;
+}
+
+QString MainWindow::fullDescription(int row)
+{
+    QTableWidgetItem *item = ui->taskTable->item(row, 2);
+    if (!item) return QString();
+    if (!item->data(Qt::UserRole).toBool()) return item->text();
+    if (isOccurrenceRow(row)) {
+        int seriesId = 0;
+        RecurrenceStore::parseOccurrenceId(ui->taskTable->item(row, 0)->text(), &seriesId, nullptr);
+        return recurrence.seriesById(seriesId).description;
+    }
+
+    return descriptions.fullText(ui->taskTable->item(row, 0)->text());
+}
+
+void MainWindow::setDescriptionCell(int row, const QString &text)
+{
+    bool truncated = text.size() > DescriptionStore::PreviewLength;
+    QTableWidgetItem *item = ui->taskTable->item(row, 2);
+    if (!item) {
+        item = new QTableWidgetItem();
+        ui->taskTable->setItem(row, 2, item);
+    }
+    item->setText(DescriptionStore::previewText(text, truncated));
+    item->setData(Qt::UserRole, truncated);
+}
+
+TaskRecord MainWindow::taskRecordAt(int row) const
+{
+    TaskRecord task;
+    task.id = ui->taskTable->item(row, 0)->text();
+    task.name = ui->taskTable->item(row, 1)->text();
+    task.status = ui->taskTable->item(row, 3)->text();
+    task.priority = ui->taskTable->item(row, 4)->text();
+    task.startDate = QDate::fromString(ui->taskTable->item(row, 5)->text(), "yyyy-MM-dd");
+    task.endDate = QDate::fromString(ui->taskTable->item(row, 6)->text(), "yyyy-MM-dd");
+    task.assignedTo = ui->taskTable->item(row, 7)->text();
+    return task;
+}
+
+QVector<TaskRecord> MainWindow::allTaskRecords() const
+{
+    QVector<TaskRecord> tasks;
+    tasks.reserve(ui->taskTable->rowCount());
+    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+        if (isOccurrenceRow(row)) continue;    // pas encore une tâche : hors statistiques
+        tasks << taskRecordAt(row);
+    }
+    return tasks;
+}
+
+QStringList MainWindow::taskCellsForRow(int row) const
+{
+    // Aperçu de la description seulement : aucune lecture en base, pour les traitements de masse
+    QStringList taskData;
+    for (int col = 0; col < 8; ++col) {
+        taskData << ui->taskTable->item(row, col)->text();
+    }
+    return taskData;
+}
+
+QStringList MainWindow::taskDataForRow(int row)
+{
+    QStringList taskData;
+    for (int col = 0; col < 8; ++col) {
+        taskData << (col == 2 ? fullDescription(row) : ui->taskTable->item(row, col)->text());
+    }
+    return taskData;
+}
+
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == ui->taskTable->viewport() && event->type() == QEvent::ToolTip) {
+        QHelpEvent *helpEvent = static_cast<QHelpEvent*>(event);
+        QTableWidgetItem *item = ui->taskTable->itemAt(helpEvent->pos());
+
+        if (item && item->column() == 2 && item->data(Qt::UserRole).toBool()) {
+            QString text = fullDescription(item->row());
+            if (text.size() > 2000) {
+                text = text.left(2000) + QChar(0x2026);
+            }
+            QToolTip::showText(helpEvent->globalPos(), text, ui->taskTable->viewport());
+            return true;
+        }
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::setupTaskTable()
+{
+    ui->taskTable->setColumnCount(10);
+    QStringList headers = {"ID", "Name", "Description", "Status", "Priority", "Start Date", "End Date", "Assigned To", "Slack", "Variance"};
+    ui->taskTable->setHorizontalHeaderLabels(headers);
     ui->taskTable->horizontalHeader()->setStretchLastSection(true);
     ui->taskTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    ui->taskTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    // Sélection multiple pour les actions de masse (menu Bulk)
+    ui->taskTable->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    ui->taskTable->viewport()->installEventFilter(this);
+
+    highlightDelegate = new FuzzyHighlightDelegate(this);
+    ui->taskTable->setItemDelegate(highlightDelegate);
 }
 
 void MainWindow::setupCalendar()
@@ -426,6 +1790,15 @@ void MainWindow::setupCalendar()
     calendarWidget->setWindowFlags(Qt::Window);
     calendarWidget->setWindowTitle("Task Calendar");
     calendarWidget->resize(600, 400);
+    connect(calendarWidget, &QCalendarWidget::currentPageChanged, this, &MainWindow::paintCalendarOccurrences);
+}
+
+void MainWindow::setupTimeline()
+{
+    ganttView = new GanttView();
+    ganttView->setWindowFlags(Qt::Window);
+    ganttView->setWindowTitle("Project Timeline (Ctrl + wheel to zoom)");
+    ganttView->resize(1200, 600);
 }
 
 void MainWindow::setupSystemTray()
@@ -473,7 +1846,7 @@ void MainWindow::on_notificationBtn_clicked()
 void MainWindow::checkDeadlineNotifications()
 {
     if (!trayIcon || !trayIcon->isVisible()) {
-        QMessageBox::warning(this, "Notifications", "System tray not available. Notifications will not be shown.");
+        notifications->warning("Notifications", "System tray not available. Deadline alerts will not be shown.");
         return;
     }
 
@@ -500,10 +1873,35 @@ void MainWindow::checkDeadlineNotifications()
                     nearDeadlineTasks << QString("• Overdue: %1 (Status: %2)").arg(taskName, status);
                     nearDeadlineCount++;
                 }
+
+                // Chemin critique : retard induit par les dépendances ou marge nulle
+                TaskGraph::Schedule schedule = taskGraph.schedule(ui->taskTable->item(row, 0)->text());
+                if (schedule.linked && status != "Completed") {
+                    if (schedule.earlyFinish > endDate) {
+                        nearDeadlineTasks << QString("• At risk: %1 (dependencies push finish to %2)")
+                                                 .arg(taskName, schedule.earlyFinish.toString("yyyy-MM-dd"));
+                        nearDeadlineCount++;
+                    } else if (schedule.critical && endDate > tomorrow && endDate <= today.addDays(7)) {
+                        nearDeadlineTasks << QString("• Critical path: %1 (due %2, no slack)")
+                                                 .arg(taskName, endDate.toString("yyyy-MM-dd"));
+                        nearDeadlineCount++;
+                    }
+                }
             }
         }
     }
 
+    // Personnes surchargées sur les deux prochaines semaines
+    QStringList overbooked = workloadAlerts(today, today.addDays(13));
+    nearDeadlineTasks << overbooked;
+    nearDeadlineCount += overbooked.size();
+
+    for (const MaterialsStore::Material &material : materials.lowStock()) {
+        nearDeadlineTasks << QString("• Low stock: %1 (%2 %3 left)")
+                                 .arg(material.name, QString::number(material.quantity, 'f', 2), material.unit);
+        nearDeadlineCount++;
+    }
+
     if (nearDeadlineCount > 0) {
         QString message = QString("You have %1 task(s) with deadlines:\n%2")
         .arg(nearDeadlineCount)
@@ -535,6 +1933,28 @@ void MainWindow::handleNavButtonClick(QAbstractButton* clickedButton)
 
     if (clickedButton == ui->navCalendarBtn) {
         showCalendar();
+    } else if (clickedButton == ui->navTimelineBtn) {
+        showTimeline();
+    } else if (clickedButton == ui->navWorkloadBtn) {
+        showWorkload();
+    } else if (clickedButton == ui->navMaterialsBtn) {
+        showMaterials();
+    } else if (clickedButton == ui->navProjectsBtn) {
+        showProjects();
+    } else if (clickedButton == ui->navMapBtn) {
+        showMap();
+    } else if (clickedButton == ui->navHistoryBtn) {
+        showHistory();
+    } else if (clickedButton == ui->navBackupsBtn) {
+        showBackups();
+    } else if (clickedButton == ui->navArchiveBtn) {
+        showArchive();
+    } else if (clickedButton == ui->navRecurringBtn) {
+        showRecurring();
+    } else if (clickedButton == ui->navTimesheetBtn) {
+        showTimesheet();
+    } else if (clickedButton == ui->navNotificationsBtn) {
+        showNotificationHistory();
     }
 }
 
@@ -555,112 +1975,12 @@ void MainWindow::on_navStatsBtn_clicked()
 
 QChart* MainWindow::createStatusPieChart()
 {
-    QMap<QString, int> statusCounts;
-    int totalTasks = 0;
-
-    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
-        QString status = ui->taskTable->item(row, 3)->text();
-        statusCounts[status]++;
-        totalTasks++;
-    }
-
-    if (totalTasks == 0) {
-        return nullptr;
-    }
-
-    QPieSeries *series = new QPieSeries();
-    for (auto it = statusCounts.begin(); it != statusCounts.end(); ++it) {
-        double percentage = (it.value() * 100.0) / totalTasks;
-        QPieSlice *slice = series->append(
-            QString("%1\n%2/%3 (%4%)")
-                .arg(it.key())
-                .arg(it.value())
-                .arg(totalTasks)
-                .arg(QString::number(percentage, 'f', 1)),
-            it.value()
-            );
-
-        slice->setLabelVisible();
-        slice->setLabelArmLengthFactor(0.3);
-        slice->setLabelPosition(QPieSlice::LabelOutside);
-    }
-
-    QChart *chart = new QChart();
-    chart->addSeries(series);
-    chart->setTitle(QString("Task Distribution by Status\nTotal Tasks: %1").arg(totalTasks));
-    chart->legend()->setAlignment(Qt::AlignRight);
-    chart->legend()->setMarkerShape(QLegend::MarkerShapeRectangle);
-
-    chart->setTitleFont(QFont("Arial", 12, QFont::Bold));
-    chart->legend()->setFont(QFont("Arial", 9));
-
-    return chart;
+    return ChartRenderer::createChart(ChartRenderer::statusSpec(allTaskRecords()));
 }
 
 QChart* MainWindow::createDurationBarChart()
 {
-    QMap<QString, int> durationCategories;
-    int totalTasks = 0;
-
-    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
-        QTableWidgetItem* startItem = ui->taskTable->item(row, 5);
-        QTableWidgetItem* endItem = ui->taskTable->item(row, 6);
-
-        if (startItem && endItem && !startItem->text().isEmpty() && !endItem->text().isEmpty()) {
-            QDate startDate = QDate::fromString(startItem->text(), "yyyy-MM-dd");
-            QDate endDate = QDate::fromString(endItem->text(), "yyyy-MM-dd");
-
-            if (startDate.isValid() && endDate.isValid()) {
-                int days = startDate.daysTo(endDate) + 1;
-
-                QString category;
-                if (days <= 1) category = "1 day";
-                else if (days <= 7) category = "2-7 days";
-                else if (days <= 30) category = "1-4 weeks";
-                else category = "1+ months";
-
-                durationCategories[category]++;
-                totalTasks++;
-            }
-        }
-    }
-
-    if (durationCategories.isEmpty()) {
-        return nullptr;
-    }
-
-    QBarSeries *series = new QBarSeries();
-    QBarSet *barSet = new QBarSet("Tasks");
-
-    QStringList categories = {"1 day", "2-7 days", "1-4 weeks", "1+ months"};
-    int maxCount = 0;
-
-    for (const QString& category : categories) {
-        int count = durationCategories.value(category, 0);
-        *barSet << count;
-        if (count > maxCount) maxCount = count;
-    }
-
-    QChart *chart = new QChart();
-    chart->addSeries(series);
-    chart->setTitle(QString("Task Duration Distribution\nTotal Tasks: %1").arg(totalTasks));
-
-    series->append(barSet);
-    barSet->setColor(QColor(32, 159, 223));
-
-    QBarCategoryAxis *axisX = new QBarCategoryAxis();
-    axisX->append(categories);
-    chart->addAxis(axisX, Qt::AlignBottom);
-    series->attachAxis(axisX);
-
-    QValueAxis *axisY = new QValueAxis();
-    axisY->setRange(0, maxCount + 2);
-    axisY->setTitleText("Number of Tasks");
-    axisY->setLabelFormat("%d");
-    chart->addAxis(axisY, Qt::AlignLeft);
-    series->attachAxis(axisY);
-
-    return chart;
+    return ChartRenderer::createChart(ChartRenderer::durationSpec(allTaskRecords()));
 }
 
 void MainWindow::on_showStatusStats_clicked()
@@ -691,15 +2011,8 @@ void MainWindow::on_showStatusStats_clicked()
         "}"
         );
 
-    connect(exportBtn, &QPushButton::clicked, [chartView]() {
-        QString fileName = QFileDialog::getSaveFileName(nullptr,
-                                                        "Save Chart as Image", "", "PNG Images (*.png);;JPEG Images (*.jpg *.jpeg)");
-
-        if (!fileName.isEmpty()) {
-            QPixmap p = chartView->grab();
-            p.save(fileName);
-            QMessageBox::information(nullptr, "Success", "Chart exported successfully!");
-        }
+    connect(exportBtn, &QPushButton::clicked, [this]() {
+        exportChart(ChartRenderer::statusSpec(allTaskRecords()));
     });
 
     QPushButton *closeBtn = new QPushButton("Close", dialog);
@@ -771,14 +2084,8 @@ void MainWindow::on_showDurationStats_clicked()
         "}"
         );
 
-    connect(exportBtn, &QPushButton::clicked, [chartView]() {
-        QString fileName = QFileDialog::getSaveFileName(nullptr,
-                                                        "Save Chart", "", "PNG Images (*.png);;JPEG Images (*.jpg *.jpeg)");
-        if (!fileName.isEmpty()) {
-            QPixmap p = chartView->grab();
-            p.save(fileName);
-            QMessageBox::information(nullptr, "Success", "Chart exported successfully!");
-        }
+    connect(exportBtn, &QPushButton::clicked, [this]() {
+        exportChart(ChartRenderer::durationSpec(allTaskRecords()));
     });
 
     connect(closeBtn, &QPushButton::clicked, dialog, &QDialog::accept);
@@ -796,44 +2103,378 @@ void MainWindow::on_showDurationStats_clicked()
     delete dialog;
 }
 
-void MainWindow::on_addBtn_clicked() {
-    QDialog dialog(this);
-    QFormLayout form(&dialog);
-    dialog.setWindowTitle("Add New Task");
+void MainWindow::on_showTrendStats_clicked()
+{
+    if (trends.isEmpty()) {
+        QMessageBox::warning(this, "No Data", "No tasks available for statistics");
+        return;
+    }
 
-    QStringList labels = {"Task ID:", "Name:", "Description:", "Status:", "Priority:",
-                          "Start Date (YYYY-MM-DD):", "End Date (YYYY-MM-DD):", "Assigned To:"};
-    QList<QLineEdit*> fields;
-    QList<QComboBox*> combos;
+    QDialog *dialog = new QDialog(this);
+    dialog->setWindowTitle("Task Trends");
+    dialog->resize(900, 650);
 
-    for (int i = 0; i < labels.size(); ++i) {
-        if (i == 3 || i == 4) {
-            QComboBox *combo = new QComboBox(&dialog);
-            if (i == 3) {
-                combo->addItems({"Not Started", "In Progress", "Completed", "On Hold"});
-            } else {
-                combo->addItems({"Low", "Medium", "High", "Critical"});
-            }
-            form.addRow(labels[i], combo);
-            combos << combo;
-        } else {
-            QLineEdit *lineEdit = new QLineEdit(&dialog);
-            form.addRow(labels[i], lineEdit);
-            fields << lineEdit;
+    QComboBox *kindCombo = new QComboBox(dialog);
+    kindCombo->addItems({"Burndown", "Cumulative Flow", "Weekly Throughput"});
 
-            if (i == 0) {
-                lineEdit->setMaxLength(10);
-                lineEdit->setPlaceholderText("T001");
-            }
-            else if (i == 5 || i == 6) {
-                lineEdit->setPlaceholderText("2023-12-31");
-            }
-        }
-    }
+    // Les curseurs sont exprimés en jours depuis la première tâche
+    QDate today = QDate::currentDate();
+    QDate firstDate = qMin(trends.firstDate(), today);
+    int span = int(firstDate.daysTo(qMax(trends.lastDate(), today)));
 
-    QDialogButtonBox buttonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel,
-                               Qt::Horizontal, &dialog);
-    form.addRow(&buttonBox);
+    QSlider *fromSlider = new QSlider(Qt::Horizontal, dialog);
+    fromSlider->setRange(0, span);
+    fromSlider->setValue(qMax(0, int(firstDate.daysTo(today.addDays(-60)))));
+    QSlider *toSlider = new QSlider(Qt::Horizontal, dialog);
+    toSlider->setRange(0, span);
+    toSlider->setValue(span);
+    QLabel *rangeLabel = new QLabel(dialog);
+
+    QChart *chart = new QChart();
+    chart->legend()->setAlignment(Qt::AlignBottom);
+    QChartView *chartView = new QChartView(chart);
+    chartView->setRenderHint(QPainter::Antialiasing);
+
+    auto redraw = [this, chart, kindCombo, fromSlider, toSlider, rangeLabel, firstDate]() {
+        QDate from = firstDate.addDays(qMin(fromSlider->value(), toSlider->value()));
+        QDate to = firstDate.addDays(qMax(fromSlider->value(), toSlider->value()));
+        rangeLabel->setText(QString("%1 to %2").arg(from.toString("yyyy-MM-dd"), to.toString("yyyy-MM-dd")));
+
+        chart->removeAllSeries();
+        for (QAbstractAxis *axis : chart->axes()) {
+            chart->removeAxis(axis);
+            delete axis;
+        }
+
+        // Au plus ~200 points par courbe, chacun calculé en O(log n)
+        int days = int(from.daysTo(to)) + 1;
+        int step = qMax(1, days / 200);
+        QList<QDate> samples;
+        for (int d = 0; d < days; d += step) {
+            samples << from.addDays(d);
+        }
+        if (samples.last() != to) samples << to;
+
+        int maxValue = 1;
+        auto point = [&maxValue](QLineSeries *series, const QDate &date, int value) {
+            series->append(date.startOfDay().toMSecsSinceEpoch(), value);
+            maxValue = qMax(maxValue, value);
+        };
+
+        QList<QLineSeries*> series;
+        if (kindCombo->currentIndex() == 0) {
+            QLineSeries *open = new QLineSeries;
+            open->setName("Open tasks");
+            for (const QDate &date : samples) {
+                point(open, date, trends.openAt(date));
+            }
+            QLineSeries *ideal = new QLineSeries;
+            ideal->setName("Ideal");
+            point(ideal, from, trends.openAt(from));
+            point(ideal, to, 0);
+            series << open << ideal;
+            chart->setTitle("Burndown");
+        } else if (kindCombo->currentIndex() == 1) {
+            QLineSeries *created = new QLineSeries;
+            created->setName("Created");
+            QLineSeries *completed = new QLineSeries;
+            completed->setName("Completed");
+            QLineSeries *due = new QLineSeries;
+            due->setName("Due");
+            for (const QDate &date : samples) {
+                point(created, date, trends.createdUpTo(date));
+                point(completed, date, trends.completedUpTo(date));
+                point(due, date, trends.dueUpTo(date));
+            }
+            series << created << completed << due;
+            chart->setTitle("Cumulative Flow");
+        } else {
+            QLineSeries *created = new QLineSeries;
+            created->setName("Created per week");
+            QLineSeries *completed = new QLineSeries;
+            completed->setName("Completed per week");
+            for (QDate week = from; week <= to; week = week.addDays(7)) {
+                QDate weekEnd = qMin(week.addDays(6), to);
+                point(created, week, trends.createdUpTo(weekEnd) - trends.createdUpTo(week.addDays(-1)));
+                point(completed, week, trends.completedBetween(week, weekEnd));
+            }
+            series << created << completed;
+            chart->setTitle("Weekly Throughput");
+        }
+
+        QDateTimeAxis *axisX = new QDateTimeAxis;
+        axisX->setFormat("MMM dd");
+        axisX->setTickCount(8);
+        axisX->setRange(from.startOfDay(), to.startOfDay());
+        QValueAxis *axisY = new QValueAxis;
+        axisY->setLabelFormat("%d");
+        axisY->setRange(0, maxValue);
+        axisY->applyNiceNumbers();
+
+        chart->addAxis(axisX, Qt::AlignBottom);
+        chart->addAxis(axisY, Qt::AlignLeft);
+        for (QLineSeries *line : series) {
+            chart->addSeries(line);
+            line->attachAxis(axisX);
+            line->attachAxis(axisY);
+        }
+    };
+
+    connect(kindCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), dialog, redraw);
+    connect(fromSlider, &QSlider::valueChanged, dialog, redraw);
+    connect(toSlider, &QSlider::valueChanged, dialog, redraw);
+    redraw();
+
+    QFormLayout *rangeLayout = new QFormLayout;
+    rangeLayout->addRow("Chart:", kindCombo);
+    rangeLayout->addRow("From:", fromSlider);
+    rangeLayout->addRow("To:", toSlider);
+    rangeLayout->addRow("Period:", rangeLabel);
+
+    QPushButton *closeBtn = new QPushButton("Close", dialog);
+    closeBtn->setStyleSheet(
+        "QPushButton {"
+        "   background: #e74c3c;"
+        "   color: white;"
+        "   padding: 8px;"
+        "   border-radius: 4px;"
+        "}"
+        "QPushButton:hover {"
+        "   background: #c0392b;"
+        "}"
+        );
+    connect(closeBtn, &QPushButton::clicked, dialog, &QDialog::accept);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(dialog);
+    mainLayout->addLayout(rangeLayout);
+    mainLayout->addWidget(chartView, 1);
+    mainLayout->addWidget(closeBtn, 0, Qt::AlignRight);
+
+    dialog->exec();
+    delete dialog;
+}
+
+void MainWindow::on_showPivotStats_clicked()
+{
+    // Le nombre de tâches en retard change avec la date du jour
+    if (analytics.isStale()) {
+        rebuildAnalytics();
+    }
+
+    QDialog *dialog = new QDialog(this);
+    dialog->setWindowTitle("Task Pivot");
+    dialog->resize(1000, 650);
+
+    QComboBox *rowsCombo = new QComboBox(dialog);
+    QComboBox *columnsCombo = new QComboBox(dialog);
+    for (int d = 0; d < AnalyticsCube::DimensionCount; ++d) {
+        rowsCombo->addItem(AnalyticsCube::dimensionName(AnalyticsCube::Dimension(d)));
+        columnsCombo->addItem(AnalyticsCube::dimensionName(AnalyticsCube::Dimension(d)));
+    }
+    rowsCombo->setCurrentIndex(AnalyticsCube::Assignee);
+    columnsCombo->setCurrentIndex(AnalyticsCube::Month);
+
+    QComboBox *measureCombo = new QComboBox(dialog);
+    for (AnalyticsCube::Measure measure : {AnalyticsCube::Count, AnalyticsCube::Overdue, AnalyticsCube::AverageDays}) {
+        measureCombo->addItem(AnalyticsCube::measureName(measure));
+    }
+
+    // Portefeuille complet : base active et archives lues en parallèle, à la demande
+    QCheckBox *archiveCheck = new QCheckBox("Include archive", dialog);
+    AnalyticsCube portfolio;
+    bool portfolioBuilt = false;
+
+    QLabel *filterLabel = new QLabel(dialog);
+    QPushButton *rollUpBtn = new QPushButton("Roll Up", dialog);
+    QPushButton *exportBtn = new QPushButton("Export CSV", dialog);
+
+    QTableWidget *table = new QTableWidget(dialog);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setToolTip("Double-click a cell to drill down");
+
+    // État de la navigation, valable tant que le dialogue est ouvert
+    QHash<int, QString> filters;
+    QList<QPair<QHash<int, QString>, int>> history;
+    AnalyticsCube::Pivot current;
+
+    auto refresh = [&]() {
+        const AnalyticsCube &cube = archiveCheck->isChecked() ? portfolio : analytics;
+        current = cube.pivot(AnalyticsCube::Dimension(rowsCombo->currentIndex()),
+                             AnalyticsCube::Dimension(columnsCombo->currentIndex()), filters);
+        AnalyticsCube::Measure measure = AnalyticsCube::Measure(measureCombo->currentIndex());
+        auto format = [measure](const AnalyticsCube::Measures &measures) {
+            return measure == AnalyticsCube::AverageDays ? QString::number(measures.value(measure), 'f', 1)
+                                                         : QString::number(int(measures.value(measure)));
+        };
+
+        table->clear();
+        table->setRowCount(current.rowLabels.size() + 1);
+        table->setColumnCount(current.columnLabels.size() + 1);
+        table->setHorizontalHeaderLabels(current.columnLabels + QStringList("Total"));
+        table->setVerticalHeaderLabels(current.rowLabels + QStringList("Total"));
+
+        for (int r = 0; r < current.rowLabels.size(); ++r) {
+            for (int c = 0; c < current.columnLabels.size(); ++c) {
+                table->setItem(r, c, new QTableWidgetItem(format(current.cells[r][c])));
+            }
+            table->setItem(r, current.columnLabels.size(), new QTableWidgetItem(format(current.rowTotals[r])));
+        }
+        for (int c = 0; c < current.columnLabels.size(); ++c) {
+            table->setItem(current.rowLabels.size(), c, new QTableWidgetItem(format(current.columnTotals[c])));
+        }
+        table->setItem(current.rowLabels.size(), current.columnLabels.size(), new QTableWidgetItem(format(current.total)));
+
+        QStringList parts;
+        for (auto it = filters.constBegin(); it != filters.constEnd(); ++it) {
+            parts << QString("%1 = %2").arg(AnalyticsCube::dimensionName(AnalyticsCube::Dimension(it.key())), it.value());
+        }
+        QString scope = archiveCheck->isChecked() ? QString("All tasks, archive included") : QString("All tasks");
+        filterLabel->setText(parts.isEmpty() ? scope : parts.join(", "));
+        rollUpBtn->setEnabled(!history.isEmpty());
+    };
+
+    // Descente : la cellule devient un filtre et les lignes passent à la prochaine dimension libre
+    connect(table, &QTableWidget::cellDoubleClicked, dialog, [&](int row, int column) {
+        history << qMakePair(filters, rowsCombo->currentIndex());
+        if (row < current.rowLabels.size()) filters.insert(current.rows, current.rowLabels[row]);
+        if (column < current.columnLabels.size()) filters.insert(current.columns, current.columnLabels[column]);
+
+        for (int d = 0; d < AnalyticsCube::DimensionCount; ++d) {
+            if (!filters.contains(d) && d != columnsCombo->currentIndex()) {
+                QSignalBlocker blocker(rowsCombo);
+                rowsCombo->setCurrentIndex(d);
+                break;
+            }
+        }
+        refresh();
+    });
+
+    connect(rollUpBtn, &QPushButton::clicked, dialog, [&]() {
+        if (history.isEmpty()) return;
+        QPair<QHash<int, QString>, int> previous = history.takeLast();
+        filters = previous.first;
+        QSignalBlocker blocker(rowsCombo);
+        rowsCombo->setCurrentIndex(previous.second);
+        refresh();
+    });
+
+    connect(exportBtn, &QPushButton::clicked, dialog, [&]() {
+        QString fileName = QFileDialog::getSaveFileName(dialog, "Export Pivot", "", "CSV Files (*.csv)");
+        if (fileName.isEmpty()) return;
+
+        QFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            QMessageBox::critical(dialog, "Export Error", QString("Cannot write %1").arg(fileName));
+            return;
+        }
+        file.write(AnalyticsCube::toCsv(current, AnalyticsCube::Measure(measureCombo->currentIndex())).toUtf8());
+        QMessageBox::information(dialog, "Success", "Pivot exported successfully!");
+    });
+
+    connect(rowsCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), dialog, refresh);
+    connect(columnsCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), dialog, refresh);
+    connect(measureCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), dialog, refresh);
+    connect(archiveCheck, &QCheckBox::toggled, dialog, [&](bool checked) {
+        if (checked && !portfolioBuilt) {
+            QApplication::setOverrideCursor(Qt::WaitCursor);
+            portfolio.rebuild(allTaskRecords() + archive.archivedRecords());
+            QApplication::restoreOverrideCursor();
+            portfolioBuilt = true;
+        }
+        refresh();
+    });
+    refresh();
+
+    QHBoxLayout *controls = new QHBoxLayout;
+    controls->addWidget(new QLabel("Rows:", dialog));
+    controls->addWidget(rowsCombo);
+    controls->addWidget(new QLabel("Columns:", dialog));
+    controls->addWidget(columnsCombo);
+    controls->addWidget(new QLabel("Measure:", dialog));
+    controls->addWidget(measureCombo);
+    controls->addStretch();
+    controls->addWidget(archiveCheck);
+
+    QHBoxLayout *filterLayout = new QHBoxLayout;
+    filterLayout->addWidget(new QLabel("Filters:", dialog));
+    filterLayout->addWidget(filterLabel, 1);
+    filterLayout->addWidget(rollUpBtn);
+
+    QPushButton *closeBtn = new QPushButton("Close", dialog);
+    connect(closeBtn, &QPushButton::clicked, dialog, &QDialog::accept);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    buttonLayout->addWidget(exportBtn);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(closeBtn);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(dialog);
+    mainLayout->addLayout(controls);
+    mainLayout->addLayout(filterLayout);
+    mainLayout->addWidget(table, 1);
+    mainLayout->addLayout(buttonLayout);
+
+    dialog->exec();
+    delete dialog;
+}
+
+void MainWindow::on_addBtn_clicked() {
+    QDialog dialog(this);
+    QFormLayout form(&dialog);
+    dialog.setWindowTitle("Add New Task");
+
+    QStringList labels = {"Task ID:", "Name:", "Description:", "Status:", "Priority:",
+                          "Start Date (YYYY-MM-DD):", "End Date (YYYY-MM-DD):", "Assigned To:"};
+    QList<QLineEdit*> fields;
+    QList<QComboBox*> combos;
+
+    for (int i = 0; i < labels.size(); ++i) {
+        if (i == 3 || i == 4) {
+            QComboBox *combo = new QComboBox(&dialog);
+            if (i == 3) {
+                combo->addItems({"Not Started", "In Progress", "Completed", "On Hold"});
+            } else {
+                combo->addItems({"Low", "Medium", "High", "Critical"});
+            }
+            form.addRow(labels[i], combo);
+            combos << combo;
+        } else {
+            QLineEdit *lineEdit = new QLineEdit(&dialog);
+            form.addRow(labels[i], lineEdit);
+            fields << lineEdit;
+
+            if (i == 0) {
+                lineEdit->setMaxLength(10);
+                lineEdit->setPlaceholderText("T001");
+            }
+            else if (i == 5 || i == 6) {
+                lineEdit->setPlaceholderText("2023-12-31");
+            }
+        }
+    }
+
+    QLineEdit *dependsEdit = new QLineEdit(&dialog);
+    dependsEdit->setPlaceholderText("T001, T002");
+    form.addRow("Depends On:", dependsEdit);
+
+    QComboBox *projectCombo = createProjectCombo(&dialog, 0);
+    QDoubleSpinBox *plannedSpin = new QDoubleSpinBox(&dialog);
+    plannedSpin->setRange(0, 1e12);
+    plannedSpin->setDecimals(2);
+    QDoubleSpinBox *actualSpin = new QDoubleSpinBox(&dialog);
+    actualSpin->setRange(0, 1e12);
+    actualSpin->setDecimals(2);
+    form.addRow("Project / Phase:", projectCombo);
+    form.addRow("Planned Cost:", plannedSpin);
+    form.addRow("Actual Cost:", actualSpin);
+
+    QLineEdit *siteEdit = new QLineEdit(&dialog);
+    siteEdit->setPlaceholderText("48.8566, 2.3522");
+    form.addRow("Site (lat, lon):", siteEdit);
+
+    QDialogButtonBox buttonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel,
+                               Qt::Horizontal, &dialog);
+    form.addRow(&buttonBox);
 
     connect(&buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
     connect(&buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
@@ -849,10 +2490,24 @@ void MainWindow::on_addBtn_clicked() {
         int row = ui->taskTable->rowCount();
         ui->taskTable->insertRow(row);
         for (int i = 0; i < taskData.size(); ++i) {
-            ui->taskTable->setItem(row, i, new QTableWidgetItem(taskData[i]));
+            if (i == 2) {
+                setDescriptionCell(row, taskData[i]);
+            } else {
+                ui->taskTable->setItem(row, i, new QTableWidgetItem(taskData[i]));
+            }
+        }
+        ui->taskTable->setItem(row, 8, new QTableWidgetItem());
+
+        bool saved = saveTaskToDatabase(taskData);
+        saveTaskCosts(taskData[0], projectCombo->currentData().toInt(),
+                      plannedSpin->value(), actualSpin->value(), row);
+        saveTaskSite(taskData[0], taskData[1], siteEdit->text());
+        if (!dependsEdit->text().trimmed().isEmpty()) {
+            saveDependencies(taskData[0], dependsEdit->text());
+        }
+        if (saved) {
+            recordChange(QString("Add %1").arg(taskData[0]), UndoJournal::created(journalState(row)));
         }
-
-        saveTaskToDatabase(taskData);
         updateCharts();
     }
 }
@@ -883,12 +2538,40 @@ void MainWindow::on_modifyBtn_clicked() {
             form.addRow(labels[i], combo);
             combos << combo;
         } else {
-            QLineEdit *lineEdit = new QLineEdit(ui->taskTable->item(row, i)->text(), &dialog);
+            QString value = (i == 2) ? fullDescription(row) : ui->taskTable->item(row, i)->text();
+            QLineEdit *lineEdit = new QLineEdit(value, &dialog);
             form.addRow(labels[i], lineEdit);
             fields << lineEdit;
         }
     }
 
+    QLineEdit *dependsEdit = new QLineEdit(&dialog);
+    dependsEdit->setPlaceholderText("T001, T002");
+    dependsEdit->setText(taskGraph.predecessors(ui->taskTable->item(row, 0)->text()).join(", "));
+    form.addRow("Depends On:", dependsEdit);
+
+    BudgetTree::TaskCosts costs = projects.tree().task(ui->taskTable->item(row, 0)->text());
+    QComboBox *projectCombo = createProjectCombo(&dialog, costs.projectId);
+    QDoubleSpinBox *plannedSpin = new QDoubleSpinBox(&dialog);
+    plannedSpin->setRange(0, 1e12);
+    plannedSpin->setDecimals(2);
+    plannedSpin->setValue(costs.planned);
+    QDoubleSpinBox *actualSpin = new QDoubleSpinBox(&dialog);
+    actualSpin->setRange(0, 1e12);
+    actualSpin->setDecimals(2);
+    actualSpin->setValue(costs.actual);
+    form.addRow("Project / Phase:", projectCombo);
+    form.addRow("Planned Cost:", plannedSpin);
+    form.addRow("Actual Cost:", actualSpin);
+
+    QString taskId = ui->taskTable->item(row, 0)->text();
+    QLineEdit *siteEdit = new QLineEdit(&dialog);
+    siteEdit->setPlaceholderText("48.8566, 2.3522");
+    if (sites.contains(taskId)) {
+        siteEdit->setText(SpatialIndex::formatCoordinates(sites.point(taskId)));
+    }
+    form.addRow("Site (lat, lon):", siteEdit);
+
     QDialogButtonBox buttonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel,
                                Qt::Horizontal, &dialog);
     form.addRow(&buttonBox);
@@ -904,17 +2587,49 @@ void MainWindow::on_modifyBtn_clicked() {
         taskData.insert(3, combos[0]->currentText());
         taskData.insert(4, combos[1]->currentText());
 
+        // Une occurrence récurrente devient une vraie tâche à sa première modification
+        if (!materializeOccurrence(row)) return;
+        QStringList before = journalState(row);
+
+        // Écriture avant la mise à jour des cellules : l'ancien ID est encore dans la table
+        updateTaskInDatabase(taskData, row);
+
         for (int i = 0; i < taskData.size(); ++i) {
-            ui->taskTable->item(row, i)->setText(taskData[i]);
+            if (i == 2) {
+                setDescriptionCell(row, taskData[i]);
+            } else {
+                ui->taskTable->item(row, i)->setText(taskData[i]);
+            }
         }
 
-        updateTaskInDatabase(taskData, row);
+        setScheduleCell(row);
+        saveTaskCosts(taskData[0], projectCombo->currentData().toInt(),
+                      plannedSpin->value(), actualSpin->value(), row);
+        saveTaskSite(taskData[0], taskData[1], siteEdit->text());
+        saveDependencies(taskData[0], dependsEdit->text());
+
+        // Modifications successives de la même tâche : une seule entrée à annuler
+        QString taskId = before[UndoJournal::Id];
+        recordChange(QString("Edit %1").arg(taskId), UndoJournal::diff(taskId, before, journalState(row)), true);
         updateCharts();
     }
 }
 
 void MainWindow::on_deleteBtn_clicked() {
     if (!validateRowSelection()) return;
+    if (selectedTaskRows().size() > 1) {
+        bulkDelete();
+        return;
+    }
+
+    if (isOccurrenceRow(ui->taskTable->currentRow())) {
+        if (QMessageBox::question(this, "Skip Occurrence",
+                                  "Skip this occurrence of the recurring task? Other dates are not affected.",
+                                  QMessageBox::Yes | QMessageBox::No, QMessageBox::No) == QMessageBox::Yes) {
+            skipOccurrence(ui->taskTable->currentRow());
+        }
+        return;
+    }
 
     QMessageBox msgBox(this);
     msgBox.setWindowTitle("Confirm Delete");
@@ -923,130 +2638,1838 @@ void MainWindow::on_deleteBtn_clicked() {
     msgBox.setDefaultButton(QMessageBox::No);
 
     if (msgBox.exec() == QMessageBox::Yes) {
-        QString taskId = ui->taskTable->item(ui->taskTable->currentRow(), 0)->text();
+        int row = ui->taskTable->currentRow();
+        QString taskId = ui->taskTable->item(row, 0)->text();
+        QVector<UndoJournal::Change> changes = UndoJournal::removed(journalState(row));
+        changes += dependencyChangesForRemoval({taskId});
+
         deleteTaskFromDatabase(taskId);
-        ui->taskTable->removeRow(ui->taskTable->currentRow());
+        ui->taskTable->removeRow(row);
+        recordChange(QString("Delete %1").arg(taskId), changes);
         updateCharts();
     }
 }
 
-void MainWindow::on_exportBtn_clicked()
+QVector<int> MainWindow::selectedTaskRows() const
 {
-    QString fileName = QFileDialog::getSaveFileName(this, "Export PDF", "", "PDF Files (*.pdf)");
-    if (fileName.isEmpty()) return;
+    // Les lignes masquées par un filtre ne sont jamais concernées
+    QVector<int> rows;
+    const QModelIndexList selected = ui->taskTable->selectionModel()->selectedRows();
+    rows.reserve(selected.size());
+    for (const QModelIndex &index : selected) {
+        if (!ui->taskTable->isRowHidden(index.row())) rows << index.row();
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
 
-    QPrinter printer(QPrinter::HighResolution);
-    printer.setOutputFormat(QPrinter::PdfFormat);
-    printer.setOutputFileName(fileName);
+bool MainWindow::execBatch(QSqlQuery &query, const QString &sql, const QList<QVariantList> &columns)
+{
+    if (!query.prepare(sql)) return false;
+    for (const QVariantList &column : columns) {
+        query.addBindValue(column);
+    }
+    Diagnostics::Timer timer(Diagnostics::statement(sql));
+    return query.execBatch();
+}
 
-    QTextDocument doc;
-    QString html = "<h1>Task Report</h1><table border='1'><tr>";
+void MainWindow::on_bulkBtn_clicked()
+{
+    QVector<int> rows = selectedTaskRows();
 
-    for (int col = 0; col < ui->taskTable->columnCount(); ++col) {
-        html += "<th>" + ui->taskTable->horizontalHeaderItem(col)->text() + "</th>";
+    QMenu bulkMenu;
+    QAction *countAction = bulkMenu.addAction(QString("%1 task(s) selected").arg(rows.size()));
+    countAction->setEnabled(false);
+    bulkMenu.addSeparator();
+
+    QMenu *statusMenu = bulkMenu.addMenu("Set Status");
+    for (const QString &status : TaskRecord::statuses()) {
+        QAction *action = statusMenu->addAction(status);
+        connect(action, &QAction::triggered, [this, status]() { bulkSetField(3, status); });
     }
-    html += "</tr>";
+    QMenu *priorityMenu = bulkMenu.addMenu("Set Priority");
+    for (const QString &priority : TaskRecord::priorities()) {
+        QAction *action = priorityMenu->addAction(priority);
+        connect(action, &QAction::triggered, [this, priority]() { bulkSetField(4, priority); });
+    }
+    QAction *reassignAction = bulkMenu.addAction("Reassign...");
+    QAction *shiftAction = bulkMenu.addAction("Shift Dates...");
+    bulkMenu.addSeparator();
+    QAction *deleteAction = bulkMenu.addAction("Delete Selected...");
 
-    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
-        html += "<tr>";
-        for (int col = 0; col < ui->taskTable->columnCount(); ++col) {
-            html += "<td>" + ui->taskTable->item(row, col)->text() + "</td>";
+    connect(reassignAction, &QAction::triggered, [this, rows]() {
+        QSet<QString> names;
+        for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+            names.insert(ui->taskTable->item(row, 7)->text());
         }
-        html += "</tr>";
-    }
+        QStringList people(names.begin(), names.end());
+        people.sort(Qt::CaseInsensitive);
+
+        bool ok = false;
+        QString name = QInputDialog::getItem(this, "Reassign Tasks",
+                                             QString("Assign %1 task(s) to:").arg(rows.size()),
+                                             people, 0, true, &ok).trimmed();
+        if (ok && !name.isEmpty()) bulkSetField(7, name);
+    });
+    connect(shiftAction, &QAction::triggered, [this]() { bulkShiftDates(); });
+    connect(deleteAction, &QAction::triggered, [this]() { bulkDelete(); });
 
-    html += "</table>";
-    doc.setHtml(html);
-    doc.print(&printer);
+    bool any = !rows.isEmpty();
+    statusMenu->setEnabled(any);
+    priorityMenu->setEnabled(any);
+    reassignAction->setEnabled(any);
+    shiftAction->setEnabled(any);
+    deleteAction->setEnabled(any);
 
-    QMessageBox::information(this, "Success", "PDF exported successfully");
+    bulkMenu.exec(ui->bulkBtn->mapToGlobal(QPoint(0, ui->bulkBtn->height())));
 }
 
-void MainWindow::on_searchBtn_clicked() {
-    QString searchText = ui->searchInput->text().trimmed().toLower();
-
-    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
-        bool matchFound = false;
-        for (int col : {0, 1}) {
-            if (ui->taskTable->item(row, col)->text().toLower().contains(searchText)) {
-                matchFound = true;
-                break;
-            }
+void MainWindow::bulkSetField(int column, const QString &value)
+{
+    QVector<int> rows = selectedTaskRows();
+    if (rows.isEmpty() || !materializeOccurrences(rows)) return;
+
+    QVariantList values, completed, ids;
+    QVector<UndoJournal::Change> changes;
+    QHash<QString, QString> completedBefore;
+    for (int row : rows) {
+        QString taskId = ui->taskTable->item(row, 0)->text();
+        ids << taskId;
+        values << value;
+        completed << (value == "Completed");
+
+        QString previous = ui->taskTable->item(row, column)->text();
+        if (previous != value) {
+            changes.append({taskId, UndoJournal::Field(column), previous, value});
+            if (column == 3) completedBefore.insert(taskId, taskTimestamps(taskId).second);
         }
-        ui->taskTable->setRowHidden(row, !matchFound);
     }
-}
 
-void MainWindow::on_sortBtn_clicked()
-{
-    QMenu sortMenu;
+    QString sql;
+    QList<QVariantList> columns;
+    if (column == 3) {
+        sql = "UPDATE tasks SET status = ?, "
+              "completed_at = CASE WHEN ? THEN COALESCE(completed_at, CURRENT_TIMESTAMP) END, "
+              "updated_at = CURRENT_TIMESTAMP WHERE id = ?";
+        columns = {values, completed, ids};
+    } else {
+        sql = QString("UPDATE tasks SET %1 = ?, updated_at = CURRENT_TIMESTAMP WHERE id = ?")
+                  .arg(column == 4 ? "priority" : "assigned_to");
+        columns = {values, ids};
+    }
 
-    QAction *sortByIdAsc = sortMenu.addAction("By ID (Ascending)");
-    QAction *sortByIdDesc = sortMenu.addAction("By ID (Descending)");
-    QAction *sortByStartDateAsc = sortMenu.addAction("By Start Date (Oldest)");
-    QAction *sortByStartDateDesc = sortMenu.addAction("By Start Date (Newest)");
-    QAction *sortByEndDateAsc = sortMenu.addAction("By End Date (Soonest)");
-    QAction *sortByEndDateDesc = sortMenu.addAction("By End Date (Farthest)");
+    // Une transaction, une requête préparée exécutée en lot
+    QSqlQuery query(db);
+    if (!db.transaction() || !execBatch(query, sql, columns) || !db.commit()) {
+        QString message = query.lastError().isValid() ? query.lastError().text() : db.lastError().text();
+        db.rollback();
+        notifications->error("Database Error", QString("Bulk update failed: %1").arg(message));
+        return;
+    }
 
-    connect(sortByIdAsc, &QAction::triggered, [this]() { sortTasks(0, Qt::AscendingOrder); });
-    connect(sortByIdDesc, &QAction::triggered, [this]() { sortTasks(0, Qt::DescendingOrder); });
-    connect(sortByStartDateAsc, &QAction::triggered, [this]() { sortTasks(5, Qt::AscendingOrder); });
-    connect(sortByStartDateDesc, &QAction::triggered, [this]() { sortTasks(5, Qt::DescendingOrder); });
-    connect(sortByEndDateAsc, &QAction::triggered, [this]() { sortTasks(6, Qt::AscendingOrder); });
-    connect(sortByEndDateDesc, &QAction::triggered, [this]() { sortTasks(6, Qt::DescendingOrder); });
+    // Table et agrégats mis à jour une seule fois, après la validation
+    ui->taskTable->setUpdatesEnabled(false);
+    for (int row : rows) {
+        ui->taskTable->item(row, column)->setText(value);
+        QStringList taskData = taskCellsForRow(row);
+        updateWorkload(taskData);
+        if (column == 3) {
+            trends.updateTask(taskData[0], value == "Completed", QDate::fromString(taskData[6], "yyyy-MM-dd"));
+        }
+    }
+    ui->taskTable->setUpdatesEnabled(true);
 
-    sortMenu.exec(ui->sortBtn->mapToGlobal(QPoint(0, ui->sortBtn->height())));
+    // Date d'achèvement posée ou effacée par la requête : l'annulation la rend telle quelle
+    for (auto it = completedBefore.constBegin(); it != completedBefore.constEnd(); ++it) {
+        QString after = taskTimestamps(it.key()).second;
+        if (after != it.value()) changes.append({it.key(), UndoJournal::CompletedAt, it.value(), after});
+    }
+
+    fuzzyIndexDirty = true;
+    rebuildAnalytics();
+    history.maybeSnapshot();
+    recordChange(QString("Set %1 of %2 task(s)")
+                     .arg(column == 3 ? "status" : column == 4 ? "priority" : "assignee")
+                     .arg(rows.size()),
+                 changes);
+    updateCharts();
 }
 
-void MainWindow::sortTasks(int column, Qt::SortOrder order)
+void MainWindow::bulkShiftDates()
 {
-    if (column == 5 || column == 6) {
-        for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
-            QTableWidgetItem *item = ui->taskTable->item(row, column);
-            QDate date = QDate::fromString(item->text(), "yyyy-MM-dd");
-            if (date.isValid()) {
-                item->setData(Qt::UserRole, date);
-            }
-        }
+    QVector<int> rows = selectedTaskRows();
+    if (rows.isEmpty()) return;
+
+    bool ok = false;
+    int days = QInputDialog::getInt(this, "Shift Dates",
+                                    QString("Move start and end dates of %1 task(s) by (days):").arg(rows.size()),
+                                    7, -3650, 3650, 1, &ok);
+    if (!ok || days == 0 || !materializeOccurrences(rows)) return;
+
+    QVector<int> shifted;
+    QVariantList starts, ends, ids;
+    QVector<UndoJournal::Change> changes;
+    for (int row : rows) {
+        QString startText = ui->taskTable->item(row, 5)->text();
+        QString endText = ui->taskTable->item(row, 6)->text();
+        QDate start = QDate::fromString(startText, "yyyy-MM-dd");
+        QDate end = QDate::fromString(endText, "yyyy-MM-dd");
+        if (!start.isValid() || !end.isValid()) continue;
+        shifted << row;
+        starts << start.addDays(days).toString("yyyy-MM-dd");
+        ends << end.addDays(days).toString("yyyy-MM-dd");
+        ids << ui->taskTable->item(row, 0)->text();
+
+        QString taskId = ids.last().toString();
+        changes.append({taskId, UndoJournal::StartDate, startText, starts.last().toString()});
+        changes.append({taskId, UndoJournal::EndDate, endText, ends.last().toString()});
     }
+    if (shifted.isEmpty()) return;
 
-    ui->taskTable->sortItems(column, order);
-}
+    QSqlQuery query(db);
+    if (!db.transaction() ||
+        !execBatch(query, "UPDATE tasks SET start_date = ?, end_date = ?, updated_at = CURRENT_TIMESTAMP WHERE id = ?",
+                   {starts, ends, ids}) ||
+        !db.commit()) {
+        QString message = query.lastError().isValid() ? query.lastError().text() : db.lastError().text();
+        db.rollback();
+        notifications->error("Database Error", QString("Bulk date shift failed: %1").arg(message));
+        return;
+    }
 
-void MainWindow::showCalendar()
-{
-    QTextCharFormat defaultFormat;
-    calendarWidget->setDateTextFormat(QDate(), defaultFormat);
+    ui->taskTable->setUpdatesEnabled(false);
+    for (int i = 0; i < shifted.size(); ++i) {
+        int row = shifted[i];
+        ui->taskTable->item(row, 5)->setText(starts[i].toString());
+        ui->taskTable->item(row, 6)->setText(ends[i].toString());
+
+        QStringList taskData = taskCellsForRow(row);
+        QDate start = QDate::fromString(taskData[5], "yyyy-MM-dd");
+        QDate end = QDate::fromString(taskData[6], "yyyy-MM-dd");
+        updateWorkload(taskData);
+        trends.updateTask(taskData[0], taskData[3] == "Completed", end);
+        taskGraph.insertTask(taskData[0], start, end);
+    }
 
+    // Un seul calcul du chemin critique au lieu d'une propagation par tâche
+    taskGraph.recomputeAll();
     for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
-        QTableWidgetItem* startItem = ui->taskTable->item(row, 5);
-        QTableWidgetItem* endItem = ui->taskTable->item(row, 6);
+        setScheduleCell(row);
+    }
+    ui->taskTable->setUpdatesEnabled(true);
 
-        if (startItem && endItem && !startItem->text().isEmpty() && !endItem->text().isEmpty()) {
-            QDate startDate = QDate::fromString(startItem->text(), "yyyy-MM-dd");
-            QDate endDate = QDate::fromString(endItem->text(), "yyyy-MM-dd");
+    rebuildAnalytics();
+    history.maybeSnapshot();
+    recordChange(QString("Shift %1 task(s) by %2 day(s)").arg(shifted.size()).arg(days), changes);
+    updateCharts();
+}
 
-            if (startDate.isValid() && endDate.isValid()) {
-                QString status = ui->taskTable->item(row, 3)->text();
-                QColor color;
+void MainWindow::bulkDelete()
+{
+    QVector<int> rows = selectedTaskRows();
+    if (rows.isEmpty()) return;
 
-                if (status == "Completed") color = QColor(40, 167, 69);
-                else if (status == "In Progress") color = QColor(23, 162, 184);
-                else if (status == "On Hold") color = QColor(108, 117, 125);
-                else color = QColor(220, 53, 69);
+    if (QMessageBox::question(this, "Confirm Delete",
+                              QString("Are you sure you want to delete %1 task(s)?").arg(rows.size()),
+                              QMessageBox::Yes | QMessageBox::No, QMessageBox::No) != QMessageBox::Yes) {
+        return;
+    }
 
-                QTextCharFormat format;
-                format.setBackground(color);
-                format.setForeground(Qt::white);
+    // Occurrences non enregistrées : seule une exception est écrite, après la suppression
+    QVariantList ids;
+    QVector<int> occurrenceRows;
+    for (int row : rows) {
+        if (isOccurrenceRow(row)) {
+            occurrenceRows << row;
+        } else {
+            ids << ui->taskTable->item(row, 0)->text();
+        }
+    }
 
-                for (QDate date = startDate; date <= endDate; date = date.addDays(1)) {
-                    calendarWidget->setDateTextFormat(date, format);
-                }
-            }
+    // Lignes complètes à restaurer : textes intégraux lus seulement si le journal peut les garder
+    QVector<UndoJournal::Change> changes;
+    bool journaled = journal.fits(ids.size() * UndoJournal::FieldCount);
+    if (journaled && !ids.isEmpty()) {
+        QSet<QString> removedIds;
+        for (int row : rows) {
+            if (isOccurrenceRow(row)) continue;
+            removedIds.insert(ui->taskTable->item(row, 0)->text());
+            changes += UndoJournal::removed(journalState(row));
         }
+        changes += dependencyChangesForRemoval(removedIds);
     }
 
-    calendarWidget->show();
+    QSqlQuery query(db);
+    if (!ids.isEmpty() &&
+        (!db.transaction() ||
+         !execBatch(query, "DELETE FROM tasks WHERE id = ?", {ids}) ||
+         !execBatch(query, "DELETE FROM task_dependencies WHERE predecessor_id = ? OR successor_id = ?", {ids, ids}) ||
+         !db.commit())) {
+        QString message = query.lastError().isValid() ? query.lastError().text() : db.lastError().text();
+        db.rollback();
+        notifications->error("Database Error", QString("Bulk delete failed: %1").arg(message));
+        return;
+    }
+
+    QStringList changed;
+    for (const QVariant &id : ids) {
+        QString taskId = id.toString();
+        descriptions.invalidate(taskId);
+        changed += taskGraph.removeTask(taskId);
+        workload.removeTask(taskId);
+        trends.removeTask(taskId);
+        projects.removeTask(taskId);
+        detachedAttachments.insert(taskId);
+        sites.remove(taskId);
+        timeTracker->stopTask(taskId, "delete");
+    }
+    for (int row : occurrenceRows) {
+        QString taskId = ui->taskTable->item(row, 0)->text();
+        int seriesId = 0;
+        QDate date;
+        QString error;
+        if (RecurrenceStore::parseOccurrenceId(taskId, &seriesId, &date) &&
+            !recurrence.addException(seriesId, date, &error)) {
+            qWarning() << "Failed to skip occurrence" << taskId << error;
+        }
+        workload.removeTask(taskId);
+    }
+
+    // Suppression par plages contiguës : la fin du tableau n'est décalée qu'une fois par plage
+    ui->taskTable->setUpdatesEnabled(false);
+    for (int i = rows.size() - 1; i >= 0; --i) {
+        int last = rows[i];
+        int first = last;
+        while (i > 0 && rows[i - 1] == first - 1) {
+            --first;
+            --i;
+        }
+        ui->taskTable->model()->removeRows(first, last - first + 1);
+    }
+    updateScheduleCells(changed);
+    ui->taskTable->setUpdatesEnabled(true);
+
+    fuzzyIndexDirty = true;
+    rebuildAnalytics();
+    history.maybeSnapshot();
+    if (!journaled) {
+        forgetUndoHistory(QString("Deleting %1 tasks cannot be undone").arg(ids.size()));
+    } else {
+        recordChange(QString("Delete %1 task(s)").arg(ids.size()), changes);
+    }
+    updateCharts();
+}
+
+void MainWindow::on_exportBtn_clicked()
+{
+    QMenu exportMenu;
+
+    QAction *tableAction = exportMenu.addAction("Task Table (PDF)...");
+    QAction *packAction = exportMenu.addAction("Chart Report Pack...");
+    QAction *reportsAction = exportMenu.addAction("Weekly Reports...");
+    exportMenu.addSeparator();
+    QAction *invoiceAction = exportMenu.addAction("Invoice Run...");
+    QAction *ratesAction = exportMenu.addAction("Billing Rates...");
+
+    connect(tableAction, &QAction::triggered, [this]() { exportTaskTable(); });
+    connect(packAction, &QAction::triggered, [this]() { exportReportPack(); });
+    connect(reportsAction, &QAction::triggered, [this]() { showReports(); });
+    connect(invoiceAction, &QAction::triggered, [this]() { runInvoices(); });
+    connect(ratesAction, &QAction::triggered, [this]() { editBillingRates(); });
+
+    exportMenu.exec(ui->exportBtn->mapToGlobal(QPoint(0, ui->exportBtn->height())));
+}
+
+void MainWindow::showReports()
+{
+    ReportsDialog *dialog = new ReportsDialog(reports, this);
+    dialog->exec();
+    delete dialog;
+}
+
+void MainWindow::exportChart(const ChartSpec &spec)
+{
+    QString fileName = QFileDialog::getSaveFileName(this, "Save Chart", "",
+                                                    "PNG Images (*.png);;JPEG Images (*.jpg *.jpeg);;PDF Files (*.pdf)");
+    if (fileName.isEmpty()) return;
+
+    bool ok = false;
+    int dpi = QInputDialog::getInt(this, "Save Chart", "Resolution (DPI):", 300, 72, 1200, 1, &ok);
+    if (!ok) return;
+
+    // Rendu hors écran : indépendant de la taille de la fenêtre affichée
+    if (ChartRenderer::save(chartRenderer.render(spec, dpi), fileName, dpi)) {
+        QMessageBox::information(this, "Success", "Chart exported successfully!");
+    } else {
+        QMessageBox::critical(this, "Export Error", QString("Cannot write %1").arg(fileName));
+    }
+}
+
+void MainWindow::exportReportPack()
+{
+    if (ui->taskTable->rowCount() == 0) {
+        QMessageBox::warning(this, "No Data", "No tasks available for statistics");
+        return;
+    }
+
+    QString directory = QFileDialog::getExistingDirectory(this, "Report Pack Folder");
+    if (directory.isEmpty()) return;
+
+    bool ok = false;
+    int dpi = QInputDialog::getInt(this, "Report Pack", "Resolution (DPI):", 150, 72, 600, 1, &ok);
+    if (!ok) return;
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QStringList written = chartRenderer.renderPack(allTaskRecords(), directory, dpi);
+    QApplication::restoreOverrideCursor();
+
+    QMessageBox::information(this, "Report Pack",
+                             QString("%1 file(s) written to %2").arg(written.size()).arg(directory));
+}
+
+void MainWindow::runInvoices()
+{
+    bool ok = false;
+    QString month = QInputDialog::getText(this, "Invoice Run", "Billing month (YYYY-MM):", QLineEdit::Normal,
+                                          QDate::currentDate().toString("yyyy-MM"), &ok);
+    if (!ok) return;
+
+    QDate monthDate = QDate::fromString(month.trimmed() + "-01", "yyyy-MM-dd");
+    if (!monthDate.isValid()) {
+        QMessageBox::warning(this, "Invalid Month", "Billing month must be in YYYY-MM format");
+        return;
+    }
+
+    QString directory = QFileDialog::getExistingDirectory(this, "Invoice Folder");
+    if (directory.isEmpty()) return;
+
+    // Numérotation d'abord : les factures déjà numérotées gardent leur numéro
+    QString period = InvoiceEngine::periodFor(monthDate);
+    QString error;
+    int planned = invoices.planRun(period, &error);
+    if (planned < 0) {
+        notifications->error("Database Error", QString("Failed to plan invoices: %1").arg(error));
+        return;
+    }
+
+    QVector<InvoiceEngine::Invoice> pending = invoices.pendingInvoices(period, directory);
+    if (pending.isEmpty()) {
+        QMessageBox::information(this, "Invoice Run",
+                                 QString("No pending invoices for %1 (%2 already rendered)")
+                                     .arg(month)
+                                     .arg(invoices.invoiceCount(period, "rendered")));
+        return;
+    }
+
+    QProgressDialog progress("Rendering invoices...", "Cancel", 0, pending.size(), this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(0);
+
+    // Rendu en parallèle (une imprimante par thread); la base n'est écrite que
+    // depuis ce thread, par lots, pour qu'une interruption perde peu de travail
+    QFutureWatcher<InvoiceEngine::Invoice> watcher;
+    QVector<InvoiceEngine::Invoice> finished;
+    int rendered = 0;
+    int failed = 0;
+
+    auto flush = [&]() {
+        QString flushError;
+        if (!invoices.markRendered(finished, &flushError)) {
+            qWarning() << "Failed to record rendered invoices:" << flushError;
+        }
+        finished.clear();
+    };
+
+    connect(&watcher, &QFutureWatcher<InvoiceEngine::Invoice>::resultReadyAt, this, [&](int index) {
+        InvoiceEngine::Invoice invoice = watcher.resultAt(index);
+        if (invoice.rendered) {
+            rendered++;
+        } else {
+            failed++;
+        }
+        finished << invoice;
+        if (finished.size() >= 250) flush();
+        progress.setValue(rendered + failed);
+    });
+    connect(&progress, &QProgressDialog::canceled, &watcher, &QFutureWatcher<InvoiceEngine::Invoice>::cancel);
+
+    QEventLoop loop;
+    connect(&watcher, &QFutureWatcher<InvoiceEngine::Invoice>::finished, &loop, &QEventLoop::quit);
+    watcher.setFuture(QtConcurrent::mapped(pending, [](const InvoiceEngine::Invoice &invoice) {
+        InvoiceEngine::Invoice result = invoice;
+        result.rendered = InvoiceEngine::render(result);
+        return result;
+    }));
+    loop.exec();
+    flush();
+    progress.reset();
+
+    int remaining = invoices.invoiceCount(period, "pending");
+    QString summary = QString("%1 new invoice(s) numbered, %2 rendered to %3.")
+                          .arg(planned)
+                          .arg(rendered)
+                          .arg(directory);
+    if (remaining > 0) {
+        summary += QString("\n%1 invoice(s) still pending (%2 failed); run again to resume.")
+                       .arg(remaining)
+                       .arg(failed);
+    }
+    QMessageBox::information(this, "Invoice Run", summary);
+}
+
+void MainWindow::editBillingRates()
+{
+    QDialog dialog(this);
+    dialog.setWindowTitle("Billing Rates");
+    dialog.resize(400, 450);
+
+    // Une ligne par personne connue, plus le tarif par défaut
+    QMap<QString, double> rates = invoices.rates();
+    QStringList people;
+    for (const TaskRecord &task : allTaskRecords()) {
+        QString assignee = task.assignedTo.trimmed();
+        if (!assignee.isEmpty() && !people.contains(assignee, Qt::CaseInsensitive)) {
+            people << assignee;
+        }
+    }
+    for (auto it = rates.constBegin(); it != rates.constEnd(); ++it) {
+        if (it.key() != InvoiceEngine::DefaultRateKey && !people.contains(it.key(), Qt::CaseInsensitive)) {
+            people << it.key();
+        }
+    }
+    people.sort(Qt::CaseInsensitive);
+    people.prepend(InvoiceEngine::DefaultRateKey);
+
+    QTableWidget *table = new QTableWidget(people.size(), 2, &dialog);
+    table->setHorizontalHeaderLabels({"Assignee", "Daily Rate"});
+    table->horizontalHeader()->setStretchLastSection(true);
+    for (int row = 0; row < people.size(); ++row) {
+        QTableWidgetItem *nameItem = new QTableWidgetItem(row == 0 ? QString("(default)") : people[row]);
+        nameItem->setFlags(nameItem->flags() & ~Qt::ItemIsEditable);
+        nameItem->setData(Qt::UserRole, people[row]);
+        table->setItem(row, 0, nameItem);
+
+        double rate = 0.0;
+        for (auto it = rates.constBegin(); it != rates.constEnd(); ++it) {
+            if (it.key().compare(people[row], Qt::CaseInsensitive) == 0) rate = it.value();
+        }
+        table->setItem(row, 1, new QTableWidgetItem(QString::number(rate, 'f', 2)));
+    }
+
+    QDialogButtonBox buttonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, &dialog);
+    connect(&buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(&buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    QVBoxLayout *layout = new QVBoxLayout(&dialog);
+    layout->addWidget(table);
+    layout->addWidget(&buttonBox);
+
+    if (dialog.exec() != QDialog::Accepted) return;
+
+    QMap<QString, double> updated;
+    for (int row = 0; row < table->rowCount(); ++row) {
+        bool valid = false;
+        double rate = table->item(row, 1)->text().toDouble(&valid);
+        if (!valid || rate < 0) {
+            QMessageBox::warning(this, "Invalid Rate",
+                                 QString("Rate for %1 must be a positive number").arg(table->item(row, 0)->text()));
+            return;
+        }
+        if (rate > 0) {
+            updated.insert(table->item(row, 0)->data(Qt::UserRole).toString(), rate);
+        }
+    }
+
+    QString error;
+    if (!invoices.setRates(updated, &error)) {
+        notifications->error("Database Error", QString("Failed to save rates: %1").arg(error));
+    }
+}
+
+void MainWindow::exportTaskTable()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, "Export PDF", "", "PDF Files (*.pdf)");
+    if (fileName.isEmpty()) return;
+
+    QPrinter printer(QPrinter::HighResolution);
+    printer.setOutputFormat(QPrinter::PdfFormat);
+    printer.setOutputFileName(fileName);
+
+    QTextDocument doc;
+    QString html = "<h1>Task Report</h1><table border='1'><tr>";
+
+    for (int col = 0; col < ui->taskTable->columnCount(); ++col) {
+        html += "<th>" + ui->taskTable->horizontalHeaderItem(col)->text() + "</th>";
+    }
+    html += "</tr>";
+
+    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+        html += "<tr>";
+        for (int col = 0; col < ui->taskTable->columnCount(); ++col) {
+            QString text = (col == 2) ? fullDescription(row) : ui->taskTable->item(row, col)->text();
+            html += "<td>" + text + "</td>";
+        }
+        html += "</tr>";
+    }
+
+    html += "</table>";
+    doc.setHtml(html);
+    doc.print(&printer);
+
+    QMessageBox::information(this, "Success", "PDF exported successfully");
+}
+
+void MainWindow::on_searchBtn_clicked() {
+    highlightDelegate->setActiveQuery(QString());
+    restoreRankedOrder();
+
+    if (FilterQuery::looksStructured(ui->searchInput->text())) {
+        applyFilterQuery(ui->searchInput->text().trimmed());
+        return;
+    }
+
+    QString searchText = ui->searchInput->text().trimmed().toLower();
+
+    if (searchText.isEmpty()) {
+        for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+            ui->taskTable->setRowHidden(row, false);
+        }
+        ui->taskTable->viewport()->update();
+        return;
+    }
+
+    static Diagnostics::Cache &fuzzyDiagnostics = Diagnostics::cache("fuzzy index (reused)");
+    if (fuzzyIndexDirty) {
+        fuzzyDiagnostics.miss();
+        rebuildFuzzyIndex();
+    } else {
+        fuzzyDiagnostics.hit();
+    }
+
+    // Recherche tolérante aux fautes de frappe, 50 meilleurs résultats
+    showRankedRows(fuzzyIndex.search(searchText, 50), searchText);
+}
+
+void MainWindow::rebuildFuzzyIndex()
+{
+    fuzzyIndex.clear();
+    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+        fuzzyIndex.addTask(ui->taskTable->item(row, 0)->text(),
+                           ui->taskTable->item(row, 1)->text(),
+                           ui->taskTable->item(row, 7)->text());
+    }
+    fuzzyIndexDirty = false;
+}
+
+void MainWindow::showRankedRows(const QVector<FuzzyIndex::Match> &matches, const QString &query)
+{
+    static const int matchColumn[FuzzyIndex::FieldCount] = {0, 1, 7};
+
+    QHash<QString, int> rank;
+    for (int i = 0; i < matches.size(); ++i) {
+        rank.insert(matches[i].taskId, i);
+    }
+
+    ui->taskTable->setUpdatesEnabled(false);
+    restoreRankedOrder();
+
+    QVector<int> rankedRows(matches.size(), -1);
+    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+        auto it = rank.constFind(ui->taskTable->item(row, 0)->text());
+        ui->taskTable->setRowHidden(row, it == rank.constEnd());
+        if (it != rank.constEnd()) rankedRows[it.value()] = row;
+    }
+
+    // Lignes trouvées affichées en tête dans l'ordre du classement. Seules les sections
+    // de l'en-tête vertical bougent : les lignes et l'ordre de tri choisi restent en place
+    QHeaderView *header = ui->taskTable->verticalHeader();
+    for (int i = 0; i < matches.size(); ++i) {
+        int row = rankedRows[i];
+        if (row < 0) continue;
+
+        rankedFrom << header->visualIndex(row);
+        header->moveSection(rankedFrom.last(), rankedFrom.size() - 1);
+
+        const FuzzyIndex::Match &match = matches[i];
+        QTableWidgetItem *item = ui->taskTable->item(row, matchColumn[match.field]);
+        if (item) {
+            item->setData(FuzzyHighlightDelegate::HighlightRole,
+                          QVariantList{query, match.start, match.length});
+        }
+    }
+
+    highlightDelegate->setActiveQuery(query);
+    ui->taskTable->setUpdatesEnabled(true);
+}
+
+void MainWindow::restoreRankedOrder()
+{
+    // Déplacements annulés en ordre inverse : l'affichage retrouve l'ordre des lignes
+    QHeaderView *header = ui->taskTable->verticalHeader();
+    for (int i = rankedFrom.size() - 1; i >= 0; --i) {
+        if (i < header->count() && rankedFrom[i] < header->count()) {
+            header->moveSection(i, rankedFrom[i]);
+        }
+    }
+    rankedFrom.clear();
+}
+
+void MainWindow::applyFilterQuery(const QString &text)
+{
+    QString error;
+    FilterQuery filter = FilterQuery::parse(text, &error);
+    if (!error.isEmpty()) {
+        QMessageBox::warning(this, "Invalid Filter", error);
+        return;
+    }
+
+    // Grande table + critère indexé : SQLite répond plus vite qu'un parcours des lignes
+    if (db.isOpen() && filter.usesIndex() && ui->taskTable->rowCount() > sql_filter_row_threshold) {
+        QSqlQuery query(db);
+        query.prepare(filter.selectIdsSql());
+        for (const QVariant &value : filter.bindings()) {
+            query.addBindValue(value);
+        }
+
+        if (timedExec(query)) {
+            QSet<QString> ids;
+            while (query.next()) {
+                ids.insert(query.value(0).toString());
+            }
+            // Les occurrences ne sont pas en base : filtrées en mémoire
+            for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+                bool visible = isOccurrenceRow(row) ? filter.matches(taskRecordAt(row))
+                                                    : ids.contains(ui->taskTable->item(row, 0)->text());
+                ui->taskTable->setRowHidden(row, !visible);
+            }
+            return;
+        }
+        qWarning() << "Filter query failed, falling back to in-memory filter:" << query.lastError().text();
+    }
+
+    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+        ui->taskTable->setRowHidden(row, !filter.matches(taskRecordAt(row)));
+    }
+}
+
+int MainWindow::countFilterMatches(const QString &text)
+{
+    FilterQuery filter = FilterQuery::parse(text);
+    if (!db.isOpen() || filter.isEmpty()) return -1;
+
+    QSqlQuery query(db);
+    query.prepare(filter.countSql());
+    for (const QVariant &value : filter.bindings()) {
+        query.addBindValue(value);
+    }
+
+    if (!timedExec(query) || !query.next()) {
+        qWarning() << "Failed to count filter matches:" << query.lastError().text();
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+QMap<QString, QString> MainWindow::loadSavedFilters()
+{
+    QMap<QString, QString> filters;
+    if (!db.isOpen()) return filters;
+
+    QSqlQuery query("SELECT name, query FROM saved_filters ORDER BY name", db);
+    while (query.next()) {
+        filters.insert(query.value(0).toString(), query.value(1).toString());
+    }
+    return filters;
+}
+
+void MainWindow::saveCurrentFilter()
+{
+    QString text = ui->searchInput->text().trimmed();
+    QString error;
+    FilterQuery::parse(text, &error);
+    if (!error.isEmpty()) {
+        QMessageBox::warning(this, "Invalid Filter", error);
+        return;
+    }
+
+    bool ok = false;
+    QString name = QInputDialog::getText(this, "Save Filter", "Filter name:",
+                                         QLineEdit::Normal, QString(), &ok).trimmed();
+    if (!ok || name.isEmpty()) return;
+
+    QSqlQuery query(db);
+    query.prepare("INSERT OR REPLACE INTO saved_filters (name, query) VALUES (:name, :query)");
+    query.bindValue(":name", name);
+    query.bindValue(":query", text);
+
+    if (!timedExec(query)) {
+        notifications->error("Database Error", QString("Failed to save filter: %1").arg(query.lastError().text()));
+    }
+}
+
+void MainWindow::deleteSavedFilter(const QString &name)
+{
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM saved_filters WHERE name = :name");
+    query.bindValue(":name", name);
+
+    if (!timedExec(query)) {
+        notifications->error("Database Error", QString("Failed to delete filter: %1").arg(query.lastError().text()));
+    }
+}
+
+void MainWindow::on_filterBtn_clicked()
+{
+    QMenu filterMenu;
+
+    QAction *saveAction = filterMenu.addAction("Save Current Filter...");
+    saveAction->setEnabled(FilterQuery::looksStructured(ui->searchInput->text()));
+    connect(saveAction, &QAction::triggered, [this]() { saveCurrentFilter(); });
+
+    QAction *clearAction = filterMenu.addAction("Clear Filter");
+    connect(clearAction, &QAction::triggered, [this]() {
+        ui->searchInput->clear();
+        highlightDelegate->setActiveQuery(QString());
+        for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+            ui->taskTable->setRowHidden(row, false);
+        }
+    });
+
+    QMap<QString, QString> filters = loadSavedFilters();
+    if (!filters.isEmpty()) {
+        filterMenu.addSeparator();
+
+        // Les compteurs sont calculés par COUNT(*) sans charger les lignes
+        for (auto it = filters.begin(); it != filters.end(); ++it) {
+            QString queryText = it.value();
+            QAction *action = filterMenu.addAction(
+                QString("%1 (%2)").arg(it.key()).arg(countFilterMatches(queryText)));
+            action->setToolTip(queryText);
+            connect(action, &QAction::triggered, [this, queryText]() {
+                ui->searchInput->setText(queryText);
+                applyFilterQuery(queryText);
+            });
+        }
+
+        filterMenu.addSeparator();
+        QMenu *deleteMenu = filterMenu.addMenu("Delete Saved Filter");
+        for (const QString &name : filters.keys()) {
+            QAction *action = deleteMenu->addAction(name);
+            connect(action, &QAction::triggered, [this, name]() { deleteSavedFilter(name); });
+        }
+    }
+
+    filterMenu.exec(ui->filterBtn->mapToGlobal(QPoint(0, ui->filterBtn->height())));
+}
+
+void MainWindow::on_sortBtn_clicked()
+{
+    QMenu sortMenu;
+
+    QAction *sortByIdAsc = sortMenu.addAction("By ID (Ascending)");
+    QAction *sortByIdDesc = sortMenu.addAction("By ID (Descending)");
+    QAction *sortByStartDateAsc = sortMenu.addAction("By Start Date (Oldest)");
+    QAction *sortByStartDateDesc = sortMenu.addAction("By Start Date (Newest)");
+    QAction *sortByEndDateAsc = sortMenu.addAction("By End Date (Soonest)");
+    QAction *sortByEndDateDesc = sortMenu.addAction("By End Date (Farthest)");
+
+    connect(sortByIdAsc, &QAction::triggered, [this]() { sortTasks(0, Qt::AscendingOrder); });
+    connect(sortByIdDesc, &QAction::triggered, [this]() { sortTasks(0, Qt::DescendingOrder); });
+    connect(sortByStartDateAsc, &QAction::triggered, [this]() { sortTasks(5, Qt::AscendingOrder); });
+    connect(sortByStartDateDesc, &QAction::triggered, [this]() { sortTasks(5, Qt::DescendingOrder); });
+    connect(sortByEndDateAsc, &QAction::triggered, [this]() { sortTasks(6, Qt::AscendingOrder); });
+    connect(sortByEndDateDesc, &QAction::triggered, [this]() { sortTasks(6, Qt::DescendingOrder); });
+
+    sortMenu.exec(ui->sortBtn->mapToGlobal(QPoint(0, ui->sortBtn->height())));
+}
+
+void MainWindow::sortTasks(int column, Qt::SortOrder order)
+{
+    if (column == 5 || column == 6) {
+        for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+            QTableWidgetItem *item = ui->taskTable->item(row, column);
+            QDate date = QDate::fromString(item->text(), "yyyy-MM-dd");
+            if (date.isValid()) {
+                item->setData(Qt::UserRole, date);
+            }
+        }
+    }
+
+    restoreRankedOrder();
+    ui->taskTable->sortItems(column, order);
+}
+
+void MainWindow::showCalendar()
+{
+    QTextCharFormat defaultFormat;
+    calendarWidget->setDateTextFormat(QDate(), defaultFormat);
+
+    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+        QTableWidgetItem* startItem = ui->taskTable->item(row, 5);
+        QTableWidgetItem* endItem = ui->taskTable->item(row, 6);
+
+        if (startItem && endItem && !startItem->text().isEmpty() && !endItem->text().isEmpty()) {
+            QDate startDate = QDate::fromString(startItem->text(), "yyyy-MM-dd");
+            QDate endDate = QDate::fromString(endItem->text(), "yyyy-MM-dd");
+
+            if (startDate.isValid() && endDate.isValid()) {
+                QTextCharFormat format;
+                format.setBackground(statusColor(ui->taskTable->item(row, 3)->text()));
+                format.setForeground(Qt::white);
+
+                for (QDate date = startDate; date <= endDate; date = date.addDays(1)) {
+                    calendarWidget->setDateTextFormat(date, format);
+                }
+            }
+        }
+    }
+
+    paintCalendarOccurrences(calendarWidget->yearShown(), calendarWidget->monthShown());
+    calendarWidget->show();
+}
+
+QColor MainWindow::statusColor(const QString &status)
+{
+    if (status == "Completed") return QColor(40, 167, 69);
+    if (status == "In Progress") return QColor(23, 162, 184);
+    if (status == "On Hold") return QColor(108, 117, 125);
+    return QColor(220, 53, 69);
+}
+
+void MainWindow::showTimeline()
+{
+    QStringList statuses = TaskRecord::statuses();
+    QVector<QColor> colors;
+    for (const QString &status : statuses) {
+        colors << statusColor(status);
+    }
+
+    QVector<GanttTask> tasks;
+    tasks.reserve(ui->taskTable->rowCount());
+    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+        TaskRecord record = taskRecordAt(row);
+        if (!record.startDate.isValid() || !record.endDate.isValid()) continue;
+
+        GanttTask task;
+        task.id = record.id;
+        task.name = record.name;
+        task.statusIndex = statuses.indexOf(record.status);
+        if (task.statusIndex < 0) task.statusIndex = 0;    // même couleur que le calendrier
+        task.startDay = record.startDate.toJulianDay();
+        task.endDay = qMax(task.startDay, record.endDate.toJulianDay());
+        tasks << task;
+    }
+
+    ganttView->setTasks(tasks, statuses, colors);
+    ganttView->show();
+    ganttView->raise();
+}
+
+void MainWindow::showMaterials()
+{
+    QStringList taskIds;
+    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+        if (!isOccurrenceRow(row)) taskIds << ui->taskTable->item(row, 0)->text();
+    }
+
+    MaterialsDialog *dialog = new MaterialsDialog(&materials, taskIds, this);
+    connect(dialog, &MaterialsDialog::stockChanged, this, &MainWindow::checkLowStock);
+    dialog->exec();
+    delete dialog;
+}
+
+void MainWindow::on_filesBtn_clicked()
+{
+    QStringList taskIds;
+    for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+        if (!isOccurrenceRow(row)) taskIds << ui->taskTable->item(row, 0)->text();
+    }
+    int row = ui->taskTable->currentRow();
+    QString taskId = row >= 0 && !isOccurrenceRow(row) ? ui->taskTable->item(row, 0)->text() : QString();
+
+    AttachmentsDialog *dialog = new AttachmentsDialog(&attachments, thumbnails, taskIds, taskId, this);
+    dialog->exec();
+    delete dialog;
+}
+
+void MainWindow::showProjects()
+{
+    ProjectsDialog *dialog = new ProjectsDialog(&projects, this);
+    connect(dialog, &ProjectsDialog::projectsChanged, this, &MainWindow::refreshVarianceCells);
+    connect(dialog, &ProjectsDialog::projectsChanged, this, &MainWindow::loadProjectSites);
+    connect(dialog, &ProjectsDialog::exportPackRequested, this, &MainWindow::exportProjectPack);
+    connect(dialog, &ProjectsDialog::importPackRequested, this, &MainWindow::importProjectPack);
+    dialog->exec();
+    delete dialog;
+}
+
+void MainWindow::exportProjectPack(int projectId)
+{
+    QString name = projects.tree().node(projectId).name;
+    QString fileName = QFileDialog::getSaveFileName(this, "Export Project Pack", name + ".taskpack",
+                                                    "Project Packs (*.taskpack)");
+    if (fileName.isEmpty()) return;
+    if (!fileName.endsWith(".taskpack")) fileName += ".taskpack";
+
+    QString error;
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool ok = TaskPack::exportProject(db, attachments.blobDirectory(), projectId, fileName, &error);
+    QApplication::restoreOverrideCursor();
+    if (!ok) {
+        notifications->error("Project Pack", QString("Exporting %1 failed: %2").arg(name, error));
+        return;
+    }
+    notifications->info("Project Pack", QString("%1 exported to %2").arg(name, QDir::toNativeSeparators(fileName)));
+}
+
+void MainWindow::importProjectPack()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, "Import Project Pack", "", "Project Packs (*.taskpack)");
+    if (fileName.isEmpty()) return;
+
+    // Tous les CRC sont contrôlés avant d'écrire quoi que ce soit
+    TaskPack pack;
+    QString error;
+    if (!pack.open(fileName, &error) || !pack.verify(&error)) {
+        notifications->error("Project Pack", QString("%1: %2").arg(QFileInfo(fileName).fileName(), error));
+        return;
+    }
+
+    int taskCount = 0;
+    int attachmentCount = 0;
+    for (const TaskPack::Section &section : pack.sections()) {
+        if (section.name == "tasks") taskCount = section.rows;
+        if (section.name == "attachments") attachmentCount = section.rows;
+    }
+    if (QMessageBox::question(this, "Import Project Pack",
+                              QString("Import project \"%1\" with %2 task(s) and %3 attachment(s)?")
+                                  .arg(pack.meta().value("project").toString())
+                                  .arg(taskCount).arg(attachmentCount),
+                              QMessageBox::Yes | QMessageBox::No, QMessageBox::No) != QMessageBox::Yes) {
+        return;
+    }
+
+    // Une tâche importée ne doit pas hériter des pièces jointes d'une tâche supprimée
+    const QStringList detached = detachedAttachments.values();
+    for (const QString &taskId : detached) {
+        dropDetachedAttachments(taskId);
+    }
+
+    TaskPack::Imported imported;
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool ok = pack.importInto(db, attachments.blobDirectory(), &imported, &error);
+    QApplication::restoreOverrideCursor();
+    if (!ok) {
+        notifications->error("Project Pack", QString("Importing %1 failed: %2").arg(QFileInfo(fileName).fileName(), error));
+        return;
+    }
+
+    history.maybeSnapshot();
+    loadTasksFromDatabase();
+    updateCharts();
+    notifications->info("Project Pack", QString("%1 task(s), %2 version(s) and %3 attachment(s) imported")
+                                            .arg(imported.taskIds.size()).arg(imported.versions).arg(imported.attachments));
+}
+
+void MainWindow::showMap()
+{
+    QDialog *dialog = new QDialog(this);
+    dialog->setWindowTitle("Site Map");
+    dialog->resize(1200, 750);
+
+    MapView *map = new MapView(tiles, &sites, dialog);
+
+    QListWidget *siteList = new QListWidget(dialog);
+    siteList->setUniformItemSizes(true);
+    siteList->setMaximumWidth(320);
+
+    QDoubleSpinBox *radiusSpin = new QDoubleSpinBox(dialog);
+    radiusSpin->setRange(0.1, 1000);
+    radiusSpin->setValue(10);
+    radiusSpin->setSuffix(" km");
+    QPushButton *nearButton = new QPushButton("Near Center", dialog);
+
+    QLabel *listLabel = new QLabel(dialog);
+    QLabel *tilesLabel = new QLabel(dialog);
+
+    // La liste suit la vue : seule la requête R-tree de la zone visible est parcourue
+    const int listLimit = 500;
+    auto fillList = [siteList, listLabel, listLimit](const QVector<SpatialIndex::Entry> &entries, const QString &caption) {
+        siteList->clear();
+        for (int i = 0; i < entries.size() && i < listLimit; ++i) {
+            QListWidgetItem *item = new QListWidgetItem(entries[i].label, siteList);
+            item->setData(Qt::UserRole, entries[i].key);
+            item->setToolTip(SpatialIndex::formatCoordinates(entries[i].point));
+        }
+        listLabel->setText(entries.size() > listLimit
+                               ? QString("%1: first %2 of %3").arg(caption).arg(listLimit).arg(entries.size())
+                               : QString("%1: %2").arg(caption).arg(entries.size()));
+    };
+    connect(map, &MapView::viewChanged, dialog, [this, map, fillList]() {
+        fillList(sites.within(map->visibleBox()), "In view");
+    });
+    connect(nearButton, &QPushButton::clicked, dialog, [this, map, radiusSpin, fillList]() {
+        fillList(sites.withinRadius(map->center(), radiusSpin->value() * 1000),
+                 QString("Within %1 km of center").arg(radiusSpin->value()));
+    });
+
+    auto updateTilesLabel = [this, tilesLabel](int pending) {
+        if (tiles->urlTemplate().isEmpty()) {
+            tilesLabel->setText("Offline: cached tiles only");
+        } else {
+            tilesLabel->setText(pending > 0 ? QString("Downloading %1 tile(s)...").arg(pending) : QString("Tiles up to date"));
+        }
+    };
+    connect(tiles, &TileCache::queueChanged, dialog, updateTilesLabel);
+    updateTilesLabel(tiles->pendingCount());
+
+    // Double-clic sur une tâche : sélection de sa ligne dans la table principale
+    auto activate = [this, dialog](const QString &key) {
+        for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+            if (ui->taskTable->item(row, 0)->text() == key) {
+                ui->taskTable->selectRow(row);
+                ui->taskTable->scrollToItem(ui->taskTable->item(row, 0));
+                dialog->accept();
+                return;
+            }
+        }
+    };
+    connect(map, &MapView::siteActivated, dialog, activate);
+    connect(siteList, &QListWidget::itemDoubleClicked, dialog, [activate](QListWidgetItem *item) {
+        activate(item->data(Qt::UserRole).toString());
+    });
+
+    QPushButton *fitButton = new QPushButton("Fit All", dialog);
+    connect(fitButton, &QPushButton::clicked, map, &MapView::fitAll);
+
+    // Préchargement pour un usage hors ligne : zone visible, zoom courant et deux niveaux de plus
+    QPushButton *seedButton = new QPushButton("Seed Visible Area", dialog);
+    connect(seedButton, &QPushButton::clicked, dialog, [this, dialog, map]() {
+        if (tiles->urlTemplate().isEmpty()) {
+            QMessageBox::information(dialog, "Seed Tiles", "Configure a tile server first.");
+            return;
+        }
+        SpatialIndex::Box box = map->visibleBox();
+        int queued = tiles->seed(box.minX, box.maxY, box.maxX, box.minY, map->zoom(), map->zoom() + 2);
+        QMessageBox::information(dialog, "Seed Tiles", QString("%1 tile(s) queued for download.").arg(queued));
+    });
+
+    QPushButton *serverButton = new QPushButton("Tile Server...", dialog);
+    connect(serverButton, &QPushButton::clicked, dialog, [this, dialog, map, updateTilesLabel]() {
+        bool ok = false;
+        QString url = QInputDialog::getText(dialog, "Tile Server",
+                                            "URL template ({z}/{x}/{y}), empty for offline:",
+                                            QLineEdit::Normal, tiles->urlTemplate(), &ok);
+        if (!ok) return;
+        QSettings("TaskManager", "TaskManager").setValue("map/tileUrl", url.trimmed());
+        tiles->setUrlTemplate(url);
+        updateTilesLabel(tiles->pendingCount());
+        map->update();
+    });
+
+    QPushButton *closeButton = new QPushButton("Close", dialog);
+    connect(closeButton, &QPushButton::clicked, dialog, &QDialog::accept);
+
+    QHBoxLayout *radius = new QHBoxLayout;
+    radius->addWidget(new QLabel("Radius:", dialog));
+    radius->addWidget(radiusSpin);
+    radius->addWidget(nearButton);
+
+    QVBoxLayout *side = new QVBoxLayout;
+    side->addLayout(radius);
+    side->addWidget(listLabel);
+    side->addWidget(siteList, 1);
+
+    QHBoxLayout *body = new QHBoxLayout;
+    body->addWidget(map, 1);
+    body->addLayout(side);
+
+    QHBoxLayout *controls = new QHBoxLayout;
+    controls->addWidget(fitButton);
+    controls->addWidget(seedButton);
+    controls->addWidget(serverButton);
+    controls->addWidget(tilesLabel);
+    controls->addStretch();
+    controls->addWidget(closeButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    layout->addLayout(body, 1);
+    layout->addLayout(controls);
+
+    dialog->show();
+    map->fitAll();
+    fillList(sites.within(map->visibleBox()), "In view");
+    dialog->exec();
+    delete dialog;
+}
+
+void MainWindow::showHistory()
+{
+    QDialog *dialog = new QDialog(this);
+    dialog->setWindowTitle("Task History");
+    dialog->resize(1200, 650);
+
+    QDateTimeEdit *whenEdit = new QDateTimeEdit(QDateTime::currentDateTime(), dialog);
+    whenEdit->setDisplayFormat("yyyy-MM-dd HH:mm");
+    whenEdit->setCalendarPopup(true);
+    QPushButton *showButton = new QPushButton("Show", dialog);
+
+    const QStringList columns = HistoryStore::trackedColumns();
+    QTableWidget *table = new QTableWidget(0, columns.size() + 1, dialog);
+    QStringList headers = {"ID"};
+    for (const QString &column : columns) {
+        headers << QString(column).replace('_', ' ');
+    }
+    table->setHorizontalHeaderLabels(headers);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setSelectionMode(QAbstractItemView::SingleSelection);
+    table->verticalHeader()->setVisible(false);
+
+    QListWidget *versionList = new QListWidget(dialog);
+    versionList->setMaximumWidth(380);
+    versionList->setWordWrap(true);
+
+    QLabel *summaryLabel = new QLabel(dialog);
+    summaryLabel->setWordWrap(true);
+
+    // Dernier instantané antérieur + rejeu des versions suivantes, sans parcourir tout l'historique
+    auto refresh = [this, whenEdit, table, summaryLabel, columns]() {
+        int replayed = 0;
+        QString error;
+        HistoryStore::State state = history.stateAt(whenEdit->dateTime(), &replayed, &error);
+        if (!error.isEmpty()) {
+            summaryLabel->setText(QString("Failed to read history: %1").arg(error));
+            return;
+        }
+
+        table->setSortingEnabled(false);
+        table->setRowCount(state.size());
+        int row = 0;
+        for (auto it = state.constBegin(); it != state.constEnd(); ++it, ++row) {
+            table->setItem(row, 0, new QTableWidgetItem(it.key()));
+            for (int col = 0; col < columns.size(); ++col) {
+                table->setItem(row, col + 1, new QTableWidgetItem(it.value().value(columns[col]).toString()));
+            }
+        }
+        table->setSortingEnabled(true);
+
+        QDateTime first = history.firstRecorded();
+        summaryLabel->setText(
+            QString("%1 task(s) as of %2 (%3 change(s) replayed after the nearest snapshot).\n"
+                    "History recorded since %4: %5 version(s), %6 snapshot(s). "
+                    "Versions older than %7 days are kept as one snapshot per month.")
+                .arg(state.size())
+                .arg(whenEdit->dateTime().toString("yyyy-MM-dd HH:mm"))
+                .arg(replayed)
+                .arg(first.isValid() ? first.toString("yyyy-MM-dd HH:mm") : QString("-"))
+                .arg(history.versionCount())
+                .arg(history.snapshotCount())
+                .arg(HistoryStore::defaultRetentionDays));
+    };
+
+    connect(showButton, &QPushButton::clicked, dialog, refresh);
+    connect(table, &QTableWidget::currentCellChanged, dialog, [this, table, versionList, columns](int row) {
+        versionList->clear();
+        if (row < 0 || !table->item(row, 0)) return;
+
+        for (const HistoryStore::Version &version : history.taskHistory(table->item(row, 0)->text())) {
+            QStringList values;
+            for (const QString &column : columns) {
+                QString value = version.fields.value(column).toString();
+                if (!value.isEmpty()) values << QString("%1: %2").arg(column, value);
+            }
+            QString title = QString("%1  %2 %3").arg(version.changedAt, version.op, version.taskId);
+            if (!version.previousId.isEmpty()) title += QString(" (was %1)").arg(version.previousId);
+            new QListWidgetItem(values.isEmpty() ? title : title + "\n" + values.join(", "), versionList);
+        }
+    });
+    refresh();
+
+    QHBoxLayout *controls = new QHBoxLayout;
+    controls->addWidget(new QLabel("As of:", dialog));
+    controls->addWidget(whenEdit);
+    controls->addWidget(showButton);
+    controls->addStretch();
+
+    QHBoxLayout *body = new QHBoxLayout;
+    body->addWidget(table, 1);
+    body->addWidget(versionList);
+
+    QPushButton *closeButton = new QPushButton("Close", dialog);
+    connect(closeButton, &QPushButton::clicked, dialog, &QDialog::accept);
+
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    layout->addLayout(controls);
+    layout->addLayout(body, 1);
+    layout->addWidget(summaryLabel);
+    layout->addWidget(closeButton, 0, Qt::AlignRight);
+
+    dialog->exec();
+    delete dialog;
+}
+
+void MainWindow::showBackups()
+{
+    BackupsDialog *dialog = new BackupsDialog(backups, this);
+    dialog->exec();
+    delete dialog;
+}
+
+void MainWindow::restoreDatabase(const QString &preparedPath)
+{
+    // Aucune lecture en arrière-plan ne doit rester ouverte sur le fichier remplacé
+    if (reports->isRunning()) {
+        QFile::remove(preparedPath);
+        notifications->error("Restore Backup", "A weekly report is being written, restore again once it has finished");
+        return;
+    }
+
+    QString dbPath = db.databaseName();
+    QString error;
+    timeTracker->flush();
+    db.close();
+    bool replaced = BackupManager::replaceDatabase(preparedPath, dbPath, &error);
+    if (!replaced) {
+        QFile::remove(preparedPath);
+    }
+
+    // Ancien ou nouveau fichier, la connexion est rouverte et les migrations rejouées :
+    // une sauvegarde ancienne n'a pas les tables et colonnes ajoutées depuis
+    bool initialized = initializeDatabase();
+    journal.clear();
+    updateUndoButtons();
+    loadTasksFromDatabase();
+    updateCharts();
+
+    if (!replaced) {
+        notifications->error("Restore Backup", QString("Restore failed: %1").arg(error));
+    } else if (initialized) {
+        notifications->info("Restore Backup", "Backup restored");
+    }
+}
+
+void MainWindow::showArchive()
+{
+    QDialog *dialog = new QDialog(this);
+    dialog->setWindowTitle("Archive");
+    dialog->resize(750, 450);
+
+    QLabel *summaryLabel = new QLabel(dialog);
+    QTableWidget *table = new QTableWidget(0, 4, dialog);
+    table->setHorizontalHeaderLabels({"Year", "Tasks", "Size", "File"});
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setSelectionMode(QAbstractItemView::SingleSelection);
+    table->horizontalHeader()->setStretchLastSection(true);
+
+    auto refresh = [this, table, summaryLabel]() {
+        const QVector<ArchiveStore::Shard> shards = archive.shards();
+        int archived = 0;
+        table->setRowCount(shards.size());
+        for (int i = 0; i < shards.size(); ++i) {
+            table->setItem(i, 0, new QTableWidgetItem(QString::number(shards[i].year)));
+            table->setItem(i, 1, new QTableWidgetItem(QString::number(shards[i].taskCount)));
+            table->setItem(i, 2, new QTableWidgetItem(QString("%1 KB").arg(shards[i].size / 1024)));
+            table->setItem(i, 3, new QTableWidgetItem(QDir::toNativeSeparators(shards[i].path)));
+            archived += shards[i].taskCount;
+        }
+        summaryLabel->setText(QString("%1 task(s) in the working database, %2 archived in %3 yearly file(s)")
+                                  .arg(allTaskRecords().size()).arg(archived).arg(shards.size()));
+    };
+    refresh();
+
+    // La table et les index en mémoire ne décrivent plus la base active
+    auto reload = [this](const QStringList &taskIds) {
+        for (const QString &taskId : taskIds) {
+            timeTracker->stopTask(taskId, "archive");
+        }
+        journal.clear();
+        updateUndoButtons();
+        loadTasksFromDatabase();
+        updateCharts();
+    };
+
+    QDateEdit *beforeEdit = new QDateEdit(QDate(QDate::currentDate().year(), 1, 1), dialog);
+    beforeEdit->setCalendarPopup(true);
+    beforeEdit->setDisplayFormat("yyyy-MM-dd");
+    QPushButton *archiveButton = new QPushButton("Archive Completed", dialog);
+    archiveButton->setToolTip("Move tasks completed before this date to one file per completion year");
+    connect(archiveButton, &QPushButton::clicked, dialog, [this, dialog, beforeEdit, refresh, reload]() {
+        if (QMessageBox::question(dialog, "Archive Tasks",
+                                  QString("Move all tasks completed before %1 out of the working database?")
+                                      .arg(beforeEdit->date().toString("yyyy-MM-dd")),
+                                  QMessageBox::Yes | QMessageBox::No, QMessageBox::No) != QMessageBox::Yes) {
+            return;
+        }
+
+        // Les années déjà validées restent archivées même si une suivante échoue
+        QStringList moved;
+        QString error;
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        bool ok = archive.archiveCompleted(beforeEdit->date(), &moved, &error);
+        QApplication::restoreOverrideCursor();
+        if (!ok) {
+            notifications->error("Archive Error", QString("Archiving failed: %1").arg(error));
+        }
+        if (!moved.isEmpty()) {
+            reload(moved);
+        }
+        notifications->info("Archive", QString("%1 completed task(s) moved to the archive").arg(moved.size()));
+        refresh();
+    });
+
+    QPushButton *restoreButton = new QPushButton("Restore Year", dialog);
+    connect(restoreButton, &QPushButton::clicked, dialog, [this, dialog, table, refresh, reload]() {
+        int row = table->currentRow();
+        if (row < 0) return;
+        int year = table->item(row, 0)->text().toInt();
+        if (QMessageBox::question(dialog, "Restore Archive",
+                                  QString("Move the %1 tasks of %2 back into the working database?")
+                                      .arg(table->item(row, 1)->text()).arg(year),
+                                  QMessageBox::Yes | QMessageBox::No, QMessageBox::No) != QMessageBox::Yes) {
+            return;
+        }
+
+        QStringList restored;
+        QString error;
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        bool ok = archive.restoreYear(year, &restored, &error);
+        QApplication::restoreOverrideCursor();
+        if (!ok) {
+            notifications->error("Archive Error", QString("Restoring %1 failed: %2").arg(year).arg(error));
+            return;
+        }
+        reload(QStringList());
+        notifications->info("Archive", QString("%1 task(s) of %2 restored").arg(restored.size()).arg(year));
+        refresh();
+    });
+
+    QPushButton *closeButton = new QPushButton("Close", dialog);
+    connect(closeButton, &QPushButton::clicked, dialog, &QDialog::accept);
+
+    QHBoxLayout *archiveLayout = new QHBoxLayout;
+    archiveLayout->addWidget(new QLabel("Completed before:", dialog));
+    archiveLayout->addWidget(beforeEdit);
+    archiveLayout->addWidget(archiveButton);
+    archiveLayout->addStretch();
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    buttonLayout->addWidget(restoreButton);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(closeButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    layout->addWidget(summaryLabel);
+    layout->addLayout(archiveLayout);
+    layout->addWidget(table, 1);
+    layout->addLayout(buttonLayout);
+
+    dialog->exec();
+    delete dialog;
+}
+
+void MainWindow::showRecurring()
+{
+    RecurringDialog *dialog = new RecurringDialog(&recurrence, this);
+    connect(dialog, &RecurringDialog::seriesChanged, this, &MainWindow::refreshOccurrenceRows);
+    connect(dialog, &RecurringDialog::seriesChanged, this, &MainWindow::updateCharts);
+    dialog->exec();
+    delete dialog;
+}
+
+static QString formatDuration(qint64 seconds)
+{
+    return QString("%1:%2").arg(seconds / 3600).arg((seconds % 3600) / 60, 2, 10, QChar('0'));
+}
+
+void MainWindow::showTimesheet()
+{
+    QDialog *dialog = new QDialog(this);
+    dialog->setWindowTitle("Timesheet");
+    dialog->resize(1000, 600);
+
+    QDateEdit *toEdit = new QDateEdit(QDate::currentDate(), dialog);
+    toEdit->setDisplayFormat("yyyy-MM-dd");
+    toEdit->setCalendarPopup(true);
+
+    QSpinBox *weeksSpin = new QSpinBox(dialog);
+    weeksSpin->setRange(1, 52);
+    weeksSpin->setValue(4);
+
+    QComboBox *groupCombo = new QComboBox(dialog);
+    groupCombo->addItems({"Person", "Task", "Task / Person"});
+
+    QTableWidget *table = new QTableWidget(dialog);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+
+    QLabel *clocksLabel = new QLabel(dialog);
+    clocksLabel->setWordWrap(true);
+
+    // Une ligne par groupe, une colonne par semaine : lecture des seuls agrégats hebdomadaires
+    auto refresh = [this, toEdit, weeksSpin, groupCombo, table, clocksLabel]() {
+        QDate lastWeek = TimeTracker::weekOf(toEdit->date());
+        QDate firstWeek = lastWeek.addDays(-7 * (weeksSpin->value() - 1));
+        int group = groupCombo->currentIndex();
+
+        QMap<QString, QVector<qint64>> totals;
+        for (const TimeTracker::Rollup &rollup : timeTracker->rollups(firstWeek, lastWeek)) {
+            QString key = group == 0 ? rollup.person
+                        : group == 1 ? rollup.taskId
+                                     : QString("%1 / %2").arg(rollup.taskId, rollup.person);
+            QVector<qint64> &weeks = totals[key];
+            if (weeks.isEmpty()) weeks.fill(0, weeksSpin->value() + 1);
+            int week = int(firstWeek.daysTo(rollup.weekStart) / 7);
+            weeks[week] += rollup.seconds;
+            weeks.last() += rollup.seconds;
+        }
+
+        QStringList headers = {groupCombo->currentText()};
+        for (int week = 0; week < weeksSpin->value(); ++week) {
+            headers << firstWeek.addDays(7 * week).toString("MMM d");
+        }
+        headers << "Total";
+
+        table->clear();
+        table->setColumnCount(headers.size());
+        table->setHorizontalHeaderLabels(headers);
+        table->setRowCount(totals.size() + 1);
+
+        QVector<qint64> columnTotals(weeksSpin->value() + 1, 0);
+        int row = 0;
+        for (auto it = totals.constBegin(); it != totals.constEnd(); ++it, ++row) {
+            table->setItem(row, 0, new QTableWidgetItem(it.key()));
+            for (int col = 0; col < it.value().size(); ++col) {
+                columnTotals[col] += it.value()[col];
+                QTableWidgetItem *item = new QTableWidgetItem(it.value()[col] ? formatDuration(it.value()[col]) : QString());
+                item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                table->setItem(row, col + 1, item);
+            }
+        }
+        QTableWidgetItem *totalLabel = new QTableWidgetItem("Total");
+        QFont bold = totalLabel->font();
+        bold.setBold(true);
+        totalLabel->setFont(bold);
+        table->setItem(row, 0, totalLabel);
+        for (int col = 0; col < columnTotals.size(); ++col) {
+            QTableWidgetItem *item = new QTableWidgetItem(formatDuration(columnTotals[col]));
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            item->setFont(bold);
+            table->setItem(row, col + 1, item);
+        }
+        table->resizeColumnsToContents();
+
+        QStringList running;
+        for (const TimeTracker::Clock &clock : timeTracker->runningClocks()) {
+            running << QString("%1 on %2 since %3 (%4)")
+                           .arg(clock.person, clock.taskId, clock.started.toString("yyyy-MM-dd HH:mm"),
+                                formatDuration(clock.started.secsTo(QDateTime::currentDateTime())));
+        }
+        clocksLabel->setText(running.isEmpty() ? QString("No clock running.")
+                                               : "Running (not yet counted): " + running.join("; "));
+    };
+
+    QPushButton *entryButton = new QPushButton("Add Entry...", dialog);
+    connect(entryButton, &QPushButton::clicked, dialog, [this, dialog, refresh]() {
+        QDialog entryDialog(dialog);
+        QFormLayout form(&entryDialog);
+        entryDialog.setWindowTitle("Add Time Entry");
+
+        QComboBox *taskCombo = new QComboBox(&entryDialog);
+        for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+            if (isOccurrenceRow(row)) continue;
+            taskCombo->addItem(QString("%1 - %2").arg(ui->taskTable->item(row, 0)->text(),
+                                                      ui->taskTable->item(row, 1)->text()),
+                               ui->taskTable->item(row, 7)->text());
+            taskCombo->setItemData(taskCombo->count() - 1, ui->taskTable->item(row, 0)->text(), Qt::UserRole + 1);
+        }
+        QLineEdit *personEdit = new QLineEdit(taskCombo->currentData().toString(), &entryDialog);
+        connect(taskCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), &entryDialog,
+                [taskCombo, personEdit]() { personEdit->setText(taskCombo->currentData().toString()); });
+        QDateTimeEdit *startEdit = new QDateTimeEdit(QDateTime::currentDateTime().addSecs(-3600), &entryDialog);
+        startEdit->setDisplayFormat("yyyy-MM-dd HH:mm");
+        startEdit->setCalendarPopup(true);
+        QDoubleSpinBox *hoursSpin = new QDoubleSpinBox(&entryDialog);
+        hoursSpin->setRange(0.25, 24);
+        hoursSpin->setSingleStep(0.25);
+        hoursSpin->setValue(1);
+        hoursSpin->setSuffix(" h");
+
+        form.addRow("Task:", taskCombo);
+        form.addRow("Person:", personEdit);
+        form.addRow("Start:", startEdit);
+        form.addRow("Duration:", hoursSpin);
+        QDialogButtonBox buttonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, &entryDialog);
+        form.addRow(&buttonBox);
+        connect(&buttonBox, &QDialogButtonBox::accepted, &entryDialog, &QDialog::accept);
+        connect(&buttonBox, &QDialogButtonBox::rejected, &entryDialog, &QDialog::reject);
+
+        if (entryDialog.exec() != QDialog::Accepted || taskCombo->currentIndex() < 0) return;
+        QString person = personEdit->text().trimmed();
+        timeTracker->addEntry(taskCombo->currentData(Qt::UserRole + 1).toString(),
+                              person.isEmpty() ? QString("Unassigned") : person,
+                              startEdit->dateTime(), qRound64(hoursSpin->value() * 3600), "manual");
+        refresh();
+    });
+
+    connect(toEdit, &QDateEdit::dateChanged, dialog, refresh);
+    connect(weeksSpin, QOverload<int>::of(&QSpinBox::valueChanged), dialog, refresh);
+    connect(groupCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), dialog, refresh);
+    refresh();
+
+    QHBoxLayout *controls = new QHBoxLayout;
+    controls->addWidget(new QLabel("Up to week of:", dialog));
+    controls->addWidget(toEdit);
+    controls->addWidget(new QLabel("Weeks:", dialog));
+    controls->addWidget(weeksSpin);
+    controls->addWidget(new QLabel("Group by:", dialog));
+    controls->addWidget(groupCombo);
+    controls->addStretch();
+    controls->addWidget(entryButton);
+
+    QPushButton *closeButton = new QPushButton("Close", dialog);
+    connect(closeButton, &QPushButton::clicked, dialog, &QDialog::accept);
+
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    layout->addLayout(controls);
+    layout->addWidget(table, 1);
+    layout->addWidget(clocksLabel);
+    layout->addWidget(closeButton, 0, Qt::AlignRight);
+
+    dialog->exec();
+    delete dialog;
+}
+
+void MainWindow::updateNotificationsButton()
+{
+    int unread = notifications->unreadCount();
+    ui->navNotificationsBtn->setText(unread ? QString("Notifications (%1)").arg(unread) : QString("Notifications"));
+}
+
+void MainWindow::showNotificationHistory()
+{
+    QDialog *dialog = new QDialog(this);
+    dialog->setWindowTitle("Notification History");
+    dialog->resize(900, 500);
+
+    QTableWidget *table = new QTableWidget(dialog);
+    table->setColumnCount(5);
+    table->setHorizontalHeaderLabels({"Last", "Level", "Title", "Message", "Count"});
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->horizontalHeader()->setStretchLastSection(false);
+
+    // Plus récents en haut; les erreurs gardent leur couleur
+    auto refresh = [this, table]() {
+        static const QStringList levels = {"Info", "Warning", "Error"};
+        QVector<NotificationCenter::Notification> entries = notifications->history();
+        table->setRowCount(entries.size());
+        for (int i = 0; i < entries.size(); ++i) {
+            const NotificationCenter::Notification &entry = entries[entries.size() - 1 - i];
+            QStringList cells = {entry.last.toString("yyyy-MM-dd HH:mm:ss"), levels.value(entry.level),
+                                 entry.title, entry.text, QString::number(entry.count)};
+            for (int col = 0; col < cells.size(); ++col) {
+                QTableWidgetItem *item = new QTableWidgetItem(cells[col]);
+                if (entry.level == NotificationCenter::Error) item->setForeground(QColor(220, 53, 69));
+                if (col == 3) item->setToolTip(entry.text);
+                table->setItem(i, col, item);
+            }
+        }
+        table->resizeColumnsToContents();
+    };
+    refresh();
+    notifications->markAllRead();
+
+    QPushButton *clearButton = new QPushButton("Clear", dialog);
+    connect(clearButton, &QPushButton::clicked, dialog, [this, refresh]() {
+        notifications->clearHistory();
+        refresh();
+    });
+    QPushButton *closeButton = new QPushButton("Close", dialog);
+    connect(closeButton, &QPushButton::clicked, dialog, &QDialog::accept);
+
+    QHBoxLayout *buttons = new QHBoxLayout;
+    buttons->addWidget(clearButton);
+    buttons->addStretch();
+    buttons->addWidget(closeButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    layout->addWidget(table, 1);
+    layout->addLayout(buttons);
+
+    dialog->exec();
+    delete dialog;
+}
+
+void MainWindow::registerDiagnostics()
+{
+    // Lues au moment du rapport, jamais entretenues en continu
+    Diagnostics::setGauge("task table rows", [this]() { return qint64(ui->taskTable->rowCount()); });
+    Diagnostics::setGauge("task table bytes (est.)", [this]() {
+        qint64 bytes = 0;
+        for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+            for (int col = 0; col < ui->taskTable->columnCount(); ++col) {
+                if (QTableWidgetItem *item = ui->taskTable->item(row, col)) {
+                    bytes += sizeof(QTableWidgetItem) + item->text().size() * sizeof(QChar);
+                }
+            }
+        }
+        return bytes;
+    });
+    Diagnostics::setGauge("recurring occurrence rows", [this]() {
+        qint64 count = 0;
+        for (int row = 0; row < ui->taskTable->rowCount(); ++row) {
+            if (isOccurrenceRow(row)) ++count;
+        }
+        return count;
+    });
+    Diagnostics::setGauge("calendar date formats", [this]() {
+        return qint64(calendarWidget ? calendarWidget->dateTextFormat().size() : 0);
+    });
+    Diagnostics::setGauge("workload assignees", [this]() { return qint64(workload.assignees().size()); });
+    Diagnostics::setGauge("map sites indexed", [this]() { return qint64(sites.size()); });
+    Diagnostics::setGauge("time events pending", [this]() { return qint64(timeTracker->pendingCount()); });
+    Diagnostics::setGauge("notification history", [this]() { return qint64(notifications->history().size()); });
+}
+
+void MainWindow::showDiagnostics()
+{
+    QDialog *dialog = new QDialog(this);
+    dialog->setWindowTitle("Diagnostics");
+    dialog->resize(900, 650);
+
+    QPlainTextEdit *reportView = new QPlainTextEdit(dialog);
+    reportView->setReadOnly(true);
+    reportView->setLineWrapMode(QPlainTextEdit::NoWrap);
+    reportView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    auto refresh = [reportView]() {
+        int scroll = reportView->verticalScrollBar()->value();
+        reportView->setPlainText(Diagnostics::report());
+        reportView->verticalScrollBar()->setValue(scroll);
+    };
+    refresh();
+
+    QTimer *refreshTimer = new QTimer(dialog);
+    connect(refreshTimer, &QTimer::timeout, dialog, refresh);
+    refreshTimer->start(1000);
+
+    QPushButton *resetButton = new QPushButton("Reset Counters", dialog);
+    connect(resetButton, &QPushButton::clicked, dialog, [refresh]() {
+        Diagnostics::reset();
+        refresh();
+    });
+    QPushButton *copyButton = new QPushButton("Copy", dialog);
+    connect(copyButton, &QPushButton::clicked, dialog, []() {
+        QApplication::clipboard()->setText(Diagnostics::report());
+    });
+    QPushButton *closeButton = new QPushButton("Close", dialog);
+    connect(closeButton, &QPushButton::clicked, dialog, &QDialog::accept);
+
+    QHBoxLayout *buttons = new QHBoxLayout;
+    buttons->addWidget(resetButton);
+    buttons->addWidget(copyButton);
+    buttons->addStretch();
+    buttons->addWidget(closeButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    layout->addWidget(reportView, 1);
+    layout->addLayout(buttons);
+
+    dialog->exec();
+    delete dialog;
+}
+
+void MainWindow::checkLowStock(int materialId)
+{
+    // Lecture de stock_levels par clé : ne dépend pas de la taille du registre
+    MaterialsStore::Material material = materials.material(materialId);
+    if (!material.isLow()) return;
+
+    if (trayIcon && trayIcon->isVisible()) {
+        trayIcon->showMessage("Low Stock",
+                              QString("%1: %2 %3 left (reorder level %4)")
+                                  .arg(material.name,
+                                       QString::number(material.quantity, 'f', 2),
+                                       material.unit,
+                                       QString::number(material.reorderLevel, 'f', 2)),
+                              QSystemTrayIcon::Warning,
+                              10000);
+    }
+    sendToArduino("LOW_STOCK");
+}
+
+void MainWindow::showWorkload()
+{
+    QDialog *dialog = new QDialog(this);
+    dialog->setWindowTitle("Team Workload");
+    dialog->resize(1100, 600);
+
+    QDateEdit *fromEdit = new QDateEdit(QDate::currentDate(), dialog);
+    fromEdit->setDisplayFormat("yyyy-MM-dd");
+    fromEdit->setCalendarPopup(true);
+
+    QSpinBox *weeksSpin = new QSpinBox(dialog);
+    weeksSpin->setRange(1, 26);
+    weeksSpin->setValue(6);
+
+    QSpinBox *limitSpin = new QSpinBox(dialog);
+    limitSpin->setRange(1, 50);
+    limitSpin->setValue(workloadLimit);
+
+    WorkloadHeatmap *heatmap = new WorkloadHeatmap;
+    QScrollArea *scrollArea = new QScrollArea(dialog);
+    scrollArea->setWidget(heatmap);
+
+    QLabel *summaryLabel = new QLabel(dialog);
+    summaryLabel->setWordWrap(true);
+
+    // Seuls les profils modifiés depuis le dernier affichage sont recalculés
+    auto refresh = [this, fromEdit, weeksSpin, limitSpin, heatmap, summaryLabel]() {
+        workloadLimit = limitSpin->value();
+        QDate from = fromEdit->date();
+        int days = weeksSpin->value() * 7;
+
+        QStringList names = workload.assignees();
+        QVector<QVector<int>> loads;
+        loads.reserve(names.size());
+        for (const QString &name : names) {
+            loads << workload.dailyLoad(name, from, days);
+        }
+        heatmap->setData(names, loads, from, workloadLimit);
+
+        QStringList alerts = workloadAlerts(from, from.addDays(days - 1));
+        summaryLabel->setText(alerts.isEmpty()
+                                  ? QString("Nobody has more than %1 concurrent tasks in this period.").arg(workloadLimit)
+                                  : alerts.join("\n"));
+    };
+
+    connect(fromEdit, &QDateEdit::dateChanged, dialog, refresh);
+    connect(weeksSpin, QOverload<int>::of(&QSpinBox::valueChanged), dialog, refresh);
+    connect(limitSpin, QOverload<int>::of(&QSpinBox::valueChanged), dialog, refresh);
+    refresh();
+
+    QHBoxLayout *controls = new QHBoxLayout;
+    controls->addWidget(new QLabel("From:", dialog));
+    controls->addWidget(fromEdit);
+    controls->addWidget(new QLabel("Weeks:", dialog));
+    controls->addWidget(weeksSpin);
+    controls->addWidget(new QLabel("Max concurrent tasks:", dialog));
+    controls->addWidget(limitSpin);
+    controls->addStretch();
+
+    QPushButton *closeButton = new QPushButton("Close", dialog);
+    connect(closeButton, &QPushButton::clicked, dialog, &QDialog::accept);
+
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    layout->addLayout(controls);
+    layout->addWidget(scrollArea, 1);
+    layout->addWidget(summaryLabel);
+    layout->addWidget(closeButton, 0, Qt::AlignRight);
+
+    dialog->exec();
+    delete dialog;
 }
 
 bool MainWindow::validateRowSelection(bool requireSelection) {
@@ -1137,12 +4560,15 @@ void MainWindow::on_taskTable_cellActivated(int row, int column)
 
 MainWindow::~MainWindow()
 {
+    Diagnostics::clearGauges();
     if (db.isOpen()) {
+        timeTracker->flush();
         db.close();
     }
     delete ui;
     delete networkManager;
     delete calendarWidget;
+    delete ganttView;
     if (arduino && arduino->isOpen()) {
         arduino->close();
         delete arduino;
@@ -10,6 +10,7 @@
 #include <QMenu>
 #include <QLineEdit>
 #include <QComboBox>
+#include <QMap>
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QStandardPaths>
@@ -17,6 +18,33 @@
 #include <QCalendarWidget>
 #include <QSerialPort>
 #include <QSerialPortInfo>
+#include <QTimer>
+#include "descriptionstore.h"
+#include "filterquery.h"
+#include "fuzzysearch.h"
+#include "taskgraph.h"
+#include "ganttview.h"
+#include "workloadengine.h"
+#include "trendindex.h"
+#include "analyticscube.h"
+#include "chartrenderer.h"
+#include "materialsstore.h"
+#include "invoiceengine.h"
+#include "projectstore.h"
+#include "attachmentstore.h"
+#include "thumbnailcache.h"
+#include "spatialindex.h"
+#include "tilecache.h"
+#include "historystore.h"
+#include "backupmanager.h"
+#include "reportscheduler.h"
+#include "archivestore.h"
+#include "recurrencestore.h"
+#include "timetracker.h"
+#include "notificationcenter.h"
+#include "toastoverlay.h"
+#include "diagnostics.h"
+#include "undojournal.h"
 
 namespace Ui {
 class MainWindow;
@@ -30,6 +58,9 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private slots:
     void on_addBtn_clicked();
     void on_modifyBtn_clicked();
@@ -38,6 +69,12 @@ private slots:
     void on_searchBtn_clicked();
     void on_sortBtn_clicked();
     void on_notificationBtn_clicked();
+    void on_filterBtn_clicked();
+    void on_filesBtn_clicked();
+    void on_bulkBtn_clicked();
+    void on_clockBtn_clicked();
+    void on_undoBtn_clicked();
+    void on_redoBtn_clicked();
 
     void handleNavButtonClick(QAbstractButton* clickedButton);
     void on_navTasksBtn_clicked();
@@ -46,6 +83,8 @@ private slots:
 
     void on_showStatusStats_clicked();
     void on_showDurationStats_clicked();
+    void on_showTrendStats_clicked();
+    void on_showPivotStats_clicked();
 
     void on_taskTable_cellActivated(int row, int column);
 
@@ -55,30 +94,145 @@ private:
     QSqlDatabase db;
     QSystemTrayIcon *trayIcon;
     QCalendarWidget *calendarWidget;
+    GanttView *ganttView;
     QSerialPort *arduino;
     QString arduinoPortName;
     bool arduinoIsAvailable;
+    DescriptionStore descriptions;
+    FuzzyIndex fuzzyIndex;
+    bool fuzzyIndexDirty;
+    QVector<int> rankedFrom;        // position d'affichage d'origine de chaque ligne classée
+    FuzzyHighlightDelegate *highlightDelegate;
+    TaskGraph taskGraph;
+    WorkloadEngine workload;
+    int workloadLimit;
+    TrendIndex trends;
+    AnalyticsCube analytics;
+    ChartRenderer chartRenderer;
+    MaterialsStore materials;
+    InvoiceEngine invoices;
+    ProjectStore projects;
+    AttachmentStore attachments;
+    QSet<QString> detachedAttachments;      // tâches supprimées dont l'annulation rendra les pièces jointes
+    ThumbnailCache *thumbnails;
+    SpatialIndex sites;
+    TileCache *tiles;
+    HistoryStore history;
+    BackupManager *backups;
+    ReportScheduler *reports;
+    ArchiveStore archive;
+    RecurrenceStore recurrence;
+    QTimer occurrenceTimer;
+    TimeTracker *timeTracker;
+    NotificationCenter *notifications;
+    ToastOverlay *toastOverlay;
+    UndoJournal journal;
 
     bool initializeDatabase();
+    bool ensureColumn(const QString &table, const QString &column, const QString &definition);
     void loadTasksFromDatabase();
-    void saveTaskToDatabase(const QStringList &taskData);
+    bool saveTaskToDatabase(const QStringList &taskData);
     void updateTaskInDatabase(const QStringList &taskData, int row);
     void deleteTaskFromDatabase(const QString &taskId);
 
+    QString fullDescription(int row);
+    void setDescriptionCell(int row, const QString &text);
+    QStringList taskDataForRow(int row);
+    QStringList taskCellsForRow(int row) const;
+    QVector<int> selectedTaskRows() const;
+    bool execBatch(QSqlQuery &query, const QString &sql, const QList<QVariantList> &columns);
+    void bulkSetField(int column, const QString &value);
+    void bulkShiftDates();
+    void bulkDelete();
+    TaskRecord taskRecordAt(int row) const;
+    QVector<TaskRecord> allTaskRecords() const;
+
+    void applyFilterQuery(const QString &text);
+    int countFilterMatches(const QString &text);
+    QMap<QString, QString> loadSavedFilters();
+    void saveCurrentFilter();
+    void deleteSavedFilter(const QString &name);
+
+    void rebuildFuzzyIndex();
+    void showRankedRows(const QVector<FuzzyIndex::Match> &matches, const QString &query);
+    void restoreRankedOrder();
+
+    void loadDependencies();
+    bool saveDependencies(const QString &taskId, const QString &text);
+    void setScheduleCell(int row);
+    void updateScheduleCells(const QStringList &taskIds);
+    void setVarianceCell(int row);
+    void refreshVarianceCells();
+    QComboBox *createProjectCombo(QWidget *parent, int projectId);
+    void saveTaskCosts(const QString &taskId, int projectId, double planned, double actual, int row);
+    void saveTaskSite(const QString &taskId, const QString &name, const QString &coordinates);
+    void loadProjectSites();
+
+    bool isOccurrenceRow(int row) const;
+    void refreshOccurrenceRows();
+    bool materializeOccurrence(int row);
+    bool materializeOccurrences(const QVector<int> &rows);
+    void skipOccurrence(int row);
+    void paintCalendarOccurrences(int year, int month);
+
+    bool toggleClock(int row, const QString &source);
+    QString clockPerson(int row) const;
+    void updateClockButton();
+
+    QPair<QString, QString> taskTimestamps(const QString &taskId) const;
+    QStringList journalState(int row, bool fullText = true);
+    QVector<UndoJournal::Change> dependencyChangesForRemoval(const QSet<QString> &removedIds) const;
+    void recordChange(const QString &label, const QVector<UndoJournal::Change> &changes, bool mergeable = false);
+    void forgetUndoHistory(const QString &reason);
+    bool applyJournalEntry(const UndoJournal::Entry &entry, bool undo);
+    void updateUndoButtons();
+    void collectDetachedAttachments();
+    void dropDetachedAttachments(const QString &taskId);
+
+    void updateWorkload(const QStringList &taskData);
+    QStringList workloadAlerts(const QDate &from, const QDate &to);
+    void rebuildAnalytics();
+
     void setupTaskTable();
     void setupCalendar();
+    void setupTimeline();
     void setupSystemTray();
     void setupArduino();
     void checkDeadlineNotifications();
 
     QChart* createStatusPieChart();
     QChart* createDurationBarChart();
+    void exportChart(const ChartSpec &spec);
+    void exportTaskTable();
+    void exportReportPack();
+    void showReports();
+    void exportProjectPack(int projectId);
+    void importProjectPack();
+    void runInvoices();
+    void editBillingRates();
 
     void updateCharts();
     void sortTasks(int column, Qt::SortOrder order);
     bool validateTaskData(const QList<QLineEdit*>& fields, const QList<QComboBox*>& combos);
     bool validateRowSelection(bool requireSelection = true);
     void showCalendar();
+    void showTimeline();
+    void showWorkload();
+    void showMaterials();
+    void showProjects();
+    void showMap();
+    void showHistory();
+    void showBackups();
+    void restoreDatabase(const QString &preparedPath);
+    void showArchive();
+    void showRecurring();
+    void showTimesheet();
+    void showNotificationHistory();
+    void showDiagnostics();
+    void registerDiagnostics();
+    void updateNotificationsButton();
+    void checkLowStock(int materialId);
+    static QColor statusColor(const QString &status);
     void readSerialData();
     void sendToArduino(const QString &message);
 };
@@ -0,0 +1,264 @@
+#include "mapview.h"
+#include <QHash>
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QToolTip>
+#include <QWheelEvent>
+#include <cmath>
+
+// Taille des cellules de regroupement, en pixels; au-delà de ce zoom chaque site est affiché seul
+static const int cluster_cell = 48;
+static const int cluster_max_zoom = 16;
+static const int pin_radius = 7;
+
+MapView::MapView(TileCache *tiles, const SpatialIndex *sites, QWidget *parent)
+    : QWidget(parent),
+    tiles(tiles),
+    sites(sites),
+    zoomLevel(2),
+    dragging(false)
+{
+    setMinimumSize(400, 300);
+    setMouseTracking(false);
+    centerPixel = TileCache::project(QPointF(0, 20), zoomLevel);
+    connect(tiles, &TileCache::tileReady, this, [this](int z) {
+        if (z == zoomLevel) update();
+    });
+}
+
+void MapView::setCenter(const QPointF &lonLat)
+{
+    centerPixel = TileCache::project(lonLat, zoomLevel);
+    update();
+    emit viewChanged();
+}
+
+QPointF MapView::center() const
+{
+    return TileCache::unproject(centerPixel, zoomLevel);
+}
+
+void MapView::setZoom(int zoom)
+{
+    zoomAround(QPointF(width() / 2.0, height() / 2.0), zoom);
+}
+
+QPointF MapView::topLeftPixel() const
+{
+    return centerPixel - QPointF(width() / 2.0, height() / 2.0);
+}
+
+SpatialIndex::Box MapView::visibleBox() const
+{
+    // Marge d'une épingle : un site à cheval sur le bord reste affiché
+    QPointF topLeft = TileCache::unproject(topLeftPixel() - QPointF(pin_radius, pin_radius), zoomLevel);
+    QPointF bottomRight = TileCache::unproject(topLeftPixel() + QPointF(width() + pin_radius, height() + pin_radius),
+                                               zoomLevel);
+    SpatialIndex::Box box;
+    box.minX = topLeft.x();
+    box.maxX = bottomRight.x();
+    box.minY = bottomRight.y();
+    box.maxY = topLeft.y();
+    return box;
+}
+
+void MapView::fitAll()
+{
+    if (sites->size() == 0) return;
+
+    SpatialIndex::Box bounds = sites->bounds();
+    QPointF middle((bounds.minX + bounds.maxX) / 2, (bounds.minY + bounds.maxY) / 2);
+
+    // Zoom le plus fort auquel toute l'emprise tient dans la fenêtre
+    int zoom = TileCache::MaxZoom - 2;
+    for (; zoom > 1; --zoom) {
+        QPointF a = TileCache::project(QPointF(bounds.minX, bounds.maxY), zoom);
+        QPointF b = TileCache::project(QPointF(bounds.maxX, bounds.minY), zoom);
+        if (b.x() - a.x() < width() * 0.9 && b.y() - a.y() < height() * 0.9) break;
+    }
+    zoomLevel = zoom;
+    setCenter(middle);
+}
+
+void MapView::zoomAround(const QPointF &widgetPos, int zoom)
+{
+    zoom = qBound(1, zoom, TileCache::MaxZoom);
+    if (zoom == zoomLevel) return;
+
+    // Le point sous le curseur reste sous le curseur
+    QPointF offset = widgetPos - QPointF(width() / 2.0, height() / 2.0);
+    QPointF anchor = TileCache::unproject(centerPixel + offset, zoomLevel);
+    zoomLevel = zoom;
+    centerPixel = TileCache::project(anchor, zoomLevel) - offset;
+    update();
+    emit viewChanged();
+}
+
+QVector<MapView::Cluster> MapView::computeClusters() const
+{
+    QVector<SpatialIndex::Entry> visible = sites->within(visibleBox());
+    QPointF origin = topLeftPixel();
+    bool grouping = zoomLevel < cluster_max_zoom;
+
+    QHash<quint64, int> cellIndex;
+    QVector<Cluster> result;
+    for (const SpatialIndex::Entry &entry : visible) {
+        QPointF position = TileCache::project(entry.point, zoomLevel) - origin;
+        if (grouping) {
+            quint64 cell = (quint64(quint32(int(std::floor(position.x() / cluster_cell)))) << 32) |
+                           quint32(int(std::floor(position.y() / cluster_cell)));
+            auto it = cellIndex.constFind(cell);
+            if (it != cellIndex.constEnd()) {
+                Cluster &cluster = result[it.value()];
+                cluster.position = (cluster.position * cluster.count + position) / (cluster.count + 1);
+                cluster.count++;
+                if (cluster.labels.size() < 8) cluster.labels << entry.label;
+                continue;
+            }
+            cellIndex.insert(cell, result.size());
+        }
+
+        Cluster cluster;
+        cluster.position = position;
+        cluster.count = 1;
+        cluster.key = entry.key;
+        cluster.label = entry.label;
+        cluster.labels << entry.label;
+        result << cluster;
+    }
+    return result;
+}
+
+int MapView::clusterAt(const QPoint &pos) const
+{
+    for (int i = clusters.size() - 1; i >= 0; --i) {
+        const Cluster &cluster = clusters[i];
+        double radius = cluster.count > 1 ? pin_radius + 6 + 2 * std::log2(double(cluster.count)) : pin_radius;
+        QPointF delta = QPointF(pos) - cluster.position;
+        if (delta.x() * delta.x() + delta.y() * delta.y() <= radius * radius) return i;
+    }
+    return -1;
+}
+
+void MapView::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(233, 236, 239));
+
+    // Tuiles couvrant la fenêtre; en longitude, le monde se répète
+    QPointF origin = topLeftPixel();
+    int tileCount = 1 << zoomLevel;
+    int x0 = int(std::floor(origin.x() / TileCache::TileSize));
+    int y0 = qMax(0, int(std::floor(origin.y() / TileCache::TileSize)));
+    int x1 = int(std::floor((origin.x() + width()) / TileCache::TileSize));
+    int y1 = qMin(tileCount - 1, int(std::floor((origin.y() + height()) / TileCache::TileSize)));
+
+    painter.setPen(QColor(206, 212, 218));
+    for (int x = x0; x <= x1; ++x) {
+        for (int y = y0; y <= y1; ++y) {
+            QPointF position = QPointF(x * TileCache::TileSize, y * TileCache::TileSize) - origin;
+            QPixmap pixmap = tiles->tile(zoomLevel, ((x % tileCount) + tileCount) % tileCount, y);
+            if (pixmap.isNull()) {
+                painter.drawRect(QRectF(position, QSizeF(TileCache::TileSize, TileCache::TileSize)));
+            } else {
+                painter.drawPixmap(position, pixmap);
+            }
+        }
+    }
+
+    clusters = computeClusters();
+
+    painter.setRenderHint(QPainter::Antialiasing);
+    QFont font = painter.font();
+    font.setBold(true);
+    painter.setFont(font);
+    int visibleSites = 0;
+    for (const Cluster &cluster : clusters) {
+        visibleSites += cluster.count;
+        if (cluster.count == 1) {
+            painter.setPen(QPen(Qt::white, 2));
+            painter.setBrush(QColor(220, 53, 69));
+            painter.drawEllipse(cluster.position, pin_radius, pin_radius);
+        } else {
+            double radius = pin_radius + 6 + 2 * std::log2(double(cluster.count));
+            painter.setPen(QPen(Qt::white, 2));
+            painter.setBrush(QColor(0, 123, 255, 220));
+            painter.drawEllipse(cluster.position, radius, radius);
+            painter.drawText(QRectF(cluster.position - QPointF(radius, radius), QSizeF(2 * radius, 2 * radius)),
+                             Qt::AlignCenter, QString::number(cluster.count));
+        }
+    }
+
+    painter.setPen(Qt::black);
+    painter.drawText(rect().adjusted(6, 0, -6, -4), Qt::AlignBottom | Qt::AlignRight,
+                     QString("Zoom %1  -  %2 site(s) in view").arg(zoomLevel).arg(visibleSites));
+}
+
+void MapView::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        dragging = true;
+        dragStart = event->position().toPoint();
+        dragCenter = centerPixel;
+        setCursor(Qt::ClosedHandCursor);
+    }
+}
+
+void MapView::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!dragging) return;
+    centerPixel = dragCenter - QPointF(event->position().toPoint() - dragStart);
+    update();
+}
+
+void MapView::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (dragging && event->button() == Qt::LeftButton) {
+        dragging = false;
+        unsetCursor();
+        emit viewChanged();
+    }
+}
+
+void MapView::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    int index = clusterAt(event->position().toPoint());
+    if (index < 0) {
+        zoomAround(event->position(), zoomLevel + 1);
+    } else if (clusters[index].count > 1) {
+        zoomAround(clusters[index].position, zoomLevel + 2);
+    } else {
+        emit siteActivated(clusters[index].key);
+    }
+}
+
+void MapView::wheelEvent(QWheelEvent *event)
+{
+    int steps = event->angleDelta().y() / 120;
+    if (steps != 0) {
+        zoomAround(event->position(), zoomLevel + steps);
+    }
+}
+
+bool MapView::event(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent *helpEvent = static_cast<QHelpEvent *>(event);
+        int index = clusterAt(helpEvent->pos());
+        if (index < 0) {
+            QToolTip::hideText();
+        } else {
+            const Cluster &cluster = clusters[index];
+            QString text = cluster.count == 1
+                               ? cluster.label
+                               : QString("%1 sites:\n%2%3")
+                                     .arg(cluster.count)
+                                     .arg(cluster.labels.join("\n"))
+                                     .arg(cluster.count > cluster.labels.size() ? QString("\n...") : QString());
+            QToolTip::showText(helpEvent->globalPos(), text, this);
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
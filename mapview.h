@@ -0,0 +1,62 @@
+#ifndef MAPVIEW_H
+#define MAPVIEW_H
+
+#include <QWidget>
+#include "spatialindex.h"
+#include "tilecache.h"
+
+// Carte des sites : tuiles du cache local, puis les seuls sites de la zone
+// visible (requête R-tree), regroupés par cellule d'écran aux petits zooms
+class MapView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    MapView(TileCache *tiles, const SpatialIndex *sites, QWidget *parent = nullptr);
+
+    void setCenter(const QPointF &lonLat);
+    QPointF center() const;
+    void setZoom(int zoom);
+    int zoom() const { return zoomLevel; }
+    SpatialIndex::Box visibleBox() const;
+    void fitAll();
+
+signals:
+    void viewChanged();
+    void siteActivated(const QString &key);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    bool event(QEvent *event) override;
+
+private:
+    struct Cluster
+    {
+        QPointF position;   // coordonnées du widget
+        int count = 0;
+        QString key;
+        QString label;
+        QStringList labels;
+    };
+
+    TileCache *tiles;
+    const SpatialIndex *sites;
+    int zoomLevel;
+    QPointF centerPixel;    // pixels du monde au zoom courant
+    QPoint dragStart;
+    QPointF dragCenter;
+    bool dragging;
+    QVector<Cluster> clusters;
+
+    QPointF topLeftPixel() const;
+    QVector<Cluster> computeClusters() const;
+    int clusterAt(const QPoint &pos) const;
+    void zoomAround(const QPointF &widgetPos, int zoom);
+};
+
+#endif // MAPVIEW_H
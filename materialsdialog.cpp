@@ -0,0 +1,313 @@
+#include "materialsdialog.h"
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+MaterialsDialog::MaterialsDialog(MaterialsStore *store, const QStringList &taskIds, QWidget *parent)
+    : QDialog(parent),
+    store(store),
+    taskIds(taskIds)
+{
+    setWindowTitle("Materials Inventory");
+    resize(1000, 700);
+
+    materialTable = new QTableWidget(this);
+    materialTable->setColumnCount(7);
+    materialTable->setHorizontalHeaderLabels({"Material", "Supplier", "Unit", "In Stock",
+                                              "Reorder At", "Avg. Cost", "Value"});
+    materialTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    materialTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    materialTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    materialTable->horizontalHeader()->setStretchLastSection(true);
+
+    movementTable = new QTableWidget(this);
+    movementTable->setColumnCount(5);
+    movementTable->setHorizontalHeaderLabels({"Date", "Task", "Quantity", "Unit Cost", "Note"});
+    movementTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    movementTable->horizontalHeader()->setStretchLastSection(true);
+
+    totalLabel = new QLabel(this);
+
+    QPushButton *supplierBtn = new QPushButton("Add Supplier", this);
+    QPushButton *materialBtn = new QPushButton("Add Material", this);
+    QPushButton *receiveBtn = new QPushButton("Receive", this);
+    QPushButton *issueBtn = new QPushButton("Issue to Task", this);
+    QPushButton *closeBtn = new QPushButton("Close", this);
+
+    connect(supplierBtn, &QPushButton::clicked, this, &MaterialsDialog::addSupplier);
+    connect(materialBtn, &QPushButton::clicked, this, &MaterialsDialog::addMaterial);
+    connect(receiveBtn, &QPushButton::clicked, this, &MaterialsDialog::receiveStock);
+    connect(issueBtn, &QPushButton::clicked, this, &MaterialsDialog::issueStock);
+    connect(closeBtn, &QPushButton::clicked, this, &QDialog::accept);
+    connect(materialTable, &QTableWidget::itemSelectionChanged, this, &MaterialsDialog::showMovements);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    buttonLayout->addWidget(supplierBtn);
+    buttonLayout->addWidget(materialBtn);
+    buttonLayout->addWidget(receiveBtn);
+    buttonLayout->addWidget(issueBtn);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(totalLabel);
+
+    QHBoxLayout *closeLayout = new QHBoxLayout;
+    closeLayout->addStretch();
+    closeLayout->addWidget(closeBtn);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(buttonLayout);
+    mainLayout->addWidget(materialTable, 2);
+    mainLayout->addWidget(new QLabel("Latest movements:", this));
+    mainLayout->addWidget(movementTable, 1);
+    mainLayout->addLayout(closeLayout);
+
+    refreshMaterials();
+}
+
+int MaterialsDialog::selectedMaterialId() const
+{
+    int row = materialTable->currentRow();
+    if (row < 0 || !materialTable->item(row, 0)) return 0;
+    return materialTable->item(row, 0)->data(Qt::UserRole).toInt();
+}
+
+void MaterialsDialog::selectMaterial(int materialId)
+{
+    for (int row = 0; row < materialTable->rowCount(); ++row) {
+        if (materialTable->item(row, 0)->data(Qt::UserRole).toInt() == materialId) {
+            materialTable->selectRow(row);
+            return;
+        }
+    }
+}
+
+void MaterialsDialog::refreshMaterials()
+{
+    int selected = selectedMaterialId();
+    QVector<MaterialsStore::Material> materials = store->materials();
+
+    materialTable->setRowCount(0);
+    double totalValue = 0.0;
+
+    for (const MaterialsStore::Material &material : materials) {
+        int row = materialTable->rowCount();
+        materialTable->insertRow(row);
+
+        QStringList cells = {material.name,
+                             material.supplierName,
+                             material.unit,
+                             QString::number(material.quantity, 'f', 2),
+                             QString::number(material.reorderLevel, 'f', 2),
+                             QString::number(material.averageCost(), 'f', 2),
+                             QString::number(material.value, 'f', 2)};
+        for (int col = 0; col < cells.size(); ++col) {
+            QTableWidgetItem *item = new QTableWidgetItem(cells[col]);
+            if (material.isLow()) {
+                item->setBackground(QColor(248, 215, 218));
+            }
+            materialTable->setItem(row, col, item);
+        }
+        materialTable->item(row, 0)->setData(Qt::UserRole, material.id);
+        totalValue += material.value;
+    }
+
+    totalLabel->setText(QString("Stock value: %1").arg(QString::number(totalValue, 'f', 2)));
+    selectMaterial(selected);
+    showMovements();
+}
+
+void MaterialsDialog::showMovements()
+{
+    movementTable->setRowCount(0);
+    int materialId = selectedMaterialId();
+    if (materialId == 0) return;
+
+    for (const MaterialsStore::Movement &movement : store->movements(materialId)) {
+        int row = movementTable->rowCount();
+        movementTable->insertRow(row);
+        movementTable->setItem(row, 0, new QTableWidgetItem(movement.createdAt));
+        movementTable->setItem(row, 1, new QTableWidgetItem(movement.taskId));
+        movementTable->setItem(row, 2, new QTableWidgetItem(QString::number(movement.quantity, 'f', 2)));
+        movementTable->setItem(row, 3, new QTableWidgetItem(QString::number(movement.unitCost, 'f', 2)));
+        movementTable->setItem(row, 4, new QTableWidgetItem(movement.note));
+    }
+}
+
+void MaterialsDialog::addSupplier()
+{
+    QDialog dialog(this);
+    QFormLayout form(&dialog);
+    dialog.setWindowTitle("Add Supplier");
+
+    QLineEdit *nameEdit = new QLineEdit(&dialog);
+    QLineEdit *contactEdit = new QLineEdit(&dialog);
+    contactEdit->setPlaceholderText("Phone or e-mail");
+    form.addRow("Name:", nameEdit);
+    form.addRow("Contact:", contactEdit);
+
+    QDialogButtonBox buttonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, &dialog);
+    form.addRow(&buttonBox);
+    connect(&buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(&buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    if (dialog.exec() != QDialog::Accepted) return;
+    if (nameEdit->text().trimmed().isEmpty()) {
+        QMessageBox::warning(this, "Missing Data", "Name cannot be empty");
+        return;
+    }
+
+    QString error;
+    if (!store->addSupplier(nameEdit->text().trimmed(), contactEdit->text().trimmed(), &error)) {
+        QMessageBox::critical(this, "Database Error", QString("Failed to save supplier: %1").arg(error));
+    }
+}
+
+void MaterialsDialog::addMaterial()
+{
+    QDialog dialog(this);
+    QFormLayout form(&dialog);
+    dialog.setWindowTitle("Add Material");
+
+    QLineEdit *nameEdit = new QLineEdit(&dialog);
+    QLineEdit *unitEdit = new QLineEdit("pcs", &dialog);
+    QComboBox *supplierCombo = new QComboBox(&dialog);
+    supplierCombo->addItem("(none)", 0);
+    for (const MaterialsStore::Supplier &supplier : store->suppliers()) {
+        supplierCombo->addItem(supplier.name, supplier.id);
+    }
+    QDoubleSpinBox *costSpin = new QDoubleSpinBox(&dialog);
+    costSpin->setRange(0, 1e9);
+    costSpin->setDecimals(2);
+    QDoubleSpinBox *reorderSpin = new QDoubleSpinBox(&dialog);
+    reorderSpin->setRange(0, 1e9);
+    reorderSpin->setDecimals(2);
+
+    form.addRow("Name:", nameEdit);
+    form.addRow("Unit:", unitEdit);
+    form.addRow("Supplier:", supplierCombo);
+    form.addRow("Unit Cost:", costSpin);
+    form.addRow("Reorder Level:", reorderSpin);
+
+    QDialogButtonBox buttonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, &dialog);
+    form.addRow(&buttonBox);
+    connect(&buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(&buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    if (dialog.exec() != QDialog::Accepted) return;
+    if (nameEdit->text().trimmed().isEmpty() || unitEdit->text().trimmed().isEmpty()) {
+        QMessageBox::warning(this, "Missing Data", "Name and unit cannot be empty");
+        return;
+    }
+
+    QString error;
+    int materialId = store->addMaterial(nameEdit->text().trimmed(), unitEdit->text().trimmed(),
+                                        supplierCombo->currentData().toInt(),
+                                        costSpin->value(), reorderSpin->value(), &error);
+    if (!materialId) {
+        QMessageBox::critical(this, "Database Error", QString("Failed to save material: %1").arg(error));
+        return;
+    }
+    refreshMaterials();
+    selectMaterial(materialId);
+}
+
+bool MaterialsDialog::askMovement(bool issue, double *quantity, double *unitCost, QString *taskId, QString *note)
+{
+    MaterialsStore::Material material = store->material(selectedMaterialId());
+
+    QDialog dialog(this);
+    QFormLayout form(&dialog);
+    dialog.setWindowTitle(issue ? QString("Issue %1").arg(material.name) : QString("Receive %1").arg(material.name));
+
+    QDoubleSpinBox *quantitySpin = new QDoubleSpinBox(&dialog);
+    quantitySpin->setRange(0.01, issue ? qMax(0.01, material.quantity) : 1e9);
+    quantitySpin->setDecimals(2);
+    quantitySpin->setSuffix(" " + material.unit);
+    form.addRow("Quantity:", quantitySpin);
+
+    QDoubleSpinBox *costSpin = new QDoubleSpinBox(&dialog);
+    costSpin->setRange(0, 1e9);
+    costSpin->setDecimals(2);
+    costSpin->setValue(issue ? material.averageCost() : material.unitCost);
+    costSpin->setEnabled(!issue);    // sortie au coût moyen
+    form.addRow("Unit Cost:", costSpin);
+
+    QComboBox *taskCombo = new QComboBox(&dialog);
+    taskCombo->setEditable(true);
+    taskCombo->addItem(QString());
+    taskCombo->addItems(taskIds);
+    form.addRow(issue ? "Task:" : "Task (optional):", taskCombo);
+
+    QLineEdit *noteEdit = new QLineEdit(&dialog);
+    form.addRow("Note:", noteEdit);
+
+    QDialogButtonBox buttonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, &dialog);
+    form.addRow(&buttonBox);
+    connect(&buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(&buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    if (dialog.exec() != QDialog::Accepted) return false;
+
+    *taskId = taskCombo->currentText().trimmed();
+    if (issue && taskId->isEmpty()) {
+        QMessageBox::warning(this, "Missing Data", "Select the task the material is issued to");
+        return false;
+    }
+    if (!taskId->isEmpty() && !taskIds.contains(*taskId)) {
+        QMessageBox::warning(this, "Unknown Task", QString("No task with ID %1").arg(*taskId));
+        return false;
+    }
+
+    *quantity = issue ? -quantitySpin->value() : quantitySpin->value();
+    *unitCost = costSpin->value();
+    *note = noteEdit->text().trimmed();
+    return true;
+}
+
+void MaterialsDialog::receiveStock()
+{
+    int materialId = selectedMaterialId();
+    if (materialId == 0) {
+        QMessageBox::warning(this, "Selection Required", "Please select a material first");
+        return;
+    }
+
+    double quantity, unitCost;
+    QString taskId, note;
+    if (!askMovement(false, &quantity, &unitCost, &taskId, &note)) return;
+
+    QString error;
+    if (!store->recordMovement(materialId, quantity, unitCost, taskId, note, &error)) {
+        QMessageBox::critical(this, "Database Error", QString("Failed to record movement: %1").arg(error));
+        return;
+    }
+    refreshMaterials();
+    emit stockChanged(materialId);
+}
+
+void MaterialsDialog::issueStock()
+{
+    int materialId = selectedMaterialId();
+    if (materialId == 0) {
+        QMessageBox::warning(this, "Selection Required", "Please select a material first");
+        return;
+    }
+
+    double quantity, unitCost;
+    QString taskId, note;
+    if (!askMovement(true, &quantity, &unitCost, &taskId, &note)) return;
+
+    QString error;
+    if (!store->recordMovement(materialId, quantity, unitCost, taskId, note, &error)) {
+        QMessageBox::warning(this, "Stock Error", QString("Failed to record movement: %1").arg(error));
+        return;
+    }
+    refreshMaterials();
+    emit stockChanged(materialId);
+}
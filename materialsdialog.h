@@ -0,0 +1,40 @@
+#ifndef MATERIALSDIALOG_H
+#define MATERIALSDIALOG_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QTableWidget>
+#include "materialsstore.h"
+
+// Fenêtre de gestion des matériaux : stock courant, entrées et sorties
+class MaterialsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    MaterialsDialog(MaterialsStore *store, const QStringList &taskIds, QWidget *parent = nullptr);
+
+signals:
+    void stockChanged(int materialId);
+
+private slots:
+    void refreshMaterials();
+    void showMovements();
+    void addSupplier();
+    void addMaterial();
+    void receiveStock();
+    void issueStock();
+
+private:
+    MaterialsStore *store;
+    QStringList taskIds;
+    QTableWidget *materialTable;
+    QTableWidget *movementTable;
+    QLabel *totalLabel;
+
+    int selectedMaterialId() const;
+    void selectMaterial(int materialId);
+    bool askMovement(bool issue, double *quantity, double *unitCost, QString *taskId, QString *note);
+};
+
+#endif // MATERIALSDIALOG_H
@@ -0,0 +1,283 @@
+#include "materialsstore.h"
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariant>
+
+void MaterialsStore::setDatabase(const QSqlDatabase &database)
+{
+    db = database;
+}
+
+bool MaterialsStore::initialize(QString *error)
+{
+    QSqlQuery query(db);
+    if (!query.exec("SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name = 'movement_tasks'") ||
+        !query.next()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    bool created = query.value(0).toInt() == 0;
+
+    QStringList schemaSQL = {
+        "CREATE TABLE IF NOT EXISTS suppliers ("
+        "   id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "   name TEXT NOT NULL UNIQUE,"
+        "   contact TEXT"
+        ")",
+        "CREATE TABLE IF NOT EXISTS materials ("
+        "   id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "   name TEXT NOT NULL UNIQUE,"
+        "   unit TEXT NOT NULL DEFAULT 'pcs',"
+        "   supplier_id INTEGER REFERENCES suppliers(id),"
+        "   unit_cost REAL NOT NULL DEFAULT 0,"
+        "   reorder_level REAL NOT NULL DEFAULT 0"
+        ")",
+        "CREATE TABLE IF NOT EXISTS stock_movements ("
+        "   id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "   material_id INTEGER NOT NULL REFERENCES materials(id),"
+        "   task_id TEXT,"
+        "   quantity REAL NOT NULL,"
+        "   unit_cost REAL NOT NULL DEFAULT 0,"
+        "   note TEXT,"
+        "   created_at DATETIME DEFAULT CURRENT_TIMESTAMP"
+        ")",
+        "CREATE INDEX IF NOT EXISTS idx_movements_material ON stock_movements(material_id)",
+        "CREATE INDEX IF NOT EXISTS idx_movements_task ON stock_movements(task_id)",
+        "CREATE TABLE IF NOT EXISTS stock_levels ("
+        "   material_id INTEGER PRIMARY KEY REFERENCES materials(id),"
+        "   quantity REAL NOT NULL DEFAULT 0,"
+        "   value REAL NOT NULL DEFAULT 0,"
+        "   updated_at DATETIME"
+        ")",
+        // Agrégat matérialisé : une ligne par matériau, mise à jour à chaque mouvement.
+        // Dans un UPDATE, SQLite évalue toutes les expressions sur l'ancienne ligne.
+        "CREATE TRIGGER IF NOT EXISTS trg_stock_movements_apply AFTER INSERT ON stock_movements "
+        "BEGIN "
+        "   INSERT OR IGNORE INTO stock_levels (material_id, quantity, value) VALUES (NEW.material_id, 0, 0);"
+        "   UPDATE stock_levels SET "
+        "       value = CASE WHEN NEW.quantity >= 0 THEN value + NEW.quantity * NEW.unit_cost "
+        "                    WHEN quantity > 0 THEN MAX(0, value + NEW.quantity * (value / quantity)) "
+        "                    ELSE value END,"
+        "       quantity = quantity + NEW.quantity,"
+        "       updated_at = CURRENT_TIMESTAMP "
+        "   WHERE material_id = NEW.material_id;"
+        "END",
+        "CREATE TRIGGER IF NOT EXISTS trg_stock_movements_no_update BEFORE UPDATE ON stock_movements "
+        "BEGIN SELECT RAISE(ABORT, 'stock_movements is append-only'); END",
+        "CREATE TRIGGER IF NOT EXISTS trg_stock_movements_no_delete BEFORE DELETE ON stock_movements "
+        "BEGIN SELECT RAISE(ABORT, 'stock_movements is append-only'); END",
+        // Tâche courante de chaque sortie, clé stable : l'ID noté au registre ne suit pas les renommages
+        "CREATE TABLE IF NOT EXISTS movement_tasks ("
+        "   movement_id INTEGER PRIMARY KEY REFERENCES stock_movements(id),"
+        "   task_id TEXT NOT NULL"
+        ")",
+        "CREATE INDEX IF NOT EXISTS idx_movement_tasks_task ON movement_tasks(task_id)",
+        "CREATE TRIGGER IF NOT EXISTS trg_stock_movements_task AFTER INSERT ON stock_movements "
+        "WHEN NEW.task_id IS NOT NULL "
+        "BEGIN INSERT INTO movement_tasks (movement_id, task_id) VALUES (NEW.id, NEW.task_id); END"
+    };
+    // Mouvements enregistrés avant la table de correspondance
+    if (created) {
+        schemaSQL << "INSERT INTO movement_tasks (movement_id, task_id) "
+                     "SELECT id, task_id FROM stock_movements WHERE task_id IS NOT NULL";
+    }
+
+    for (const QString &sql : schemaSQL) {
+        if (!query.exec(sql)) {
+            if (error) *error = query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+QVector<MaterialsStore::Supplier> MaterialsStore::suppliers() const
+{
+    QVector<Supplier> result;
+    QSqlQuery query("SELECT id, name, contact FROM suppliers ORDER BY name COLLATE NOCASE", db);
+    while (query.next()) {
+        Supplier supplier;
+        supplier.id = query.value(0).toInt();
+        supplier.name = query.value(1).toString();
+        supplier.contact = query.value(2).toString();
+        result << supplier;
+    }
+    return result;
+}
+
+int MaterialsStore::addSupplier(const QString &name, const QString &contact, QString *error)
+{
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO suppliers (name, contact) VALUES (:name, :contact)");
+    query.bindValue(":name", name);
+    query.bindValue(":contact", contact);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return 0;
+    }
+    return query.lastInsertId().toInt();
+}
+
+const char *MaterialsStore::materialColumns()
+{
+    return "SELECT m.id, m.name, m.unit, m.supplier_id, s.name, m.unit_cost, m.reorder_level, "
+           "COALESCE(l.quantity, 0), COALESCE(l.value, 0) "
+           "FROM materials m "
+           "LEFT JOIN suppliers s ON s.id = m.supplier_id "
+           "LEFT JOIN stock_levels l ON l.material_id = m.id ";
+}
+
+MaterialsStore::Material MaterialsStore::readMaterial(const QSqlQuery &query)
+{
+    Material material;
+    material.id = query.value(0).toInt();
+    material.name = query.value(1).toString();
+    material.unit = query.value(2).toString();
+    material.supplierId = query.value(3).toInt();
+    material.supplierName = query.value(4).toString();
+    material.unitCost = query.value(5).toDouble();
+    material.reorderLevel = query.value(6).toDouble();
+    material.quantity = query.value(7).toDouble();
+    material.value = query.value(8).toDouble();
+    return material;
+}
+
+QVector<MaterialsStore::Material> MaterialsStore::materials() const
+{
+    QVector<Material> result;
+    QSqlQuery query(QString(materialColumns()) + "ORDER BY m.name COLLATE NOCASE", db);
+    while (query.next()) {
+        result << readMaterial(query);
+    }
+    return result;
+}
+
+MaterialsStore::Material MaterialsStore::material(int materialId) const
+{
+    // Recherche par clé primaire des deux côtés : indépendante de la taille du registre
+    QSqlQuery query(db);
+    query.prepare(QString(materialColumns()) + "WHERE m.id = :id");
+    query.bindValue(":id", materialId);
+    if (query.exec() && query.next()) {
+        return readMaterial(query);
+    }
+    return Material();
+}
+
+QVector<MaterialsStore::Material> MaterialsStore::lowStock() const
+{
+    QVector<Material> result;
+    QSqlQuery query(QString(materialColumns()) +
+                        "WHERE m.reorder_level > 0 AND COALESCE(l.quantity, 0) <= m.reorder_level "
+                        "ORDER BY m.name COLLATE NOCASE", db);
+    while (query.next()) {
+        result << readMaterial(query);
+    }
+    return result;
+}
+
+int MaterialsStore::addMaterial(const QString &name, const QString &unit, int supplierId,
+                                double unitCost, double reorderLevel, QString *error)
+{
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO materials (name, unit, supplier_id, unit_cost, reorder_level) "
+                  "VALUES (:name, :unit, :supplier_id, :unit_cost, :reorder_level)");
+    query.bindValue(":name", name);
+    query.bindValue(":unit", unit);
+    query.bindValue(":supplier_id", supplierId > 0 ? QVariant(supplierId) : QVariant());
+    query.bindValue(":unit_cost", unitCost);
+    query.bindValue(":reorder_level", reorderLevel);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return 0;
+    }
+    return query.lastInsertId().toInt();
+}
+
+bool MaterialsStore::recordMovement(int materialId, double quantity, double unitCost,
+                                    const QString &taskId, const QString &note, QString *error)
+{
+    if (quantity == 0) {
+        if (error) *error = "Quantity cannot be zero";
+        return false;
+    }
+
+    // Les sorties sont valorisées au coût moyen au moment du mouvement
+    if (quantity < 0) {
+        Material current = material(materialId);
+        if (current.id == 0) {
+            if (error) *error = "Unknown material";
+            return false;
+        }
+        if (current.quantity + quantity < 0) {
+            if (error) *error = QString("Only %1 %2 in stock").arg(current.quantity).arg(current.unit);
+            return false;
+        }
+        unitCost = current.averageCost();
+    }
+
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO stock_movements (material_id, task_id, quantity, unit_cost, note) "
+                  "VALUES (:material_id, :task_id, :quantity, :unit_cost, :note)");
+    query.bindValue(":material_id", materialId);
+    query.bindValue(":task_id", taskId.isEmpty() ? QVariant() : QVariant(taskId));
+    query.bindValue(":quantity", quantity);
+    query.bindValue(":unit_cost", unitCost);
+    query.bindValue(":note", note);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QVector<MaterialsStore::Movement> MaterialsStore::movements(int materialId, int limit) const
+{
+    QVector<Movement> result;
+    QSqlQuery query(db);
+    query.prepare("SELECT m.id, COALESCE(t.task_id, m.task_id), m.quantity, m.unit_cost, m.note, m.created_at "
+                  "FROM stock_movements m LEFT JOIN movement_tasks t ON t.movement_id = m.id "
+                  "WHERE m.material_id = :material_id ORDER BY m.id DESC LIMIT :limit");
+    query.bindValue(":material_id", materialId);
+    query.bindValue(":limit", limit);
+    if (!query.exec()) return result;
+
+    while (query.next()) {
+        Movement movement;
+        movement.id = query.value(0).toLongLong();
+        movement.taskId = query.value(1).toString();
+        movement.quantity = query.value(2).toDouble();
+        movement.unitCost = query.value(3).toDouble();
+        movement.note = query.value(4).toString();
+        movement.createdAt = query.value(5).toString();
+        result << movement;
+    }
+    return result;
+}
+
+double MaterialsStore::taskMaterialCost(const QString &taskId) const
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT COALESCE(SUM(-m.quantity * m.unit_cost), 0) "
+                  "FROM movement_tasks t JOIN stock_movements m ON m.id = t.movement_id "
+                  "WHERE t.task_id = :task_id AND m.quantity < 0");
+    query.bindValue(":task_id", taskId);
+    if (query.exec() && query.next()) {
+        return query.value(0).toDouble();
+    }
+    return 0.0;
+}
+
+bool MaterialsStore::renameTask(const QString &oldId, const QString &newId, QString *error)
+{
+    QSqlQuery query(db);
+    query.prepare("UPDATE movement_tasks SET task_id = :new_id WHERE task_id = :old_id");
+    query.bindValue(":new_id", newId);
+    query.bindValue(":old_id", oldId);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,81 @@
+#ifndef MATERIALSSTORE_H
+#define MATERIALSSTORE_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+
+class QSqlQuery;
+
+// Matériaux, fournisseurs et registre des mouvements de stock.
+// Le registre (stock_movements) n'accepte que des ajouts; la quantité en
+// stock et sa valeur (coût moyen pondéré) sont tenues à jour dans
+// stock_levels par un trigger, donc une lecture de stock reste en O(1).
+// La tâche d'un mouvement se lit dans movement_tasks, indexée par l'ID du
+// mouvement et renommée avec la tâche.
+class MaterialsStore
+{
+public:
+    struct Supplier
+    {
+        int id = 0;
+        QString name;
+        QString contact;
+    };
+
+    struct Material
+    {
+        int id = 0;
+        QString name;
+        QString unit;
+        int supplierId = 0;
+        QString supplierName;
+        double unitCost = 0.0;       // prix catalogue
+        double reorderLevel = 0.0;
+        double quantity = 0.0;
+        double value = 0.0;
+
+        double averageCost() const { return quantity > 0 ? value / quantity : unitCost; }
+        bool isLow() const { return reorderLevel > 0 && quantity <= reorderLevel; }
+    };
+
+    struct Movement
+    {
+        qint64 id = 0;
+        QString taskId;
+        double quantity = 0.0;       // positif : entrée, négatif : sortie
+        double unitCost = 0.0;
+        QString note;
+        QString createdAt;
+    };
+
+    void setDatabase(const QSqlDatabase &database);
+    bool initialize(QString *error);
+
+    QVector<Supplier> suppliers() const;
+    int addSupplier(const QString &name, const QString &contact, QString *error);
+
+    QVector<Material> materials() const;
+    Material material(int materialId) const;
+    QVector<Material> lowStock() const;
+    int addMaterial(const QString &name, const QString &unit, int supplierId,
+                    double unitCost, double reorderLevel, QString *error);
+
+    // Entrée (quantité > 0) au coût donné, ou sortie au coût moyen courant
+    bool recordMovement(int materialId, double quantity, double unitCost,
+                        const QString &taskId, const QString &note, QString *error);
+    QVector<Movement> movements(int materialId, int limit = 200) const;
+
+    // Coût des matériaux sortis pour une tâche
+    double taskMaterialCost(const QString &taskId) const;
+    // Appelé dans la transaction qui change l'ID de la tâche
+    bool renameTask(const QString &oldId, const QString &newId, QString *error);
+
+private:
+    QSqlDatabase db;
+
+    static const char *materialColumns();
+    static Material readMaterial(const QSqlQuery &query);
+};
+
+#endif // MATERIALSSTORE_H
@@ -0,0 +1,127 @@
+#include "notificationcenter.h"
+#include <algorithm>
+
+// Entrées récentes examinées pour regrouper une répétition
+static const int coalesce_scan = 50;
+
+NotificationCenter::NotificationCenter(QObject *parent)
+    : QObject(parent),
+    nextId(1),
+    dropped(0)
+{
+}
+
+int NotificationCenter::timeoutFor(Level level)
+{
+    switch (level) {
+    case Info: return 4000;
+    case Warning: return 6000;
+    case Error: return 8000;
+    }
+    return 4000;
+}
+
+int NotificationCenter::indexOf(int id) const
+{
+    // Les identifiants croissent avec la position : recherche dichotomique
+    auto it = std::lower_bound(entries.cbegin(), entries.cend(), id, [](const Notification &entry, int value) {
+        return entry.id < value;
+    });
+    return it != entries.cend() && it->id == id ? int(it - entries.cbegin()) : -1;
+}
+
+int NotificationCenter::post(Level level, const QString &title, const QString &text, const QString &key)
+{
+    QString coalesceKey = key.isEmpty() ? title + '\n' + text : key;
+    QDateTime now = QDateTime::currentDateTime();
+
+    // Répétition récente : même entrée, compteur incrémenté, pas de nouveau toast
+    for (int i = entries.size() - 1; i >= 0 && i >= entries.size() - coalesce_scan; --i) {
+        Notification &entry = entries[i];
+        if (entry.key != coalesceKey || entry.last.msecsTo(now) > CoalesceMs) continue;
+
+        entry.count += 1;
+        entry.last = now;
+        entry.read = false;
+        entry.text = text;
+        if (visible.contains(entry.id)) {
+            emit toastUpdated(entry);
+        } else if (!queued.contains(entry.id)) {
+            show(entry.id);
+        }
+        emit historyChanged();
+        return entry.id;
+    }
+
+    Notification entry;
+    entry.id = nextId++;
+    entry.level = level;
+    entry.title = title;
+    entry.text = text;
+    entry.key = coalesceKey;
+    entry.first = now;
+    entry.last = now;
+    entries << entry;
+    if (entries.size() > HistoryLimit) {
+        entries.remove(0, entries.size() - HistoryLimit);
+    }
+
+    show(entry.id);
+    emit historyChanged();
+    return entry.id;
+}
+
+void NotificationCenter::show(int id)
+{
+    if (visible.size() < MaxVisible) {
+        visible.insert(id);
+        emit toastRequested(entries[indexOf(id)]);
+    } else if (queued.size() < MaxQueued) {
+        queued.enqueue(id);
+    } else {
+        ++dropped;    // consultable dans l'historique seulement
+    }
+}
+
+void NotificationCenter::toastClosed(int id)
+{
+    visible.remove(id);
+    while (visible.size() < MaxVisible && !queued.isEmpty()) {
+        int next = queued.dequeue();
+        if (indexOf(next) < 0) continue;    // sorti de l'historique entre-temps
+        visible.insert(next);
+        emit toastRequested(entries[indexOf(next)]);
+    }
+
+    if (queued.isEmpty() && dropped > 0 && visible.size() < MaxVisible) {
+        int count = dropped;
+        dropped = 0;
+        post(Info, "Notifications", QString("%1 more notification(s) in the history").arg(count), "dropped");
+    }
+}
+
+int NotificationCenter::unreadCount() const
+{
+    int count = 0;
+    for (const Notification &entry : entries) {
+        if (!entry.read) ++count;
+    }
+    return count;
+}
+
+void NotificationCenter::markAllRead()
+{
+    for (Notification &entry : entries) {
+        entry.read = true;
+    }
+    emit historyChanged();
+}
+
+void NotificationCenter::clearHistory()
+{
+    // Les toasts encore affichés se ferment d'eux-mêmes
+    entries.clear();
+    queued.clear();
+    dropped = 0;
+    emit historyChanged();
+}
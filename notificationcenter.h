@@ -0,0 +1,74 @@
+#ifndef NOTIFICATIONCENTER_H
+#define NOTIFICATIONCENTER_H
+
+#include <QDateTime>
+#include <QObject>
+#include <QQueue>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+// Messages non bloquants : remplace les QMessageBox des chemins fréquents
+// (port série, requêtes en échec) dont la boucle d'événements imbriquée
+// retardait les lectures et les minuteries. Un message répété dans les dix
+// secondes incrémente le compteur du précédent; au-delà de MaxVisible
+// toasts à l'écran les suivants attendent, puis ne vont plus qu'à l'historique.
+class NotificationCenter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Level { Info, Warning, Error };
+
+    struct Notification
+    {
+        int id = 0;
+        Level level = Info;
+        QString title;
+        QString text;
+        QString key;
+        QDateTime first;
+        QDateTime last;
+        int count = 1;
+        bool read = false;
+    };
+
+    static constexpr int MaxVisible = 4;
+    static constexpr int MaxQueued = 20;
+    static constexpr int CoalesceMs = 10000;
+    static constexpr int HistoryLimit = 500;
+
+    explicit NotificationCenter(QObject *parent = nullptr);
+
+    // La clé regroupe les répétitions; par défaut titre et texte
+    int post(Level level, const QString &title, const QString &text, const QString &key = QString());
+    int info(const QString &title, const QString &text) { return post(Info, title, text); }
+    int warning(const QString &title, const QString &text) { return post(Warning, title, text); }
+    int error(const QString &title, const QString &text) { return post(Error, title, text); }
+
+    QVector<Notification> history() const { return entries; }
+    int unreadCount() const;
+    void markAllRead();
+    void clearHistory();
+    static int timeoutFor(Level level);
+
+public slots:
+    void toastClosed(int id);
+
+signals:
+    void toastRequested(const NotificationCenter::Notification &notification);
+    void toastUpdated(const NotificationCenter::Notification &notification);
+    void historyChanged();
+
+private:
+    QVector<Notification> entries;
+    QSet<int> visible;
+    QQueue<int> queued;
+    int nextId;
+    int dropped;
+
+    int indexOf(int id) const;
+    void show(int id);
+};
+
+#endif // NOTIFICATIONCENTER_H
@@ -0,0 +1,339 @@
+#include "projectsdialog.h"
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTreeWidgetItemIterator>
+#include <QVBoxLayout>
+#include "spatialindex.h"
+#include <algorithm>
+
+ProjectsDialog::ProjectsDialog(ProjectStore *store, QWidget *parent)
+    : QDialog(parent),
+    store(store)
+{
+    setWindowTitle("Projects & Budgets");
+    resize(1000, 650);
+
+    projectTree = new QTreeWidget(this);
+    projectTree->setColumnCount(7);
+    projectTree->setHeaderLabels({"Project", "Kind", "Budget", "Planned", "Actual", "Variance", "Tasks"});
+    projectTree->setSelectionMode(QAbstractItemView::SingleSelection);
+    projectTree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    projectTree->header()->setStretchLastSection(false);
+
+    overrunsOnly = new QCheckBox("Overruns only", this);
+    totalLabel = new QLabel(this);
+
+    QPushButton *projectBtn = new QPushButton("Add Project", this);
+    QPushButton *phaseBtn = new QPushButton("Add Phase", this);
+    QPushButton *editBtn = new QPushButton("Edit", this);
+    QPushButton *deleteBtn = new QPushButton("Delete", this);
+    QPushButton *exportBtn = new QPushButton("Export Pack...", this);
+    exportBtn->setToolTip("Write the selected project, its tasks, history and attachments to a .taskpack file");
+    QPushButton *importBtn = new QPushButton("Import Pack...", this);
+    QPushButton *closeBtn = new QPushButton("Close", this);
+
+    connect(projectBtn, &QPushButton::clicked, this, &ProjectsDialog::addProject);
+    connect(phaseBtn, &QPushButton::clicked, this, &ProjectsDialog::addPhase);
+    connect(editBtn, &QPushButton::clicked, this, &ProjectsDialog::editProject);
+    connect(deleteBtn, &QPushButton::clicked, this, &ProjectsDialog::deleteProject);
+    connect(exportBtn, &QPushButton::clicked, this, &ProjectsDialog::exportPack);
+    connect(importBtn, &QPushButton::clicked, this, &ProjectsDialog::importPack);
+    connect(closeBtn, &QPushButton::clicked, this, &QDialog::accept);
+    connect(overrunsOnly, &QCheckBox::toggled, this, &ProjectsDialog::refreshTree);
+    connect(projectTree, &QTreeWidget::itemDoubleClicked, this, &ProjectsDialog::editProject);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    buttonLayout->addWidget(projectBtn);
+    buttonLayout->addWidget(phaseBtn);
+    buttonLayout->addWidget(editBtn);
+    buttonLayout->addWidget(deleteBtn);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(overrunsOnly);
+
+    QHBoxLayout *closeLayout = new QHBoxLayout;
+    closeLayout->addWidget(totalLabel);
+    closeLayout->addStretch();
+    closeLayout->addWidget(exportBtn);
+    closeLayout->addWidget(importBtn);
+    closeLayout->addWidget(closeBtn);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(buttonLayout);
+    mainLayout->addWidget(projectTree, 1);
+    mainLayout->addLayout(closeLayout);
+
+    refreshTree();
+}
+
+int ProjectsDialog::selectedProjectId() const
+{
+    QTreeWidgetItem *item = projectTree->currentItem();
+    return item ? item->data(0, Qt::UserRole).toInt() : 0;
+}
+
+void ProjectsDialog::selectProject(int projectId)
+{
+    if (projectId == 0) return;
+    for (QTreeWidgetItemIterator it(projectTree); *it; ++it) {
+        if ((*it)->data(0, Qt::UserRole).toInt() == projectId) {
+            projectTree->setCurrentItem(*it);
+            projectTree->scrollToItem(*it);
+            return;
+        }
+    }
+}
+
+QTreeWidgetItem *ProjectsDialog::createItem(const BudgetTree::Node &node, bool showPath) const
+{
+    const BudgetTree &tree = store->tree();
+    auto money = [](double amount) { return QString::number(amount, 'f', 2); };
+
+    QStringList cells = {showPath ? tree.path(node.id) : node.name,
+                         tree.depth(node.id) == 0 ? "Project" : "Phase",
+                         node.budget > 0 ? money(node.budget) : QString("-"),
+                         money(node.total.planned),
+                         money(node.total.actual),
+                         money(node.limit() - node.total.actual),
+                         QString::number(node.taskCount)};
+    QTreeWidgetItem *item = new QTreeWidgetItem(cells);
+    item->setData(0, Qt::UserRole, node.id);
+    for (int col = 2; col < 7; ++col) {
+        item->setTextAlignment(col, Qt::AlignRight | Qt::AlignVCenter);
+    }
+    if (node.isOverrun()) {
+        for (int col = 0; col < 7; ++col) {
+            item->setBackground(col, QColor(248, 215, 218));
+        }
+        item->setToolTip(0, QString("Over budget by %1").arg(money(node.overrun())));
+    }
+    return item;
+}
+
+void ProjectsDialog::addChildren(QTreeWidgetItem *parentItem, const BudgetTree::Node &node) const
+{
+    const BudgetTree &tree = store->tree();
+    QVector<int> children = node.children;
+    std::sort(children.begin(), children.end(), [&tree](int a, int b) {
+        return tree.node(a).name.compare(tree.node(b).name, Qt::CaseInsensitive) < 0;
+    });
+
+    for (int childId : children) {
+        BudgetTree::Node child = tree.node(childId);
+        QTreeWidgetItem *item = createItem(child, false);
+        parentItem->addChild(item);
+        addChildren(item, child);
+    }
+}
+
+void ProjectsDialog::refreshTree()
+{
+    int selected = selectedProjectId();
+    const BudgetTree &tree = store->tree();
+
+    projectTree->clear();
+    if (overrunsOnly->isChecked()) {
+        // Liste tenue à jour par l'arbre : aucun parcours du portefeuille
+        for (int id : tree.overruns()) {
+            projectTree->addTopLevelItem(createItem(tree.node(id), true));
+        }
+    } else {
+        for (int id : tree.roots()) {
+            BudgetTree::Node node = tree.node(id);
+            QTreeWidgetItem *item = createItem(node, false);
+            projectTree->addTopLevelItem(item);
+            addChildren(item, node);
+        }
+        projectTree->expandToDepth(0);
+    }
+
+    BudgetTree::Costs portfolio = tree.portfolio();
+    totalLabel->setText(QString("Planned: %1   Actual: %2   Over budget: %3 of %4")
+                            .arg(QString::number(portfolio.planned, 'f', 2),
+                                 QString::number(portfolio.actual, 'f', 2))
+                            .arg(tree.overrunCount())
+                            .arg(tree.projectCount()));
+    selectProject(selected);
+}
+
+bool ProjectsDialog::askProject(const QString &title, int *parentId, QString *name, double *budget, QString *site,
+                                int excludeId)
+{
+    const BudgetTree &tree = store->tree();
+
+    QDialog dialog(this);
+    QFormLayout form(&dialog);
+    dialog.setWindowTitle(title);
+
+    QLineEdit *nameEdit = new QLineEdit(*name, &dialog);
+    QComboBox *parentCombo = new QComboBox(&dialog);
+    parentCombo->addItem("(none - top-level project)", 0);
+
+    // Parcours en profondeur pour lister les parents possibles dans l'ordre de l'arbre
+    QVector<int> pending = tree.roots();
+    std::reverse(pending.begin(), pending.end());
+    while (!pending.isEmpty()) {
+        int id = pending.takeLast();
+        if (id == excludeId) continue;
+        parentCombo->addItem(tree.path(id), id);
+
+        QVector<int> children = tree.node(id).children;
+        std::sort(children.begin(), children.end(), [&tree](int a, int b) {
+            return tree.node(a).name.compare(tree.node(b).name, Qt::CaseInsensitive) > 0;
+        });
+        pending += children;
+    }
+    parentCombo->setCurrentIndex(qMax(0, parentCombo->findData(*parentId)));
+
+    QDoubleSpinBox *budgetSpin = new QDoubleSpinBox(&dialog);
+    budgetSpin->setRange(0, 1e12);
+    budgetSpin->setDecimals(2);
+    budgetSpin->setSpecialValueText("No budget");
+    budgetSpin->setValue(*budget);
+
+    form.addRow("Name:", nameEdit);
+    form.addRow("Parent:", parentCombo);
+    QLineEdit *siteEdit = new QLineEdit(*site, &dialog);
+    siteEdit->setPlaceholderText("48.8566, 2.3522");
+
+    form.addRow("Budget:", budgetSpin);
+    form.addRow("Site (lat, lon):", siteEdit);
+
+    QDialogButtonBox buttonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, &dialog);
+    form.addRow(&buttonBox);
+    connect(&buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(&buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    if (dialog.exec() != QDialog::Accepted) return false;
+    if (nameEdit->text().trimmed().isEmpty()) {
+        QMessageBox::warning(this, "Missing Data", "Name cannot be empty");
+        return false;
+    }
+    QPointF point;
+    if (!siteEdit->text().trimmed().isEmpty() && !SpatialIndex::parseCoordinates(siteEdit->text(), &point)) {
+        QMessageBox::warning(this, "Invalid Site", "Site must be \"latitude, longitude\", e.g. 48.8566, 2.3522");
+        return false;
+    }
+
+    *name = nameEdit->text().trimmed();
+    *parentId = parentCombo->currentData().toInt();
+    *budget = budgetSpin->value();
+    *site = siteEdit->text().trimmed();
+    return true;
+}
+
+void ProjectsDialog::addProject()
+{
+    int parentId = 0;
+    QString name;
+    double budget = 0.0;
+    QString site;
+    if (!askProject("Add Project", &parentId, &name, &budget, &site, 0)) return;
+
+    QString error;
+    int projectId = store->addProject(parentId, name, budget, &error);
+    if (!projectId || (!site.isEmpty() && !store->setSite(projectId, site, &error))) {
+        QMessageBox::critical(this, "Database Error", QString("Failed to save project: %1").arg(error));
+        return;
+    }
+    refreshTree();
+    selectProject(projectId);
+    emit projectsChanged();
+}
+
+void ProjectsDialog::addPhase()
+{
+    int parentId = selectedProjectId();
+    if (parentId == 0) {
+        QMessageBox::warning(this, "Selection Required", "Please select the project to add a phase to");
+        return;
+    }
+
+    QString name;
+    double budget = 0.0;
+    QString site;
+    if (!askProject("Add Phase", &parentId, &name, &budget, &site, 0)) return;
+
+    QString error;
+    int projectId = store->addProject(parentId, name, budget, &error);
+    if (!projectId || (!site.isEmpty() && !store->setSite(projectId, site, &error))) {
+        QMessageBox::critical(this, "Database Error", QString("Failed to save phase: %1").arg(error));
+        return;
+    }
+    refreshTree();
+    selectProject(projectId);
+    emit projectsChanged();
+}
+
+void ProjectsDialog::editProject()
+{
+    int projectId = selectedProjectId();
+    if (projectId == 0) {
+        QMessageBox::warning(this, "Selection Required", "Please select a project first");
+        return;
+    }
+
+    BudgetTree::Node node = store->tree().node(projectId);
+    int parentId = node.parentId;
+    QString name = node.name;
+    double budget = node.budget;
+    QString site = store->siteText(projectId);
+    if (!askProject("Edit Project", &parentId, &name, &budget, &site, projectId)) return;
+
+    QString error;
+    if (!store->updateProject(projectId, parentId, name, budget, &error) ||
+        !store->setSite(projectId, site, &error)) {
+        QMessageBox::critical(this, "Invalid Project", QString("Failed to update project: %1").arg(error));
+        return;
+    }
+    refreshTree();
+    emit projectsChanged();
+}
+
+void ProjectsDialog::deleteProject()
+{
+    int projectId = selectedProjectId();
+    if (projectId == 0) {
+        QMessageBox::warning(this, "Selection Required", "Please select a project first");
+        return;
+    }
+
+    BudgetTree::Node node = store->tree().node(projectId);
+    if (QMessageBox::question(this, "Confirm Delete",
+                              QString("Delete \"%1\"? Its phases and %2 task(s) will move to the parent level.")
+                                  .arg(node.name)
+                                  .arg(node.taskCount)) != QMessageBox::Yes) {
+        return;
+    }
+
+    QString error;
+    if (!store->removeProject(projectId, nullptr, &error)) {
+        QMessageBox::critical(this, "Database Error", QString("Failed to delete project: %1").arg(error));
+        return;
+    }
+    refreshTree();
+    emit projectsChanged();
+}
+
+void ProjectsDialog::exportPack()
+{
+    int projectId = selectedProjectId();
+    if (projectId == 0) {
+        QMessageBox::warning(this, "Selection Required", "Please select a project first");
+        return;
+    }
+    emit exportPackRequested(projectId);
+}
+
+void ProjectsDialog::importPack()
+{
+    // La fenêtre principale recharge le magasin de projets avant de rendre la main
+    emit importPackRequested();
+    refreshTree();
+}
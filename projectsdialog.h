@@ -0,0 +1,45 @@
+#ifndef PROJECTSDIALOG_H
+#define PROJECTSDIALOG_H
+
+#include <QCheckBox>
+#include <QDialog>
+#include <QLabel>
+#include <QTreeWidget>
+#include "projectstore.h"
+
+// Portefeuille de projets : arbre des budgets et liste des dépassements
+class ProjectsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    ProjectsDialog(ProjectStore *store, QWidget *parent = nullptr);
+
+signals:
+    void projectsChanged();
+    void exportPackRequested(int projectId);
+    void importPackRequested();
+
+private slots:
+    void refreshTree();
+    void addProject();
+    void addPhase();
+    void editProject();
+    void deleteProject();
+    void exportPack();
+    void importPack();
+
+private:
+    ProjectStore *store;
+    QTreeWidget *projectTree;
+    QCheckBox *overrunsOnly;
+    QLabel *totalLabel;
+
+    int selectedProjectId() const;
+    void selectProject(int projectId);
+    QTreeWidgetItem *createItem(const BudgetTree::Node &node, bool showPath) const;
+    void addChildren(QTreeWidgetItem *parentItem, const BudgetTree::Node &node) const;
+    bool askProject(const QString &title, int *parentId, QString *name, double *budget, QString *site, int excludeId);
+};
+
+#endif // PROJECTSDIALOG_H
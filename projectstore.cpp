@@ -0,0 +1,197 @@
+#include "projectstore.h"
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+#include "spatialindex.h"
+
+void ProjectStore::setDatabase(const QSqlDatabase &database)
+{
+    db = database;
+}
+
+bool ProjectStore::initialize(QString *error)
+{
+    // Un projet sans parent est un projet, les niveaux suivants sont des phases
+    QStringList schemaSQL = {
+        "CREATE TABLE IF NOT EXISTS projects ("
+        "   id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "   parent_id INTEGER REFERENCES projects(id),"
+        "   name TEXT NOT NULL,"
+        "   budget REAL NOT NULL DEFAULT 0,"
+        "   created_at DATETIME DEFAULT CURRENT_TIMESTAMP"
+        ")",
+        "CREATE INDEX IF NOT EXISTS idx_projects_parent ON projects(parent_id)"
+    };
+
+    QSqlQuery query(db);
+    for (const QString &sql : schemaSQL) {
+        if (!query.exec(sql)) {
+            if (error) *error = query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ProjectStore::load(QString *error)
+{
+    budget.clear();
+    siteById.clear();
+
+    QSqlQuery query(db);
+    if (!query.exec("SELECT id, COALESCE(parent_id, 0), name, budget, latitude, longitude FROM projects")) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        QString cycleError;
+        if (!budget.setProject(query.value(0).toInt(), query.value(1).toInt(),
+                               query.value(2).toString(), query.value(3).toDouble(), &cycleError)) {
+            // Données corrompues : le projet est rattaché à la racine plutôt que perdu
+            budget.setProject(query.value(0).toInt(), 0, query.value(2).toString(), query.value(3).toDouble());
+        }
+        if (!query.value(4).isNull() && !query.value(5).isNull()) {
+            siteById.insert(query.value(0).toInt(), QPointF(query.value(5).toDouble(), query.value(4).toDouble()));
+        }
+    }
+    return true;
+}
+
+void ProjectStore::trackTask(const QString &taskId, int projectId, double planned, double actual)
+{
+    budget.setTask(taskId, projectId, planned, actual);
+}
+
+int ProjectStore::addProject(int parentId, const QString &name, double budgetAmount, QString *error)
+{
+    if (parentId != 0 && !budget.contains(parentId)) {
+        if (error) *error = "Unknown parent project";
+        return 0;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO projects (parent_id, name, budget) VALUES (:parent_id, :name, :budget)");
+    query.bindValue(":parent_id", parentId > 0 ? QVariant(parentId) : QVariant());
+    query.bindValue(":name", name);
+    query.bindValue(":budget", budgetAmount);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return 0;
+    }
+
+    int id = query.lastInsertId().toInt();
+    budget.setProject(id, parentId, name, budgetAmount);
+    return id;
+}
+
+bool ProjectStore::updateProject(int id, int parentId, const QString &name, double budgetAmount, QString *error)
+{
+    if (!budget.contains(id) || (parentId != 0 && !budget.contains(parentId))) {
+        if (error) *error = "Unknown project";
+        return false;
+    }
+    if (!budget.canMove(id, parentId, error)) return false;
+
+    QSqlQuery query(db);
+    query.prepare("UPDATE projects SET parent_id = :parent_id, name = :name, budget = :budget WHERE id = :id");
+    query.bindValue(":parent_id", parentId > 0 ? QVariant(parentId) : QVariant());
+    query.bindValue(":name", name);
+    query.bindValue(":budget", budgetAmount);
+    query.bindValue(":id", id);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    return budget.setProject(id, parentId, name, budgetAmount, error);
+}
+
+bool ProjectStore::removeProject(int id, QStringList *movedTasks, QString *error)
+{
+    int parentId = budget.node(id).parentId;
+    QVariant parent = parentId > 0 ? QVariant(parentId) : QVariant();
+
+    if (!db.transaction()) {
+        if (error) *error = db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(db);
+    QStringList statements = {
+        "UPDATE projects SET parent_id = :parent WHERE parent_id = :id",
+        "UPDATE tasks SET project_id = :parent WHERE project_id = :id",
+        "DELETE FROM projects WHERE id = :id"
+    };
+    for (const QString &sql : statements) {
+        query.prepare(sql);
+        if (sql.contains(":parent")) query.bindValue(":parent", parent);
+        query.bindValue(":id", id);
+        if (!query.exec()) {
+            if (error) *error = query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+
+    if (!db.commit()) {
+        if (error) *error = db.lastError().text();
+        return false;
+    }
+
+    QStringList moved = budget.removeProject(id);
+    siteById.remove(id);
+    if (movedTasks) *movedTasks = moved;
+    return true;
+}
+
+bool ProjectStore::setSite(int id, const QString &coordinates, QString *error)
+{
+    QPointF site;
+    bool located = !coordinates.trimmed().isEmpty();
+    if (located && !SpatialIndex::parseCoordinates(coordinates, &site)) {
+        if (error) *error = "Site must be \"latitude, longitude\"";
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("UPDATE projects SET latitude = :latitude, longitude = :longitude WHERE id = :id");
+    query.bindValue(":latitude", located ? QVariant(site.y()) : QVariant());
+    query.bindValue(":longitude", located ? QVariant(site.x()) : QVariant());
+    query.bindValue(":id", id);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+
+    if (located) {
+        siteById.insert(id, site);
+    } else {
+        siteById.remove(id);
+    }
+    return true;
+}
+
+QString ProjectStore::siteText(int id) const
+{
+    auto it = siteById.constFind(id);
+    return it == siteById.constEnd() ? QString() : SpatialIndex::formatCoordinates(it.value());
+}
+
+bool ProjectStore::setTaskCosts(const QString &taskId, int projectId, double planned, double actual, QString *error)
+{
+    if (!budget.contains(projectId)) projectId = 0;
+
+    QSqlQuery query(db);
+    query.prepare("UPDATE tasks SET project_id = :project_id, planned_cost = :planned, actual_cost = :actual "
+                  "WHERE id = :id");
+    query.bindValue(":project_id", projectId > 0 ? QVariant(projectId) : QVariant());
+    query.bindValue(":planned", planned);
+    query.bindValue(":actual", actual);
+    query.bindValue(":id", taskId);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+
+    budget.setTask(taskId, projectId, planned, actual);
+    return true;
+}
@@ -0,0 +1,45 @@
+#ifndef PROJECTSTORE_H
+#define PROJECTSTORE_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QPointF>
+#include "budgettree.h"
+
+// Persistance des projets et des coûts de tâches; les agrégats vivent
+// dans le BudgetTree, tenu à jour à chaque écriture
+class ProjectStore
+{
+public:
+    void setDatabase(const QSqlDatabase &database);
+    bool initialize(QString *error);
+
+    // Recharge les projets; les coûts des tâches sont ajoutés avec trackTask()
+    bool load(QString *error);
+    void trackTask(const QString &taskId, int projectId, double planned, double actual);
+
+    int addProject(int parentId, const QString &name, double budget, QString *error);
+    bool updateProject(int id, int parentId, const QString &name, double budget, QString *error);
+    // Phases et tâches remontent au parent; movedTasks reçoit les tâches déplacées
+    bool removeProject(int id, QStringList *movedTasks, QString *error);
+
+    // Emplacement du site, "" pour l'effacer
+    bool setSite(int id, const QString &coordinates, QString *error);
+    QHash<int, QPointF> sites() const { return siteById; }
+    QString siteText(int id) const;
+
+    bool setTaskCosts(const QString &taskId, int projectId, double planned, double actual, QString *error);
+    void renameTask(const QString &oldId, const QString &newId) { budget.renameTask(oldId, newId); }
+    void removeTask(const QString &taskId) { budget.removeTask(taskId); }
+
+    const BudgetTree &tree() const { return budget; }
+
+private:
+    QSqlDatabase db;
+    BudgetTree budget;
+    QHash<int, QPointF> siteById;
+};
+
+#endif // PROJECTSTORE_H
@@ -0,0 +1,249 @@
+#include "recurrencerule.h"
+#include <QLocale>
+#include <QRegularExpression>
+#include <QStringList>
+#include <algorithm>
+
+static const QStringList day_codes = {"MO", "TU", "WE", "TH", "FR", "SA", "SU"};
+static const QStringList frequency_names = {"DAILY", "WEEKLY", "MONTHLY", "YEARLY"};
+
+RecurrenceRule RecurrenceRule::parse(const QString &text, QString *error)
+{
+    RecurrenceRule rule;
+    auto fail = [error, &rule](const QString &message) {
+        if (error) *error = message;
+        rule.valid = false;
+        return rule;
+    };
+
+    QString body = text.trimmed().toUpper();
+    if (body.startsWith("RRULE:")) body = body.mid(6);
+    if (body.isEmpty()) return fail("Empty rule");
+
+    bool hasFrequency = false;
+    static const QRegularExpression weekdayPattern("^([+-]?\\d{1,2})?(MO|TU|WE|TH|FR|SA|SU)$");
+
+    for (const QString &part : body.split(';', Qt::SkipEmptyParts)) {
+        int equals = part.indexOf('=');
+        if (equals <= 0) return fail(QString("Malformed part \"%1\"").arg(part));
+        QString key = part.left(equals).trimmed();
+        QString value = part.mid(equals + 1).trimmed();
+        bool ok = true;
+
+        if (key == "FREQ") {
+            int index = frequency_names.indexOf(value);
+            if (index < 0) return fail(QString("Unsupported frequency %1").arg(value));
+            rule.frequency = Frequency(index);
+            hasFrequency = true;
+        } else if (key == "INTERVAL") {
+            rule.interval = value.toInt(&ok);
+            if (!ok || rule.interval < 1 || rule.interval > 1000) return fail("INTERVAL must be between 1 and 1000");
+        } else if (key == "COUNT") {
+            rule.count = value.toInt(&ok);
+            if (!ok || rule.count < 1) return fail("COUNT must be a positive number");
+        } else if (key == "UNTIL") {
+            rule.until = QDate::fromString(value.left(8), "yyyyMMdd");
+            if (!rule.until.isValid()) return fail("UNTIL must be a date (YYYYMMDD)");
+        } else if (key == "BYDAY") {
+            for (const QString &item : value.split(',', Qt::SkipEmptyParts)) {
+                QRegularExpressionMatch match = weekdayPattern.match(item.trimmed());
+                if (!match.hasMatch()) return fail(QString("Invalid BYDAY value %1").arg(item));
+                Weekday weekday;
+                weekday.ordinal = match.captured(1).isEmpty() ? 0 : match.captured(1).toInt();
+                weekday.day = day_codes.indexOf(match.captured(2)) + 1;
+                if (qAbs(weekday.ordinal) > 5) return fail(QString("Invalid BYDAY value %1").arg(item));
+                rule.byDay << weekday;
+            }
+        } else if (key == "BYMONTHDAY") {
+            for (const QString &item : value.split(',', Qt::SkipEmptyParts)) {
+                int day = item.trimmed().toInt(&ok);
+                if (!ok || day == 0 || qAbs(day) > 31) return fail(QString("Invalid BYMONTHDAY value %1").arg(item));
+                rule.byMonthDay << day;
+            }
+        } else {
+            return fail(QString("Unsupported rule part %1").arg(key));
+        }
+    }
+
+    if (!hasFrequency) return fail("FREQ is required");
+    if (rule.count > 0 && rule.until.isValid()) return fail("COUNT and UNTIL cannot be combined");
+    if (!rule.byMonthDay.isEmpty() && rule.frequency != Monthly) return fail("BYMONTHDAY requires FREQ=MONTHLY");
+    if (!rule.byDay.isEmpty() && rule.frequency != Weekly && rule.frequency != Monthly) {
+        return fail("BYDAY requires FREQ=WEEKLY or FREQ=MONTHLY");
+    }
+    for (const Weekday &weekday : rule.byDay) {
+        if (weekday.ordinal != 0 && rule.frequency != Monthly) return fail("Numbered BYDAY requires FREQ=MONTHLY");
+    }
+
+    rule.valid = true;
+    return rule;
+}
+
+QString RecurrenceRule::toString() const
+{
+    if (!valid) return QString();
+
+    QStringList parts = {"FREQ=" + frequency_names[frequency]};
+    if (interval > 1) parts << QString("INTERVAL=%1").arg(interval);
+    if (!byDay.isEmpty()) {
+        QStringList days;
+        for (const Weekday &weekday : byDay) {
+            days << (weekday.ordinal ? QString::number(weekday.ordinal) : QString()) + day_codes[weekday.day - 1];
+        }
+        parts << "BYDAY=" + days.join(',');
+    }
+    if (!byMonthDay.isEmpty()) {
+        QStringList days;
+        for (int day : byMonthDay) days << QString::number(day);
+        parts << "BYMONTHDAY=" + days.join(',');
+    }
+    if (count > 0) parts << QString("COUNT=%1").arg(count);
+    if (until.isValid()) parts << "UNTIL=" + until.toString("yyyyMMdd");
+    return parts.join(';');
+}
+
+QString RecurrenceRule::describe() const
+{
+    if (!valid) return QString();
+
+    static const QStringList units = {"day", "week", "month", "year"};
+    QString text = interval == 1 ? QString("Every %1").arg(units[frequency])
+                                 : QString("Every %1 %2s").arg(interval).arg(units[frequency]);
+
+    QLocale locale(QLocale::English);
+    QStringList days;
+    for (const Weekday &weekday : byDay) {
+        QString name = locale.dayName(weekday.day, QLocale::ShortFormat);
+        if (weekday.ordinal == -1) {
+            name = "last " + name;
+        } else if (weekday.ordinal < 0) {
+            name = QString("%1th last %2").arg(-weekday.ordinal).arg(name);
+        } else if (weekday.ordinal > 0) {
+            static const QStringList ordinals = {"1st", "2nd", "3rd", "4th", "5th"};
+            name = ordinals[weekday.ordinal - 1] + " " + name;
+        }
+        days << name;
+    }
+    for (int day : byMonthDay) {
+        days << (day == -1 ? QString("last day") : day < 0 ? QString("day %1 from the end").arg(-day)
+                                                           : QString("day %1").arg(day));
+    }
+    if (!days.isEmpty()) text += " on " + days.join(", ");
+
+    if (count > 0) text += QString(", %1 time(s)").arg(count);
+    if (until.isValid()) text += QString(", until %1").arg(until.toString("yyyy-MM-dd"));
+    return text;
+}
+
+QDate RecurrenceRule::periodStart(const QDate &start, qint64 period) const
+{
+    switch (frequency) {
+    case Daily:
+        return start.addDays(period * interval);
+    case Weekly:
+        return start.addDays(1 - start.dayOfWeek()).addDays(7 * period * interval);
+    case Monthly:
+        return QDate(start.year(), start.month(), 1).addMonths(int(period * interval));
+    case Yearly:
+        return QDate(start.year() + int(period * interval), 1, 1);
+    }
+    return QDate();
+}
+
+qint64 RecurrenceRule::periodOf(const QDate &start, const QDate &date) const
+{
+    qint64 elapsed = 0;
+    switch (frequency) {
+    case Daily:
+        elapsed = start.daysTo(date);
+        break;
+    case Weekly:
+        elapsed = start.addDays(1 - start.dayOfWeek()).daysTo(date) / 7;
+        break;
+    case Monthly:
+        elapsed = qint64(date.year() - start.year()) * 12 + date.month() - start.month();
+        break;
+    case Yearly:
+        elapsed = date.year() - start.year();
+        break;
+    }
+    return qMax<qint64>(0, elapsed / interval);
+}
+
+QVector<QDate> RecurrenceRule::candidates(const QDate &start, qint64 period) const
+{
+    QVector<QDate> dates;
+    QDate first = periodStart(start, period);
+
+    switch (frequency) {
+    case Daily:
+        dates << first;
+        break;
+    case Weekly:
+        if (byDay.isEmpty()) {
+            dates << first.addDays(start.dayOfWeek() - 1);
+        }
+        for (const Weekday &weekday : byDay) {
+            dates << first.addDays(weekday.day - 1);
+        }
+        break;
+    case Monthly: {
+        int length = first.daysInMonth();
+        for (int day : byMonthDay) {
+            int actual = day > 0 ? day : length + day + 1;
+            if (actual >= 1 && actual <= length) dates << first.addDays(actual - 1);
+        }
+        for (const Weekday &weekday : byDay) {
+            QDate firstMatch = first.addDays((weekday.day - first.dayOfWeek() + 7) % 7);
+            if (weekday.ordinal == 0) {
+                for (QDate date = firstMatch; date.month() == first.month(); date = date.addDays(7)) {
+                    dates << date;
+                }
+            } else if (weekday.ordinal > 0) {
+                QDate date = firstMatch.addDays(7 * (weekday.ordinal - 1));
+                if (date.month() == first.month()) dates << date;
+            } else {
+                QDate last = first.addDays(length - 1);
+                QDate date = last.addDays(-((last.dayOfWeek() - weekday.day + 7) % 7) + 7 * (weekday.ordinal + 1));
+                if (date.month() == first.month()) dates << date;
+            }
+        }
+        // Sans précision, même quantième que le début; les mois trop courts sont sautés (RFC 5545)
+        if (byMonthDay.isEmpty() && byDay.isEmpty() && start.day() <= length) {
+            dates << first.addDays(start.day() - 1);
+        }
+        break;
+    }
+    case Yearly: {
+        QDate date(first.year(), start.month(), start.day());
+        if (date.isValid()) dates << date;
+        break;
+    }
+    }
+
+    std::sort(dates.begin(), dates.end());
+    dates.erase(std::unique(dates.begin(), dates.end()), dates.end());
+    return dates;
+}
+
+QVector<QDate> RecurrenceRule::occurrences(const QDate &start, const QDate &from, const QDate &to) const
+{
+    QVector<QDate> result;
+    if (!valid || !start.isValid() || !from.isValid() || !to.isValid() || to < from) return result;
+
+    QDate last = until.isValid() ? qMin(to, until) : to;
+    // Avec COUNT, les occurrences antérieures à la fenêtre doivent être comptées
+    qint64 period = count > 0 ? 0 : periodOf(start, qMax(from, start));
+    int seen = 0;
+
+    for (;; ++period) {
+        if (periodStart(start, period) > last) break;
+        for (const QDate &date : candidates(start, period)) {
+            if (date < start) continue;
+            if (date > last) return result;
+            if (count > 0 && ++seen > count) return result;
+            if (date >= from) result << date;
+        }
+    }
+    return result;
+}
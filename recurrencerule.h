@@ -0,0 +1,47 @@
+#ifndef RECURRENCERULE_H
+#define RECURRENCERULE_H
+
+#include <QDate>
+#include <QString>
+#include <QVector>
+
+// Sous-ensemble de RRULE (RFC 5545) : FREQ=DAILY|WEEKLY|MONTHLY|YEARLY,
+// INTERVAL, BYDAY (MO,WE ou 2TU, -1FR en mensuel), BYMONTHDAY (15, -1),
+// COUNT et UNTIL=AAAAMMJJ. Les dates sont calculées à la demande pour une
+// fenêtre : on saute directement à la période qui la contient, sauf avec
+// COUNT où il faut compter depuis le début de la série.
+class RecurrenceRule
+{
+public:
+    enum Frequency { Daily, Weekly, Monthly, Yearly };
+
+    struct Weekday
+    {
+        int ordinal = 0;    // 0 : tous les jours de ce nom dans la période; -1 : le dernier
+        int day = 1;        // 1 = lundi ... 7 = dimanche (Qt::DayOfWeek)
+    };
+
+    static RecurrenceRule parse(const QString &text, QString *error = nullptr);
+
+    bool isValid() const { return valid; }
+    QString toString() const;
+    QString describe() const;
+
+    // Dates de la série commençant à start, comprises dans [from, to]
+    QVector<QDate> occurrences(const QDate &start, const QDate &from, const QDate &to) const;
+
+private:
+    bool valid = false;
+    Frequency frequency = Weekly;
+    int interval = 1;
+    QVector<Weekday> byDay;
+    QVector<int> byMonthDay;
+    int count = 0;
+    QDate until;
+
+    QVector<QDate> candidates(const QDate &start, qint64 period) const;
+    QDate periodStart(const QDate &start, qint64 period) const;
+    qint64 periodOf(const QDate &start, const QDate &date) const;
+};
+
+#endif // RECURRENCERULE_H
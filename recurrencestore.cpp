@@ -0,0 +1,238 @@
+#include "recurrencestore.h"
+#include <QRegularExpression>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariant>
+#include <algorithm>
+
+QString RecurrenceStore::occurrenceId(int seriesId, const QDate &date)
+{
+    return QString("R%1-%2").arg(seriesId).arg(date.toString("yyyyMMdd"));
+}
+
+bool RecurrenceStore::parseOccurrenceId(const QString &taskId, int *seriesId, QDate *date)
+{
+    static const QRegularExpression pattern("^R(\\d+)-(\\d{8})$");
+    QRegularExpressionMatch match = pattern.match(taskId);
+    if (!match.hasMatch()) return false;
+
+    QDate parsed = QDate::fromString(match.captured(2), "yyyyMMdd");
+    if (!parsed.isValid()) return false;
+    if (seriesId) *seriesId = match.captured(1).toInt();
+    if (date) *date = parsed;
+    return true;
+}
+
+void RecurrenceStore::setDatabase(const QSqlDatabase &database)
+{
+    db = database;
+}
+
+bool RecurrenceStore::initialize(QString *error)
+{
+    QStringList schemaSQL = {
+        "CREATE TABLE IF NOT EXISTS recurring_tasks ("
+        "   id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "   name TEXT NOT NULL,"
+        "   description TEXT,"
+        "   priority TEXT NOT NULL DEFAULT 'Medium',"
+        "   assigned_to TEXT,"
+        "   start_date TEXT NOT NULL,"
+        "   duration_days INTEGER NOT NULL DEFAULT 1,"
+        "   rule TEXT NOT NULL,"
+        "   created_at DATETIME DEFAULT CURRENT_TIMESTAMP"
+        ")",
+        // Occurrences déjà écrites dans tasks, ou supprimées avant de l'être
+        "CREATE TABLE IF NOT EXISTS recurring_exceptions ("
+        "   recurring_id INTEGER NOT NULL REFERENCES recurring_tasks(id),"
+        "   occurrence_date TEXT NOT NULL,"
+        "   PRIMARY KEY (recurring_id, occurrence_date)"
+        ")"
+    };
+
+    QSqlQuery query(db);
+    for (const QString &sql : schemaSQL) {
+        if (!query.exec(sql)) {
+            if (error) *error = query.lastError().text();
+            return false;
+        }
+    }
+    return load(error);
+}
+
+bool RecurrenceStore::load(QString *error)
+{
+    seriesMap.clear();
+    exceptions.clear();
+
+    QSqlQuery query(db);
+    if (!query.exec("SELECT id, name, description, priority, assigned_to, start_date, duration_days, rule "
+                    "FROM recurring_tasks")) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        Series series;
+        series.id = query.value(0).toInt();
+        series.name = query.value(1).toString();
+        series.description = query.value(2).toString();
+        series.priority = query.value(3).toString();
+        series.assignedTo = query.value(4).toString();
+        series.start = QDate::fromString(query.value(5).toString(), "yyyy-MM-dd");
+        series.durationDays = qMax(1, query.value(6).toInt());
+        series.rule = query.value(7).toString();
+        series.parsed = RecurrenceRule::parse(series.rule);
+        seriesMap.insert(series.id, series);
+    }
+
+    if (!query.exec("SELECT recurring_id, occurrence_date FROM recurring_exceptions")) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        QDate date = QDate::fromString(query.value(1).toString(), "yyyy-MM-dd");
+        exceptions[query.value(0).toInt()].insert(date.toJulianDay());
+    }
+    return true;
+}
+
+QVector<RecurrenceStore::Series> RecurrenceStore::series() const
+{
+    QVector<Series> result(seriesMap.cbegin(), seriesMap.cend());
+    std::sort(result.begin(), result.end(), [](const Series &a, const Series &b) {
+        return a.name.compare(b.name, Qt::CaseInsensitive) < 0;
+    });
+    return result;
+}
+
+int RecurrenceStore::addSeries(const Series &series, QString *error)
+{
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO recurring_tasks (name, description, priority, assigned_to, start_date, duration_days, rule) "
+                  "VALUES (:name, :description, :priority, :assigned_to, :start_date, :duration_days, :rule)");
+    query.bindValue(":name", series.name);
+    query.bindValue(":description", series.description);
+    query.bindValue(":priority", series.priority);
+    query.bindValue(":assigned_to", series.assignedTo);
+    query.bindValue(":start_date", series.start.toString("yyyy-MM-dd"));
+    query.bindValue(":duration_days", qMax(1, series.durationDays));
+    query.bindValue(":rule", series.rule);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return 0;
+    }
+
+    Series added = series;
+    added.id = query.lastInsertId().toInt();
+    added.durationDays = qMax(1, series.durationDays);
+    added.parsed = RecurrenceRule::parse(series.rule);
+    seriesMap.insert(added.id, added);
+    return added.id;
+}
+
+bool RecurrenceStore::updateSeries(const Series &series, QString *error)
+{
+    QSqlQuery query(db);
+    query.prepare("UPDATE recurring_tasks SET name = :name, description = :description, priority = :priority, "
+                  "assigned_to = :assigned_to, start_date = :start_date, duration_days = :duration_days, rule = :rule "
+                  "WHERE id = :id");
+    query.bindValue(":name", series.name);
+    query.bindValue(":description", series.description);
+    query.bindValue(":priority", series.priority);
+    query.bindValue(":assigned_to", series.assignedTo);
+    query.bindValue(":start_date", series.start.toString("yyyy-MM-dd"));
+    query.bindValue(":duration_days", qMax(1, series.durationDays));
+    query.bindValue(":rule", series.rule);
+    query.bindValue(":id", series.id);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+
+    Series updated = series;
+    updated.durationDays = qMax(1, series.durationDays);
+    updated.parsed = RecurrenceRule::parse(series.rule);
+    seriesMap.insert(updated.id, updated);
+    return true;
+}
+
+bool RecurrenceStore::removeSeries(int id, QString *error)
+{
+    // Les occurrences déjà matérialisées restent des tâches ordinaires
+    if (!db.transaction()) {
+        if (error) *error = db.lastError().text();
+        return false;
+    }
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM recurring_exceptions WHERE recurring_id = :id");
+    query.bindValue(":id", id);
+    bool ok = query.exec();
+    if (ok) {
+        query.prepare("DELETE FROM recurring_tasks WHERE id = :id");
+        query.bindValue(":id", id);
+        ok = query.exec();
+    }
+    if (!ok || !db.commit()) {
+        if (error) *error = ok ? db.lastError().text() : query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    seriesMap.remove(id);
+    exceptions.remove(id);
+    return true;
+}
+
+QVector<RecurrenceStore::Occurrence> RecurrenceStore::occurrences(const QDate &from, const QDate &to) const
+{
+    QVector<Occurrence> result;
+    for (const Series &series : seriesMap) {
+        if (!series.parsed.isValid()) continue;
+
+        const QSet<qint64> skipped = exceptions.value(series.id);
+        for (const QDate &date : series.parsed.occurrences(series.start, from, to)) {
+            if (skipped.contains(date.toJulianDay())) continue;
+
+            Occurrence occurrence;
+            occurrence.seriesId = series.id;
+            occurrence.taskId = occurrenceId(series.id, date);
+            occurrence.name = series.name;
+            occurrence.description = series.description;
+            occurrence.priority = series.priority;
+            occurrence.assignedTo = series.assignedTo;
+            occurrence.start = date;
+            occurrence.end = date.addDays(series.durationDays - 1);
+            result << occurrence;
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const Occurrence &a, const Occurrence &b) {
+        return a.start < b.start || (a.start == b.start && a.seriesId < b.seriesId);
+    });
+    return result;
+}
+
+bool RecurrenceStore::isPending(const QString &taskId) const
+{
+    int seriesId = 0;
+    QDate date;
+    if (!parseOccurrenceId(taskId, &seriesId, &date) || !seriesMap.contains(seriesId)) return false;
+    if (exceptions.value(seriesId).contains(date.toJulianDay())) return false;
+
+    const Series &series = seriesMap[seriesId];
+    return !series.parsed.occurrences(series.start, date, date).isEmpty();
+}
+
+bool RecurrenceStore::addException(int seriesId, const QDate &date, QString *error)
+{
+    QSqlQuery query(db);
+    query.prepare("INSERT OR IGNORE INTO recurring_exceptions (recurring_id, occurrence_date) VALUES (:id, :date)");
+    query.bindValue(":id", seriesId);
+    query.bindValue(":date", date.toString("yyyy-MM-dd"));
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    exceptions[seriesId].insert(date.toJulianDay());
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef RECURRENCESTORE_H
+#define RECURRENCESTORE_H
+
+#include <QDate>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+#include "recurrencerule.h"
+
+// Tâches récurrentes (inspections, visites, rapports mensuels). Seule la
+// définition est stockée; les occurrences sont calculées pour la fenêtre
+// demandée. Une occurrence modifiée devient une vraie tâche (identifiant
+// R<série>-AAAAMMJJ) et une exception empêche de la générer à nouveau.
+class RecurrenceStore
+{
+public:
+    struct Series
+    {
+        int id = 0;
+        QString name;
+        QString description;
+        QString priority = "Medium";
+        QString assignedTo;
+        QDate start;
+        int durationDays = 1;
+        QString rule;
+        RecurrenceRule parsed;
+    };
+
+    struct Occurrence
+    {
+        int seriesId = 0;
+        QString taskId;
+        QString name;
+        QString description;
+        QString priority;
+        QString assignedTo;
+        QDate start;
+        QDate end;
+    };
+
+    static QString occurrenceId(int seriesId, const QDate &date);
+    static bool parseOccurrenceId(const QString &taskId, int *seriesId, QDate *date);
+
+    void setDatabase(const QSqlDatabase &database);
+    bool initialize(QString *error);
+    bool load(QString *error);
+
+    QVector<Series> series() const;
+    Series seriesById(int id) const { return seriesMap.value(id); }
+    int addSeries(const Series &series, QString *error);
+    bool updateSeries(const Series &series, QString *error);
+    bool removeSeries(int id, QString *error);
+
+    // Occurrences non matérialisées commençant dans [from, to], triées par date
+    QVector<Occurrence> occurrences(const QDate &from, const QDate &to) const;
+    bool isPending(const QString &taskId) const;
+    bool addException(int seriesId, const QDate &date, QString *error);
+
+private:
+    QSqlDatabase db;
+    QMap<int, Series> seriesMap;
+    QHash<int, QSet<qint64>> exceptions;    // jours juliens déjà matérialisés ou annulés
+};
+
+#endif // RECURRENCESTORE_H
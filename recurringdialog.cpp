@@ -0,0 +1,269 @@
+#include "recurringdialog.h"
+#include <QComboBox>
+#include <QDateEdit>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QVBoxLayout>
+#include "taskrecord.h"
+
+// Occurrences listées dans l'aperçu
+static const int upcoming_count = 12;
+
+RecurringDialog::RecurringDialog(RecurrenceStore *store, QWidget *parent)
+    : QDialog(parent),
+    store(store)
+{
+    setWindowTitle("Recurring Tasks");
+    resize(1000, 560);
+
+    seriesTable = new QTableWidget(this);
+    seriesTable->setColumnCount(5);
+    seriesTable->setHorizontalHeaderLabels({"Name", "Repeats", "Starts", "Days", "Assigned To"});
+    seriesTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    seriesTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    seriesTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    seriesTable->horizontalHeader()->setStretchLastSection(true);
+
+    upcomingList = new QListWidget(this);
+    upcomingList->setMaximumWidth(280);
+
+    QPushButton *addBtn = new QPushButton("Add", this);
+    QPushButton *editBtn = new QPushButton("Edit", this);
+    QPushButton *removeBtn = new QPushButton("Delete", this);
+    QPushButton *closeBtn = new QPushButton("Close", this);
+
+    connect(addBtn, &QPushButton::clicked, this, &RecurringDialog::addSeries);
+    connect(editBtn, &QPushButton::clicked, this, &RecurringDialog::editSeries);
+    connect(removeBtn, &QPushButton::clicked, this, &RecurringDialog::removeSeries);
+    connect(closeBtn, &QPushButton::clicked, this, &QDialog::accept);
+    connect(seriesTable, &QTableWidget::itemSelectionChanged, this, &RecurringDialog::showUpcoming);
+    connect(seriesTable, &QTableWidget::cellDoubleClicked, this, &RecurringDialog::editSeries);
+
+    QVBoxLayout *upcomingLayout = new QVBoxLayout;
+    upcomingLayout->addWidget(new QLabel("Upcoming occurrences:", this));
+    upcomingLayout->addWidget(upcomingList, 1);
+
+    QHBoxLayout *bodyLayout = new QHBoxLayout;
+    bodyLayout->addWidget(seriesTable, 1);
+    bodyLayout->addLayout(upcomingLayout);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    buttonLayout->addWidget(addBtn);
+    buttonLayout->addWidget(editBtn);
+    buttonLayout->addWidget(removeBtn);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(closeBtn);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(bodyLayout, 1);
+    mainLayout->addWidget(new QLabel("Occurrences are not stored until they are edited; "
+                                     "deleting one skips that date only.", this));
+    mainLayout->addLayout(buttonLayout);
+
+    refreshSeries();
+}
+
+int RecurringDialog::selectedSeriesId() const
+{
+    int row = seriesTable->currentRow();
+    if (row < 0 || !seriesTable->item(row, 0)) return 0;
+    return seriesTable->item(row, 0)->data(Qt::UserRole).toInt();
+}
+
+void RecurringDialog::refreshSeries()
+{
+    int selected = selectedSeriesId();
+    seriesTable->setRowCount(0);
+
+    for (const RecurrenceStore::Series &series : store->series()) {
+        int row = seriesTable->rowCount();
+        seriesTable->insertRow(row);
+        QStringList cells = {series.name,
+                             series.parsed.isValid() ? series.parsed.describe() : QString("Invalid rule: %1").arg(series.rule),
+                             series.start.toString("yyyy-MM-dd"),
+                             QString::number(series.durationDays),
+                             series.assignedTo};
+        for (int col = 0; col < cells.size(); ++col) {
+            seriesTable->setItem(row, col, new QTableWidgetItem(cells[col]));
+        }
+        seriesTable->item(row, 0)->setData(Qt::UserRole, series.id);
+        seriesTable->item(row, 1)->setToolTip(series.rule);
+        if (series.id == selected) seriesTable->selectRow(row);
+    }
+    seriesTable->resizeColumnsToContents();
+    showUpcoming();
+}
+
+void RecurringDialog::showUpcoming()
+{
+    upcomingList->clear();
+    RecurrenceStore::Series series = store->seriesById(selectedSeriesId());
+    if (series.id == 0 || !series.parsed.isValid()) return;
+
+    // Fenêtre élargie jusqu'à trouver assez d'occurrences, sans dépasser dix ans
+    QDate today = QDate::currentDate();
+    QVector<QDate> dates;
+    for (int years = 1; years <= 10 && dates.size() < upcoming_count; years *= 2) {
+        dates = series.parsed.occurrences(series.start, today, today.addYears(years));
+    }
+    for (int i = 0; i < dates.size() && i < upcoming_count; ++i) {
+        QListWidgetItem *item = new QListWidgetItem(dates[i].toString("ddd yyyy-MM-dd"), upcomingList);
+        item->setToolTip(RecurrenceStore::occurrenceId(series.id, dates[i]));
+    }
+    if (dates.isEmpty()) {
+        upcomingList->addItem("(no further occurrences)");
+    }
+}
+
+bool RecurringDialog::askSeries(RecurrenceStore::Series *series)
+{
+    QDialog dialog(this);
+    QFormLayout form(&dialog);
+    dialog.setWindowTitle(series->id ? "Edit Recurring Task" : "Add Recurring Task");
+
+    QLineEdit *nameEdit = new QLineEdit(series->name, &dialog);
+    QLineEdit *descriptionEdit = new QLineEdit(series->description, &dialog);
+    QComboBox *priorityCombo = new QComboBox(&dialog);
+    priorityCombo->addItems(TaskRecord::priorities());
+    priorityCombo->setCurrentText(series->priority);
+    QLineEdit *assignedEdit = new QLineEdit(series->assignedTo, &dialog);
+    QDateEdit *startEdit = new QDateEdit(series->start.isValid() ? series->start : QDate::currentDate(), &dialog);
+    startEdit->setDisplayFormat("yyyy-MM-dd");
+    startEdit->setCalendarPopup(true);
+    QSpinBox *durationSpin = new QSpinBox(&dialog);
+    durationSpin->setRange(1, 365);
+    durationSpin->setValue(series->durationDays);
+    durationSpin->setSuffix(" day(s)");
+
+    QComboBox *presetCombo = new QComboBox(&dialog);
+    presetCombo->addItem("Custom", QString());
+    presetCombo->addItem("Every day", "FREQ=DAILY");
+    presetCombo->addItem("Every weekday", "FREQ=WEEKLY;BYDAY=MO,TU,WE,TH,FR");
+    presetCombo->addItem("Every week", "FREQ=WEEKLY");
+    presetCombo->addItem("Every 2 weeks", "FREQ=WEEKLY;INTERVAL=2");
+    presetCombo->addItem("Every month (same day)", "FREQ=MONTHLY");
+    presetCombo->addItem("Every month (last day)", "FREQ=MONTHLY;BYMONTHDAY=-1");
+    presetCombo->addItem("Every month (first Monday)", "FREQ=MONTHLY;BYDAY=1MO");
+    presetCombo->addItem("Every quarter", "FREQ=MONTHLY;INTERVAL=3");
+    presetCombo->addItem("Every year", "FREQ=YEARLY");
+    QLineEdit *ruleEdit = new QLineEdit(series->rule.isEmpty() ? QString("FREQ=WEEKLY") : series->rule, &dialog);
+    ruleEdit->setPlaceholderText("FREQ=WEEKLY;BYDAY=MO;COUNT=10");
+    QLabel *previewLabel = new QLabel(&dialog);
+    previewLabel->setWordWrap(true);
+
+    auto preview = [ruleEdit, startEdit, previewLabel]() {
+        QString error;
+        RecurrenceRule rule = RecurrenceRule::parse(ruleEdit->text(), &error);
+        if (!rule.isValid()) {
+            previewLabel->setText(QString("<span style='color:#dc3545'>%1</span>").arg(error.toHtmlEscaped()));
+            return;
+        }
+        QStringList next;
+        QDate from = qMax(startEdit->date(), QDate::currentDate());
+        for (const QDate &date : rule.occurrences(startEdit->date(), from, from.addYears(1))) {
+            next << date.toString("yyyy-MM-dd");
+            if (next.size() == 4) break;
+        }
+        previewLabel->setText(QString("%1<br>Next: %2").arg(rule.describe().toHtmlEscaped(),
+                                                           next.isEmpty() ? QString("-") : next.join(", ")));
+    };
+    connect(presetCombo, QOverload<int>::of(&QComboBox::activated), &dialog, [presetCombo, ruleEdit](int index) {
+        QString rule = presetCombo->itemData(index).toString();
+        if (!rule.isEmpty()) ruleEdit->setText(rule);
+    });
+    connect(ruleEdit, &QLineEdit::textChanged, &dialog, preview);
+    connect(startEdit, &QDateEdit::dateChanged, &dialog, preview);
+    preview();
+
+    form.addRow("Name:", nameEdit);
+    form.addRow("Description:", descriptionEdit);
+    form.addRow("Priority:", priorityCombo);
+    form.addRow("Assigned To:", assignedEdit);
+    form.addRow("First Occurrence:", startEdit);
+    form.addRow("Duration:", durationSpin);
+    form.addRow("Preset:", presetCombo);
+    form.addRow("Rule (RRULE):", ruleEdit);
+    form.addRow(previewLabel);
+
+    QDialogButtonBox buttonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, &dialog);
+    form.addRow(&buttonBox);
+    connect(&buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(&buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    if (dialog.exec() != QDialog::Accepted) return false;
+
+    QString error;
+    RecurrenceRule rule = RecurrenceRule::parse(ruleEdit->text(), &error);
+    if (nameEdit->text().trimmed().isEmpty()) {
+        QMessageBox::warning(this, "Missing Data", "Name cannot be empty");
+        return false;
+    }
+    if (!rule.isValid()) {
+        QMessageBox::warning(this, "Invalid Rule", error);
+        return false;
+    }
+
+    series->name = nameEdit->text().trimmed();
+    series->description = descriptionEdit->text().trimmed();
+    series->priority = priorityCombo->currentText();
+    series->assignedTo = assignedEdit->text().trimmed();
+    series->start = startEdit->date();
+    series->durationDays = durationSpin->value();
+    series->rule = rule.toString();
+    return true;
+}
+
+void RecurringDialog::addSeries()
+{
+    RecurrenceStore::Series series;
+    if (!askSeries(&series)) return;
+
+    QString error;
+    if (!store->addSeries(series, &error)) {
+        QMessageBox::critical(this, "Database Error", QString("Failed to save recurring task: %1").arg(error));
+        return;
+    }
+    refreshSeries();
+    emit seriesChanged();
+}
+
+void RecurringDialog::editSeries()
+{
+    RecurrenceStore::Series series = store->seriesById(selectedSeriesId());
+    if (series.id == 0 || !askSeries(&series)) return;
+
+    QString error;
+    if (!store->updateSeries(series, &error)) {
+        QMessageBox::critical(this, "Database Error", QString("Failed to save recurring task: %1").arg(error));
+        return;
+    }
+    refreshSeries();
+    emit seriesChanged();
+}
+
+void RecurringDialog::removeSeries()
+{
+    RecurrenceStore::Series series = store->seriesById(selectedSeriesId());
+    if (series.id == 0) return;
+
+    if (QMessageBox::question(this, "Delete Recurring Task",
+                              QString("Delete \"%1\"? Occurrences already saved as tasks are kept.").arg(series.name),
+                              QMessageBox::Yes | QMessageBox::No, QMessageBox::No) != QMessageBox::Yes) {
+        return;
+    }
+
+    QString error;
+    if (!store->removeSeries(series.id, &error)) {
+        QMessageBox::critical(this, "Database Error", QString("Failed to delete recurring task: %1").arg(error));
+        return;
+    }
+    refreshSeries();
+    emit seriesChanged();
+}
@@ -0,0 +1,36 @@
+#ifndef RECURRINGDIALOG_H
+#define RECURRINGDIALOG_H
+
+#include <QDialog>
+#include <QListWidget>
+#include <QTableWidget>
+#include "recurrencestore.h"
+
+// Définitions des tâches récurrentes et aperçu des prochaines occurrences
+class RecurringDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    RecurringDialog(RecurrenceStore *store, QWidget *parent = nullptr);
+
+signals:
+    void seriesChanged();
+
+private slots:
+    void refreshSeries();
+    void showUpcoming();
+    void addSeries();
+    void editSeries();
+    void removeSeries();
+
+private:
+    RecurrenceStore *store;
+    QTableWidget *seriesTable;
+    QListWidget *upcomingList;
+
+    int selectedSeriesId() const;
+    bool askSeries(RecurrenceStore::Series *series);
+};
+
+#endif // RECURRINGDIALOG_H
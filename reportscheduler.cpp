@@ -0,0 +1,468 @@
+#include "reportscheduler.h"
+#include "diagnostics.h"
+#include "timetracker.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QPair>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTextStream>
+#include <QUuid>
+#include <QVariant>
+#include <QtConcurrent>
+
+// Colonnes dont dépendent les synthèses : toute autre modification ne les touche pas
+static const QStringList summary_columns = {"assigned_to", "status", "start_date", "end_date",
+                                            "created_at", "completed_at"};
+
+static QString assigneeOf(const QString &prefix)
+{
+    return QString("COALESCE(NULLIF(TRIM(%1assigned_to), ''), 'Unassigned')").arg(prefix);
+}
+
+// Mêmes tranches que ChartRenderer::durationSpec, -1 sans dates valides
+static QString bucketOf(const QString &prefix)
+{
+    QString days = QString("(julianday(%1end_date) - julianday(%1start_date) + 1)").arg(prefix);
+    return QString("CASE WHEN julianday(%1start_date) IS NULL OR julianday(%1end_date) IS NULL THEN -1 "
+                   "WHEN %2 <= 1 THEN 0 WHEN %2 <= 7 THEN 1 WHEN %2 <= 30 THEN 2 ELSE 3 END").arg(prefix, days);
+}
+
+// Lundi de la semaine; les horodatages sont en UTC, les échéances en date locale
+static QString weekSql(const QString &column, bool utc)
+{
+    return QString("date(%1%2, 'weekday 0', '-6 days')").arg(column, utc ? ", 'localtime'" : "");
+}
+
+// Contribution d'une ligne de tasks à une table hebdomadaire, sign = 1 ou -1
+static QString weeklyContribution(const QString &table, const QString &prefix, int sign,
+                                  const QString &condition = QString())
+{
+    QString assignee = assigneeOf(prefix);
+    QString extra = condition.isEmpty() ? QString() : " AND " + condition;
+    QStringList statements;
+    const QVector<QPair<QString, QString>> measures = {
+        {"created", weekSql(prefix + "created_at", true)},
+        {"completed", weekSql(prefix + "completed_at", true)},
+        {"due", weekSql(prefix + "end_date", false)}
+    };
+    for (const auto &measure : measures) {
+        // WHERE obligatoire avant ON CONFLICT dans un INSERT ... SELECT
+        statements << QString("INSERT INTO %1 (week_start, assignee, %2) "
+                              "SELECT %3, %4, %5 WHERE %3 IS NOT NULL%6 "
+                              "ON CONFLICT (week_start, assignee) DO UPDATE SET %2 = %2 + excluded.%2;")
+                          .arg(table, measure.first, measure.second, assignee).arg(sign).arg(extra);
+    }
+    return statements.join(" ");
+}
+
+// Contribution d'une ligne de tasks aux deux synthèses, sign = 1 ou -1
+static QString contribution(const QString &prefix, int sign)
+{
+    return QString("INSERT INTO report_status (assignee, status, bucket, tasks) "
+                   "VALUES (%1, COALESCE(%2status, ''), %3, %4) "
+                   "ON CONFLICT (assignee, status, bucket) DO UPDATE SET tasks = tasks + excluded.tasks; ")
+               .arg(assigneeOf(prefix), prefix, bucketOf(prefix)).arg(sign)
+           + weeklyContribution("weekly_summary", prefix, sign);
+}
+
+ReportScheduler::ReportScheduler(ChartRenderer *renderer, QObject *parent)
+    : QObject(parent),
+    renderer(renderer)
+{
+    scheduleTimer.setInterval(10 * 60 * 1000);
+    connect(&scheduleTimer, &QTimer::timeout, this, &ReportScheduler::checkSchedule);
+    connect(&collectWatcher, &QFutureWatcher<Snapshot>::finished, this, &ReportScheduler::onCollected);
+    connect(&writeWatcher, &QFutureWatcher<Result>::finished, this, &ReportScheduler::onWritten);
+}
+
+ReportScheduler::~ReportScheduler()
+{
+    collectWatcher.waitForFinished();
+    writeWatcher.waitForFinished();
+}
+
+void ReportScheduler::setDatabase(const QSqlDatabase &database)
+{
+    db = database;
+}
+
+void ReportScheduler::setSource(const QString &databasePath)
+{
+    sourcePath = databasePath;
+}
+
+void ReportScheduler::setDirectory(const QString &directory)
+{
+    reportDir = directory;
+}
+
+void ReportScheduler::setSettings(const Settings &settings)
+{
+    config = settings;
+    config.dpi = qBound(72, config.dpi, 600);
+    config.trendWeeks = qBound(1, config.trendWeeks, 52);
+    if (config.enabled) {
+        scheduleTimer.start();
+        // Rattrapage au démarrage, une fois l'application chargée
+        QTimer::singleShot(60 * 1000, this, &ReportScheduler::checkSchedule);
+    } else {
+        scheduleTimer.stop();
+    }
+}
+
+bool ReportScheduler::initialize(QString *error)
+{
+    QSqlQuery query(db);
+    if (!query.exec("SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name = 'weekly_summary'") ||
+        !query.next()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    bool created = query.value(0).toInt() == 0;
+
+    QStringList changed;
+    for (const QString &column : summary_columns) {
+        changed << QString("OLD.%1 IS NOT NEW.%1").arg(column);
+    }
+
+    QStringList schemaSQL = {
+        "CREATE TABLE IF NOT EXISTS report_status ("
+        "   assignee TEXT NOT NULL,"
+        "   status TEXT NOT NULL,"
+        "   bucket INTEGER NOT NULL,"
+        "   tasks INTEGER NOT NULL DEFAULT 0,"
+        "   PRIMARY KEY (assignee, status, bucket)"
+        ") WITHOUT ROWID",
+        "CREATE TABLE IF NOT EXISTS weekly_summary ("
+        "   week_start TEXT NOT NULL,"
+        "   assignee TEXT NOT NULL,"
+        "   created INTEGER NOT NULL DEFAULT 0,"
+        "   completed INTEGER NOT NULL DEFAULT 0,"
+        "   due INTEGER NOT NULL DEFAULT 0,"
+        "   PRIMARY KEY (week_start, assignee)"
+        ") WITHOUT ROWID",
+        // Part des tâches archivées : hors de tasks, donc hors de rebuild()
+        "CREATE TABLE IF NOT EXISTS weekly_archived ("
+        "   week_start TEXT NOT NULL,"
+        "   assignee TEXT NOT NULL,"
+        "   created INTEGER NOT NULL DEFAULT 0,"
+        "   completed INTEGER NOT NULL DEFAULT 0,"
+        "   due INTEGER NOT NULL DEFAULT 0,"
+        "   PRIMARY KEY (week_start, assignee)"
+        ") WITHOUT ROWID",
+        // Recréés à chaque démarrage, comme ceux de l'historique
+        "DROP TRIGGER IF EXISTS trg_tasks_report_insert",
+        "DROP TRIGGER IF EXISTS trg_tasks_report_update",
+        "DROP TRIGGER IF EXISTS trg_tasks_report_delete",
+        // Archivage et restauration (archived_ids, voir ArchiveStore) : la part de la tâche
+        // passe d'une table hebdomadaire à l'autre, les semaines passées ne bougent pas
+        QString("CREATE TRIGGER trg_tasks_report_insert AFTER INSERT ON tasks "
+                "BEGIN %1 %2 END").arg(contribution("NEW.", 1),
+                                      weeklyContribution("weekly_archived", "NEW.", -1,
+                                                         "EXISTS (SELECT 1 FROM archived_ids WHERE id = NEW.id AND restoring = 1)")),
+        QString("CREATE TRIGGER trg_tasks_report_update AFTER UPDATE ON tasks WHEN %1 "
+                "BEGIN %2 %3 END").arg(changed.join(" OR "), contribution("OLD.", -1), contribution("NEW.", 1)),
+        QString("CREATE TRIGGER trg_tasks_report_delete AFTER DELETE ON tasks "
+                "BEGIN %1 %2 END").arg(contribution("OLD.", -1),
+                                      weeklyContribution("weekly_archived", "OLD.", 1,
+                                                         "EXISTS (SELECT 1 FROM archived_ids WHERE id = OLD.id AND restoring = 0)"))
+    };
+    for (const QString &sql : schemaSQL) {
+        if (!query.exec(sql)) {
+            if (error) *error = query.lastError().text();
+            return false;
+        }
+    }
+
+    // Tâches existant avant les triggers
+    return !created || rebuild(error);
+}
+
+bool ReportScheduler::rebuild(QString *error)
+{
+    if (!db.transaction()) {
+        if (error) *error = db.lastError().text();
+        return false;
+    }
+
+    QString assignee = assigneeOf("");
+    QStringList statements = {
+        "DELETE FROM report_status",
+        "DELETE FROM weekly_summary",
+        QString("INSERT INTO report_status (assignee, status, bucket, tasks) "
+                "SELECT %1, COALESCE(status, ''), %2, COUNT(*) FROM tasks GROUP BY 1, 2, 3").arg(assignee, bucketOf(""))
+    };
+    const QVector<QPair<QString, QString>> measures = {
+        {"created", weekSql("created_at", true)},
+        {"completed", weekSql("completed_at", true)},
+        {"due", weekSql("end_date", false)}
+    };
+    for (const auto &measure : measures) {
+        statements << QString("INSERT INTO weekly_summary (week_start, assignee, %1) "
+                              "SELECT %2, %3, COUNT(*) FROM tasks WHERE %2 IS NOT NULL GROUP BY 1, 2 "
+                              "ON CONFLICT (week_start, assignee) DO UPDATE SET %1 = %1 + excluded.%1")
+                          .arg(measure.first, measure.second, assignee);
+    }
+
+    QSqlQuery query(db);
+    for (const QString &sql : statements) {
+        if (!query.exec(sql)) {
+            if (error) *error = query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    if (!db.commit()) {
+        if (error) *error = db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QString ReportScheduler::bundlePath(const QDate &weekStart) const
+{
+    return QDir(reportDir).filePath("week-" + weekStart.toString("yyyy-MM-dd"));
+}
+
+QVector<ReportScheduler::Bundle> ReportScheduler::bundles() const
+{
+    QVector<Bundle> result;
+    if (reportDir.isEmpty()) return result;
+
+    // Un dossier .part est une génération interrompue
+    const QFileInfoList dirs = QDir(reportDir).entryInfoList({"week-*"}, QDir::Dirs | QDir::NoDotAndDotDot,
+                                                             QDir::Name | QDir::Reversed);
+    for (const QFileInfo &info : dirs) {
+        if (info.fileName().endsWith(".part")) continue;
+        Bundle bundle;
+        bundle.weekStart = QDate::fromString(info.fileName().mid(5), "yyyy-MM-dd");
+        bundle.path = info.absoluteFilePath();
+        bundle.files = QDir(bundle.path).entryList(QDir::Files).size();
+        result << bundle;
+    }
+    return result;
+}
+
+void ReportScheduler::checkSchedule()
+{
+    if (!config.enabled || isRunning()) return;
+
+    // Semaines complètes de la fenêtre de tendance sans dossier, produites une seule fois
+    QDate lastWeek = TimeTracker::weekOf(QDate::currentDate()).addDays(-7);
+    pendingWeeks.clear();
+    for (int i = config.trendWeeks - 1; i >= 0; --i) {
+        QDate week = lastWeek.addDays(-7 * i);
+        if (!QFileInfo::exists(bundlePath(week))) pendingWeeks << week;
+    }
+    generatePending();
+}
+
+void ReportScheduler::generatePending()
+{
+    // Une semaine à la fois : la suivante part quand la précédente est écrite
+    while (!pendingWeeks.isEmpty() && !isRunning()) {
+        if (generate(pendingWeeks.takeFirst())) return;
+    }
+}
+
+bool ReportScheduler::generate(const QDate &date)
+{
+    if (isRunning() || sourcePath.isEmpty() || reportDir.isEmpty() || !date.isValid()) return false;
+    collectWatcher.setFuture(QtConcurrent::run(&ReportScheduler::collect, sourcePath,
+                                               TimeTracker::weekOf(date), config));
+    return true;
+}
+
+ReportScheduler::Snapshot ReportScheduler::collect(const QString &source, const QDate &weekStart, const Settings &settings)
+{
+    static Diagnostics::Latency &latency = Diagnostics::latency("weekly report collect (summary tables)");
+    Diagnostics::Timer timer(latency);
+
+    Snapshot snapshot;
+    snapshot.weekStart = weekStart;
+    QString name = "Reports-" + QUuid::createUuid().toString(QUuid::WithoutBraces);
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", name);
+        database.setDatabaseName(source);
+        database.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if (!database.open()) {
+            snapshot.error = database.lastError().text();
+        } else {
+            // État courant : quelques lignes par personne, quel que soit le nombre de tâches.
+            // Pas d'historique de statut par semaine : les graphiques portent la date de génération.
+            const QString caption = QString("as of %1").arg(QDate::currentDate().toString("yyyy-MM-dd"));
+            const QStringList durationLabels = ChartRenderer::durationSpec(QVector<TaskRecord>()).labels;
+            QMap<QString, QMap<QString, int>> statusByScope;    // "" : toutes les personnes
+            QMap<QString, QVector<int>> durationByScope;
+            QSqlQuery query(database);
+            if (!query.exec("SELECT assignee, status, bucket, tasks FROM report_status WHERE tasks > 0")) {
+                snapshot.error = query.lastError().text();
+            }
+            while (query.next()) {
+                QString assignee = query.value(0).toString();
+                int bucket = query.value(2).toInt();
+                int count = query.value(3).toInt();
+                for (const QString &scope : {QString(), assignee}) {
+                    if (!scope.isEmpty() && !settings.assignees.isEmpty() && !settings.assignees.contains(scope)) continue;
+                    statusByScope[scope][query.value(1).toString()] += count;
+                    QVector<int> &durations = durationByScope[scope];
+                    if (durations.isEmpty()) durations = QVector<int>(durationLabels.size(), 0);
+                    if (bucket >= 0 && bucket < durations.size()) durations[bucket] += count;
+                }
+            }
+            for (auto it = statusByScope.constBegin(); it != statusByScope.constEnd(); ++it) {
+                ChartSpec status;
+                status.kind = ChartSpec::StatusPie;
+                status.scope = it.key();
+                status.caption = caption;
+                status.labels = it.value().keys();
+                status.values = it.value().values();
+                ChartSpec duration;
+                duration.kind = ChartSpec::DurationBar;
+                duration.scope = it.key();
+                duration.caption = caption;
+                duration.labels = durationLabels;
+                duration.values = durationByScope.value(it.key());
+                snapshot.specs << status << duration;
+            }
+
+            // Tendance : une ligne par semaine et par personne
+            // Tâches actives et archivées : l'archivage ne retire rien aux semaines passées
+            query.prepare("SELECT week_start, assignee, SUM(created), SUM(completed), SUM(due) FROM ("
+                          "   SELECT * FROM weekly_summary UNION ALL SELECT * FROM weekly_archived"
+                          ") WHERE week_start BETWEEN :from AND :to "
+                          "GROUP BY week_start, assignee ORDER BY week_start, assignee");
+            query.bindValue(":from", weekStart.addDays(-7 * (settings.trendWeeks - 1)).toString("yyyy-MM-dd"));
+            query.bindValue(":to", weekStart.toString("yyyy-MM-dd"));
+            if (snapshot.error.isEmpty() && !query.exec()) {
+                snapshot.error = query.lastError().text();
+            }
+            while (query.next()) {
+                WeekRow row;
+                row.weekStart = QDate::fromString(query.value(0).toString(), "yyyy-MM-dd");
+                row.assignee = query.value(1).toString();
+                row.created = query.value(2).toInt();
+                row.completed = query.value(3).toInt();
+                row.due = query.value(4).toInt();
+                if (!settings.assignees.isEmpty() && !settings.assignees.contains(row.assignee)) continue;
+                snapshot.weeks << row;
+            }
+
+            // Modifications de la semaine par l'index sur changed_at : coût proportionnel à la semaine
+            query.prepare("SELECT task_id, COUNT(*), datetime(MAX(changed_at), 'localtime') FROM task_history "
+                          "WHERE changed_at >= :from AND changed_at < :to GROUP BY task_id ORDER BY task_id");
+            query.bindValue(":from", QDateTime(weekStart, QTime(0, 0)).toUTC().toString("yyyy-MM-dd HH:mm:ss"));
+            query.bindValue(":to", QDateTime(weekStart.addDays(7), QTime(0, 0)).toUTC().toString("yyyy-MM-dd HH:mm:ss"));
+            if (snapshot.error.isEmpty() && !query.exec()) {
+                snapshot.error = query.lastError().text();
+            }
+            while (query.next()) {
+                snapshot.changes.append({query.value(0).toString(), query.value(1).toInt(), query.value(2).toString()});
+            }
+        }
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+    return snapshot;
+}
+
+void ReportScheduler::onCollected()
+{
+    Snapshot snapshot = collectWatcher.result();
+    if (!snapshot.error.isEmpty()) {
+        pendingWeeks.clear();       // même erreur pour les suivantes, nouvel essai au prochain contrôle
+        emit finished(false, bundlePath(snapshot.weekStart), snapshot.error);
+        return;
+    }
+
+    // Les scènes QtCharts ne sont pas thread-safe : rendu ici, via le cache
+    QVector<QImage> pages;
+    QStringList names;
+    for (const ChartSpec &spec : snapshot.specs) {
+        if (spec.total() == 0) continue;
+        pages << renderer->render(spec, config.dpi);
+        names << spec.fileStem() + ".png";
+    }
+    writeWatcher.setFuture(QtConcurrent::run(&ReportScheduler::write, bundlePath(snapshot.weekStart),
+                                             snapshot, pages, names, config.dpi));
+}
+
+void ReportScheduler::onWritten()
+{
+    Result result = writeWatcher.result();
+    if (!result.ok) pendingWeeks.clear();
+    emit finished(result.ok, result.path, result.error);
+    generatePending();
+}
+
+static QString csvField(const QString &text)
+{
+    if (!text.contains(',') && !text.contains('"') && !text.contains('\n')) return text;
+    return QString("\"%1\"").arg(QString(text).replace("\"", "\"\""));
+}
+
+ReportScheduler::Result ReportScheduler::write(const QString &path, const Snapshot &snapshot,
+                                               const QVector<QImage> &pages, const QStringList &names, int dpi)
+{
+    Result result;
+    result.path = path;
+
+    // Écrit à côté puis renommé : un dossier de semaine est toujours complet
+    QString partial = path + ".part";
+    QDir(partial).removeRecursively();
+    if (!QDir().mkpath(partial)) {
+        result.error = QString("Could not create %1").arg(partial);
+        return result;
+    }
+    QDir dir(partial);
+
+    for (int i = 0; i < pages.size(); ++i) {
+        if (!pages[i].save(dir.filePath(names[i]))) {
+            result.error = QString("Failed to write %1").arg(names[i]);
+            return result;
+        }
+    }
+    if (!pages.isEmpty() && !ChartRenderer::writePdf(pages, dir.filePath("report.pdf"), dpi)) {
+        result.error = "Failed to write report.pdf";
+        return result;
+    }
+
+    QFile summary(dir.filePath("weekly_summary.csv"));
+    QFile changes(dir.filePath("changes.csv"));
+    if (!summary.open(QIODevice::WriteOnly | QIODevice::Text) || !changes.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        result.error = summary.isOpen() ? changes.errorString() : summary.errorString();
+        return result;
+    }
+    QTextStream summaryOut(&summary);
+    summaryOut << "Week,Assignee,Created,Completed,Due\n";
+    for (const WeekRow &row : snapshot.weeks) {
+        summaryOut << row.weekStart.toString("yyyy-MM-dd") << ',' << csvField(row.assignee) << ','
+                   << row.created << ',' << row.completed << ',' << row.due << '\n';
+    }
+    QTextStream changesOut(&changes);
+    changesOut << "Task,Versions,Last Change\n";
+    for (const Change &change : snapshot.changes) {
+        changesOut << csvField(change.taskId) << ',' << change.versions << ',' << change.lastChange << '\n';
+    }
+    summaryOut.flush();
+    changesOut.flush();
+    summary.close();
+    changes.close();
+    if (summary.error() != QFile::NoError || changes.error() != QFile::NoError) {
+        result.error = summary.error() != QFile::NoError ? summary.errorString() : changes.errorString();
+        return result;
+    }
+
+    QDir(path).removeRecursively();
+    if (!QDir().rename(partial, path)) {
+        result.error = QString("Could not move %1 into place").arg(partial);
+        return result;
+    }
+    result.ok = true;
+    return result;
+}
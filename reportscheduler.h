@@ -0,0 +1,120 @@
+#ifndef REPORTSCHEDULER_H
+#define REPORTSCHEDULER_H
+
+#include <QDate>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QObject>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+#include "chartrenderer.h"
+
+// Rapports hebdomadaires planifiés. Deux tables de synthèse sont tenues à
+// jour par des triggers sur tasks : report_status (tâches par personne,
+// statut et tranche de durée) et weekly_summary (créées, terminées et
+// échues par semaine et par personne), weekly_archived gardant la part des
+// tâches archivées depuis. Produire une semaine ne lit que ces
+// agrégats et les versions d'historique de la semaine, jamais toute la
+// table. Lecture sur un thread de travail avec sa propre connexion, rendu
+// des graphiques sur le thread GUI via le cache, écriture en arrière-plan.
+class ReportScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Settings
+    {
+        bool enabled = false;
+        int dpi = 150;
+        int trendWeeks = 8;
+        QStringList assignees;      // vide : une page par personne
+    };
+
+    struct Bundle
+    {
+        QDate weekStart;
+        QString path;
+        int files = 0;
+    };
+
+    explicit ReportScheduler(ChartRenderer *renderer, QObject *parent = nullptr);
+    ~ReportScheduler();
+
+    void setDatabase(const QSqlDatabase &database);
+    // Tables et triggers; les tables sont remplies d'un coup à leur création
+    bool initialize(QString *error);
+    bool rebuild(QString *error);
+
+    void setSource(const QString &databasePath);
+    void setDirectory(const QString &directory);
+    QString directory() const { return reportDir; }
+    void setSettings(const Settings &settings);
+    Settings settings() const { return config; }
+
+    QVector<Bundle> bundles() const;
+    QString bundlePath(const QDate &weekStart) const;
+    bool isRunning() const { return collectWatcher.isRunning() || writeWatcher.isRunning(); }
+    // Semaine commençant le lundi de la date donnée
+    bool generate(const QDate &date);
+
+signals:
+    void finished(bool ok, const QString &path, const QString &error);
+
+private:
+    struct WeekRow
+    {
+        QDate weekStart;
+        QString assignee;
+        int created = 0;
+        int completed = 0;
+        int due = 0;
+    };
+
+    struct Change
+    {
+        QString taskId;
+        int versions = 0;
+        QString lastChange;
+    };
+
+    // Tout ce que lit un rapport, collecté hors du thread GUI
+    struct Snapshot
+    {
+        QDate weekStart;
+        QVector<ChartSpec> specs;
+        QVector<WeekRow> weeks;
+        QVector<Change> changes;
+        QString error;
+    };
+
+    struct Result
+    {
+        bool ok = false;
+        QString path;
+        QString error;
+    };
+
+    ChartRenderer *renderer;
+    QSqlDatabase db;
+    QString sourcePath;
+    QString reportDir;
+    Settings config;
+    QTimer scheduleTimer;
+    QVector<QDate> pendingWeeks;        // rattrapage, la plus ancienne d'abord
+    QFutureWatcher<Snapshot> collectWatcher;
+    QFutureWatcher<Result> writeWatcher;
+
+    void checkSchedule();
+    void generatePending();
+    void onCollected();
+    void onWritten();
+
+    static Snapshot collect(const QString &source, const QDate &weekStart, const Settings &settings);
+    static Result write(const QString &path, const Snapshot &snapshot, const QVector<QImage> &pages,
+                        const QStringList &names, int dpi);
+};
+
+#endif // REPORTSCHEDULER_H
@@ -0,0 +1,151 @@
+#include "reportsdialog.h"
+#include <QApplication>
+#include <QDir>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QSettings>
+#include <QVBoxLayout>
+
+ReportsDialog::ReportsDialog(ReportScheduler *scheduler, QWidget *parent)
+    : QDialog(parent),
+    scheduler(scheduler)
+{
+    setWindowTitle("Weekly Reports");
+    resize(760, 480);
+
+    ReportScheduler::Settings settings = scheduler->settings();
+
+    bundleTable = new QTableWidget(this);
+    bundleTable->setColumnCount(3);
+    bundleTable->setHorizontalHeaderLabels({"Week", "Files", "Folder"});
+    bundleTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    bundleTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    bundleTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    bundleTable->horizontalHeader()->setStretchLastSection(true);
+
+    enabledCheck = new QCheckBox("Generate last week's report every Monday", this);
+    enabledCheck->setChecked(settings.enabled);
+    dpiSpin = new QSpinBox(this);
+    dpiSpin->setRange(72, 600);
+    dpiSpin->setSuffix(" DPI");
+    dpiSpin->setValue(settings.dpi);
+    weeksSpin = new QSpinBox(this);
+    weeksSpin->setRange(1, 52);
+    weeksSpin->setSuffix(" weeks");
+    weeksSpin->setValue(settings.trendWeeks);
+    assigneesEdit = new QLineEdit(settings.assignees.join(", "), this);
+    assigneesEdit->setPlaceholderText("Everyone");
+    assigneesEdit->setToolTip("Comma-separated names; one chart page per person");
+
+    // Semaine précédente par défaut : la semaine en cours n'est pas terminée
+    weekEdit = new QDateEdit(QDate::currentDate().addDays(-7), this);
+    weekEdit->setCalendarPopup(true);
+    weekEdit->setDisplayFormat("yyyy-MM-dd");
+    weekEdit->setToolTip("Any day of the week to report on");
+
+    statusLabel = new QLabel(QString("Folder: %1").arg(QDir::toNativeSeparators(scheduler->directory())), this);
+    statusLabel->setWordWrap(true);
+
+    generateBtn = new QPushButton("Generate Now", this);
+    generateBtn->setEnabled(!scheduler->isRunning());
+    QPushButton *rebuildBtn = new QPushButton("Rebuild Summaries", this);
+    rebuildBtn->setToolTip("Recompute the summary tables from all tasks");
+    QPushButton *closeBtn = new QPushButton("Close", this);
+
+    connect(generateBtn, &QPushButton::clicked, this, &ReportsDialog::generateNow);
+    connect(rebuildBtn, &QPushButton::clicked, this, &ReportsDialog::rebuildSummaries);
+    connect(closeBtn, &QPushButton::clicked, this, &QDialog::accept);
+    connect(enabledCheck, &QCheckBox::toggled, this, &ReportsDialog::saveSettings);
+    connect(dpiSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &ReportsDialog::saveSettings);
+    connect(weeksSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &ReportsDialog::saveSettings);
+    connect(assigneesEdit, &QLineEdit::editingFinished, this, &ReportsDialog::saveSettings);
+
+    connect(scheduler, &ReportScheduler::finished, this, [this](bool ok, const QString &path, const QString &error) {
+        generateBtn->setEnabled(true);
+        statusLabel->setText(ok ? QString("Report written to %1").arg(QDir::toNativeSeparators(path))
+                                : QString("Report failed: %1").arg(error));
+        refreshBundles();
+    });
+
+    QHBoxLayout *settingsLayout = new QHBoxLayout;
+    settingsLayout->addWidget(enabledCheck);
+    settingsLayout->addStretch();
+    settingsLayout->addWidget(new QLabel("Trend:", this));
+    settingsLayout->addWidget(weeksSpin);
+    settingsLayout->addWidget(dpiSpin);
+
+    QHBoxLayout *assigneeLayout = new QHBoxLayout;
+    assigneeLayout->addWidget(new QLabel("People:", this));
+    assigneeLayout->addWidget(assigneesEdit, 1);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    buttonLayout->addWidget(new QLabel("Week of:", this));
+    buttonLayout->addWidget(weekEdit);
+    buttonLayout->addWidget(generateBtn);
+    buttonLayout->addWidget(rebuildBtn);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(closeBtn);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(settingsLayout);
+    mainLayout->addLayout(assigneeLayout);
+    mainLayout->addWidget(bundleTable, 1);
+    mainLayout->addWidget(statusLabel);
+    mainLayout->addLayout(buttonLayout);
+
+    refreshBundles();
+}
+
+void ReportsDialog::refreshBundles()
+{
+    QVector<ReportScheduler::Bundle> bundles = scheduler->bundles();
+    bundleTable->setRowCount(bundles.size());
+    for (int row = 0; row < bundles.size(); ++row) {
+        const ReportScheduler::Bundle &bundle = bundles[row];
+        bundleTable->setItem(row, 0, new QTableWidgetItem(bundle.weekStart.toString("yyyy-MM-dd")));
+        bundleTable->setItem(row, 1, new QTableWidgetItem(QString::number(bundle.files)));
+        bundleTable->setItem(row, 2, new QTableWidgetItem(QDir::toNativeSeparators(bundle.path)));
+    }
+    bundleTable->resizeColumnsToContents();
+}
+
+void ReportsDialog::generateNow()
+{
+    if (scheduler->generate(weekEdit->date())) {
+        generateBtn->setEnabled(false);
+        statusLabel->setText("Generating...");
+    }
+}
+
+void ReportsDialog::rebuildSummaries()
+{
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QString error;
+    bool ok = scheduler->rebuild(&error);
+    QApplication::restoreOverrideCursor();
+
+    if (!ok) {
+        QMessageBox::critical(this, "Weekly Reports", QString("Rebuild failed: %1").arg(error));
+        return;
+    }
+    statusLabel->setText("Summary tables rebuilt from all tasks");
+}
+
+void ReportsDialog::saveSettings()
+{
+    ReportScheduler::Settings settings;
+    settings.enabled = enabledCheck->isChecked();
+    settings.dpi = dpiSpin->value();
+    settings.trendWeeks = weeksSpin->value();
+    for (const QString &name : assigneesEdit->text().split(',', Qt::SkipEmptyParts)) {
+        if (!name.trimmed().isEmpty()) settings.assignees << name.trimmed();
+    }
+    scheduler->setSettings(settings);
+
+    QSettings store("TaskManager", "TaskManager");
+    store.setValue("reports/enabled", settings.enabled);
+    store.setValue("reports/dpi", settings.dpi);
+    store.setValue("reports/trendWeeks", settings.trendWeeks);
+    store.setValue("reports/assignees", settings.assignees);
+}
@@ -0,0 +1,40 @@
+#ifndef REPORTSDIALOG_H
+#define REPORTSDIALOG_H
+
+#include <QCheckBox>
+#include <QDateEdit>
+#include <QDialog>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include "reportscheduler.h"
+
+// Rapports hebdomadaires : réglages, génération immédiate, dossiers produits
+class ReportsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    ReportsDialog(ReportScheduler *scheduler, QWidget *parent = nullptr);
+
+private slots:
+    void refreshBundles();
+    void generateNow();
+    void rebuildSummaries();
+    void saveSettings();
+
+private:
+    ReportScheduler *scheduler;
+    QTableWidget *bundleTable;
+    QCheckBox *enabledCheck;
+    QSpinBox *dpiSpin;
+    QSpinBox *weeksSpin;
+    QLineEdit *assigneesEdit;
+    QDateEdit *weekEdit;
+    QLabel *statusLabel;
+    QPushButton *generateBtn;
+};
+
+#endif // REPORTSDIALOG_H
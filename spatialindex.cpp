@@ -0,0 +1,207 @@
+#include "spatialindex.h"
+#include <QRegularExpression>
+#include <QtMath>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+
+// Nombre d'enfants par nœud
+static const int node_capacity = 16;
+static const double earth_radius_m = 6371000.0;
+
+void SpatialIndex::clear()
+{
+    sites.clear();
+    dirty = true;
+}
+
+void SpatialIndex::insert(const QString &key, const QString &label, const QPointF &point)
+{
+    Entry entry;
+    entry.key = key;
+    entry.label = label;
+    entry.point = point;
+    sites.insert(key, entry);
+    dirty = true;
+}
+
+void SpatialIndex::remove(const QString &key)
+{
+    if (sites.remove(key)) dirty = true;
+}
+
+void SpatialIndex::removeByPrefix(const QString &prefix)
+{
+    for (auto it = sites.begin(); it != sites.end();) {
+        if (it.key().startsWith(prefix)) {
+            it = sites.erase(it);
+            dirty = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void SpatialIndex::rename(const QString &oldKey, const QString &newKey)
+{
+    if (oldKey == newKey || !sites.contains(oldKey)) return;
+    Entry entry = sites.take(oldKey);
+    entry.key = newKey;
+    sites.insert(newKey, entry);
+    dirty = true;
+}
+
+SpatialIndex::Box SpatialIndex::bounds() const
+{
+    rebuild();
+    return root >= 0 ? nodes[root].box : Box();
+}
+
+// Ordre STR : tranches verticales par x, puis tri par y dans chaque tranche,
+// de sorte que chaque paquet de node_capacity éléments soit compact
+template <typename T, typename X, typename Y>
+static void strOrder(QVector<T> &items, X x, Y y)
+{
+    int groups = (items.size() + node_capacity - 1) / node_capacity;
+    int slices = int(std::ceil(std::sqrt(double(groups))));
+    int sliceSize = slices * node_capacity;
+
+    std::sort(items.begin(), items.end(), [&x](const T &a, const T &b) { return x(a) < x(b); });
+    for (int start = 0; start < items.size(); start += sliceSize) {
+        auto end = items.begin() + qMin<qsizetype>(items.size(), start + sliceSize);
+        std::sort(items.begin() + start, end, [&y](const T &a, const T &b) { return y(a) < y(b); });
+    }
+}
+
+void SpatialIndex::rebuild() const
+{
+    if (!dirty) return;
+    dirty = false;
+
+    entries = QVector<Entry>(sites.constBegin(), sites.constEnd());
+    nodes.clear();
+    root = -1;
+    if (entries.isEmpty()) return;
+
+    strOrder(entries,
+             [](const Entry &e) { return e.point.x(); },
+             [](const Entry &e) { return e.point.y(); });
+
+    // Feuilles : des tranches contiguës du tableau d'entrées
+    QVector<Node> level;
+    for (int first = 0; first < entries.size(); first += node_capacity) {
+        Node node;
+        node.first = first;
+        node.count = qMin(node_capacity, int(entries.size()) - first);
+        node.box = {entries[first].point.x(), entries[first].point.y(),
+                    entries[first].point.x(), entries[first].point.y()};
+        for (int i = first + 1; i < first + node.count; ++i) {
+            node.box.minX = qMin(node.box.minX, entries[i].point.x());
+            node.box.minY = qMin(node.box.minY, entries[i].point.y());
+            node.box.maxX = qMax(node.box.maxX, entries[i].point.x());
+            node.box.maxY = qMax(node.box.maxY, entries[i].point.y());
+        }
+        level << node;
+    }
+
+    // Niveaux supérieurs : même découpage sur les centres des boîtes
+    while (level.size() > 1) {
+        strOrder(level,
+                 [](const Node &n) { return (n.box.minX + n.box.maxX) / 2; },
+                 [](const Node &n) { return (n.box.minY + n.box.maxY) / 2; });
+        int start = nodes.size();
+        nodes += level;
+
+        QVector<Node> parents;
+        for (int first = 0; first < level.size(); first += node_capacity) {
+            Node parent;
+            parent.leaf = false;
+            parent.first = start + first;
+            parent.count = qMin(node_capacity, int(level.size()) - first);
+            parent.box = level[first].box;
+            for (int i = first + 1; i < first + parent.count; ++i) {
+                parent.box.minX = qMin(parent.box.minX, level[i].box.minX);
+                parent.box.minY = qMin(parent.box.minY, level[i].box.minY);
+                parent.box.maxX = qMax(parent.box.maxX, level[i].box.maxX);
+                parent.box.maxY = qMax(parent.box.maxY, level[i].box.maxY);
+            }
+            parents << parent;
+        }
+        level = parents;
+    }
+
+    nodes += level;
+    root = nodes.size() - 1;
+}
+
+QVector<SpatialIndex::Entry> SpatialIndex::within(const Box &box) const
+{
+    rebuild();
+
+    QVector<Entry> result;
+    if (root < 0) return result;
+
+    QVector<int> stack = {root};
+    while (!stack.isEmpty()) {
+        const Node &node = nodes.at(stack.takeLast());
+        if (!node.box.intersects(box)) continue;
+
+        for (int i = node.first; i < node.first + node.count; ++i) {
+            if (node.leaf) {
+                if (box.contains(entries.at(i).point)) result << entries.at(i);
+            } else {
+                stack << i;
+            }
+        }
+    }
+    return result;
+}
+
+QVector<SpatialIndex::Entry> SpatialIndex::withinRadius(const QPointF &center, double meters) const
+{
+    // Boîte englobante en degrés, puis distance exacte sur les seuls candidats
+    double dLat = meters / 111320.0;
+    double dLon = meters / (111320.0 * qMax(0.01, std::cos(qDegreesToRadians(center.y()))));
+    Box box = {center.x() - dLon, center.y() - dLat, center.x() + dLon, center.y() + dLat};
+
+    QVector<Entry> result;
+    for (const Entry &entry : within(box)) {
+        if (distanceMeters(center, entry.point) <= meters) result << entry;
+    }
+    std::sort(result.begin(), result.end(), [&center](const Entry &a, const Entry &b) {
+        return distanceMeters(center, a.point) < distanceMeters(center, b.point);
+    });
+    return result;
+}
+
+double SpatialIndex::distanceMeters(const QPointF &a, const QPointF &b)
+{
+    // Haversine
+    double lat1 = qDegreesToRadians(a.y());
+    double lat2 = qDegreesToRadians(b.y());
+    double dLat = lat2 - lat1;
+    double dLon = qDegreesToRadians(b.x() - a.x());
+    double h = std::sin(dLat / 2) * std::sin(dLat / 2) +
+               std::cos(lat1) * std::cos(lat2) * std::sin(dLon / 2) * std::sin(dLon / 2);
+    return 2 * earth_radius_m * std::asin(std::min(1.0, std::sqrt(h)));
+}
+
+bool SpatialIndex::parseCoordinates(const QString &text, QPointF *point)
+{
+    QStringList parts = text.split(QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts);
+    if (parts.size() != 2) return false;
+
+    bool latOk = false;
+    bool lonOk = false;
+    double latitude = parts[0].toDouble(&latOk);
+    double longitude = parts[1].toDouble(&lonOk);
+    if (!latOk || !lonOk || qAbs(latitude) > 85.0511 || qAbs(longitude) > 180.0) return false;
+
+    *point = QPointF(longitude, latitude);
+    return true;
+}
+
+QString SpatialIndex::formatCoordinates(const QPointF &point)
+{
+    return QString("%1, %2").arg(point.y(), 0, 'f', 6).arg(point.x(), 0, 'f', 6);
+}
@@ -0,0 +1,76 @@
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include <QHash>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+// Index spatial des sites (x = longitude, y = latitude) : R-tree compact
+// construit par Sort-Tile-Recursive. Les modifications marquent l'arbre
+// comme périmé, il est reconstruit à la requête suivante; une requête ne
+// visite que les nœuds dont la boîte touche la zone demandée.
+class SpatialIndex
+{
+public:
+    struct Entry
+    {
+        QString key;
+        QString label;
+        QPointF point;
+    };
+
+    struct Box
+    {
+        double minX = 0.0;
+        double minY = 0.0;
+        double maxX = 0.0;
+        double maxY = 0.0;
+
+        bool intersects(const Box &other) const
+        {
+            return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+        }
+        bool contains(const QPointF &p) const
+        {
+            return p.x() >= minX && p.x() <= maxX && p.y() >= minY && p.y() <= maxY;
+        }
+    };
+
+    void clear();
+    void insert(const QString &key, const QString &label, const QPointF &point);
+    void remove(const QString &key);
+    void removeByPrefix(const QString &prefix);
+    void rename(const QString &oldKey, const QString &newKey);
+    bool contains(const QString &key) const { return sites.contains(key); }
+    QPointF point(const QString &key) const { return sites.value(key).point; }
+    int size() const { return sites.size(); }
+    Box bounds() const;
+
+    QVector<Entry> within(const Box &box) const;
+    QVector<Entry> withinRadius(const QPointF &center, double meters) const;
+
+    static double distanceMeters(const QPointF &a, const QPointF &b);
+    // "48.8566, 2.3522" (latitude, longitude)
+    static bool parseCoordinates(const QString &text, QPointF *point);
+    static QString formatCoordinates(const QPointF &point);
+
+private:
+    struct Node
+    {
+        Box box;
+        int first = 0;
+        int count = 0;
+        bool leaf = true;
+    };
+
+    QHash<QString, Entry> sites;
+    mutable QVector<Entry> entries;
+    mutable QVector<Node> nodes;
+    mutable int root = -1;
+    mutable bool dirty = true;
+
+    void rebuild() const;
+};
+
+#endif // SPATIALINDEX_H
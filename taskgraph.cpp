@@ -0,0 +1,356 @@
+#include "taskgraph.h"
+#include <QSet>
+#include <algorithm>
+
+void TaskGraph::clear()
+{
+    nodes.clear();
+    indexOf.clear();
+    freeSlots.clear();
+}
+
+int TaskGraph::nodeFor(const QString &id)
+{
+    auto it = indexOf.constFind(id);
+    if (it != indexOf.constEnd()) return it.value();
+
+    int index;
+    if (!freeSlots.isEmpty()) {
+        index = freeSlots.takeLast();
+        nodes[index] = Node();
+    } else {
+        index = nodes.size();
+        nodes.append(Node());
+    }
+
+    nodes[index].id = id;
+    indexOf.insert(id, index);
+    return index;
+}
+
+void TaskGraph::setDates(Node &node, const QDate &start, const QDate &end)
+{
+    QDate first = start.isValid() ? start : (end.isValid() ? end : QDate::currentDate());
+    QDate last = (end.isValid() && end >= first) ? end : first;
+
+    node.start = int(first.toJulianDay());
+    node.duration = int(first.daysTo(last)) + 1;
+}
+
+void TaskGraph::insertTask(const QString &id, const QDate &start, const QDate &end)
+{
+    setDates(nodes[nodeFor(id)], start, end);
+}
+
+bool TaskGraph::reaches(int from, int to) const
+{
+    QVector<bool> visited(nodes.size(), false);
+    QVector<int> stack = {from};
+
+    while (!stack.isEmpty()) {
+        int v = stack.takeLast();
+        if (v == to) return true;
+        if (visited[v]) continue;
+        visited[v] = true;
+        for (int s : nodes[v].succs) {
+            if (!visited[s]) stack.append(s);
+        }
+    }
+    return false;
+}
+
+bool TaskGraph::insertDependency(const QString &predecessor, const QString &successor, QString *error)
+{
+    QString message;
+    if (predecessor == successor) {
+        message = QString("Task %1 cannot depend on itself").arg(successor);
+    } else if (!contains(predecessor)) {
+        message = QString("Unknown task %1").arg(predecessor);
+    } else if (!contains(successor)) {
+        message = QString("Unknown task %1").arg(successor);
+    } else if (reaches(indexOf.value(successor), indexOf.value(predecessor))) {
+        message = QString("Dependency %1 -> %2 would create a cycle").arg(predecessor, successor);
+    }
+
+    if (!message.isEmpty()) {
+        if (error) *error = message;
+        return false;
+    }
+
+    int p = indexOf.value(predecessor);
+    int s = indexOf.value(successor);
+    if (!nodes[p].succs.contains(s)) {
+        nodes[p].succs.append(s);
+        nodes[s].preds.append(p);
+    }
+    return true;
+}
+
+QVector<int> TaskGraph::descendants(const QVector<int> &seeds) const
+{
+    QVector<bool> visited(nodes.size(), false);
+    QVector<int> result;
+    QVector<int> stack = seeds;
+
+    while (!stack.isEmpty()) {
+        int v = stack.takeLast();
+        if (visited[v] || !nodes[v].alive) continue;
+        visited[v] = true;
+        result.append(v);
+        for (int s : nodes[v].succs) {
+            if (!visited[s]) stack.append(s);
+        }
+    }
+    return result;
+}
+
+QVector<int> TaskGraph::component(int seed, QVector<bool> &visited) const
+{
+    QVector<int> result;
+    QVector<int> stack = {seed};
+
+    while (!stack.isEmpty()) {
+        int v = stack.takeLast();
+        if (visited[v] || !nodes[v].alive) continue;
+        visited[v] = true;
+        result.append(v);
+        for (int p : nodes[v].preds) {
+            if (!visited[p]) stack.append(p);
+        }
+        for (int s : nodes[v].succs) {
+            if (!visited[s]) stack.append(s);
+        }
+    }
+    return result;
+}
+
+QVector<int> TaskGraph::topologicalOrder(const QVector<int> &subset) const
+{
+    QHash<int, int> inDegree;
+    for (int v : subset) inDegree.insert(v, 0);
+    for (int v : subset) {
+        for (int s : nodes[v].succs) {
+            auto it = inDegree.find(s);
+            if (it != inDegree.end()) ++it.value();
+        }
+    }
+
+    QVector<int> order;
+    for (int v : subset) {
+        if (inDegree.value(v) == 0) order.append(v);
+    }
+
+    for (int i = 0; i < order.size(); ++i) {
+        for (int s : nodes[order[i]].succs) {
+            auto it = inDegree.find(s);
+            if (it != inDegree.end() && --it.value() == 0) order.append(s);
+        }
+    }
+    return order;
+}
+
+void TaskGraph::forwardPass(const QVector<int> &order)
+{
+    for (int v : order) {
+        Node &node = nodes[v];
+        node.earlyStart = node.start;
+        for (int p : node.preds) {
+            node.earlyStart = qMax(node.earlyStart, nodes[p].earlyFinish + 1);
+        }
+        node.earlyFinish = node.earlyStart + node.duration - 1;
+    }
+}
+
+void TaskGraph::backwardPass(const QVector<int> &order)
+{
+    int finish = 0;
+    for (int v : order) {
+        finish = qMax(finish, nodes[v].earlyFinish);
+    }
+
+    bool linked = order.size() > 1;
+    for (int i = order.size() - 1; i >= 0; --i) {
+        Node &node = nodes[order[i]];
+        node.lateFinish = finish;
+        for (int s : node.succs) {
+            node.lateFinish = qMin(node.lateFinish, nodes[s].lateStart - 1);
+        }
+        node.lateStart = node.lateFinish - node.duration + 1;
+        node.linked = linked;
+    }
+}
+
+void TaskGraph::recomputeAll()
+{
+    QVector<bool> visited(nodes.size(), false);
+    for (int v = 0; v < nodes.size(); ++v) {
+        if (visited[v] || !nodes[v].alive) continue;
+        QVector<int> order = topologicalOrder(component(v, visited));
+        forwardPass(order);
+        backwardPass(order);
+    }
+}
+
+QStringList TaskGraph::update(const QVector<int> &seeds)
+{
+    // Composantes touchées par la modification (le reste du graphe n'est pas visité)
+    QVector<bool> visited(nodes.size(), false);
+    QVector<QVector<int>> components;
+    for (int seed : seeds) {
+        if (!visited[seed] && nodes[seed].alive) {
+            components.append(component(seed, visited));
+        }
+    }
+
+    struct Snapshot { int earlyStart, earlyFinish, lateStart; bool linked; };
+    QHash<int, Snapshot> before;
+    for (const QVector<int> &comp : components) {
+        for (int v : comp) {
+            before.insert(v, {nodes[v].earlyStart, nodes[v].earlyFinish, nodes[v].lateStart, nodes[v].linked});
+        }
+    }
+
+    forwardPass(topologicalOrder(descendants(seeds)));
+    for (const QVector<int> &comp : components) {
+        backwardPass(topologicalOrder(comp));
+    }
+
+    QStringList changed;
+    for (auto it = before.constBegin(); it != before.constEnd(); ++it) {
+        const Node &node = nodes[it.key()];
+        const Snapshot &old = it.value();
+        if (old.earlyStart != node.earlyStart || old.earlyFinish != node.earlyFinish
+            || old.lateStart != node.lateStart || old.linked != node.linked) {
+            changed << node.id;
+        }
+    }
+    return changed;
+}
+
+QStringList TaskGraph::updateTask(const QString &id, const QDate &start, const QDate &end)
+{
+    bool isNew = !contains(id);
+    int v = nodeFor(id);
+    setDates(nodes[v], start, end);
+
+    QStringList changed = update({v});
+    if (isNew && !changed.contains(id)) changed << id;
+    return changed;
+}
+
+QStringList TaskGraph::removeTask(const QString &id)
+{
+    if (!contains(id)) return QStringList();
+
+    int v = indexOf.take(id);
+    Node &node = nodes[v];
+    QVector<int> neighbours = node.preds + node.succs;
+
+    for (int p : node.preds) nodes[p].succs.removeAll(v);
+    for (int s : node.succs) nodes[s].preds.removeAll(v);
+
+    node.preds.clear();
+    node.succs.clear();
+    node.alive = false;
+    freeSlots.append(v);
+
+    return update(neighbours);
+}
+
+QStringList TaskGraph::renameTask(const QString &oldId, const QString &newId)
+{
+    if (oldId == newId || !contains(oldId) || contains(newId)) return QStringList();
+
+    int v = indexOf.take(oldId);
+    nodes[v].id = newId;
+    indexOf.insert(newId, v);
+    return QStringList() << newId;
+}
+
+QStringList TaskGraph::setPredecessors(const QString &id, const QStringList &predecessors, QString *error)
+{
+    if (!contains(id)) {
+        *error = QString("Unknown task %1").arg(id);
+        return QStringList();
+    }
+
+    int v = indexOf.value(id);
+
+    // Validation complète avant toute modification du graphe
+    for (const QString &pred : predecessors) {
+        if (pred == id) {
+            *error = QString("Task %1 cannot depend on itself").arg(id);
+            return QStringList();
+        }
+        if (!contains(pred)) {
+            *error = QString("Unknown task %1").arg(pred);
+            return QStringList();
+        }
+        if (reaches(v, indexOf.value(pred))) {
+            *error = QString("Dependency %1 -> %2 would create a cycle").arg(pred, id);
+            return QStringList();
+        }
+    }
+    error->clear();
+
+    QVector<int> seeds = {v};
+    for (int p : nodes[v].preds) {
+        nodes[p].succs.removeAll(v);
+        seeds.append(p);
+    }
+    nodes[v].preds.clear();
+
+    for (const QString &pred : predecessors) {
+        int p = indexOf.value(pred);
+        if (!nodes[v].preds.contains(p)) {
+            nodes[v].preds.append(p);
+            nodes[p].succs.append(v);
+            seeds.append(p);
+        }
+    }
+
+    return update(seeds);
+}
+
+QStringList TaskGraph::predecessors(const QString &id) const
+{
+    QStringList result;
+    auto it = indexOf.constFind(id);
+    if (it == indexOf.constEnd()) return result;
+
+    for (int p : nodes[it.value()].preds) {
+        result << nodes[p].id;
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+QStringList TaskGraph::successors(const QString &id) const
+{
+    QStringList result;
+    auto it = indexOf.constFind(id);
+    if (it == indexOf.constEnd()) return result;
+
+    for (int s : nodes[it.value()].succs) {
+        result << nodes[s].id;
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+TaskGraph::Schedule TaskGraph::schedule(const QString &id) const
+{
+    Schedule result;
+    auto it = indexOf.constFind(id);
+    if (it == indexOf.constEnd()) return result;
+
+    const Node &node = nodes[it.value()];
+    result.earlyStart = QDate::fromJulianDay(node.earlyStart);
+    result.earlyFinish = QDate::fromJulianDay(node.earlyFinish);
+    result.lateStart = QDate::fromJulianDay(node.lateStart);
+    result.lateFinish = QDate::fromJulianDay(node.lateFinish);
+    result.slack = node.lateStart - node.earlyStart;
+    result.linked = node.linked;
+    result.critical = node.linked && result.slack <= 0;
+    return result;
+}
@@ -0,0 +1,79 @@
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include <QDate>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Graphe orienté acyclique des dépendances entre tâches (prédécesseur -> successeur)
+// avec ordonnancement au plus tôt / au plus tard (méthode du chemin critique).
+// Une modification ne recalcule que les descendants (passe avant) et la
+// composante connexe concernée (passe arrière).
+class TaskGraph
+{
+public:
+    struct Schedule
+    {
+        QDate earlyStart;
+        QDate earlyFinish;
+        QDate lateStart;
+        QDate lateFinish;
+        int slack = 0;
+        bool critical = false;
+        bool linked = false;    // fait partie d'une chaîne de dépendances
+    };
+
+    void clear();
+
+    // Chargement en bloc, suivi d'un seul recomputeAll()
+    void insertTask(const QString &id, const QDate &start, const QDate &end);
+    bool insertDependency(const QString &predecessor, const QString &successor, QString *error = nullptr);
+    void recomputeAll();
+
+    // Mises à jour incrémentales; renvoient les tâches dont l'ordonnancement a changé
+    QStringList updateTask(const QString &id, const QDate &start, const QDate &end);
+    QStringList removeTask(const QString &id);
+    QStringList renameTask(const QString &oldId, const QString &newId);
+    QStringList setPredecessors(const QString &id, const QStringList &predecessors, QString *error);
+
+    bool contains(const QString &id) const { return indexOf.contains(id); }
+    QStringList predecessors(const QString &id) const;
+    QStringList successors(const QString &id) const;
+    Schedule schedule(const QString &id) const;
+
+private:
+    struct Node
+    {
+        QString id;
+        int start = 0;
+        int duration = 1;
+        QVector<int> preds;
+        QVector<int> succs;
+        int earlyStart = 0;
+        int earlyFinish = 0;
+        int lateStart = 0;
+        int lateFinish = 0;
+        bool linked = false;
+        bool alive = true;
+    };
+
+    QVector<Node> nodes;
+    QHash<QString, int> indexOf;
+    QVector<int> freeSlots;
+
+    int nodeFor(const QString &id);
+    void setDates(Node &node, const QDate &start, const QDate &end);
+    bool reaches(int from, int to) const;
+
+    QVector<int> descendants(const QVector<int> &seeds) const;
+    QVector<int> component(int seed, QVector<bool> &visited) const;
+    QVector<int> topologicalOrder(const QVector<int> &subset) const;
+
+    void forwardPass(const QVector<int> &order);
+    void backwardPass(const QVector<int> &order);
+    QStringList update(const QVector<int> &seeds);
+};
+
+#endif // TASKGRAPH_H
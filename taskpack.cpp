@@ -0,0 +1,590 @@
+#include "taskpack.h"
+#include "attachmentstore.h"
+#include "diagnostics.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QPair>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QVariant>
+
+static const quint32 pack_magic = 0x544d504b;    // "TMPK"
+static const int block_size = 1 << 20;
+static const qint64 footer_size = 12;           // position de l'index (qint64) + magic
+
+static quint32 crc32(const QByteArray &data)
+{
+    static const QVector<quint32> table = []() {
+        QVector<quint32> entries(256);
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[i] = c;
+        }
+        return entries;
+    }();
+
+    quint32 crc = 0xffffffffu;
+    for (char byte : data) {
+        crc = table[(crc ^ quint8(byte)) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffffu;
+}
+
+namespace {
+
+// Sections écrites l'une après l'autre; un bloc ne contient que des lignes entières
+class PackWriter
+{
+public:
+    explicit PackWriter(QIODevice *device)
+        : device(device),
+        stream(device)
+    {
+        stream.setVersion(QDataStream::Qt_6_0);
+        stream << pack_magic << TaskPack::formatVersion;
+    }
+
+    void begin(const QString &name)
+    {
+        current = TaskPack::Section();
+        current.name = name;
+        current.offset = device->pos();
+    }
+
+    void row(const QVariantList &values)
+    {
+        QDataStream out(&pending, QIODevice::WriteOnly | QIODevice::Append);
+        out.setVersion(QDataStream::Qt_6_0);
+        out << values;
+        ++current.rows;
+        if (pending.size() >= block_size) flush();
+    }
+
+    void bytes(const QByteArray &data)
+    {
+        pending += data;
+        if (pending.size() >= block_size) flush();
+    }
+
+    void end()
+    {
+        flush();
+        stream << quint32(0);   // fin de section : un lecteur séquentiel n'a pas besoin de l'index
+        index << current;
+    }
+
+    // Index puis pied de taille fixe : un lecteur commence par la fin du fichier
+    bool finish()
+    {
+        qint64 indexOffset = device->pos();
+        stream << quint32(index.size());
+        for (const TaskPack::Section &section : index) {
+            stream << section.name << section.offset << quint32(section.blocks)
+                   << quint32(section.rows) << section.size;
+        }
+        stream << indexOffset << pack_magic;
+        return stream.status() == QDataStream::Ok;
+    }
+
+private:
+    QIODevice *device;
+    QDataStream stream;
+    QVector<TaskPack::Section> index;
+    TaskPack::Section current;
+    QByteArray pending;
+
+    void flush()
+    {
+        if (pending.isEmpty()) return;
+        QByteArray compressed = qCompress(pending, 6);
+        stream << quint32(pending.size()) << crc32(compressed) << compressed;
+        current.size += pending.size();
+        ++current.blocks;
+        pending.clear();
+    }
+};
+
+}
+
+static bool writeRows(PackWriter &writer, const QString &name, QSqlQuery &query, const QString &sql, QString *error)
+{
+    if (!query.exec(sql)) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    writer.begin(name);
+    int columns = query.record().count();
+    while (query.next()) {
+        QVariantList values;
+        for (int i = 0; i < columns; ++i) {
+            values << query.value(i);
+        }
+        writer.row(values);
+    }
+    writer.end();
+    return true;
+}
+
+bool TaskPack::exportProject(const QSqlDatabase &db, const QString &blobDirectory, int projectId,
+                             const QString &path, QString *error)
+{
+    static Diagnostics::Latency &latency = Diagnostics::latency("task pack export");
+    Diagnostics::Timer timer(latency);
+
+    QSqlQuery query(db);
+    query.prepare("SELECT name FROM projects WHERE id = :id");
+    query.bindValue(":id", projectId);
+    if (!query.exec() || !query.next()) {
+        if (error) *error = query.lastError().isValid() ? query.lastError().text() : "Project not found";
+        return false;
+    }
+    QString projectName = query.value(0).toString();
+
+    QStringList setup = {
+        "CREATE TEMP TABLE IF NOT EXISTS pack_projects (id INTEGER NOT NULL)",
+        "CREATE TEMP TABLE IF NOT EXISTS pack_tasks (id TEXT PRIMARY KEY)",
+        "DELETE FROM temp.pack_projects",
+        "DELETE FROM temp.pack_tasks"
+    };
+    for (const QString &sql : setup) {
+        if (!query.exec(sql)) {
+            if (error) *error = query.lastError().text();
+            return false;
+        }
+    }
+
+    // Parcours en largeur : un projet est toujours écrit avant ses phases
+    query.prepare("WITH RECURSIVE subtree(id) AS ("
+                  "   SELECT :id UNION ALL SELECT p.id FROM projects p JOIN subtree s ON p.parent_id = s.id"
+                  ") INSERT INTO temp.pack_projects (id) SELECT id FROM subtree");
+    query.bindValue(":id", projectId);
+    if (!query.exec() ||
+        !query.exec("INSERT INTO temp.pack_tasks SELECT id FROM tasks "
+                    "WHERE project_id IN (SELECT id FROM temp.pack_projects)")) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+
+    QStringList columns;
+    if (!query.exec("PRAGMA table_info(tasks)")) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        columns << query.value(1).toString();
+    }
+
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly)) {
+        if (error) *error = out.errorString();
+        return false;
+    }
+    PackWriter writer(&out);
+
+    // Colonnes nommées : l'import ne garde que celles que la base d'arrivée connaît
+    QVariantMap meta;
+    meta["project"] = projectName;
+    meta["exportedAt"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    meta["taskColumns"] = columns;
+    writer.begin("meta");
+    writer.row({meta});
+    writer.end();
+
+    const QString inPack = "IN (SELECT id FROM temp.pack_tasks)";
+    const QVector<QPair<QString, QString>> sections = {
+        {"projects", "SELECT p.id, p.parent_id, p.name, p.budget, p.latitude, p.longitude "
+                     "FROM temp.pack_projects t JOIN projects p ON p.id = t.id ORDER BY t.rowid"},
+        {"tasks", QString("SELECT %1 FROM tasks WHERE id %2 ORDER BY id").arg(columns.join(", "), inPack)},
+        // Seuls les liens internes au projet voyagent
+        {"dependencies", QString("SELECT predecessor_id, successor_id FROM task_dependencies "
+                                 "WHERE predecessor_id %1 AND successor_id %1").arg(inPack)},
+        {"history", QString("SELECT task_id, previous_id, op, data, COALESCE(origin_at, changed_at) "
+                            "FROM task_history WHERE task_id %1 ORDER BY seq").arg(inPack)},
+        {"attachments", QString("SELECT a.task_id, a.hash, a.file_name, b.size, a.created_at "
+                                "FROM attachments a JOIN blobs b ON b.hash = a.hash "
+                                "WHERE a.task_id %1 ORDER BY a.id").arg(inPack)}
+    };
+    for (const auto &section : sections) {
+        if (!writeRows(writer, section.first, query, section.second, error)) return false;
+    }
+
+    // Un blob partagé par plusieurs pièces jointes n'est écrit qu'une fois
+    if (!query.exec(QString("SELECT DISTINCT hash FROM attachments WHERE task_id %1").arg(inPack))) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    QStringList hashes;
+    while (query.next()) {
+        hashes << query.value(0).toString();
+    }
+    for (const QString &hash : hashes) {
+        QFile in(AttachmentStore::blobPath(blobDirectory, hash));
+        if (!in.open(QIODevice::ReadOnly)) {
+            if (error) *error = QString("Attachment %1 is missing: %2").arg(hash, in.errorString());
+            return false;
+        }
+        writer.begin("blob/" + hash);
+        while (!in.atEnd()) {
+            QByteArray chunk = in.read(block_size);
+            if (chunk.isEmpty()) break;
+            writer.bytes(chunk);
+        }
+        writer.end();
+        if (in.error() != QFile::NoError) {
+            if (error) *error = in.errorString();
+            return false;
+        }
+    }
+
+    if (!writer.finish() || !out.commit()) {
+        if (error) *error = QString("Failed to write %1: %2").arg(path, out.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool TaskPack::open(const QString &path, QString *error)
+{
+    index.clear();
+    metaData.clear();
+    file.close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != pack_magic) {
+        if (error) *error = "Not a TaskManager project pack";
+        return false;
+    }
+    if (version > formatVersion) {
+        if (error) *error = QString("Pack format %1 needs a newer version of TaskManager").arg(version);
+        return false;
+    }
+
+    qint64 indexOffset = 0;
+    if (!file.seek(file.size() - footer_size)) {
+        if (error) *error = "Project pack is truncated";
+        return false;
+    }
+    in >> indexOffset >> magic;
+    if (in.status() != QDataStream::Ok || magic != pack_magic ||
+        indexOffset <= 0 || indexOffset > file.size() - footer_size || !file.seek(indexOffset)) {
+        if (error) *error = "Project pack is truncated or its index is corrupt";
+        return false;
+    }
+
+    quint32 count = 0;
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        Section section;
+        quint32 blocks = 0;
+        quint32 rows = 0;
+        in >> section.name >> section.offset >> blocks >> rows >> section.size;
+        section.blocks = blocks;
+        section.rows = rows;
+        index << section;
+    }
+    if (in.status() != QDataStream::Ok) {
+        index.clear();
+        if (error) *error = "Project pack index is corrupt";
+        return false;
+    }
+
+    QVariantList first;
+    if (!readRows("meta", [&first](const QVariantList &row) { first = row; return true; }, error)) {
+        return false;
+    }
+    metaData = first.value(0).toMap();
+    return true;
+}
+
+const TaskPack::Section *TaskPack::section(const QString &name) const
+{
+    for (const Section &entry : index) {
+        if (entry.name == name) return &entry;
+    }
+    return nullptr;
+}
+
+bool TaskPack::readBlocks(const QString &name, bool decompress,
+                          const std::function<bool(const QByteArray &)> &block, QString *error)
+{
+    const Section *entry = section(name);
+    if (!entry) {
+        if (error) *error = QString("Project pack has no %1 section").arg(name);
+        return false;
+    }
+    if (!file.seek(entry->offset)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+
+    // Le CRC porte sur les octets compressés : un bloc abîmé est écarté avant qUncompress
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    for (int i = 0; i < entry->blocks; ++i) {
+        quint32 size = 0;
+        quint32 crc = 0;
+        QByteArray compressed;
+        in >> size >> crc >> compressed;
+        if (in.status() != QDataStream::Ok || crc != crc32(compressed)) {
+            if (error) *error = QString("Block %1 of %2 is corrupt").arg(i + 1).arg(name);
+            return false;
+        }
+        if (!decompress) {
+            if (!block(compressed)) return false;
+            continue;
+        }
+        QByteArray data = qUncompress(compressed);
+        if (quint32(data.size()) != size) {
+            if (error) *error = QString("Block %1 of %2 is corrupt").arg(i + 1).arg(name);
+            return false;
+        }
+        if (!block(data)) return false;
+    }
+    return true;
+}
+
+bool TaskPack::readRows(const QString &name, const std::function<bool(const QVariantList &)> &row, QString *error)
+{
+    return readBlocks(name, true, [&name, &row, error](const QByteArray &data) {
+        QDataStream in(data);
+        in.setVersion(QDataStream::Qt_6_0);
+        while (!in.atEnd()) {
+            QVariantList values;
+            in >> values;
+            if (in.status() != QDataStream::Ok) {
+                if (error) *error = QString("Unreadable row in %1").arg(name);
+                return false;
+            }
+            if (!row(values)) return false;
+        }
+        return true;
+    }, error);
+}
+
+bool TaskPack::readBytes(const QString &name, const std::function<bool(const QByteArray &)> &chunk, QString *error)
+{
+    return readBlocks(name, true, chunk, error);
+}
+
+bool TaskPack::verify(QString *error)
+{
+    for (const Section &entry : index) {
+        if (!readBlocks(entry.name, false, [](const QByteArray &) { return true; }, error)) return false;
+    }
+    return true;
+}
+
+bool TaskPack::importBlobs(const QString &blobDirectory, QStringList *created, QString *error)
+{
+    static const QRegularExpression blobPattern("^blob/([0-9a-f]{64})$");
+    for (const Section &entry : index) {
+        QRegularExpressionMatch match = blobPattern.match(entry.name);
+        if (!match.hasMatch()) continue;
+
+        QString hash = match.captured(1);
+        QString target = AttachmentStore::blobPath(blobDirectory, hash);
+        if (QFile::exists(target)) continue;    // contenu déjà présent : dédupliqué comme un import de fichier
+
+        QDir().mkpath(QFileInfo(target).absolutePath());
+        QSaveFile out(target);
+        if (!out.open(QIODevice::WriteOnly)) {
+            if (error) *error = out.errorString();
+            return false;
+        }
+        QCryptographicHash sha(QCryptographicHash::Sha256);
+        QString failure;
+        bool ok = readBytes(entry.name, [&out, &sha](const QByteArray &chunk) {
+            sha.addData(chunk);
+            return out.write(chunk) == chunk.size();
+        }, &failure);
+        if (ok && QString::fromLatin1(sha.result().toHex()) != hash) {
+            failure = QString("Attachment %1 does not match its checksum").arg(hash);
+            ok = false;
+        }
+        if (!ok || !out.commit()) {
+            if (error) *error = failure.isEmpty() ? out.errorString() : failure;
+            return false;
+        }
+        *created << target;
+    }
+    return true;
+}
+
+bool TaskPack::importInto(const QSqlDatabase &db, const QString &blobDirectory, Imported *result, QString *error)
+{
+    static Diagnostics::Latency &latency = Diagnostics::latency("task pack import");
+    Diagnostics::Timer timer(latency);
+    *result = Imported();
+
+    // Blobs d'abord : tant que la transaction n'est pas validée, rien ne les référence
+    QStringList createdBlobs;
+    bool blobsOk = importBlobs(blobDirectory, &createdBlobs, error);
+    auto discardBlobs = [&createdBlobs]() {
+        for (const QString &path : createdBlobs) {
+            QFile::remove(path);
+        }
+    };
+    if (!blobsOk) {
+        discardBlobs();
+        return false;
+    }
+
+    QSqlDatabase database(db);
+    QSqlQuery query(database);
+    QStringList localColumns;
+    if (!query.exec("PRAGMA table_info(tasks)")) {
+        if (error) *error = query.lastError().text();
+        discardBlobs();
+        return false;
+    }
+    while (query.next()) {
+        localColumns << query.value(1).toString();
+    }
+    const QStringList packColumns = metaData.value("taskColumns").toStringList();
+    QVector<int> kept;
+    QStringList names;
+    for (int i = 0; i < packColumns.size(); ++i) {
+        if (!localColumns.contains(packColumns[i])) continue;
+        kept << i;
+        names << packColumns[i];
+    }
+    int idColumn = packColumns.indexOf("id");
+    int projectColumn = packColumns.indexOf("project_id");
+    if (idColumn < 0 || !localColumns.contains("id")) {
+        if (error) *error = "Project pack has no task IDs";
+        discardBlobs();
+        return false;
+    }
+
+    if (!database.transaction()) {
+        if (error) *error = database.lastError().text();
+        discardBlobs();
+        return false;
+    }
+    QString failure;
+    auto fail = [&](const QSqlQuery &failed) {
+        failure = failed.lastError().text();
+        return false;
+    };
+
+    // Nouveaux identifiants de projet; le projet importé arrive à la racine
+    QHash<int, int> projectIds;
+    QSqlQuery projectQuery(database);
+    projectQuery.prepare("INSERT INTO projects (parent_id, name, budget, latitude, longitude) VALUES (?, ?, ?, ?, ?)");
+    bool ok = readRows("projects", [&](const QVariantList &row) {
+        int parentId = projectIds.value(row.value(1).toInt());
+        projectQuery.bindValue(0, parentId ? QVariant(parentId) : QVariant());
+        for (int i = 2; i < 6; ++i) {
+            projectQuery.bindValue(i - 1, row.value(i));
+        }
+        if (!projectQuery.exec()) return fail(projectQuery);
+        int newId = projectQuery.lastInsertId().toInt();
+        projectIds.insert(row.value(0).toInt(), newId);
+        if (result->projectId == 0) result->projectId = newId;
+        return true;
+    }, &failure);
+
+    // Avant les tâches : la version "insertion" écrite par le trigger reste la dernière.
+    // Versions horodatées à l'import pour que le rejeu reste dans l'ordre, date d'origine à part.
+    QSqlQuery existsQuery(database);
+    existsQuery.prepare("SELECT 1 FROM tasks WHERE id = ?");
+    QSqlQuery historyQuery(database);
+    historyQuery.prepare("INSERT INTO task_history (task_id, previous_id, op, data, origin_at) VALUES (?, ?, ?, ?, ?)");
+    if (ok) ok = readRows("history", [&](const QVariantList &row) {
+        // Un ancien identifiant repris ici par une autre tâche ne doit pas l'effacer au rejeu
+        QVariant previousId = row.value(1);
+        if (!previousId.isNull()) {
+            existsQuery.bindValue(0, previousId);
+            if (!existsQuery.exec()) return fail(existsQuery);
+            if (existsQuery.next()) previousId = QVariant();
+        }
+        historyQuery.bindValue(0, row.value(0));
+        historyQuery.bindValue(1, previousId);
+        historyQuery.bindValue(2, row.value(2));
+        historyQuery.bindValue(3, row.value(3));
+        historyQuery.bindValue(4, row.value(4));
+        if (!historyQuery.exec()) return fail(historyQuery);
+        ++result->versions;
+        return true;
+    }, &failure);
+
+    QSqlQuery taskQuery(database);
+    taskQuery.prepare(QString("INSERT INTO tasks (%1) VALUES (%2)")
+                          .arg(names.join(", "), QStringList(names.size(), "?").join(", ")));
+    if (ok) ok = readRows("tasks", [&](const QVariantList &row) {
+        QString taskId = row.value(idColumn).toString();
+        existsQuery.bindValue(0, taskId);
+        if (!existsQuery.exec()) return fail(existsQuery);
+        if (existsQuery.next()) {
+            failure = QString("Task %1 already exists in this database").arg(taskId);
+            return false;
+        }
+        for (int i = 0; i < kept.size(); ++i) {
+            QVariant value = row.value(kept[i]);
+            if (kept[i] == projectColumn) {
+                int projectId = projectIds.value(value.toInt());
+                value = projectId ? QVariant(projectId) : QVariant();
+            }
+            taskQuery.bindValue(i, value);
+        }
+        if (!taskQuery.exec()) return fail(taskQuery);
+        result->taskIds << taskId;
+        return true;
+    }, &failure);
+
+    QSqlQuery dependencyQuery(database);
+    dependencyQuery.prepare("INSERT OR IGNORE INTO task_dependencies (predecessor_id, successor_id) VALUES (?, ?)");
+    if (ok) ok = readRows("dependencies", [&](const QVariantList &row) {
+        dependencyQuery.bindValue(0, row.value(0));
+        dependencyQuery.bindValue(1, row.value(1));
+        return dependencyQuery.exec() || fail(dependencyQuery);
+    }, &failure);
+
+    QSqlQuery blobQuery(database);
+    blobQuery.prepare("INSERT OR IGNORE INTO blobs (hash, size) VALUES (?, ?)");
+    QSqlQuery attachmentQuery(database);
+    attachmentQuery.prepare("INSERT INTO attachments (task_id, hash, file_name, created_at) VALUES (?, ?, ?, ?)");
+    if (ok) ok = readRows("attachments", [&](const QVariantList &row) {
+        blobQuery.bindValue(0, row.value(1));
+        blobQuery.bindValue(1, row.value(3));
+        if (!blobQuery.exec()) return fail(blobQuery);
+        attachmentQuery.bindValue(0, row.value(0));
+        attachmentQuery.bindValue(1, row.value(1));
+        attachmentQuery.bindValue(2, row.value(2));
+        attachmentQuery.bindValue(3, row.value(4));
+        if (!attachmentQuery.exec()) return fail(attachmentQuery);
+        ++result->attachments;
+        return true;
+    }, &failure);
+
+    if (ok && !database.commit()) {
+        failure = database.lastError().text();
+        ok = false;
+    }
+    if (!ok) {
+        if (error) *error = failure;
+        database.rollback();
+        discardBlobs();
+        *result = Imported();
+    }
+    return ok;
+}
@@ -0,0 +1,69 @@
+#ifndef TASKPACK_H
+#define TASKPACK_H
+
+#include <QFile>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QVariantMap>
+#include <QVector>
+#include <functional>
+
+// Archive de passation d'un projet (.taskpack) : le projet et ses phases,
+// leurs tâches, les dépendances entre elles, leur historique et leurs pièces
+// jointes dans un seul fichier versionné. Chaque section est une suite de
+// blocs compressés indépendants portant leur CRC-32; un index en fin de
+// fichier donne la position de chaque section, un lecteur va donc droit à
+// celle qui l'intéresse. Écriture et import se font bloc par bloc, sans
+// charger le fichier ni passer par une base intermédiaire.
+class TaskPack
+{
+public:
+    struct Section
+    {
+        QString name;       // "tasks", "history"... ou "blob/<sha256>"
+        qint64 offset = 0;
+        int blocks = 0;
+        int rows = 0;       // 0 pour un blob
+        qint64 size = 0;    // octets avant compression
+    };
+
+    struct Imported
+    {
+        int projectId = 0;
+        QStringList taskIds;
+        int versions = 0;
+        int attachments = 0;
+    };
+
+    static const quint32 formatVersion = 1;
+
+    static bool exportProject(const QSqlDatabase &db, const QString &blobDirectory, int projectId,
+                              const QString &path, QString *error);
+
+    // Lit l'en-tête et l'index; les sections sont lues à la demande
+    bool open(const QString &path, QString *error);
+    QVariantMap meta() const { return metaData; }
+    QVector<Section> sections() const { return index; }
+
+    bool readRows(const QString &name, const std::function<bool(const QVariantList &)> &row, QString *error);
+    bool readBytes(const QString &name, const std::function<bool(const QByteArray &)> &chunk, QString *error);
+    // Contrôle le CRC de chaque bloc sans rien décompresser
+    bool verify(QString *error);
+
+    // Une transaction : le projet arrive à la racine, refusé si une tâche existe déjà
+    bool importInto(const QSqlDatabase &db, const QString &blobDirectory, Imported *result, QString *error);
+
+private:
+    QFile file;
+    QVector<Section> index;
+    QVariantMap metaData;
+
+    const Section *section(const QString &name) const;
+    bool readBlocks(const QString &name, bool decompress,
+                    const std::function<bool(const QByteArray &)> &block, QString *error);
+    bool importBlobs(const QString &blobDirectory, QStringList *created, QString *error);
+};
+
+#endif // TASKPACK_H
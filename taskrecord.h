@@ -0,0 +1,50 @@
+#ifndef TASKRECORD_H
+#define TASKRECORD_H
+
+#include <QDate>
+#include <QString>
+#include <QStringList>
+
+// Vue en mémoire d'une ligne de la table des tâches (sans la description)
+struct TaskRecord
+{
+    QString id;
+    QString name;
+    QString status;
+    QString priority;
+    QDate startDate;
+    QDate endDate;
+    QString assignedTo;
+
+    // Construit l'enregistrement à partir des 8 champs du formulaire
+    static TaskRecord fromTaskData(const QStringList &taskData)
+    {
+        TaskRecord task;
+        task.id = taskData[0];
+        task.name = taskData[1];
+        task.status = taskData[3];
+        task.priority = taskData[4];
+        task.startDate = QDate::fromString(taskData[5], "yyyy-MM-dd");
+        task.endDate = QDate::fromString(taskData[6], "yyyy-MM-dd");
+        task.assignedTo = taskData[7];
+        return task;
+    }
+
+    static QStringList statuses()
+    {
+        return {"Not Started", "In Progress", "Completed", "On Hold"};
+    }
+
+    static QStringList priorities()
+    {
+        return {"Low", "Medium", "High", "Critical"};
+    }
+
+    // -1 si la priorité est inconnue
+    static int priorityRank(const QString &priority)
+    {
+        return priorities().indexOf(priority);
+    }
+};
+
+#endif // TASKRECORD_H
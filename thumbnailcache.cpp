@@ -0,0 +1,139 @@
+#include "thumbnailcache.h"
+#include "diagnostics.h"
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QThread>
+#include <QtConcurrent>
+
+// Au-delà, les demandes les plus anciennes (éléments sortis de l'écran) sont oubliées
+static const int max_queued_requests = 256;
+
+ThumbnailCache::ThumbnailCache(QObject *parent)
+    : QObject(parent),
+    memory(32 * 1024),
+    running(0)
+{
+    // Un cœur reste libre pour le thread graphique
+    pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+    queue.clear();
+    pool.waitForDone();
+}
+
+void ThumbnailCache::setDirectory(const QString &dir)
+{
+    directory = dir;
+}
+
+QString ThumbnailCache::cachePath(const QString &key) const
+{
+    return QDir(directory).filePath(key + ".jpg");
+}
+
+QImage ThumbnailCache::thumbnail(const QString &hash, const QString &sourcePath, int size)
+{
+    QString key = QString("%1_%2").arg(hash).arg(size);
+    static Diagnostics::Cache &diagnostics = Diagnostics::cache("thumbnails (memory)");
+    if (QImage *image = memory.object(key)) {
+        diagnostics.hit();
+        return *image;
+    }
+    diagnostics.miss();
+    if (failed.contains(key) || pending.contains(key)) {
+        return QImage();
+    }
+
+    Request request;
+    request.key = key;
+    request.hash = hash;
+    request.sourcePath = sourcePath;
+    request.size = size;
+    queue << request;
+    pending.insert(key);
+
+    if (queue.size() > max_queued_requests) {
+        pending.remove(queue.takeFirst().key);
+    }
+    startNext();
+    return QImage();
+}
+
+void ThumbnailCache::cancelPending()
+{
+    for (const Request &request : queue) {
+        pending.remove(request.key);
+    }
+    queue.clear();
+}
+
+void ThumbnailCache::startNext()
+{
+    while (running < pool.maxThreadCount() && !queue.isEmpty()) {
+        Request request = queue.takeLast();
+        ++running;
+
+        QFutureWatcher<QImage> *watcher = new QFutureWatcher<QImage>(this);
+        connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, request]() {
+            QImage image = watcher->result();
+            watcher->deleteLater();
+            --running;
+            pending.remove(request.key);
+
+            if (image.isNull()) {
+                failed.insert(request.key);
+            } else {
+                memory.insert(request.key, new QImage(image), qMax<qsizetype>(1, image.sizeInBytes() / 1024));
+                emit thumbnailReady(request.hash);
+            }
+            startNext();
+        });
+        watcher->setFuture(QtConcurrent::run(&pool, &ThumbnailCache::load,
+                                             request.sourcePath, cachePath(request.key), request.size));
+    }
+}
+
+QImage ThumbnailCache::load(const QString &sourcePath, const QString &cachePath, int size)
+{
+    // Vignette déjà sur disque : quelques Ko à décoder
+    if (QFile::exists(cachePath)) {
+        QImage image(cachePath);
+        if (!image.isNull()) return image;
+    }
+
+    QFile file(sourcePath);
+    if (!file.open(QIODevice::ReadOnly)) return QImage();
+
+    // Lecture dans les pages projetées du blob, sans copie du fichier en mémoire
+    uchar *data = file.map(0, file.size());
+    QByteArray bytes = data ? QByteArray::fromRawData(reinterpret_cast<const char *>(data), file.size())
+                            : file.readAll();
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::ReadOnly);
+
+    QImageReader reader(&buffer);
+    reader.setAutoTransform(true);
+    QSize original = reader.size();
+    if (original.isValid() && (original.width() > size || original.height() > size)) {
+        // Réduction faite par le décodeur : un JPEG n'est jamais décodé en pleine taille
+        reader.setScaledSize(original.scaled(size, size, Qt::KeepAspectRatio));
+    }
+    QImage image = reader.read();
+    if (image.isNull()) return image;
+
+    if (image.width() > size || image.height() > size) {
+        image = image.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    QSaveFile out(cachePath);
+    if (out.open(QIODevice::WriteOnly) && image.save(&out, image.hasAlphaChannel() ? "PNG" : "JPG", 85)) {
+        out.commit();
+    }
+    return image;
+}
@@ -0,0 +1,57 @@
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QCache>
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+#include <QVector>
+
+// Vignettes des pièces jointes sur deux niveaux : LRU en mémoire, puis
+// fichiers sur disque. Un manque ne bloque jamais l'appelant : la vignette
+// est décodée (et réduite dès le décodage) dans un pool dédié, puis
+// thumbnailReady() est émis. Les dernières demandes passent en premier,
+// ce sont celles des éléments visibles.
+class ThumbnailCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ThumbnailCache(QObject *parent = nullptr);
+    ~ThumbnailCache();
+
+    void setDirectory(const QString &directory);
+
+    // Image nulle tant que la vignette n'est pas prête
+    QImage thumbnail(const QString &hash, const QString &sourcePath, int size);
+    void cancelPending();
+
+    // Sans état : exécuté dans le pool
+    static QImage load(const QString &sourcePath, const QString &cachePath, int size);
+
+signals:
+    void thumbnailReady(const QString &hash);
+
+private:
+    struct Request
+    {
+        QString key;
+        QString hash;
+        QString sourcePath;
+        int size = 0;
+    };
+
+    QString directory;
+    QCache<QString, QImage> memory;     // coût en Ko
+    QThreadPool pool;
+    QVector<Request> queue;             // pile : la dernière demande part en premier
+    QSet<QString> pending;              // en file ou en cours
+    QSet<QString> failed;               // pas une image : inutile de réessayer
+    int running;
+
+    QString cachePath(const QString &key) const;
+    void startNext();
+};
+
+#endif // THUMBNAILCACHE_H
@@ -0,0 +1,166 @@
+#include "tilecache.h"
+#include "diagnostics.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSaveFile>
+#include <QUrl>
+#include <QtMath>
+#include <cmath>
+
+// Politesse envers le serveur de tuiles
+static const int max_parallel_downloads = 4;
+// Garde-fou : une zone large au zoom maximal représenterait des millions de tuiles
+static const int max_seed_tiles = 20000;
+
+TileCache::TileCache(QNetworkAccessManager *network, QObject *parent)
+    : QObject(parent),
+    network(network),
+    memory(256),
+    inFlight(0)
+{
+}
+
+void TileCache::setDirectory(const QString &dir)
+{
+    directory = dir;
+}
+
+void TileCache::setUrlTemplate(const QString &urlTemplate)
+{
+    tileUrl = urlTemplate.trimmed();
+    unavailable.clear();
+}
+
+QPointF TileCache::project(const QPointF &lonLat, int zoom)
+{
+    double scale = TileSize * double(1 << zoom);
+    double latitude = qDegreesToRadians(qBound(-85.0511, lonLat.y(), 85.0511));
+    double x = (lonLat.x() + 180.0) / 360.0 * scale;
+    double y = (1.0 - std::log(std::tan(latitude) + 1.0 / std::cos(latitude)) / M_PI) / 2.0 * scale;
+    return QPointF(x, y);
+}
+
+QPointF TileCache::unproject(const QPointF &pixel, int zoom)
+{
+    double scale = TileSize * double(1 << zoom);
+    double longitude = pixel.x() / scale * 360.0 - 180.0;
+    double n = M_PI - 2.0 * M_PI * pixel.y() / scale;
+    double latitude = qRadiansToDegrees(std::atan(std::sinh(n)));
+    return QPointF(longitude, latitude);
+}
+
+QString TileCache::tileKey(int z, int x, int y)
+{
+    return QString("%1/%2/%3").arg(z).arg(x).arg(y);
+}
+
+QString TileCache::tilePath(const QString &key) const
+{
+    return QDir(directory).filePath(key + ".png");
+}
+
+QPixmap TileCache::tile(int z, int x, int y)
+{
+    QString key = tileKey(z, x, y);
+    static Diagnostics::Cache &diagnostics = Diagnostics::cache("map tiles (memory)");
+    if (QPixmap *pixmap = memory.object(key)) {
+        diagnostics.hit();
+        return *pixmap;
+    }
+    diagnostics.miss();
+    if (unavailable.contains(key)) {
+        return QPixmap();
+    }
+
+    // Une tuile sur disque pèse quelques dizaines de Ko : lecture directe
+    QString path = tilePath(key);
+    if (QFile::exists(path)) {
+        QPixmap pixmap;
+        if (pixmap.load(path)) {
+            memory.insert(key, new QPixmap(pixmap));
+            return pixmap;
+        }
+    }
+
+    // Hors ligne : la tuile manquante n'est plus recherchée sur disque à chaque rendu
+    if (tileUrl.isEmpty()) {
+        unavailable.insert(key);
+    } else if (enqueue(key)) {
+        fetchNext();
+    }
+    return QPixmap();
+}
+
+int TileCache::seed(double west, double north, double east, double south, int fromZoom, int toZoom)
+{
+    int queued = 0;
+    for (int z = qMax(0, fromZoom); z <= qMin(MaxZoom, toZoom); ++z) {
+        QPointF topLeft = project(QPointF(west, north), z);
+        QPointF bottomRight = project(QPointF(east, south), z);
+        int last = (1 << z) - 1;
+        int x0 = qBound(0, int(topLeft.x() / TileSize), last);
+        int y0 = qBound(0, int(topLeft.y() / TileSize), last);
+        int x1 = qBound(0, int(bottomRight.x() / TileSize), last);
+        int y1 = qBound(0, int(bottomRight.y() / TileSize), last);
+
+        for (int x = x0; x <= x1 && queued < max_seed_tiles; ++x) {
+            for (int y = y0; y <= y1 && queued < max_seed_tiles; ++y) {
+                QString key = tileKey(z, x, y);
+                if (!QFile::exists(tilePath(key)) && enqueue(key)) queued++;
+            }
+        }
+    }
+    fetchNext();
+    return queued;
+}
+
+bool TileCache::enqueue(const QString &key)
+{
+    if (tileUrl.isEmpty() || requested.contains(key) || unavailable.contains(key)) return false;
+    requested.insert(key);
+    queue << key;
+    return true;
+}
+
+void TileCache::fetchNext()
+{
+    while (inFlight < max_parallel_downloads && !queue.isEmpty()) {
+        QString key = queue.takeLast();
+        QStringList zxy = key.split('/');
+
+        QString url = tileUrl;
+        url.replace("{z}", zxy[0]).replace("{x}", zxy[1]).replace("{y}", zxy[2]);
+        QNetworkRequest request{QUrl(url)};
+        request.setHeader(QNetworkRequest::UserAgentHeader, "TaskManager");
+
+        ++inFlight;
+        QNetworkReply *reply = network->get(request);
+        connect(reply, &QNetworkReply::finished, this, [this, reply, key, zxy]() {
+            reply->deleteLater();
+            --inFlight;
+            requested.remove(key);
+
+            QByteArray data = reply->readAll();
+            QPixmap pixmap;
+            if (reply->error() != QNetworkReply::NoError || !pixmap.loadFromData(data)) {
+                unavailable.insert(key);
+            } else {
+                // Écrite d'un bloc : une tuile tronquée ne peut pas rester dans le cache
+                QString path = tilePath(key);
+                QDir().mkpath(QFileInfo(path).absolutePath());
+                QSaveFile file(path);
+                if (file.open(QIODevice::WriteOnly) && file.write(data) == data.size()) {
+                    file.commit();
+                }
+                memory.insert(key, new QPixmap(pixmap));
+                emit tileReady(zxy[0].toInt(), zxy[1].toInt(), zxy[2].toInt());
+            }
+            emit queueChanged(pendingCount());
+            fetchNext();
+        });
+    }
+    emit queueChanged(pendingCount());
+}
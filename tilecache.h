@@ -0,0 +1,60 @@
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include <QCache>
+#include <QNetworkAccessManager>
+#include <QObject>
+#include <QPixmap>
+#include <QPointF>
+#include <QSet>
+#include <QStringList>
+
+// Tuiles de carte (z/x/y, 256 px) servies depuis un répertoire local.
+// Une tuile absente n'est téléchargée que si un serveur est configuré
+// (variable TASKMANAGER_TILE_URL ou réglage « Tile Server »), puis gardée
+// sur disque : la carte reste utilisable hors ligne une fois la zone chargée.
+class TileCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int TileSize = 256;
+    static const int MaxZoom = 19;
+
+    // Web Mercator : (longitude, latitude) <-> pixels du monde au niveau de zoom
+    static QPointF project(const QPointF &lonLat, int zoom);
+    static QPointF unproject(const QPointF &pixel, int zoom);
+
+    TileCache(QNetworkAccessManager *network, QObject *parent = nullptr);
+
+    void setDirectory(const QString &directory);
+    void setUrlTemplate(const QString &urlTemplate);
+    QString urlTemplate() const { return tileUrl; }
+
+    // Pixmap nulle tant que la tuile n'est pas disponible; tileReady() suivra
+    QPixmap tile(int z, int x, int y);
+    // Met en file les tuiles manquantes de la zone pour les niveaux donnés
+    int seed(double west, double north, double east, double south, int fromZoom, int toZoom);
+    int pendingCount() const { return queue.size() + inFlight; }
+
+signals:
+    void tileReady(int z, int x, int y);
+    void queueChanged(int pending);
+
+private:
+    QNetworkAccessManager *network;
+    QString directory;
+    QString tileUrl;
+    QCache<QString, QPixmap> memory;
+    QStringList queue;          // pile : les tuiles demandées en dernier sont les plus visibles
+    QSet<QString> requested;
+    QSet<QString> unavailable;
+    int inFlight;
+
+    static QString tileKey(int z, int x, int y);
+    QString tilePath(const QString &key) const;
+    bool enqueue(const QString &key);
+    void fetchNext();
+};
+
+#endif // TILECACHE_H
@@ -0,0 +1,327 @@
+#include "timetracker.h"
+#include "diagnostics.h"
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariant>
+#include <QDebug>
+#include <algorithm>
+
+static const QChar key_separator(0x1f);
+
+TimeTracker::TimeTracker(QObject *parent)
+    : QObject(parent)
+{
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(FlushIntervalMs);
+    connect(&flushTimer, &QTimer::timeout, this, [this]() {
+        QString error;
+        if (!flush(&error)) {
+            qWarning() << "Failed to write time entries:" << error;
+            flushTimer.start();    // nouvel essai, les événements restent en mémoire
+        }
+    });
+}
+
+TimeTracker::~TimeTracker()
+{
+    if (!pending.isEmpty()) flush();
+}
+
+void TimeTracker::setDatabase(const QSqlDatabase &database)
+{
+    db = database;
+}
+
+bool TimeTracker::initialize(QString *error)
+{
+    QStringList schemaSQL = {
+        // Journal en ajout seul : aucun index secondaire, l'insertion reste en fin d'arbre
+        "CREATE TABLE IF NOT EXISTS time_events ("
+        "   id INTEGER PRIMARY KEY,"
+        "   kind TEXT NOT NULL CHECK (kind IN ('start', 'stop', 'entry')),"
+        "   task_id TEXT NOT NULL,"
+        "   person TEXT NOT NULL,"
+        "   at INTEGER NOT NULL,"
+        "   seconds INTEGER NOT NULL DEFAULT 0,"
+        "   source TEXT"
+        ")",
+        "CREATE TABLE IF NOT EXISTS time_rollups ("
+        "   task_id TEXT NOT NULL,"
+        "   person TEXT NOT NULL,"
+        "   week_start TEXT NOT NULL,"
+        "   seconds INTEGER NOT NULL DEFAULT 0,"
+        "   entries INTEGER NOT NULL DEFAULT 0,"
+        "   PRIMARY KEY (task_id, person, week_start)"
+        ") WITHOUT ROWID",
+        "CREATE INDEX IF NOT EXISTS idx_time_rollups_week ON time_rollups(week_start)",
+        "CREATE TABLE IF NOT EXISTS time_clocks ("
+        "   task_id TEXT NOT NULL,"
+        "   person TEXT NOT NULL,"
+        "   started_at INTEGER NOT NULL,"
+        "   PRIMARY KEY (task_id, person)"
+        ") WITHOUT ROWID"
+    };
+
+    QSqlQuery query(db);
+    for (const QString &sql : schemaSQL) {
+        if (!query.exec(sql)) {
+            if (error) *error = query.lastError().text();
+            return false;
+        }
+    }
+
+    // Les chronos en cours survivent à un redémarrage
+    clocks.clear();
+    if (!query.exec("SELECT task_id, person, started_at FROM time_clocks")) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        Clock clock;
+        clock.taskId = query.value(0).toString();
+        clock.person = query.value(1).toString();
+        clock.started = QDateTime::fromSecsSinceEpoch(query.value(2).toLongLong());
+        clocks.insert(clockKey(clock.taskId, clock.person), clock);
+    }
+    return true;
+}
+
+QString TimeTracker::clockKey(const QString &taskId, const QString &person)
+{
+    return taskId + key_separator + person;
+}
+
+bool TimeTracker::isRunning(const QString &taskId, const QString &person) const
+{
+    return clocks.contains(clockKey(taskId, person));
+}
+
+QVector<TimeTracker::Clock> TimeTracker::runningClocks() const
+{
+    QVector<Clock> result(clocks.cbegin(), clocks.cend());
+    std::sort(result.begin(), result.end(), [](const Clock &a, const Clock &b) {
+        return a.started < b.started;
+    });
+    return result;
+}
+
+bool TimeTracker::toggle(const QString &taskId, const QString &person, const QString &source, const QDateTime &at)
+{
+    QString key = clockKey(taskId, person);
+    Event event;
+    event.taskId = taskId;
+    event.person = person;
+    event.at = at.toSecsSinceEpoch();
+    event.source = source;
+
+    if (clocks.contains(key)) {
+        Clock clock = clocks.take(key);
+        event.kind = "stop";
+        event.seconds = qMax<qint64>(0, clock.started.secsTo(at));
+        addInterval(taskId, person, clock.started, event.seconds);
+        pendingClocks.insert(key, 0);
+    } else {
+        clocks.insert(key, Clock{taskId, person, at});
+        event.kind = "start";
+        pendingClocks.insert(key, event.at);
+    }
+    record(event);
+
+    bool running = clocks.contains(key);
+    emit clockChanged(taskId, person, running);
+    return running;
+}
+
+void TimeTracker::addEntry(const QString &taskId, const QString &person, const QDateTime &start, qint64 seconds,
+                           const QString &source)
+{
+    if (seconds <= 0) return;
+
+    Event event;
+    event.kind = "entry";
+    event.taskId = taskId;
+    event.person = person;
+    event.at = start.toSecsSinceEpoch();
+    event.seconds = seconds;
+    event.source = source;
+    addInterval(taskId, person, start, seconds);
+    record(event);
+}
+
+void TimeTracker::stopTask(const QString &taskId, const QString &source)
+{
+    for (const Clock &clock : runningClocks()) {
+        if (clock.taskId == taskId) toggle(clock.taskId, clock.person, source);
+    }
+}
+
+void TimeTracker::addInterval(const QString &taskId, const QString &person, const QDateTime &start, qint64 seconds)
+{
+    // Une période à cheval sur deux semaines est répartie entre elles
+    QDateTime from = start;
+    QDateTime end = start.addSecs(seconds);
+    while (from < end) {
+        QDate week = weekOf(from.date());
+        QDateTime boundary(week.addDays(7), QTime(0, 0));
+        QDateTime until = qMin(end, boundary);
+
+        Delta &delta = pendingRollups[taskId + key_separator + person + key_separator + week.toString("yyyy-MM-dd")];
+        delta.seconds += from.secsTo(until);
+        delta.entries += 1;
+        from = until;
+    }
+}
+
+void TimeTracker::record(const Event &event)
+{
+    pending << event;
+    if (pending.size() >= BatchSize) {
+        QString error;
+        if (!flush(&error)) qWarning() << "Failed to write time entries:" << error;
+    } else if (!flushTimer.isActive()) {
+        flushTimer.start();
+    }
+}
+
+bool TimeTracker::flush(QString *error)
+{
+    flushTimer.stop();
+    if (pending.isEmpty()) return true;
+
+    QVariantList kinds, taskIds, persons, times, seconds, sources;
+    for (const Event &event : pending) {
+        kinds << event.kind;
+        taskIds << event.taskId;
+        persons << event.person;
+        times << event.at;
+        seconds << event.seconds;
+        sources << event.source;
+    }
+
+    QVariantList rollupTasks, rollupPersons, rollupWeeks, rollupSeconds, rollupEntries;
+    for (auto it = pendingRollups.constBegin(); it != pendingRollups.constEnd(); ++it) {
+        QStringList parts = it.key().split(key_separator);
+        rollupTasks << parts[0];
+        rollupPersons << parts[1];
+        rollupWeeks << parts[2];
+        rollupSeconds << it.value().seconds;
+        rollupEntries << it.value().entries;
+    }
+
+    QVariantList startedTasks, startedPersons, startedTimes, stoppedTasks, stoppedPersons;
+    for (auto it = pendingClocks.constBegin(); it != pendingClocks.constEnd(); ++it) {
+        QStringList parts = it.key().split(key_separator);
+        if (it.value()) {
+            startedTasks << parts[0];
+            startedPersons << parts[1];
+            startedTimes << it.value();
+        } else {
+            stoppedTasks << parts[0];
+            stoppedPersons << parts[1];
+        }
+    }
+
+    auto batch = [](QSqlQuery &query, const QString &sql, const QList<QVariantList> &columns) {
+        if (columns.first().isEmpty()) return true;
+        if (!query.prepare(sql)) return false;
+        for (const QVariantList &column : columns) {
+            query.addBindValue(column);
+        }
+        Diagnostics::Timer timer(Diagnostics::statement(sql));
+        return query.execBatch();
+    };
+
+    // Événements, agrégats et chronos dans une seule transaction
+    QSqlQuery query(db);
+    if (!db.transaction() ||
+        !batch(query, "INSERT INTO time_events (kind, task_id, person, at, seconds, source) VALUES (?, ?, ?, ?, ?, ?)",
+               {kinds, taskIds, persons, times, seconds, sources}) ||
+        !batch(query, "INSERT INTO time_rollups (task_id, person, week_start, seconds, entries) VALUES (?, ?, ?, ?, ?) "
+                      "ON CONFLICT (task_id, person, week_start) DO UPDATE SET "
+                      "seconds = seconds + excluded.seconds, entries = entries + excluded.entries",
+               {rollupTasks, rollupPersons, rollupWeeks, rollupSeconds, rollupEntries}) ||
+        !batch(query, "INSERT OR REPLACE INTO time_clocks (task_id, person, started_at) VALUES (?, ?, ?)",
+               {startedTasks, startedPersons, startedTimes}) ||
+        !batch(query, "DELETE FROM time_clocks WHERE task_id = ? AND person = ?", {stoppedTasks, stoppedPersons}) ||
+        !db.commit()) {
+        if (error) *error = query.lastError().isValid() ? query.lastError().text() : db.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    pending.clear();
+    pendingRollups.clear();
+    pendingClocks.clear();
+    return true;
+}
+
+QVector<TimeTracker::Rollup> TimeTracker::rollups(const QDate &fromWeek, const QDate &toWeek)
+{
+    QVector<Rollup> result;
+    QString error;
+    if (!flush(&error)) qWarning() << "Failed to write time entries:" << error;
+
+    QSqlQuery query(db);
+    query.prepare("SELECT task_id, person, week_start, seconds, entries FROM time_rollups "
+                  "WHERE week_start BETWEEN :from AND :to ORDER BY week_start, person, task_id");
+    query.bindValue(":from", weekOf(fromWeek).toString("yyyy-MM-dd"));
+    query.bindValue(":to", weekOf(toWeek).toString("yyyy-MM-dd"));
+    if (!query.exec()) {
+        qWarning() << "Failed to read timesheet:" << query.lastError().text();
+        return result;
+    }
+    while (query.next()) {
+        Rollup rollup;
+        rollup.taskId = query.value(0).toString();
+        rollup.person = query.value(1).toString();
+        rollup.weekStart = QDate::fromString(query.value(2).toString(), "yyyy-MM-dd");
+        rollup.seconds = query.value(3).toLongLong();
+        rollup.entries = query.value(4).toInt();
+        result << rollup;
+    }
+    return result;
+}
+
+qint64 TimeTracker::taskSeconds(const QString &taskId)
+{
+    QString error;
+    if (!flush(&error)) qWarning() << "Failed to write time entries:" << error;
+
+    QSqlQuery query(db);
+    query.prepare("SELECT COALESCE(SUM(seconds), 0) FROM time_rollups WHERE task_id = :task_id");
+    query.bindValue(":task_id", taskId);
+    if (!query.exec() || !query.next()) return 0;
+    return query.value(0).toLongLong();
+}
+
+bool TimeTracker::renameTask(const QString &oldId, const QString &newId, QString *error)
+{
+    // Le journal garde l'identifiant d'origine; agrégats et chronos suivent la tâche
+    if (!flush(error)) return false;
+
+    QSqlQuery query(db);
+    if (!db.transaction()) {
+        if (error) *error = db.lastError().text();
+        return false;
+    }
+    bool ok = true;
+    for (const QString &table : {QString("time_rollups"), QString("time_clocks")}) {
+        query.prepare(QString("UPDATE %1 SET task_id = :new_id WHERE task_id = :old_id").arg(table));
+        query.bindValue(":new_id", newId);
+        query.bindValue(":old_id", oldId);
+        ok = ok && query.exec();
+    }
+    if (!ok || !db.commit()) {
+        if (error) *error = ok ? db.lastError().text() : query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    for (const Clock &clock : runningClocks()) {
+        if (clock.taskId != oldId) continue;
+        clocks.remove(clockKey(oldId, clock.person));
+        clocks.insert(clockKey(newId, clock.person), Clock{newId, clock.person, clock.started});
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+#ifndef TIMETRACKER_H
+#define TIMETRACKER_H
+
+#include <QDate>
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QSqlDatabase>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+// Pointage du temps passé sur les tâches. Chaque début, arrêt ou saisie
+// manuelle est ajouté à time_events (jamais modifié), par lots dans une
+// seule transaction. Dans la même transaction, les totaux par tâche,
+// personne et semaine (time_rollups) sont incrémentés : feuilles de temps
+// et facturation ne lisent que ces agrégats, jamais les événements.
+class TimeTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int BatchSize = 256;
+    static constexpr int FlushIntervalMs = 2000;
+
+    struct Clock
+    {
+        QString taskId;
+        QString person;
+        QDateTime started;
+    };
+
+    struct Rollup
+    {
+        QString taskId;
+        QString person;
+        QDate weekStart;
+        qint64 seconds = 0;
+        int entries = 0;
+    };
+
+    explicit TimeTracker(QObject *parent = nullptr);
+    ~TimeTracker();
+
+    void setDatabase(const QSqlDatabase &database);
+    bool initialize(QString *error);
+
+    bool isRunning(const QString &taskId, const QString &person) const;
+    QVector<Clock> runningClocks() const;
+    // Démarre ou arrête le chrono; true si un chrono tourne après l'appel
+    bool toggle(const QString &taskId, const QString &person, const QString &source,
+                const QDateTime &at = QDateTime::currentDateTime());
+    void addEntry(const QString &taskId, const QString &person, const QDateTime &start, qint64 seconds,
+                  const QString &source);
+    // Arrête les chronos d'une tâche supprimée : le temps passé reste compté
+    void stopTask(const QString &taskId, const QString &source);
+
+    bool flush(QString *error = nullptr);
+    int pendingCount() const { return pending.size(); }
+
+    static QDate weekOf(const QDate &date) { return date.addDays(1 - date.dayOfWeek()); }
+
+    // Lectures sur les agrégats seulement, après écriture des lots en attente
+    QVector<Rollup> rollups(const QDate &fromWeek, const QDate &toWeek);
+    qint64 taskSeconds(const QString &taskId);
+    bool renameTask(const QString &oldId, const QString &newId, QString *error);
+
+signals:
+    void clockChanged(const QString &taskId, const QString &person, bool running);
+
+private:
+    struct Event
+    {
+        QString kind;       // start, stop, entry
+        QString taskId;
+        QString person;
+        qint64 at = 0;      // secondes depuis l'époque
+        qint64 seconds = 0;
+        QString source;
+    };
+
+    struct Delta
+    {
+        qint64 seconds = 0;
+        int entries = 0;
+    };
+
+    QSqlDatabase db;
+    QTimer flushTimer;
+    QHash<QString, Clock> clocks;
+    QVector<Event> pending;
+    QHash<QString, Delta> pendingRollups;       // clé tâche / personne / semaine
+    QHash<QString, qint64> pendingClocks;       // clé tâche / personne, 0 = chrono arrêté
+
+    static QString clockKey(const QString &taskId, const QString &person);
+    void record(const Event &event);
+    void addInterval(const QString &taskId, const QString &person, const QDateTime &start, qint64 seconds);
+};
+
+#endif // TIMETRACKER_H
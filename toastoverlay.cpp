@@ -0,0 +1,116 @@
+#include "toastoverlay.h"
+#include "diagnostics.h"
+#include <QEvent>
+#include <QStringList>
+#include <QVBoxLayout>
+
+static const int toast_width = 340;
+static const int toast_margin = 16;
+static const int toast_spacing = 8;
+static const qint64 toast_bytes = sizeof(QFrame) + 2 * sizeof(QLabel) + sizeof(QTimer);
+
+ToastOverlay::ToastOverlay(QWidget *host)
+    : QObject(host),
+    host(host)
+{
+    host->installEventFilter(this);
+}
+
+void ToastOverlay::showToast(const NotificationCenter::Notification &notification)
+{
+    static const QStringList colors = {"#17a2b8", "#ffc107", "#dc3545"};
+
+    Toast toast;
+    toast.id = notification.id;
+    toast.frame = new QFrame(host);
+    toast.frame->setObjectName("toast");
+    toast.frame->setStyleSheet(QString("#toast { background: #343a40; border-left: 5px solid %1; border-radius: 4px; }"
+                                       "QLabel { color: white; background: transparent; }")
+                                   .arg(colors.value(notification.level)));
+    toast.frame->setFixedWidth(toast_width);
+    toast.frame->setCursor(Qt::PointingHandCursor);
+    toast.frame->setToolTip("Click to open the notification history");
+    toast.frame->installEventFilter(this);
+
+    toast.titleLabel = new QLabel(toast.frame);
+    QFont font = toast.titleLabel->font();
+    font.setBold(true);
+    toast.titleLabel->setFont(font);
+    toast.textLabel = new QLabel(toast.frame);
+    toast.textLabel->setWordWrap(true);
+
+    QVBoxLayout *layout = new QVBoxLayout(toast.frame);
+    layout->setContentsMargins(12, 8, 12, 8);
+    layout->addWidget(toast.titleLabel);
+    layout->addWidget(toast.textLabel);
+
+    toast.timer = new QTimer(toast.frame);
+    toast.timer->setSingleShot(true);
+    int id = notification.id;
+    connect(toast.timer, &QTimer::timeout, this, [this, id]() { closeToast(id); });
+
+    setContent(toast, notification);
+    toasts << toast;
+    Diagnostics::objects("toasts").add(1, toast_bytes);
+    toast.frame->show();
+    toast.frame->raise();
+    layoutToasts();
+}
+
+void ToastOverlay::updateToast(const NotificationCenter::Notification &notification)
+{
+    for (Toast &toast : toasts) {
+        if (toast.id != notification.id) continue;
+        setContent(toast, notification);
+        layoutToasts();
+        return;
+    }
+}
+
+void ToastOverlay::setContent(Toast &toast, const NotificationCenter::Notification &notification)
+{
+    toast.titleLabel->setText(notification.count > 1
+                                  ? QString("%1 (x%2)").arg(notification.title).arg(notification.count)
+                                  : notification.title);
+    toast.textLabel->setText(notification.text);
+    toast.frame->adjustSize();
+    toast.timer->start(NotificationCenter::timeoutFor(notification.level));    // une répétition prolonge l'affichage
+}
+
+void ToastOverlay::closeToast(int id)
+{
+    for (int i = 0; i < toasts.size(); ++i) {
+        if (toasts[i].id != id) continue;
+        toasts[i].frame->deleteLater();
+        toasts.remove(i);
+        Diagnostics::objects("toasts").add(-1, -toast_bytes);
+        layoutToasts();
+        emit closed(id);
+        return;
+    }
+}
+
+void ToastOverlay::layoutToasts()
+{
+    int y = toast_margin;
+    for (const Toast &toast : toasts) {
+        toast.frame->move(host->width() - toast_width - toast_margin, y);
+        y += toast.frame->height() + toast_spacing;
+    }
+}
+
+bool ToastOverlay::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == host && event->type() == QEvent::Resize) {
+        layoutToasts();
+    } else if (event->type() == QEvent::MouseButtonRelease) {
+        for (const Toast &toast : toasts) {
+            if (toast.frame != watched) continue;
+            int id = toast.id;
+            closeToast(id);
+            emit clicked(id);
+            return true;
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
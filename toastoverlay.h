@@ -0,0 +1,50 @@
+#ifndef TOASTOVERLAY_H
+#define TOASTOVERLAY_H
+
+#include <QFrame>
+#include <QLabel>
+#include <QMap>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include "notificationcenter.h"
+
+// Toasts empilés en haut à droite de la fenêtre hôte, fermés après un
+// délai ou par un clic. Aucun n'est modal : la boucle d'événements continue.
+class ToastOverlay : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ToastOverlay(QWidget *host);
+
+public slots:
+    void showToast(const NotificationCenter::Notification &notification);
+    void updateToast(const NotificationCenter::Notification &notification);
+
+signals:
+    void closed(int id);
+    void clicked(int id);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct Toast
+    {
+        int id = 0;
+        QFrame *frame = nullptr;
+        QLabel *titleLabel = nullptr;
+        QLabel *textLabel = nullptr;
+        QTimer *timer = nullptr;
+    };
+
+    QWidget *host;
+    QVector<Toast> toasts;
+
+    void setContent(Toast &toast, const NotificationCenter::Notification &notification);
+    void closeToast(int id);
+    void layoutToasts();
+};
+
+#endif // TOASTOVERLAY_H
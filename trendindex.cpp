@@ -0,0 +1,167 @@
+#include "trendindex.h"
+
+void FenwickTree::reset(int size)
+{
+    tree.fill(0, size);
+}
+
+void FenwickTree::add(int index, int delta)
+{
+    for (int i = index + 1; i <= tree.size(); i += i & -i) {
+        tree[i - 1] += delta;
+    }
+}
+
+qint64 FenwickTree::prefix(int index) const
+{
+    qint64 sum = 0;
+    for (int i = qMin(index + 1, int(tree.size())); i > 0; i -= i & -i) {
+        sum += tree[i - 1];
+    }
+    return sum;
+}
+
+void TrendIndex::clear()
+{
+    events.clear();
+    createdTree.reset(0);
+    completedTree.reset(0);
+    dueTree.reset(0);
+    origin = 0;
+}
+
+void TrendIndex::setTask(const QString &taskId, const QDate &created, const QDate &completed, const QDate &due)
+{
+    Events task;
+    task.created = created.isValid() ? created.toJulianDay() : QDate::currentDate().toJulianDay();
+    task.completed = completed.isValid() ? completed.toJulianDay() : 0;
+    task.due = due.isValid() ? due.toJulianDay() : 0;
+    insert(taskId, task);
+}
+
+void TrendIndex::updateTask(const QString &taskId, bool completed, const QDate &due)
+{
+    qint64 today = QDate::currentDate().toJulianDay();
+
+    // Même règle que la colonne completed_at : la date de fin est conservée
+    // tant que la tâche reste terminée
+    Events task = events.value(taskId, Events{today, 0, 0});
+    task.completed = completed ? (task.completed ? task.completed : today) : 0;
+    task.due = due.isValid() ? due.toJulianDay() : 0;
+    insert(taskId, task);
+}
+
+void TrendIndex::renameTask(const QString &oldId, const QString &newId)
+{
+    if (!events.contains(oldId)) return;
+    events.insert(newId, events.take(oldId));
+}
+
+void TrendIndex::removeTask(const QString &taskId)
+{
+    auto it = events.find(taskId);
+    if (it == events.end()) return;
+
+    apply(*it, -1);
+    events.erase(it);
+}
+
+void TrendIndex::insert(const QString &taskId, const Events &task)
+{
+    removeTask(taskId);
+    ensureSpan(task);
+    apply(task, 1);
+    events.insert(taskId, task);
+}
+
+void TrendIndex::apply(const Events &task, int sign)
+{
+    createdTree.add(int(task.created - origin), sign);
+    if (task.completed) completedTree.add(int(task.completed - origin), sign);
+    if (task.due) dueTree.add(int(task.due - origin), sign);
+}
+
+void TrendIndex::ensureSpan(const Events &task)
+{
+    qint64 first = task.created;
+    qint64 last = task.created;
+    for (qint64 day : {task.completed, task.due}) {
+        if (!day) continue;
+        first = qMin(first, day);
+        last = qMax(last, day);
+    }
+
+    int size = createdTree.size();
+    if (size > 0 && first >= origin && last < origin + size) return;
+
+    if (size > 0) {
+        first = qMin(first, origin);
+        last = qMax(last, origin + size - 1);
+    }
+    // Marge pour que les ajouts suivants ne déclenchent pas de reconstruction
+    rebuild(first - 90, last + 365);
+}
+
+void TrendIndex::rebuild(qint64 first, qint64 last)
+{
+    origin = first;
+    int size = int(last - first + 1);
+    createdTree.reset(size);
+    completedTree.reset(size);
+    dueTree.reset(size);
+
+    for (const Events &task : std::as_const(events)) {
+        apply(task, 1);
+    }
+}
+
+int TrendIndex::countUpTo(const FenwickTree &tree, qint64 origin, const QDate &date)
+{
+    if (!date.isValid() || tree.size() == 0) return 0;
+
+    qint64 index = date.toJulianDay() - origin;
+    if (index < 0) return 0;
+    return int(tree.prefix(int(qMin<qint64>(index, tree.size() - 1))));
+}
+
+int TrendIndex::createdUpTo(const QDate &date) const
+{
+    return countUpTo(createdTree, origin, date);
+}
+
+int TrendIndex::completedUpTo(const QDate &date) const
+{
+    return countUpTo(completedTree, origin, date);
+}
+
+int TrendIndex::dueUpTo(const QDate &date) const
+{
+    return countUpTo(dueTree, origin, date);
+}
+
+int TrendIndex::completedBetween(const QDate &from, const QDate &to) const
+{
+    return completedUpTo(to) - completedUpTo(from.addDays(-1));
+}
+
+QDate TrendIndex::firstDate() const
+{
+    if (events.isEmpty()) return QDate();
+
+    qint64 first = events.cbegin()->created;
+    for (const Events &task : events) {
+        first = qMin(first, task.created);
+    }
+    return QDate::fromJulianDay(first);
+}
+
+QDate TrendIndex::lastDate() const
+{
+    if (events.isEmpty()) return QDate();
+
+    qint64 last = 0;
+    for (const Events &task : events) {
+        last = qMax(last, qMax(task.created, qMax(task.completed, task.due)));
+    }
+    return QDate::fromJulianDay(last);
+}
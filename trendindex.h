@@ -0,0 +1,65 @@
+#ifndef TRENDINDEX_H
+#define TRENDINDEX_H
+
+#include <QDate>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// Arbre de Fenwick : somme préfixe et mise à jour en O(log n)
+class FenwickTree
+{
+public:
+    void reset(int size);
+    int size() const { return tree.size(); }
+    void add(int index, int delta);
+    qint64 prefix(int index) const;    // somme des cases [0, index]
+
+private:
+    QVector<qint64> tree;
+};
+
+// Événements datés des tâches (création, fin, échéance) indexés par jour.
+// Toute requête « combien jusqu'au jour d » coûte O(log n), ce qui permet de
+// redessiner les courbes de tendance à chaque mouvement du curseur.
+class TrendIndex
+{
+public:
+    void clear();
+    void setTask(const QString &taskId, const QDate &created, const QDate &completed, const QDate &due);
+    void updateTask(const QString &taskId, bool completed, const QDate &due);
+    void renameTask(const QString &oldId, const QString &newId);
+    void removeTask(const QString &taskId);
+
+    bool isEmpty() const { return events.isEmpty(); }
+    QDate firstDate() const;
+    QDate lastDate() const;
+
+    int createdUpTo(const QDate &date) const;
+    int completedUpTo(const QDate &date) const;
+    int dueUpTo(const QDate &date) const;
+    int completedBetween(const QDate &from, const QDate &to) const;
+    int openAt(const QDate &date) const { return createdUpTo(date) - completedUpTo(date); }
+
+private:
+    struct Events
+    {
+        qint64 created;
+        qint64 completed;    // 0 si la tâche n'est pas terminée
+        qint64 due;          // 0 si pas d'échéance
+    };
+
+    QHash<QString, Events> events;
+    FenwickTree createdTree;
+    FenwickTree completedTree;
+    FenwickTree dueTree;
+    qint64 origin = 0;
+
+    void insert(const QString &taskId, const Events &task);
+    void apply(const Events &task, int sign);
+    void ensureSpan(const Events &task);
+    void rebuild(qint64 first, qint64 last);
+    static int countUpTo(const FenwickTree &tree, qint64 origin, const QDate &date);
+};
+
+#endif // TRENDINDEX_H
@@ -0,0 +1,175 @@
+#include "undojournal.h"
+#include <QDateTime>
+
+UndoJournal::UndoJournal(int depth, int maxChanges)
+    : maxDepth(qMax(1, depth)),
+    maxChanges(qMax(1, maxChanges)),
+    totalChanges(0)
+{
+}
+
+void UndoJournal::setLimits(int depth, int changes)
+{
+    maxDepth = qMax(1, depth);
+    maxChanges = qMax(1, changes);
+    trim();
+}
+
+QVector<UndoJournal::Change> UndoJournal::diff(const QString &taskId, const QStringList &before, const QStringList &after)
+{
+    QVector<Change> changes;
+    for (int field = Id; field < Exists; ++field) {
+        QString from = before.value(field);
+        QString to = after.value(field);
+        if (from != to) {
+            changes.append({taskId, Field(field), from, to});
+        }
+    }
+    return changes;
+}
+
+QVector<UndoJournal::Change> UndoJournal::created(const QStringList &state)
+{
+    QVector<Change> changes = diff(state.value(Id), emptyState(), state);
+    changes.append({state.value(Id), Exists, QString(), "1"});
+    return changes;
+}
+
+QVector<UndoJournal::Change> UndoJournal::removed(const QStringList &state)
+{
+    QVector<Change> changes = diff(state.value(Id), state, emptyState());
+    changes.append({state.value(Id), Exists, "1", QString()});
+    return changes;
+}
+
+QStringList UndoJournal::emptyState()
+{
+    QStringList state;
+    for (int field = Id; field < Exists; ++field) {
+        state << QString();
+    }
+    return state;
+}
+
+QString UndoJournal::currentId(const Entry &entry)
+{
+    for (const Change &change : entry.changes) {
+        if (change.field == Id) return change.after;
+    }
+    return entry.changes.isEmpty() ? QString() : entry.changes.first().taskId;
+}
+
+bool UndoJournal::merge(Entry &entry, const QVector<Change> &changes)
+{
+    // Seulement une suite de modifications d'une même tâche, sans création ni suppression
+    QString id = currentId(entry);
+    for (const Change &change : changes) {
+        if (change.taskId != id || change.field == Exists) return false;
+    }
+
+    QString originalId = entry.changes.first().taskId;
+    for (const Change &change : changes) {
+        bool found = false;
+        for (Change &existing : entry.changes) {
+            if (existing.field != change.field) continue;
+            existing.after = change.after;      // l'état initial reste celui de la première modification
+            found = true;
+            break;
+        }
+        if (!found) {
+            entry.changes.append({originalId, change.field, change.before, change.after});
+        }
+    }
+
+    // Un champ revenu à sa valeur de départ ne coûte plus rien
+    for (int i = entry.changes.size() - 1; i >= 0; --i) {
+        if (entry.changes[i].before == entry.changes[i].after) entry.changes.remove(i);
+    }
+    return true;
+}
+
+bool UndoJournal::record(const QString &label, const QVector<Change> &changes, bool mergeable)
+{
+    if (changes.isEmpty()) return true;
+    if (!fits(changes.size())) {
+        clear();
+        return false;
+    }
+
+    // Une nouvelle modification rend l'historique à rétablir caduc
+    for (const Entry &entry : redoEntries) {
+        totalChanges -= entry.changes.size();
+    }
+    redoEntries.clear();
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (mergeable && !undoEntries.isEmpty()) {
+        Entry &last = undoEntries.last();
+        int previous = last.changes.size();
+        if (last.mergeable && now - last.at <= MergeWindowMs && merge(last, changes)) {
+            totalChanges += last.changes.size() - previous;
+            last.at = now;
+            if (last.changes.isEmpty()) undoEntries.removeLast();
+            trim();
+            return true;
+        }
+    }
+
+    Entry entry;
+    entry.label = label;
+    entry.changes = changes;
+    entry.at = now;
+    entry.mergeable = mergeable;
+    undoEntries.append(entry);
+    totalChanges += changes.size();
+    trim();
+    return true;
+}
+
+void UndoJournal::undone()
+{
+    if (undoEntries.isEmpty()) return;
+    Entry entry = undoEntries.takeLast();
+    entry.mergeable = false;    // une modification après une annulation ne s'y ajoute pas
+    redoEntries.append(entry);
+}
+
+void UndoJournal::redone()
+{
+    if (redoEntries.isEmpty()) return;
+    undoEntries.append(redoEntries.takeLast());
+}
+
+QSet<QString> UndoJournal::taskIds() const
+{
+    QSet<QString> ids;
+    for (const QVector<Entry> *entries : {&undoEntries, &redoEntries}) {
+        for (const Entry &entry : *entries) {
+            for (const Change &change : entry.changes) {
+                ids.insert(change.taskId);
+                if (change.field == Id) ids << change.before << change.after;
+            }
+        }
+    }
+    return ids;
+}
+
+void UndoJournal::clear()
+{
+    undoEntries.clear();
+    redoEntries.clear();
+    totalChanges = 0;
+}
+
+void UndoJournal::trim()
+{
+    // Les plus anciennes entrées partent d'abord, puis les rétablissements les plus lointains
+    while (!undoEntries.isEmpty() && (undoEntries.size() > maxDepth || totalChanges > maxChanges)) {
+        totalChanges -= undoEntries.first().changes.size();
+        undoEntries.removeFirst();
+    }
+    while (!redoEntries.isEmpty() && totalChanges > maxChanges) {
+        totalChanges -= redoEntries.first().changes.size();
+        redoEntries.removeFirst();
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef UNDOJOURNAL_H
+#define UNDOJOURNAL_H
+
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Journal annuler / rétablir par écarts de champs : une entrée ne garde que
+// les champs modifiés (avant, après), jamais la ligne entière sauf pour une
+// création ou une suppression. Deux modifications rapprochées de la même
+// tâche fusionnent en une seule entrée. Profondeur et nombre total d'écarts
+// sont bornés; une opération plus grosse que la borne n'est pas journalisée.
+class UndoJournal
+{
+public:
+    // Colonnes 0 à 7 de la table, puis les champs hors table
+    enum Field : qint8 {
+        Id, Name, Description, Status, Priority, StartDate, EndDate, AssignedTo,
+        Predecessors, Project, PlannedCost, ActualCost, Site,
+        CreatedAt, CompletedAt,     // horodatages enregistrés, rendus tels quels
+        Exists,     // "1" : la tâche existe, "" : absente
+        FieldCount
+    };
+
+    struct Change
+    {
+        QString taskId;     // ID avant l'opération
+        Field field = Name;
+        QString before;
+        QString after;
+    };
+
+    struct Entry
+    {
+        QString label;
+        QVector<Change> changes;
+        qint64 at = 0;              // ms depuis l'époque, pour la fusion
+        bool mergeable = false;
+    };
+
+    static constexpr int DefaultDepth = 100;
+    static constexpr int DefaultMaxChanges = 50000;
+    static constexpr int MergeWindowMs = 3000;
+
+    explicit UndoJournal(int depth = DefaultDepth, int maxChanges = DefaultMaxChanges);
+
+    void setLimits(int depth, int maxChanges);
+    int depth() const { return maxDepth; }
+    bool fits(int changeCount) const { return changeCount <= maxChanges; }
+
+    // États complets de Id à CompletedAt (Exists valeurs); seuls les champs différents sont gardés
+    static QVector<Change> diff(const QString &taskId, const QStringList &before, const QStringList &after);
+    static QVector<Change> created(const QStringList &state);
+    static QVector<Change> removed(const QStringList &state);
+    static QStringList emptyState();
+
+    // false si l'opération dépasse la borne à elle seule : le journal est vidé
+    bool record(const QString &label, const QVector<Change> &changes, bool mergeable = false);
+
+    bool canUndo() const { return !undoEntries.isEmpty(); }
+    bool canRedo() const { return !redoEntries.isEmpty(); }
+    const Entry &nextUndo() const { return undoEntries.last(); }
+    const Entry &nextRedo() const { return redoEntries.last(); }
+
+    // Après application réussie de nextUndo() / nextRedo()
+    void undone();
+    void redone();
+    void clear();
+
+    int changeCount() const { return totalChanges; }
+    // Tâches dont une entrée, à annuler ou à rétablir, parle encore
+    QSet<QString> taskIds() const;
+
+private:
+    QVector<Entry> undoEntries;
+    QVector<Entry> redoEntries;
+    int maxDepth;
+    int maxChanges;
+    int totalChanges;
+
+    static QString currentId(const Entry &entry);
+    static bool merge(Entry &entry, const QVector<Change> &changes);
+    void trim();
+};
+
+#endif // UNDOJOURNAL_H
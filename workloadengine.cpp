@@ -0,0 +1,176 @@
+#include "workloadengine.h"
+#include <algorithm>
+
+QString WorkloadEngine::keyFor(const QString &assignee)
+{
+    return assignee.trimmed().toLower();
+}
+
+void WorkloadEngine::clear()
+{
+    intervals.clear();
+    profiles.clear();
+}
+
+void WorkloadEngine::applyDelta(Profile &profile, qint64 day, int delta)
+{
+    int &value = profile.deltas[day];
+    value += delta;
+    if (value == 0) {
+        profile.deltas.remove(day);
+    }
+    profile.dirty = true;
+}
+
+void WorkloadEngine::updateTask(const QString &taskId, const QString &assignee,
+                                const QDate &start, const QDate &end)
+{
+    removeTask(taskId);
+
+    QString key = keyFor(assignee);
+    if (key.isEmpty() || !start.isValid()) return;
+
+    qint64 first = start.toJulianDay();
+    qint64 last = end.isValid() ? qMax(first, end.toJulianDay()) : first;
+
+    Profile &profile = profiles[key];
+    if (profile.name.isEmpty()) {
+        profile.name = assignee.trimmed();
+    }
+    applyDelta(profile, first, 1);
+    applyDelta(profile, last + 1, -1);
+    profile.taskCount++;
+
+    intervals.insert(taskId, {key, first, last});
+}
+
+void WorkloadEngine::removeTask(const QString &taskId)
+{
+    auto it = intervals.find(taskId);
+    if (it == intervals.end()) return;
+
+    auto profileIt = profiles.find(it->key);
+    if (profileIt != profiles.end()) {
+        applyDelta(*profileIt, it->start, -1);
+        applyDelta(*profileIt, it->end + 1, 1);
+        if (--profileIt->taskCount == 0) {
+            profiles.erase(profileIt);
+        }
+    }
+    intervals.erase(it);
+}
+
+const WorkloadEngine::Profile *WorkloadEngine::cleanProfile(const QString &key) const
+{
+    auto it = profiles.constFind(key);
+    if (it == profiles.constEnd()) return nullptr;
+
+    const Profile &profile = it.value();
+    if (profile.dirty) {
+        profile.days.clear();
+        profile.levels.clear();
+        profile.peak = 0;
+
+        int level = 0;
+        for (auto delta = profile.deltas.constBegin(); delta != profile.deltas.constEnd(); ++delta) {
+            level += delta.value();
+            profile.days << delta.key();
+            profile.levels << level;
+            profile.peak = qMax(profile.peak, level);
+        }
+        profile.dirty = false;
+    }
+    return &profile;
+}
+
+int WorkloadEngine::levelAt(const Profile &profile, qint64 day) const
+{
+    auto it = std::upper_bound(profile.days.constBegin(), profile.days.constEnd(), day);
+    int index = int(it - profile.days.constBegin()) - 1;
+    return index < 0 ? 0 : profile.levels[index];
+}
+
+QStringList WorkloadEngine::assignees() const
+{
+    QStringList names;
+    for (const Profile &profile : profiles) {
+        names << profile.name;
+    }
+    std::sort(names.begin(), names.end(), [](const QString &a, const QString &b) {
+        return a.compare(b, Qt::CaseInsensitive) < 0;
+    });
+    return names;
+}
+
+int WorkloadEngine::peak(const QString &assignee) const
+{
+    const Profile *profile = cleanProfile(keyFor(assignee));
+    return profile ? profile->peak : 0;
+}
+
+QVector<int> WorkloadEngine::dailyLoad(const QString &assignee, const QDate &from, int days) const
+{
+    QVector<int> load(qMax(0, days), 0);
+    const Profile *profile = cleanProfile(keyFor(assignee));
+    if (!profile || !from.isValid()) return load;
+
+    qint64 first = from.toJulianDay();
+    int next = int(std::upper_bound(profile->days.constBegin(), profile->days.constEnd(), first)
+                   - profile->days.constBegin());
+    int level = levelAt(*profile, first);
+
+    for (int d = 0; d < load.size(); ++d) {
+        while (next < profile->days.size() && profile->days[next] <= first + d) {
+            level = profile->levels[next];
+            next++;
+        }
+        load[d] = level;
+    }
+    return load;
+}
+
+QVector<WorkloadEngine::Overload> WorkloadEngine::overloaded(int limit, const QDate &from, const QDate &to) const
+{
+    QVector<Overload> result;
+    if (!from.isValid() || !to.isValid() || to < from) return result;
+
+    qint64 first = from.toJulianDay();
+    qint64 last = to.toJulianDay();
+
+    for (auto it = profiles.constBegin(); it != profiles.constEnd(); ++it) {
+        const Profile *profile = cleanProfile(it.key());
+        if (profile->peak <= limit) continue;
+
+        // Parcours des seuls paliers qui recoupent [first, last]
+        int index = int(std::upper_bound(profile->days.constBegin(), profile->days.constEnd(), first)
+                        - profile->days.constBegin()) - 1;
+        index = qMax(index, 0);
+
+        Overload overload;
+        overload.assignee = profile->name;
+        overload.peak = 0;
+
+        for (int i = index; i < profile->days.size() && profile->days[i] <= last; ++i) {
+            if (profile->levels[i] <= limit) continue;
+
+            qint64 segmentStart = qMax(profile->days[i], first);
+            qint64 segmentEnd = (i + 1 < profile->days.size()) ? qMin(profile->days[i + 1] - 1, last) : last;
+            if (segmentEnd < segmentStart) continue;
+
+            if (overload.peak == 0) {
+                overload.from = QDate::fromJulianDay(segmentStart);
+            }
+            overload.to = QDate::fromJulianDay(segmentEnd);
+            overload.peak = qMax(overload.peak, profile->levels[i]);
+        }
+
+        if (overload.peak > 0) {
+            result << overload;
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const Overload &a, const Overload &b) {
+        return a.peak > b.peak;
+    });
+    return result;
+}
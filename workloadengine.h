@@ -0,0 +1,67 @@
+#ifndef WORKLOADENGINE_H
+#define WORKLOADENGINE_H
+
+#include <QDate>
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Charge de travail par personne : nombre de tâches simultanées par jour.
+// Chaque personne garde un tableau de différences (+1 au début, -1 au
+// lendemain de la fin) mis à jour à chaque modification; le profil en
+// escalier n'est reconstruit que pour les personnes modifiées.
+class WorkloadEngine
+{
+public:
+    struct Overload
+    {
+        QString assignee;
+        QDate from;
+        QDate to;
+        int peak;
+    };
+
+    void clear();
+    void updateTask(const QString &taskId, const QString &assignee, const QDate &start, const QDate &end);
+    void removeTask(const QString &taskId);
+
+    QStringList assignees() const;
+    int peak(const QString &assignee) const;
+    QVector<int> dailyLoad(const QString &assignee, const QDate &from, int days) const;
+
+    // Personnes ayant plus de 'limit' tâches simultanées entre from et to
+    QVector<Overload> overloaded(int limit, const QDate &from, const QDate &to) const;
+
+private:
+    struct Interval
+    {
+        QString key;
+        qint64 start;
+        qint64 end;
+    };
+
+    struct Profile
+    {
+        QString name;
+        QMap<qint64, int> deltas;
+        int taskCount = 0;
+
+        // Profil en escalier : charge levels[i] à partir du jour days[i]
+        mutable bool dirty = true;
+        mutable QVector<qint64> days;
+        mutable QVector<int> levels;
+        mutable int peak = 0;
+    };
+
+    QHash<QString, Interval> intervals;
+    QHash<QString, Profile> profiles;
+
+    static QString keyFor(const QString &assignee);
+    void applyDelta(Profile &profile, qint64 day, int delta);
+    const Profile *cleanProfile(const QString &key) const;
+    int levelAt(const Profile &profile, qint64 day) const;
+};
+
+#endif // WORKLOADENGINE_H
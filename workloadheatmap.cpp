@@ -0,0 +1,109 @@
+#include "workloadheatmap.h"
+#include <QHelpEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QToolTip>
+
+WorkloadHeatmap::WorkloadHeatmap(QWidget *parent)
+    : QWidget(parent),
+    days(0),
+    limit(1)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void WorkloadHeatmap::setData(const QStringList &newNames, const QVector<QVector<int>> &newLoads,
+                              const QDate &newFrom, int newLimit)
+{
+    names = newNames;
+    loads = newLoads;
+    from = newFrom;
+    limit = qMax(1, newLimit);
+    days = loads.isEmpty() ? 0 : loads.first().size();
+
+    resize(sizeHint());
+    update();
+}
+
+QSize WorkloadHeatmap::sizeHint() const
+{
+    return QSize(NameWidth + days * CellSize + 1, HeaderHeight + names.size() * CellSize + 1);
+}
+
+QColor WorkloadHeatmap::colorFor(int load) const
+{
+    if (load <= 0) return QColor(248, 249, 250);
+    if (load > limit) return QColor(220, 53, 69);
+
+    // Du vert clair (charge faible) à l'ambre (charge maximale autorisée)
+    qreal ratio = qreal(load) / limit;
+    return QColor(int(212 + (255 - 212) * ratio),
+                  int(237 + (193 - 237) * ratio),
+                  int(218 + (7 - 218) * ratio));
+}
+
+void WorkloadHeatmap::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    QRect area = event->rect();
+    painter.fillRect(area, Qt::white);
+
+    int firstRow = qMax(0, (area.top() - HeaderHeight) / CellSize);
+    int lastRow = qMin(int(names.size()) - 1, (area.bottom() - HeaderHeight) / CellSize);
+    int firstCol = qMax(0, (area.left() - NameWidth) / CellSize);
+    int lastCol = qMin(days - 1, (area.right() - NameWidth) / CellSize);
+
+    // En-tête : jour du mois et initiale du jour de la semaine
+    painter.setPen(QColor(52, 58, 64));
+    for (int c = firstCol; c <= lastCol; ++c) {
+        QDate date = from.addDays(c);
+        QRect cell(NameWidth + c * CellSize, 0, CellSize, HeaderHeight);
+        if (date.dayOfWeek() >= 6) {
+            painter.fillRect(cell, QColor(233, 236, 239));
+        }
+        painter.drawText(cell.adjusted(0, 2, 0, -HeaderHeight / 2), Qt::AlignCenter,
+                         date.toString("ddd").left(1));
+        painter.drawText(cell.adjusted(0, HeaderHeight / 2, 0, -2), Qt::AlignCenter,
+                         QString::number(date.day()));
+    }
+
+    for (int r = firstRow; r <= lastRow; ++r) {
+        int top = HeaderHeight + r * CellSize;
+
+        painter.setPen(QColor(52, 58, 64));
+        painter.drawText(QRect(4, top, NameWidth - 8, CellSize), Qt::AlignVCenter | Qt::AlignLeft,
+                         fontMetrics().elidedText(names[r], Qt::ElideRight, NameWidth - 8));
+
+        for (int c = firstCol; c <= lastCol; ++c) {
+            int load = loads[r].value(c);
+            QRect cell(NameWidth + c * CellSize, top, CellSize, CellSize);
+            painter.fillRect(cell.adjusted(1, 1, 0, 0), colorFor(load));
+            if (load > 0) {
+                painter.setPen(load > limit ? Qt::white : QColor(52, 58, 64));
+                painter.drawText(cell, Qt::AlignCenter, QString::number(load));
+            }
+        }
+    }
+}
+
+bool WorkloadHeatmap::event(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent *helpEvent = static_cast<QHelpEvent*>(event);
+        int row = (helpEvent->pos().y() - HeaderHeight) / CellSize;
+        int col = (helpEvent->pos().x() - NameWidth) / CellSize;
+
+        if (helpEvent->pos().y() >= HeaderHeight && helpEvent->pos().x() >= NameWidth
+            && row < names.size() && col < days) {
+            QToolTip::showText(helpEvent->globalPos(),
+                               QString("%1, %2: %3 task(s)")
+                                   .arg(names[row], from.addDays(col).toString("yyyy-MM-dd"))
+                                   .arg(loads[row].value(col)),
+                               this);
+        } else {
+            QToolTip::hideText();
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
@@ -0,0 +1,38 @@
+#ifndef WORKLOADHEATMAP_H
+#define WORKLOADHEATMAP_H
+
+#include <QDate>
+#include <QStringList>
+#include <QVector>
+#include <QWidget>
+
+// Carte de chaleur personnes x jours; seules les cellules exposées sont dessinées
+class WorkloadHeatmap : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit WorkloadHeatmap(QWidget *parent = nullptr);
+
+    void setData(const QStringList &names, const QVector<QVector<int>> &loads, const QDate &from, int limit);
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    bool event(QEvent *event) override;
+
+private:
+    static const int NameWidth = 140;
+    static const int CellSize = 24;
+    static const int HeaderHeight = 40;
+
+    QStringList names;
+    QVector<QVector<int>> loads;
+    QDate from;
+    int days;
+    int limit;
+
+    QColor colorFor(int load) const;
+};
+
+#endif // WORKLOADHEATMAP_H